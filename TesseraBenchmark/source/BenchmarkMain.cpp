@@ -0,0 +1,27 @@
+#include <cstdlib>
+#include <exception>
+
+#include "BenchmarkRunner.h"
+#include "utils/TesseraLog.h"
+
+// Example: TesseraBenchmark --name=many_draws --draws=5000 --trianglesPerDraw=16 --frames=2000 --output=many_draws.json
+int main(const int argc, char** argv)
+{
+    try
+    {
+        const auto settings = tessera::benchmark::BenchmarkSettings::parse(argc, argv);
+        const auto results = tessera::benchmark::BenchmarkRunner(settings).run();
+        results.writeJson(settings.output);
+
+        tessera::TesseraLog::send(tessera::LogType::INFO, "Benchmark", settings.name + ": " + std::to_string(results.measuredFrames) + " frames, CPU p50 "
+            + std::to_string(results.cpuFrameTimes.p50Ms) + " ms, p99 " + std::to_string(results.cpuFrameTimes.p99Ms) + " ms, GPU p50 "
+            + std::to_string(results.gpuFrameTimes.p50Ms) + " ms. Results written to " + settings.output + ".");
+    }
+    catch (const std::exception& exception)
+    {
+        tessera::TesseraLog::send(tessera::LogType::FATAL, "Benchmark", exception.what());
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,108 @@
+#include "BenchmarkResults.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <numeric>
+#include <stdexcept>
+
+namespace tessera::benchmark
+{
+
+	namespace
+	{
+		// Nearest-rank percentile of sorted values.
+		double percentile(const std::vector<double>& sortedValues, const double fraction)
+		{
+			const auto rank = static_cast<size_t>(std::ceil(fraction * static_cast<double>(sortedValues.size())));
+			return sortedValues[std::clamp<size_t>(rank, 1, sortedValues.size()) - 1];
+		}
+
+		std::string escape(const std::string& text)
+		{
+			std::string escaped;
+			escaped.reserve(text.size());
+			for (const char c : text)
+			{
+				if (c == '"' || c == '\\')
+				{
+					escaped += '\\';
+				}
+				escaped += c;
+			}
+			return escaped;
+		}
+
+		void writeStatistics(std::ofstream& file, const char* name, const FrameTimeStatistics& statistics)
+		{
+			file << "  \"" << name << "\": { \"samples\": " << statistics.samples
+				<< ", \"meanMs\": " << statistics.meanMs
+				<< ", \"minMs\": " << statistics.minMs
+				<< ", \"p50Ms\": " << statistics.p50Ms
+				<< ", \"p90Ms\": " << statistics.p90Ms
+				<< ", \"p99Ms\": " << statistics.p99Ms
+				<< ", \"maxMs\": " << statistics.maxMs << " }";
+		}
+	}
+
+	FrameTimeStatistics FrameTimeStatistics::compute(std::vector<double> frameTimesMs)
+	{
+		FrameTimeStatistics statistics;
+		if (frameTimesMs.empty())
+		{
+			return statistics;
+		}
+
+		std::ranges::sort(frameTimesMs);
+
+		statistics.samples = frameTimesMs.size();
+		statistics.meanMs = std::accumulate(frameTimesMs.begin(), frameTimesMs.end(), 0.0) / static_cast<double>(frameTimesMs.size());
+		statistics.minMs = frameTimesMs.front();
+		statistics.p50Ms = percentile(frameTimesMs, 0.50);
+		statistics.p90Ms = percentile(frameTimesMs, 0.90);
+		statistics.p99Ms = percentile(frameTimesMs, 0.99);
+		statistics.maxMs = frameTimesMs.back();
+
+		return statistics;
+	}
+
+	void BenchmarkResults::writeJson(const std::string& filename) const
+	{
+		std::ofstream file(filename, std::ios::trunc);
+		if (!file.is_open())
+		{
+			throw std::runtime_error("BenchmarkResults: failed to open " + filename + " for writing.");
+		}
+
+		file << std::fixed << std::setprecision(4);
+		file << "{\n";
+		file << "  \"name\": \"" << escape(settings.name) << "\",\n";
+		file << "  \"device\": { \"name\": \"" << escape(deviceName) << "\", \"apiVersion\": " << apiVersion << ", \"driverVersion\": " << driverVersion << " },\n";
+
+		file << "  \"settings\": { \"frames\": " << settings.frames
+			<< ", \"warmupFrames\": " << settings.warmupFrames
+			<< ", \"draws\": " << settings.draws
+			<< ", \"trianglesPerDraw\": " << settings.trianglesPerDraw
+			<< ", \"instances\": " << settings.instances
+			<< ", \"uploadsPerFrame\": " << settings.uploadsPerFrame
+			<< ", \"uploadSize\": " << settings.uploadSize
+			<< ", \"resizeInterval\": " << settings.resizeInterval
+			<< ", \"windowed\": " << (settings.windowed || settings.resizeInterval > 0 ? "true" : "false") << ", \"config\": {";
+		for (size_t i = 0; i < settings.configOverrides.size(); ++i)
+		{
+			const auto& [key, value] = settings.configOverrides[i];
+			file << (i == 0 ? " " : ", ") << "\"" << escape(key) << "\": \"" << escape(value) << "\"";
+		}
+		file << " } },\n";
+
+		file << "  \"measuredFrames\": " << measuredFrames << ",\n";
+		file << "  \"elapsedSeconds\": " << elapsedSeconds << ",\n";
+		file << "  \"framesPerSecond\": " << (elapsedSeconds > 0.0 ? static_cast<double>(measuredFrames) / elapsedSeconds : 0.0) << ",\n";
+		writeStatistics(file, "cpuFrameTimes", cpuFrameTimes);
+		file << ",\n";
+		writeStatistics(file, "gpuFrameTimes", gpuFrameTimes);
+		file << "\n}\n";
+	}
+
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "BenchmarkSettings.h"
+
+namespace tessera::benchmark
+{
+
+	struct FrameTimeStatistics
+	{
+		size_t samples = 0;
+		double meanMs = 0.0;
+		double minMs = 0.0;
+		double p50Ms = 0.0;
+		double p90Ms = 0.0;
+		double p99Ms = 0.0;
+		double maxMs = 0.0;
+
+		static FrameTimeStatistics compute(std::vector<double> frameTimesMs);
+	};
+
+	struct BenchmarkResults
+	{
+		BenchmarkSettings settings;
+
+		std::string deviceName;
+		uint32_t apiVersion = 0;
+		uint32_t driverVersion = 0;
+
+		uint64_t measuredFrames = 0;
+		double elapsedSeconds = 0.0;
+		FrameTimeStatistics cpuFrameTimes;
+		// Empty when the device cannot write timestamps on the graphics queue.
+		FrameTimeStatistics gpuFrameTimes;
+
+		// Machine-readable result, stable across versions so runs of different builds can be diffed.
+		void writeJson(const std::string& filename) const;
+	};
+
+}
@@ -0,0 +1,224 @@
+#include "BenchmarkRunner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <optional>
+#include <vector>
+#include <GLFW/glfw3.h>
+
+#include "Application.h"
+#include "utils/EngineConfig.h"
+#include "utils/TesseraLog.h"
+#include "utils/interfaces/ServiceLocator.h"
+
+namespace tessera::benchmark
+{
+
+	void BenchmarkRunner::applyConfigOverrides() const
+	{
+		const bool windowed = settings.windowed || settings.resizeInterval > 0;
+
+		EngineConfig::setOverride("render.headless", windowed ? "false" : "true");
+		// Measure raw throughput; a capped or vsynced run would only measure the display.
+		EngineConfig::setOverride("render.maxFrameRate", "0");
+		EngineConfig::setOverride("render.presentMode", "immediate");
+		EngineConfig::setOverride("profiling.gpu", "true");
+		EngineConfig::setOverride("profiling.logIntervalFrames", "0");
+
+		for (const auto& [key, value] : settings.configOverrides)
+		{
+			EngineConfig::setOverride(key, value);
+		}
+	}
+
+	BenchmarkResults BenchmarkRunner::run() const
+	{
+		applyConfigOverrides();
+
+		Application application{};
+		application.init();
+
+		const auto& glfwInitializer = ServiceLocator::getService<glfw::GlfwInitializer>();
+		const auto& queueManager = ServiceLocator::getService<vulkan::QueueManager>();
+		const auto& commandBufferManager = ServiceLocator::getService<vulkan::CommandBufferManager>();
+		const auto& uploadManager = ServiceLocator::getService<vulkan::UploadManager>();
+		const auto& memoryAllocator = ServiceLocator::getService<vulkan::MemoryAllocator>();
+		const auto& gpuProfiler = ServiceLocator::getService<vulkan::GpuProfiler>();
+		const auto& deviceManager = ServiceLocator::getService<vulkan::DeviceManager>();
+		const auto& frameScheduler = ServiceLocator::getService<FrameScheduler>();
+
+		if (settings.resizeInterval > 0 && glfwInitializer->isHeadless())
+		{
+			throw std::runtime_error("BenchmarkRunner: resize storms need a window, do not override render.headless.");
+		}
+
+		BenchmarkResults results;
+		results.settings = settings;
+
+		VkPhysicalDeviceProperties deviceProperties;
+		vkGetPhysicalDeviceProperties(deviceManager->getPhysicalDevice(), &deviceProperties);
+		results.deviceName = deviceProperties.deviceName;
+		results.apiVersion = deviceProperties.apiVersion;
+		results.driverVersion = deviceProperties.driverVersion;
+
+		const vulkan::MeshHandle defaultMesh = ServiceLocator::getService<vulkan::BufferManager>()->getDefaultMesh();
+
+		// Instances come from a real instance buffer, laid out on a grid covering the view.
+		const auto& instancingManager = ServiceLocator::getService<vulkan::InstancingManager>();
+		std::optional<vulkan::InstanceBatchHandle> instanceBatch;
+		if (settings.instances > 1)
+		{
+			const int side = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(settings.instances))));
+			const float spacing = 2.0f / static_cast<float>(side);
+
+			std::vector<InstanceData> instances(settings.instances);
+			for (int i = 0; i < settings.instances; ++i)
+			{
+				instances[i].transform = { -1.0f + spacing * (static_cast<float>(i % side) + 0.5f), -1.0f + spacing * (static_cast<float>(i / side) + 0.5f), 0.0f, spacing * 0.5f };
+			}
+			instanceBatch = instancingManager->createBatch(defaultMesh, instances);
+		}
+
+		// Replace the engine's draws with the requested number of draws over the same mesh.
+		commandBufferManager->setDrawListCallback([&instancingManager, instanceBatch, draws = settings.draws, trianglesPerDraw = settings.trianglesPerDraw](vulkan::DrawList& drawList)
+			{
+				vulkan::DrawCommand draw = instanceBatch.has_value() ? instancingManager->makeDraw(*instanceBatch) : drawList.front();
+				if (trianglesPerDraw > 0)
+				{
+					draw.indexCount = std::min(draw.indexCount, static_cast<uint32_t>(trianglesPerDraw) * 3);
+				}
+
+				drawList.assign(static_cast<size_t>(draws), draw);
+			});
+
+		// The GPU-driven path draws objects instead; one per draw and instance, on a grid twice the size of the view so culling has work to do.
+		const auto& indirectDrawManager = ServiceLocator::getService<vulkan::IndirectDrawManager>();
+		if (indirectDrawManager->isEnabled())
+		{
+			const int objectCount = settings.draws * settings.instances;
+			const int side = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(objectCount))));
+			const float spacing = 4.0f / static_cast<float>(side);
+
+			std::vector<vulkan::GpuObject> objects;
+			objects.reserve(objectCount);
+			for (int i = 0; i < objectCount; ++i)
+			{
+				const glm::vec3 position(-2.0f + spacing * (static_cast<float>(i % side) + 0.5f), -2.0f + spacing * (static_cast<float>(i / side) + 0.5f), 0.5f);
+				vulkan::GpuObject object = indirectDrawManager->makeMeshObject(defaultMesh, position, spacing * 0.5f);
+				if (settings.trianglesPerDraw > 0)
+				{
+					object.indexCount = std::min(object.indexCount, static_cast<uint32_t>(settings.trianglesPerDraw) * 3);
+				}
+				objects.push_back(object);
+			}
+			indirectDrawManager->setObjects(objects);
+		}
+
+		VkBuffer uploadTarget = VK_NULL_HANDLE;
+		vulkan::MemoryAllocation uploadTargetMemory;
+		std::vector<uint8_t> uploadData;
+		// Every frame in flight uploads to a region of its own. A frame's batch is retired with the frame, before
+		// the region comes around again, whereas consecutive batches are not ordered against each other.
+		const int uploadRegions = commandBufferManager->getNumberOfBuffers();
+		const VkDeviceSize uploadRegionSize = static_cast<VkDeviceSize>(settings.uploadsPerFrame) * settings.uploadSize;
+		if (settings.uploadsPerFrame > 0)
+		{
+			const VkDeviceSize targetSize = uploadRegionSize * uploadRegions;
+			memoryAllocator->createBuffer(targetSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+				uploadTarget, uploadTargetMemory, uploadManager->getSharedQueueFamilies());
+
+			uploadData.resize(settings.uploadSize);
+			for (size_t i = 0; i < uploadData.size(); ++i)
+			{
+				uploadData[i] = static_cast<uint8_t>(i * 31);
+			}
+		}
+
+		std::vector<double> cpuFrameTimes;
+		std::vector<double> gpuFrameTimes;
+		cpuFrameTimes.reserve(settings.frames);
+		gpuFrameTimes.reserve(settings.frames);
+		uint64_t lastPublishedFrame = gpuProfiler->getPublishedFrameCount();
+
+		const int totalFrames = settings.warmupFrames + settings.frames;
+		auto measureStart = std::chrono::steady_clock::now();
+
+		for (int frame = 0; frame < totalFrames; ++frame)
+		{
+			if (frame == settings.warmupFrames)
+			{
+				measureStart = std::chrono::steady_clock::now();
+			}
+			const auto frameStart = std::chrono::steady_clock::now();
+
+			queueManager->waitBeforeInput();
+
+			if (!glfwInitializer->isHeadless())
+			{
+				GLFWwindow* window = glfwInitializer->getWindow().get();
+				if (glfwWindowShouldClose(window))
+				{
+					break;
+				}
+
+				if (settings.resizeInterval > 0 && frame % settings.resizeInterval == 0)
+				{
+					const int size = frame / settings.resizeInterval % 2;
+					glfwSetWindowSize(window, RESIZE_WIDTHS[size], RESIZE_HEIGHTS[size]);
+				}
+				glfwPollEvents();
+			}
+
+			const VkDeviceSize uploadRegion = uploadRegionSize * (queueManager->getFrameNumber() % uploadRegions);
+			for (int upload = 0; upload < settings.uploadsPerFrame; ++upload)
+			{
+				uploadManager->uploadToBuffer(uploadData.data(), uploadData.size(), uploadTarget, uploadRegion + static_cast<VkDeviceSize>(upload) * settings.uploadSize);
+			}
+
+			// Same frame path as Application::loop().
+			frameScheduler->beginRenderFrame();
+			queueManager->drawFrame();
+
+			if (frame < settings.warmupFrames)
+			{
+				continue;
+			}
+
+			cpuFrameTimes.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+
+			// Timings are read back frames in flight later, so only sample when a new frame was published.
+			if (const uint64_t publishedFrame = gpuProfiler->getPublishedFrameCount(); publishedFrame != lastPublishedFrame)
+			{
+				lastPublishedFrame = publishedFrame;
+
+				const auto timings = gpuProfiler->getTimings();
+				if (const auto timing = std::ranges::find(timings, GPU_FRAME_SCOPE, &vulkan::GpuScopeTiming::name); timing != timings.end())
+				{
+					gpuFrameTimes.push_back(timing->lastMs);
+				}
+			}
+		}
+
+		deviceManager->deviceWaitIdle();
+		results.elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - measureStart).count();
+		results.measuredFrames = cpuFrameTimes.size();
+		results.cpuFrameTimes = FrameTimeStatistics::compute(std::move(cpuFrameTimes));
+		results.gpuFrameTimes = FrameTimeStatistics::compute(std::move(gpuFrameTimes));
+
+		commandBufferManager->setDrawListCallback(nullptr);
+		if (instanceBatch.has_value())
+		{
+			instancingManager->destroyBatch(*instanceBatch);
+		}
+		if (uploadTarget != VK_NULL_HANDLE)
+		{
+			memoryAllocator->destroyBuffer(uploadTarget, uploadTargetMemory);
+		}
+
+		application.clean();
+
+		return results;
+	}
+
+}
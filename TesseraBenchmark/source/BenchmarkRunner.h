@@ -0,0 +1,33 @@
+#pragma once
+#include <utility>
+
+#include "BenchmarkResults.h"
+#include "BenchmarkSettings.h"
+
+namespace tessera::benchmark
+{
+
+	/**
+	 * @brief Runs one workload through a fully initialized engine.
+	 *
+	 * The engine renders headless unless the workload needs a window. Draws are injected through
+	 * CommandBufferManager::setDrawListCallback() and uploads go through the UploadManager, so the measured
+	 * path is the one the engine itself uses. GPU frame times come from the GpuProfiler "Frame" scope.
+	 */
+	class BenchmarkRunner final
+	{
+	public:
+		explicit BenchmarkRunner(BenchmarkSettings settings) : settings(std::move(settings)) {}
+
+		[[nodiscard]] BenchmarkResults run() const;
+	private:
+		void applyConfigOverrides() const;
+
+		BenchmarkSettings settings;
+
+		static constexpr auto GPU_FRAME_SCOPE = "Frame";
+		static constexpr int RESIZE_WIDTHS[] = { 800, 1280 };
+		static constexpr int RESIZE_HEIGHTS[] = { 600, 720 };
+	};
+
+}
@@ -0,0 +1,104 @@
+#include "BenchmarkSettings.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string_view>
+
+namespace tessera::benchmark
+{
+
+	namespace
+	{
+		using IntegerArgument = std::pair<std::string_view, int BenchmarkSettings::*>;
+
+		constexpr IntegerArgument INTEGER_ARGUMENTS[] = {
+			{ "frames", &BenchmarkSettings::frames },
+			{ "warmupFrames", &BenchmarkSettings::warmupFrames },
+			{ "draws", &BenchmarkSettings::draws },
+			{ "trianglesPerDraw", &BenchmarkSettings::trianglesPerDraw },
+			{ "instances", &BenchmarkSettings::instances },
+			{ "uploadsPerFrame", &BenchmarkSettings::uploadsPerFrame },
+			{ "uploadSize", &BenchmarkSettings::uploadSize },
+			{ "resizeInterval", &BenchmarkSettings::resizeInterval },
+		};
+
+		int parseInt(const std::string& name, const std::string& value)
+		{
+			try
+			{
+				return std::stoi(value);
+			}
+			catch (const std::exception&)
+			{
+				throw std::runtime_error("BenchmarkSettings: --" + name + " expects an integer, got " + value + ".");
+			}
+		}
+	}
+
+	BenchmarkSettings BenchmarkSettings::parse(const int argc, char** argv)
+	{
+		BenchmarkSettings settings;
+
+		for (int i = 1; i < argc; ++i)
+		{
+			const std::string_view argument = argv[i];
+
+			if (argument == "--set")
+			{
+				if (i + 1 >= argc)
+				{
+					throw std::runtime_error("BenchmarkSettings: --set expects section.key=value.");
+				}
+
+				const std::string assignment = argv[++i];
+				const size_t separator = assignment.find('=');
+				if (separator == std::string::npos)
+				{
+					throw std::runtime_error("BenchmarkSettings: --set expects section.key=value, got " + assignment + ".");
+				}
+
+				settings.configOverrides.emplace_back(assignment.substr(0, separator), assignment.substr(separator + 1));
+				continue;
+			}
+
+			const size_t separator = argument.find('=');
+			if (!argument.starts_with("--") || separator == std::string_view::npos)
+			{
+				throw std::runtime_error("BenchmarkSettings: unexpected argument " + std::string(argument) + ", expected --name=value.");
+			}
+
+			const std::string name(argument.substr(2, separator - 2));
+			const std::string value(argument.substr(separator + 1));
+
+			if (const auto field = std::ranges::find(INTEGER_ARGUMENTS, name, &IntegerArgument::first); field != std::ranges::end(INTEGER_ARGUMENTS))
+			{
+				settings.*field->second = parseInt(name, value);
+			}
+			else if (name == "name")
+			{
+				settings.name = value;
+			}
+			else if (name == "output")
+			{
+				settings.output = value;
+			}
+			else if (name == "windowed")
+			{
+				settings.windowed = value == "true" || value == "1";
+			}
+			else
+			{
+				throw std::runtime_error("BenchmarkSettings: unknown argument --" + name + ".");
+			}
+		}
+
+		if (settings.frames <= 0 || settings.warmupFrames < 0 || settings.draws < 0 || settings.instances <= 0
+			|| settings.uploadsPerFrame < 0 || settings.uploadSize <= 0 || settings.resizeInterval < 0)
+		{
+			throw std::runtime_error("BenchmarkSettings: frames, instances and uploadSize must be positive, the other counts must not be negative.");
+		}
+
+		return settings;
+	}
+
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tessera::benchmark
+{
+
+	/**
+	 * @brief Synthetic workload driven through the engine's real render and upload paths.
+	 *
+	 * Every field maps to a --name=value argument of the same name, so a run is fully described by its
+	 * command line and the settings are written into the results next to the measured times.
+	 */
+	struct BenchmarkSettings
+	{
+		std::string name = "default";
+		int frames = 1000;
+		// Frames rendered before measuring, so pipeline compilation and first uploads do not skew the results.
+		int warmupFrames = 100;
+
+		// Draws recorded per frame, each drawing trianglesPerDraw triangles of the engine mesh (0 draws all of it).
+		// With --set render.gpuDriven=true, draws * instances objects are culled and drawn by the GPU instead.
+		int draws = 1;
+		int trianglesPerDraw = 0;
+		// Above 1, every draw is an instanced draw of this many instances from one instance buffer.
+		int instances = 1;
+
+		// Buffer uploads enqueued on the UploadManager every frame.
+		int uploadsPerFrame = 0;
+		int uploadSize = 64 * 1024;
+
+		// Resize the window every resizeInterval frames; 0 disables. Requires a window.
+		int resizeInterval = 0;
+		bool windowed = false;
+
+		std::string output = "benchmark_results.json";
+		// Extra engine.ini keys given as --set section.key=value.
+		std::vector<std::pair<std::string, std::string>> configOverrides;
+
+		static BenchmarkSettings parse(int argc, char** argv);
+	};
+
+}
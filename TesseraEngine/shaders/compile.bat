@@ -1,3 +1,6 @@
-%VULKAN_SDK%/Bin/glslc.exe shader.vert -o vert.spv
-%VULKAN_SDK%/Bin/glslc.exe shader.frag -o frag.spv
+%VULKAN_SDK%/Bin/glslc.exe shader.vert -o shader.vert.spv
+%VULKAN_SDK%/Bin/glslc.exe shader.frag -o shader.frag.spv
+%VULKAN_SDK%/Bin/glslc.exe instanced.vert -o instanced.vert.spv
+%VULKAN_SDK%/Bin/glslc.exe indirect.vert -o indirect.vert.spv
+%VULKAN_SDK%/Bin/glslc.exe cull.comp -o cull.comp.spv
 pause
\ No newline at end of file
@@ -0,0 +1,35 @@
+#version 450
+
+// Must match GpuObject in IndirectDrawManager.h.
+struct ObjectData {
+    vec4 boundingSphere;
+    vec4 transform;
+    uint indexCount;
+    uint firstIndex;
+    int vertexOffset;
+    uint mesh;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer Objects {
+    ObjectData objects[];
+};
+
+layout(push_constant) uniform Camera {
+    mat4 viewProjection;
+} camera;
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inColor;
+layout(location = 2) in vec3 inNormal;
+
+layout(location = 0) out vec3 fragColor;
+
+// The depth prepass and the main pass test for equal depth, so both must compute exactly the same position.
+invariant gl_Position;
+
+void main() {
+    // The culling shader stores the object index in firstInstance.
+    const vec4 transform = objects[gl_InstanceIndex].transform;
+    gl_Position = camera.viewProjection * vec4(inPosition * transform.w + transform.xyz, 1.0);
+    fragColor = inColor;
+}
\ No newline at end of file
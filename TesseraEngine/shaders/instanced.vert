@@ -0,0 +1,30 @@
+#version 450
+
+// Must match FrameConstants in UniformManager.h.
+layout(set = 0, binding = 0) uniform Frame {
+    mat4 viewProjection;
+    mat4 view;
+    mat4 projection;
+    vec4 cameraPosition;
+    float time;
+    float deltaTime;
+    uint frameNumber;
+} frame;
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inColor;
+layout(location = 2) in vec3 inNormal;
+
+// Per instance, see InstanceData.
+layout(location = 3) in vec4 instanceTransform;
+layout(location = 4) in vec4 instanceColor;
+
+layout(location = 0) out vec3 fragColor;
+
+// The depth prepass and the main pass test for equal depth, so both must compute exactly the same position.
+invariant gl_Position;
+
+void main() {
+    gl_Position = frame.viewProjection * vec4(inPosition * instanceTransform.w + instanceTransform.xyz, 1.0);
+    fragColor = inColor * instanceColor.rgb;
+}
\ No newline at end of file
@@ -1,11 +1,26 @@
 #version 450
 
-layout(location = 0) in vec2 inPosition;
+// Must match FrameConstants in UniformManager.h.
+layout(set = 0, binding = 0) uniform Frame {
+    mat4 viewProjection;
+    mat4 view;
+    mat4 projection;
+    vec4 cameraPosition;
+    float time;
+    float deltaTime;
+    uint frameNumber;
+} frame;
+
+layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inColor;
+layout(location = 2) in vec3 inNormal;
 
 layout(location = 0) out vec3 fragColor;
 
+// The depth prepass and the main pass test for equal depth, so both must compute exactly the same position.
+invariant gl_Position;
+
 void main() {
-    gl_Position = vec4(inPosition, 0.0, 1.0);
+    gl_Position = frame.viewProjection * vec4(inPosition, 1.0);
     fragColor = inColor;
 }
\ No newline at end of file
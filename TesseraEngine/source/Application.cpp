@@ -1,7 +1,21 @@
 #include "Application.h"
 
 #include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 
+#include "utils/CpuProfiler.h"
+#include "utils/EngineConfig.h"
+#include "utils/FrameScheduler.h"
+#include "utils/TesseraLog.h"
 #include "utils/interfaces/ServiceLocator.h"
 #include "vulkan/QueueManager.h"
 
@@ -10,13 +24,189 @@ namespace tessera
 	
 	void Application::init()
 	{
-		std::ranges::for_each(initializerList.begin(), initializerList.end(), [&](const std::shared_ptr<Initializable>& service)
+		validateDependencies();
+		const auto start = std::chrono::steady_clock::now();
+
+		// The configuration decides how the rest starts and the ThreadPool runs it, so both come first.
+		initSequentially(0, BOOTSTRAP_SERVICE_COUNT);
+
+		if (ServiceLocator::getService<EngineConfig>()->getBool("startup.parallel", true))
+		{
+			initConcurrently(BOOTSTRAP_SERVICE_COUNT);
+		}
+		else
+		{
+			initSequentially(BOOTSTRAP_SERVICE_COUNT, initializerList.size());
+		}
+
+		TESSERA_LOG(LogType::DEBUG, "Application", "Initialized " + std::to_string(initializerList.size()) + " services in "
+			+ std::to_string(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count()) + " ms.");
+
+		std::ranges::for_each(initializerList.begin(), initializerList.end(), [&](const ServiceNode& node)
 			{
-				service->init();
-				registerServiceManager(service.get(), service);
+				node.service->resolveServices();
 			});
 	}
 
+	void Application::validateDependencies()
+	{
+		std::unordered_set<std::type_index> listed;
+		for (const auto& [service, dependencies, mainThread] : initializerList)
+		{
+			for (const auto& dependency : dependencies)
+			{
+				if (!listed.contains(dependency))
+				{
+					throw std::runtime_error(std::string("Application: ") + typeid(*service).name() + " depends on " + dependency.name()
+						+ ", which is not initialized before it.");
+				}
+			}
+			listed.emplace(typeid(*service));
+		}
+	}
+
+	void Application::initService(const ServiceNode& node)
+	{
+		node.service->init();
+		registerServiceManager(node.service.get(), node.service);
+	}
+
+	void Application::initSequentially(const size_t first, const size_t last)
+	{
+		for (size_t i = first; i < last; ++i)
+		{
+			initService(initializerList[i]);
+		}
+	}
+
+	void Application::initConcurrently(const size_t first)
+	{
+		const size_t count = initializerList.size();
+
+		std::unordered_map<std::type_index, size_t> serviceIndices;
+		for (size_t i = 0; i < count; ++i)
+		{
+			serviceIndices.emplace(typeid(*initializerList[i].service), i);
+		}
+
+		// Dependencies initialized before first are already satisfied.
+		std::vector<size_t> pendingDependencies(count, 0);
+		std::vector<std::vector<size_t>> dependents(count);
+		for (size_t i = first; i < count; ++i)
+		{
+			for (const auto& dependency : initializerList[i].dependencies)
+			{
+				const size_t dependencyIndex = serviceIndices.at(dependency);
+				if (dependencyIndex >= first)
+				{
+					++pendingDependencies[i];
+					dependents[dependencyIndex].push_back(i);
+				}
+			}
+		}
+
+		std::deque<size_t> ready;
+		for (size_t i = first; i < count; ++i)
+		{
+			if (pendingDependencies[i] == 0)
+			{
+				ready.push_back(i);
+			}
+		}
+
+		auto& threadPool = *ServiceLocator::getServicePointer<ThreadPool>();
+		std::mutex completedMutex;
+		std::condition_variable completedCondition;
+		std::vector<std::pair<size_t, std::exception_ptr>> completed;
+		std::exception_ptr failure;
+		size_t running = 0;
+
+		const auto finish = [&](const size_t i)
+			{
+				for (const size_t dependent : dependents[i])
+				{
+					if (--pendingDependencies[dependent] == 0)
+					{
+						ready.push_back(dependent);
+					}
+				}
+			};
+
+		while (true)
+		{
+			// Nothing new starts after a failure; services already running are waited for before rethrowing.
+			while (!ready.empty() && !failure)
+			{
+				const size_t i = ready.front();
+				ready.pop_front();
+
+				if (initializerList[i].mainThread)
+				{
+					try
+					{
+						initService(initializerList[i]);
+						finish(i);
+					}
+					catch (...)
+					{
+						failure = std::current_exception();
+					}
+					continue;
+				}
+
+				++running;
+				threadPool.submit([&, i]
+					{
+						std::exception_ptr error;
+						try
+						{
+							initService(initializerList[i]);
+						}
+						catch (...)
+						{
+							error = std::current_exception();
+						}
+
+						{
+							std::lock_guard lock(completedMutex);
+							completed.emplace_back(i, error);
+						}
+						completedCondition.notify_one();
+					});
+			}
+
+			if (running == 0)
+			{
+				break;
+			}
+
+			std::vector<std::pair<size_t, std::exception_ptr>> batch;
+			{
+				std::unique_lock lock(completedMutex);
+				completedCondition.wait(lock, [&] { return !completed.empty(); });
+				batch.swap(completed);
+			}
+
+			for (const auto& [i, error] : batch)
+			{
+				--running;
+				if (error)
+				{
+					failure = failure ? failure : error;
+				}
+				else
+				{
+					finish(i);
+				}
+			}
+		}
+
+		if (failure)
+		{
+			std::rethrow_exception(failure);
+		}
+	}
+
 	template<typename T>
 	void Application::registerServiceManager(const T* servicePointer, const std::shared_ptr<Initializable>& service)
 	{
@@ -28,20 +218,50 @@ namespace tessera
 		const auto& glfwInitializer = ServiceLocator::getService<glfw::GlfwInitializer>();
 		const auto& queueManager = ServiceLocator::getService<vulkan::QueueManager>();
 		const auto& deviceManager = ServiceLocator::getService<vulkan::DeviceManager>();
+		const auto& frameScheduler = ServiceLocator::getService<FrameScheduler>();
+		const auto& config = ServiceLocator::getService<EngineConfig>();
+
+		CpuProfiler::setEnabled(config->getBool("profiling.cpu", false));
 
-		glfwInitializer->mainLoop([&] 
+		const auto loopStart = std::chrono::steady_clock::now();
+		const uint64_t firstFrame = queueManager->getFrameNumber();
+
+		glfwInitializer->mainLoop([&]
+			{
+				queueManager->waitBeforeInput();
+			},
+			[&] 
 			{
+				// The scheduler is opt-in and does nothing until an application starts it; once started, its render
+				// callback receives the interpolated state before the frame is recorded.
+				frameScheduler->beginRenderFrame();
 				queueManager->drawFrame();
 			});
 
+		frameScheduler->stop();
 		deviceManager->deviceWaitIdle();
+
+		// Headless runs exist to measure throughput, so report it once every frame has finished on the GPU.
+		if (glfwInitializer->isHeadless())
+		{
+			const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - loopStart).count();
+			const uint64_t frames = queueManager->getFrameNumber() - firstFrame;
+			TesseraLog::send(LogType::INFO, "Application", "Rendered " + std::to_string(frames) + " frames in " + std::to_string(seconds)
+				+ " s (" + std::to_string(seconds > 0.0 ? static_cast<double>(frames) / seconds : 0.0) + " frames per second).");
+		}
+
+		if (CpuProfiler::isEnabled())
+		{
+			CpuProfiler::setEnabled(false);
+			CpuProfiler::exportChromeTrace(config->getString("profiling.cpuTraceFile", "cpu_trace.json"));
+		}
 	}
 
 	void Application::clean()
 	{
 		for (auto it = initializerList.rbegin(); it != initializerList.rend(); ++it)
 		{
-			(*it)->clean();
+			it->service->clean();
 		}
 	}
 
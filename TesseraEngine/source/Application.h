@@ -1,24 +1,63 @@
 #pragma once
 
-#include <list>
 #include <memory>
+#include <typeindex>
+#include <typeinfo>
+#include <vector>
 
 #include "glfw/GlfwInitializer.h"
 #include "vulkan/CommandBufferManager.h"
+#include "vulkan/ComputeManager.h"
+#include "vulkan/DeletionQueue.h"
 #include "vulkan/DebugManager.h"
-#include "vulkan/FramebufferManager.h"
+#include "vulkan/DescriptorManager.h"
+#include "vulkan/GpuProfiler.h"
 #include "vulkan/GraphicsPipelineManager.h"
 #include "vulkan/ImageViewManager.h"
+#include "vulkan/IndirectDrawManager.h"
+#include "vulkan/InstancingManager.h"
 #include "vulkan/InstanceManager.h"
 #include "vulkan/QueueManager.h"
+#include "vulkan/RenderGraphManager.h"
+#include "vulkan/SceneManager.h"
+#include "vulkan/ShaderLibrary.h"
 #include "vulkan/SurfaceManager.h"
 #include "vulkan/SwapChainManager.h"
 #include "vulkan/SyncObjectsManager.h"
+#include "vulkan/TextureManager.h"
+#include "vulkan/UniformManager.h"
 #include "vulkan/BufferManager.h"
+#include "vulkan/MemoryAllocator.h"
+#include "vulkan/PipelineCacheManager.h"
+#include "vulkan/PipelineRegistry.h"
+#include "utils/EngineConfig.h"
+#include "utils/FrameScheduler.h"
+#include "utils/ThreadPool.h"
+#include "vulkan/UploadManager.h"
 
 
 namespace tessera
 {
+	/**
+	 * @brief Service of the engine together with the services its init() uses.
+	 *
+	 * Application starts every service once its dependencies are initialized, on the ThreadPool unless it
+	 * must run on the main thread, so independent services start concurrently.
+	 */
+	struct ServiceNode
+	{
+		std::shared_ptr<Initializable> service;
+		std::vector<std::type_index> dependencies;
+		// GLFW window and event functions may only be called from the main thread.
+		bool mainThread = false;
+	};
+
+	template <class... T>
+	std::vector<std::type_index> after()
+	{
+		return { std::type_index(typeid(T))... };
+	}
+
 	class Application final : public Initializable
 	{
 	public:
@@ -30,20 +69,57 @@ namespace tessera
 		template <class T>
 		void registerServiceManager(const T* servicePointer, const std::shared_ptr<Initializable>& service);
 
-		static inline std::list<std::shared_ptr<Initializable>> initializerList = {
-			std::make_shared<glfw::GlfwInitializer>(),
-			std::make_shared<vulkan::InstanceManager>(),
-			std::make_shared<vulkan::DebugManager>(),
-			std::make_shared<vulkan::SurfaceManager>(),
-			std::make_shared<vulkan::DeviceManager>(),
-			std::make_shared<vulkan::QueueManager>(),
-			std::make_shared<vulkan::SwapChainManager>(),
-			std::make_shared<vulkan::ImageViewManager>(),
-			std::make_shared<vulkan::GraphicsPipelineManager>(),
-			std::make_shared<vulkan::FramebufferManager>(),
-			std::make_shared<vulkan::CommandBufferManager>(),
-			std::make_shared<vulkan::BufferManager>(),
-			std::make_shared<vulkan::SyncObjectsManager>(),
+		// Throws unless every dependency comes earlier in initializerList, which also rules out cycles.
+		static void validateDependencies();
+		void initService(const ServiceNode& node);
+		void initSequentially(size_t first, size_t last);
+		// Start every service from first on as soon as its dependencies are initialized.
+		void initConcurrently(size_t first);
+
+		// EngineConfig and ThreadPool.
+		static constexpr size_t BOOTSTRAP_SERVICE_COUNT = 2;
+
+		// Listed in an order satisfying the dependencies; services are cleaned in reverse.
+		static inline std::vector<ServiceNode> initializerList = {
+			{ std::make_shared<EngineConfig>(), {} },
+			{ std::make_shared<ThreadPool>(), {} },
+			{ std::make_shared<glfw::GlfwInitializer>(), after<EngineConfig>(), true },
+			{ std::make_shared<vulkan::InstanceManager>(), after<glfw::GlfwInitializer>() },
+			{ std::make_shared<vulkan::DebugManager>(), after<vulkan::InstanceManager>() },
+			{ std::make_shared<vulkan::SurfaceManager>(), after<glfw::GlfwInitializer, vulkan::InstanceManager>(), true },
+			{ std::make_shared<vulkan::DeviceManager>(), after<vulkan::InstanceManager, vulkan::SurfaceManager>() },
+			{ std::make_shared<vulkan::MemoryAllocator>(), after<EngineConfig, vulkan::DeviceManager>() },
+			{ std::make_shared<vulkan::DeletionQueue>(), {} },
+			{ std::make_shared<vulkan::PipelineCacheManager>(), after<vulkan::DeviceManager>() },
+			{ std::make_shared<vulkan::PipelineRegistry>(), after<ThreadPool, vulkan::DeviceManager, vulkan::DeletionQueue, vulkan::PipelineCacheManager>() },
+			{ std::make_shared<vulkan::ShaderLibrary>(), after<EngineConfig, ThreadPool, vulkan::DeviceManager, vulkan::DeletionQueue, vulkan::PipelineRegistry>() },
+			{ std::make_shared<vulkan::QueueManager>(), after<vulkan::DeviceManager, vulkan::SurfaceManager>() },
+			{ std::make_shared<vulkan::GpuProfiler>(), after<EngineConfig, vulkan::DeviceManager, vulkan::QueueManager>() },
+			{ std::make_shared<vulkan::UploadManager>(), after<EngineConfig, vulkan::DeviceManager, vulkan::MemoryAllocator, vulkan::QueueManager, vulkan::GpuProfiler>() },
+			{ std::make_shared<vulkan::ComputeManager>(), after<EngineConfig, vulkan::DeviceManager, vulkan::QueueManager, vulkan::UploadManager>() },
+			{ std::make_shared<vulkan::DescriptorManager>(), after<EngineConfig, vulkan::DeviceManager, vulkan::DeletionQueue>() },
+			{ std::make_shared<vulkan::UniformManager>(), after<EngineConfig, vulkan::DeviceManager, vulkan::MemoryAllocator>() },
+			{ std::make_shared<vulkan::TextureManager>(), after<EngineConfig, vulkan::DeviceManager, vulkan::MemoryAllocator, vulkan::DeletionQueue,
+				vulkan::UploadManager, vulkan::DescriptorManager>() },
+			{ std::make_shared<vulkan::SwapChainManager>(), after<EngineConfig, glfw::GlfwInitializer, vulkan::SurfaceManager, vulkan::DeviceManager,
+				vulkan::MemoryAllocator>(), true },
+			{ std::make_shared<vulkan::ImageViewManager>(), after<vulkan::DeviceManager, vulkan::SwapChainManager>() },
+			{ std::make_shared<vulkan::RenderGraphManager>(), after<EngineConfig, vulkan::DeviceManager, vulkan::MemoryAllocator, vulkan::SwapChainManager,
+				vulkan::ImageViewManager, vulkan::ComputeManager>() },
+			{ std::make_shared<vulkan::GraphicsPipelineManager>(), after<vulkan::DeviceManager, vulkan::PipelineRegistry, vulkan::ShaderLibrary, vulkan::DescriptorManager,
+				vulkan::UniformManager, vulkan::RenderGraphManager>() },
+			{ std::make_shared<vulkan::CommandBufferManager>(), after<EngineConfig, ThreadPool, vulkan::DeviceManager, vulkan::SurfaceManager>() },
+			{ std::make_shared<vulkan::BufferManager>(), after<vulkan::MemoryAllocator, vulkan::DeletionQueue, vulkan::UploadManager>() },
+			{ std::make_shared<vulkan::InstancingManager>(), after<vulkan::MemoryAllocator, vulkan::DeletionQueue, vulkan::UploadManager, vulkan::BufferManager,
+				vulkan::GraphicsPipelineManager>() },
+			{ std::make_shared<vulkan::SceneManager>(), after<EngineConfig, ThreadPool, vulkan::MemoryAllocator, vulkan::DeletionQueue, vulkan::BufferManager, vulkan::GraphicsPipelineManager,
+				vulkan::UniformManager>() },
+			{ std::make_shared<vulkan::IndirectDrawManager>(), after<EngineConfig, ThreadPool, vulkan::DeviceManager, vulkan::MemoryAllocator, vulkan::DeletionQueue,
+				vulkan::PipelineCacheManager, vulkan::PipelineRegistry, vulkan::ShaderLibrary, vulkan::UploadManager, vulkan::UniformManager, vulkan::RenderGraphManager, vulkan::BufferManager,
+				vulkan::ComputeManager>() },
+			{ std::make_shared<vulkan::SyncObjectsManager>(), after<vulkan::DeviceManager, vulkan::CommandBufferManager>() },
+			// Last so its thread stops before anything a tick may use is cleaned.
+			{ std::make_shared<FrameScheduler>(), after<EngineConfig>() },
 		};
 	};
 
@@ -0,0 +1,385 @@
+#include "BoundingVolumeHierarchy.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "utils/CpuProfiler.h"
+
+namespace tessera
+{
+
+	namespace
+	{
+		float getSurfaceArea(const glm::vec3& min, const glm::vec3& max)
+		{
+			const glm::vec3 size = max - min;
+			return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+		}
+	}
+
+	void BoundingVolumeHierarchy::update(const Scene& scene)
+	{
+		TESSERA_PROFILE_ZONE("BVH update");
+
+		// Only entities whose renderable state may have changed are looked at; the changes are settled by the current state.
+		const Scene::Components& c = scene.getComponents();
+		for (const Entity entity : scene.getRenderableChanges())
+		{
+			const bool renderable = scene.isAlive(entity) && c.meshes[scene.getDenseIndex(entity)] != 0;
+			const bool inTree = leafPositions.contains(entity);
+			if (renderable && !inTree)
+			{
+				addLeaf(scene, entity);
+			}
+			else if (!renderable && inTree)
+			{
+				removeLeaf(entity);
+			}
+		}
+
+		for (uint32_t position = 0; position < leafNodes.size(); ++position)
+		{
+			readLeaf(scene, position);
+
+			const glm::vec3 center(sphereX[position], sphereY[position], sphereZ[position]);
+			const Node& node = nodes[leafNodes[position]];
+			if (glm::all(glm::greaterThanEqual(center - sphereRadius[position], node.min)) && glm::all(glm::lessThanEqual(center + sphereRadius[position], node.max)))
+			{
+				continue;
+			}
+
+			const uint32_t leafNode = leafNodes[position];
+			removeNode(leafNode);
+			fattenLeaf(position);
+			insertNode(leafNode);
+		}
+	}
+
+	void BoundingVolumeHierarchy::addLeaf(const Scene& scene, const Entity entity)
+	{
+		const uint32_t leafNode = allocateNode();
+		const auto position = static_cast<uint32_t>(leafNodes.size());
+		nodes[leafNode].leaf = position;
+
+		leafNodes.push_back(leafNode);
+		leafEntities.push_back(entity);
+		leafDenseIndices.push_back(0);
+		sphereX.push_back(0.0f);
+		sphereY.push_back(0.0f);
+		sphereZ.push_back(0.0f);
+		sphereRadius.push_back(0.0f);
+		leafPositions.emplace(entity, position);
+
+		readLeaf(scene, position);
+		fattenLeaf(position);
+		insertNode(leafNode);
+	}
+
+	void BoundingVolumeHierarchy::removeLeaf(const Entity entity)
+	{
+		const auto it = leafPositions.find(entity);
+		const uint32_t position = it->second;
+		leafPositions.erase(it);
+
+		removeNode(leafNodes[position]);
+		freeNode(leafNodes[position]);
+
+		// The last leaf takes the freed position, so the arrays stay without holes.
+		const auto last = static_cast<uint32_t>(leafNodes.size() - 1);
+		if (position != last)
+		{
+			leafNodes[position] = leafNodes[last];
+			leafEntities[position] = leafEntities[last];
+			leafDenseIndices[position] = leafDenseIndices[last];
+			sphereX[position] = sphereX[last];
+			sphereY[position] = sphereY[last];
+			sphereZ[position] = sphereZ[last];
+			sphereRadius[position] = sphereRadius[last];
+			nodes[leafNodes[position]].leaf = position;
+			leafPositions[leafEntities[position]] = position;
+		}
+
+		leafNodes.pop_back();
+		leafEntities.pop_back();
+		leafDenseIndices.pop_back();
+		sphereX.pop_back();
+		sphereY.pop_back();
+		sphereZ.pop_back();
+		sphereRadius.pop_back();
+	}
+
+	void BoundingVolumeHierarchy::readLeaf(const Scene& scene, const uint32_t position)
+	{
+		const Scene::Components& c = scene.getComponents();
+		const uint32_t index = scene.getDenseIndex(leafEntities[position]);
+		leafDenseIndices[position] = index;
+		sphereX[position] = c.boundsX[index];
+		sphereY[position] = c.boundsY[index];
+		sphereZ[position] = c.boundsZ[index];
+		sphereRadius[position] = c.boundsRadius[index];
+	}
+
+	void BoundingVolumeHierarchy::fattenLeaf(const uint32_t position)
+	{
+		const float extent = sphereRadius[position] + std::max(sphereRadius[position] * FAT_MARGIN_RATIO, MIN_FAT_MARGIN);
+		const glm::vec3 center(sphereX[position], sphereY[position], sphereZ[position]);
+
+		Node& node = nodes[leafNodes[position]];
+		node.min = center - extent;
+		node.max = center + extent;
+	}
+
+	uint32_t BoundingVolumeHierarchy::allocateNode()
+	{
+		if (freeNodes.empty())
+		{
+			nodes.emplace_back();
+			return static_cast<uint32_t>(nodes.size() - 1);
+		}
+
+		const uint32_t nodeIndex = freeNodes.back();
+		freeNodes.pop_back();
+		nodes[nodeIndex] = Node{};
+		return nodeIndex;
+	}
+
+	void BoundingVolumeHierarchy::freeNode(const uint32_t nodeIndex)
+	{
+		freeNodes.push_back(nodeIndex);
+	}
+
+	void BoundingVolumeHierarchy::insertNode(const uint32_t leafNode)
+	{
+		if (root == NULL_NODE)
+		{
+			root = leafNode;
+			nodes[leafNode].parent = NULL_NODE;
+			return;
+		}
+
+		// Walk down towards the sibling whose pairing adds the least surface area, counting what the ancestors grow by on the way.
+		const glm::vec3 leafMin = nodes[leafNode].min;
+		const glm::vec3 leafMax = nodes[leafNode].max;
+		uint32_t sibling = root;
+		while (nodes[sibling].left != NULL_NODE)
+		{
+			const Node& node = nodes[sibling];
+			const float area = getSurfaceArea(node.min, node.max);
+			const float combinedArea = getSurfaceArea(glm::min(node.min, leafMin), glm::max(node.max, leafMax));
+
+			// Pairing with this node makes a new parent; descending grows this node by the leaf instead.
+			const float pairCost = 2.0f * combinedArea;
+			const float inheritedCost = 2.0f * (combinedArea - area);
+
+			const auto getDescendCost = [&](const uint32_t childIndex)
+				{
+					const Node& child = nodes[childIndex];
+					const float grownArea = getSurfaceArea(glm::min(child.min, leafMin), glm::max(child.max, leafMax));
+					return (child.left == NULL_NODE ? grownArea : grownArea - getSurfaceArea(child.min, child.max)) + inheritedCost;
+				};
+			const float leftCost = getDescendCost(node.left);
+			const float rightCost = getDescendCost(node.right);
+
+			if (pairCost < leftCost && pairCost < rightCost)
+			{
+				break;
+			}
+			sibling = leftCost < rightCost ? node.left : node.right;
+		}
+
+		const uint32_t oldParent = nodes[sibling].parent;
+		const uint32_t newParent = allocateNode();
+		Node& parent = nodes[newParent];
+		parent.parent = oldParent;
+		parent.min = glm::min(nodes[sibling].min, leafMin);
+		parent.max = glm::max(nodes[sibling].max, leafMax);
+		parent.height = nodes[sibling].height + 1;
+		parent.left = sibling;
+		parent.right = leafNode;
+		nodes[sibling].parent = newParent;
+		nodes[leafNode].parent = newParent;
+
+		if (oldParent == NULL_NODE)
+		{
+			root = newParent;
+			return;
+		}
+
+		Node& grandparent = nodes[oldParent];
+		(grandparent.left == sibling ? grandparent.left : grandparent.right) = newParent;
+		refitAncestors(oldParent);
+	}
+
+	void BoundingVolumeHierarchy::removeNode(const uint32_t leafNode)
+	{
+		if (leafNode == root)
+		{
+			root = NULL_NODE;
+			return;
+		}
+
+		// The sibling takes the place of the parent, which goes away with the leaf.
+		const uint32_t parentIndex = nodes[leafNode].parent;
+		const Node& parent = nodes[parentIndex];
+		const uint32_t grandparentIndex = parent.parent;
+		const uint32_t sibling = parent.left == leafNode ? parent.right : parent.left;
+		freeNode(parentIndex);
+		nodes[sibling].parent = grandparentIndex;
+		nodes[leafNode].parent = NULL_NODE;
+
+		if (grandparentIndex == NULL_NODE)
+		{
+			root = sibling;
+			return;
+		}
+
+		Node& grandparent = nodes[grandparentIndex];
+		(grandparent.left == parentIndex ? grandparent.left : grandparent.right) = sibling;
+		refitAncestors(grandparentIndex);
+	}
+
+	void BoundingVolumeHierarchy::refitAncestors(uint32_t nodeIndex)
+	{
+		while (nodeIndex != NULL_NODE)
+		{
+			nodeIndex = balance(nodeIndex);
+
+			Node& node = nodes[nodeIndex];
+			const Node& left = nodes[node.left];
+			const Node& right = nodes[node.right];
+			node.min = glm::min(left.min, right.min);
+			node.max = glm::max(left.max, right.max);
+			node.height = 1 + std::max(left.height, right.height);
+
+			nodeIndex = node.parent;
+		}
+	}
+
+	uint32_t BoundingVolumeHierarchy::balance(const uint32_t nodeIndex)
+	{
+		Node& a = nodes[nodeIndex];
+		if (a.left == NULL_NODE || a.height < 2)
+		{
+			return nodeIndex;
+		}
+
+		const int heightDifference = static_cast<int>(nodes[a.right].height) - static_cast<int>(nodes[a.left].height);
+		if (std::abs(heightDifference) <= 1)
+		{
+			return nodeIndex;
+		}
+
+		// The taller child b moves up into the place of a. Of its children, the taller one stays below b and
+		// the other one replaces b below a.
+		const bool rightTaller = heightDifference > 0;
+		const uint32_t bIndex = rightTaller ? a.right : a.left;
+		const uint32_t otherIndex = rightTaller ? a.left : a.right;
+		Node& b = nodes[bIndex];
+
+		const bool firstTaller = nodes[b.left].height > nodes[b.right].height;
+		const uint32_t keptIndex = firstTaller ? b.left : b.right;
+		const uint32_t movedIndex = firstTaller ? b.right : b.left;
+
+		b.parent = a.parent;
+		if (b.parent == NULL_NODE)
+		{
+			root = bIndex;
+		}
+		else
+		{
+			Node& parent = nodes[b.parent];
+			(parent.left == nodeIndex ? parent.left : parent.right) = bIndex;
+		}
+
+		b.left = nodeIndex;
+		b.right = keptIndex;
+		a.parent = bIndex;
+		(rightTaller ? a.right : a.left) = movedIndex;
+		nodes[movedIndex].parent = nodeIndex;
+
+		const Node& other = nodes[otherIndex];
+		const Node& moved = nodes[movedIndex];
+		a.min = glm::min(other.min, moved.min);
+		a.max = glm::max(other.max, moved.max);
+		a.height = 1 + std::max(other.height, moved.height);
+
+		const Node& kept = nodes[keptIndex];
+		b.min = glm::min(a.min, kept.min);
+		b.max = glm::max(a.max, kept.max);
+		b.height = 1 + std::max(a.height, kept.height);
+
+		return bIndex;
+	}
+
+	uint32_t BoundingVolumeHierarchy::query(const Frustum& frustum, std::vector<uint32_t>& visible)
+	{
+		TESSERA_PROFILE_ZONE("BVH query");
+
+		visible.clear();
+		if (root == NULL_NODE)
+		{
+			return 0;
+		}
+
+		candidateX.clear();
+		candidateY.clear();
+		candidateZ.clear();
+		candidateRadius.clear();
+		candidates.clear();
+
+		stack.clear();
+		stack.push_back(root);
+		while (!stack.empty())
+		{
+			const uint32_t entry = stack.back();
+			stack.pop_back();
+			const Node& node = nodes[entry & ~INSIDE_FLAG];
+
+			FrustumTest test = FrustumTest::INSIDE;
+			if (!(entry & INSIDE_FLAG))
+			{
+				test = frustum.testBox((node.min + node.max) * 0.5f, (node.max - node.min) * 0.5f);
+				if (test == FrustumTest::OUTSIDE)
+				{
+					continue;
+				}
+			}
+
+			if (node.left != NULL_NODE)
+			{
+				const uint32_t flag = test == FrustumTest::INSIDE ? INSIDE_FLAG : 0;
+				stack.push_back(node.right | flag);
+				stack.push_back(node.left | flag);
+			}
+			else if (test == FrustumTest::INSIDE)
+			{
+				visible.push_back(leafDenseIndices[node.leaf]);
+			}
+			else
+			{
+				// Gathered so every intersecting leaf is tested in one batch of SIMD sphere tests.
+				candidates.push_back(leafDenseIndices[node.leaf]);
+				candidateX.push_back(sphereX[node.leaf]);
+				candidateY.push_back(sphereY[node.leaf]);
+				candidateZ.push_back(sphereZ[node.leaf]);
+				candidateRadius.push_back(sphereRadius[node.leaf]);
+			}
+		}
+
+		if (candidates.empty())
+		{
+			return static_cast<uint32_t>(visible.size());
+		}
+
+		candidateVisible.resize(candidates.size());
+		const uint32_t count = frustum.testSpheres(candidateX.data(), candidateY.data(), candidateZ.data(), candidateRadius.data(),
+			static_cast<uint32_t>(candidates.size()), candidateVisible.data());
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			visible.push_back(candidates[candidateVisible[i]]);
+		}
+
+		return static_cast<uint32_t>(visible.size());
+	}
+
+}
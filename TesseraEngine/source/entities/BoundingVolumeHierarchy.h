@@ -0,0 +1,99 @@
+#pragma once
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "Scene.h"
+#include "utils/Frustum.h"
+
+namespace tessera
+{
+
+	/**
+	 * @brief Dynamic bounding volume hierarchy over the bounds of the renderable entities of a Scene.
+	 *
+	 * Every renderable entity is a leaf holding a box fattened by a margin around its bounding sphere.
+	 * Leaves are inserted next to the sibling that grows the tree's surface area the least and removed on
+	 * their own, and rotations keep the tree balanced, so entities created, destroyed or toggled cost
+	 * O(log n) each instead of a rebuild. Leaves are keyed by entity, so the dense indices moving in
+	 * Scene::update() do not disturb the tree.
+	 *
+	 * update() still reads the bounds of every leaf once per frame to find the ones that moved, a linear
+	 * pass like the transform update of the Scene; only leaves leaving their fattened box are reinserted.
+	 */
+	class BoundingVolumeHierarchy final
+	{
+	public:
+		// Called after every Scene::update(), whose renderable changes it consumes.
+		void update(const Scene& scene);
+
+		/**
+		 * @brief Collect the dense indices of the renderable entities whose bounds are at least partly inside frustum.
+		 *
+		 * visible is cleared first and filled in no particular order. Boxes completely inside add their entities
+		 * without testing them; spheres of the leaves left intersecting are tested together by Frustum::testSpheres().
+		 *
+		 * @return The number of visible entities.
+		 */
+		uint32_t query(const Frustum& frustum, std::vector<uint32_t>& visible);
+
+		[[nodiscard]] uint32_t getNodeCount() const { return static_cast<uint32_t>(nodes.size() - freeNodes.size()); }
+	private:
+		struct Node
+		{
+			glm::vec3 min{ 0.0f };
+			uint32_t parent = NULL_NODE;
+			glm::vec3 max{ 0.0f };
+			// 0 for leaves.
+			uint32_t height = 0;
+			// NULL_NODE for leaves.
+			uint32_t left = NULL_NODE;
+			uint32_t right = NULL_NODE;
+			// Position of a leaf in the leaf arrays, NULL_NODE for inner nodes.
+			uint32_t leaf = NULL_NODE;
+		};
+
+		void addLeaf(const Scene& scene, Entity entity);
+		void removeLeaf(Entity entity);
+		// Copy the current bounds and dense index of the leaf at position from the scene.
+		void readLeaf(const Scene& scene, uint32_t position);
+		// Set the box of the leaf at position to its sphere grown by the margin.
+		void fattenLeaf(uint32_t position);
+
+		uint32_t allocateNode();
+		void freeNode(uint32_t nodeIndex);
+		void insertNode(uint32_t leafNode);
+		void removeNode(uint32_t leafNode);
+		// Refit and rebalance from nodeIndex up to the root.
+		void refitAncestors(uint32_t nodeIndex);
+		// Rotate the taller grandchild up when the subtrees of nodeIndex differ in height by more than one; returns the subtree root.
+		uint32_t balance(uint32_t nodeIndex);
+
+		std::vector<Node> nodes;
+		std::vector<uint32_t> freeNodes;
+		uint32_t root = NULL_NODE;
+
+		// Leaf arrays, indexed by the position stored in the leaf node and swapped with the last one on removal.
+		std::vector<uint32_t> leafNodes;
+		std::vector<Entity> leafEntities;
+		std::vector<uint32_t> leafDenseIndices;
+		std::vector<float> sphereX, sphereY, sphereZ, sphereRadius;
+		std::unordered_map<Entity, uint32_t> leafPositions;
+
+		// Scratch of query(), keeping its capacity.
+		std::vector<uint32_t> stack;
+		std::vector<uint32_t> candidates;
+		std::vector<float> candidateX, candidateY, candidateZ, candidateRadius;
+		std::vector<uint32_t> candidateVisible;
+
+		static constexpr uint32_t NULL_NODE = UINT32_MAX;
+		// Set on nodes pushed from a box completely inside the frustum, whose leaves are visible without tests.
+		static constexpr uint32_t INSIDE_FLAG = 1u << 31;
+		// Leaf boxes are grown by this share of the radius so small motions do not reinsert them.
+		static constexpr float FAT_MARGIN_RATIO = 0.1f;
+		// Floor of the margin, without which entities of radius 0 would be reinserted on every motion.
+		static constexpr float MIN_FAT_MARGIN = 0.05f;
+	};
+
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+#include "Vertex.h"
+
+namespace tessera
+{
+
+	// Non-owning view of packed mesh data, either from a Mesh or straight from a memory-mapped cache file.
+	struct MeshView
+	{
+		VertexLayout layout = VertexLayout::FULL;
+		uint32_t vertexCount = 0;
+		const void* vertexData = nullptr;
+		size_t vertexDataSize = 0;
+
+		VkIndexType indexType = VK_INDEX_TYPE_UINT16;
+		uint32_t indexCount = 0;
+		const void* indexData = nullptr;
+		size_t indexDataSize = 0;
+	};
+
+	// GPU-ready mesh: vertices already packed into layout, indices narrowed to 16 bits whenever they fit.
+	struct Mesh
+	{
+		VertexLayout layout = VertexLayout::FULL;
+		uint32_t vertexCount = 0;
+		std::vector<uint8_t> vertexData;
+
+		VkIndexType indexType = VK_INDEX_TYPE_UINT16;
+		uint32_t indexCount = 0;
+		std::vector<uint8_t> indexData;
+
+		[[nodiscard]] MeshView getView() const
+		{
+			return { layout, vertexCount, vertexData.data(), vertexData.size(), indexType, indexCount, indexData.data(), indexData.size() };
+		}
+	};
+
+}
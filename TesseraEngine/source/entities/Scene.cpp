@@ -0,0 +1,359 @@
+#include "Scene.h"
+
+#include <algorithm>
+#include <future>
+#include <stdexcept>
+#include <utility>
+
+#include "utils/CpuProfiler.h"
+#include "utils/ThreadPool.h"
+
+namespace tessera
+{
+
+	namespace
+	{
+		constexpr uint8_t KEPT = 0;
+		// Its slot was released by destroyEntity().
+		constexpr uint8_t DESTROYED = 1;
+		constexpr uint8_t DESCENDANT_DESTROYED = 2;
+
+		template <class T>
+		void permute(std::vector<T>& array, const std::vector<uint32_t>& order)
+		{
+			std::vector<T> permuted(order.size());
+			for (size_t i = 0; i < order.size(); ++i)
+			{
+				permuted[i] = array[order[i]];
+			}
+			array = std::move(permuted);
+		}
+	}
+
+	Entity Scene::createEntity(const glm::vec3& position, const float scale, const Entity parent)
+	{
+		const uint32_t parentIndex = parent != NULL_ENTITY ? getDenseIndex(parent) : NO_PARENT;
+
+		uint32_t slot;
+		if (!freeSlots.empty())
+		{
+			slot = freeSlots.back();
+			freeSlots.pop_back();
+		}
+		else
+		{
+			if (slots.size() > SLOT_MASK)
+			{
+				throw std::runtime_error("Scene: too many entities.");
+			}
+			slot = static_cast<uint32_t>(slots.size());
+			slots.emplace_back();
+		}
+
+		const Entity entity = (static_cast<Entity>(slots[slot].generation) << SLOT_BITS) | slot;
+		slots[slot].denseIndex = getEntityCount();
+		append(entity, parentIndex, position, scale);
+		return entity;
+	}
+
+	void Scene::append(const Entity entity, const uint32_t parentIndex, const glm::vec3& position, const float scale)
+	{
+		Components& c = components;
+		const uint32_t depth = parentIndex != NO_PARENT ? c.depths[parentIndex] + 1 : 0;
+
+		// Appending keeps the arrays sorted unless a shallower entity follows a deeper one.
+		if (!c.depths.empty() && depth < c.depths.back())
+		{
+			orderChanged = true;
+		}
+		levelsChanged = true;
+		++structureVersion;
+
+		c.entities.push_back(entity);
+		c.parents.push_back(parentIndex);
+		c.depths.push_back(depth);
+		c.localX.push_back(position.x);
+		c.localY.push_back(position.y);
+		c.localZ.push_back(position.z);
+		c.localScale.push_back(scale);
+		c.worldX.push_back(position.x);
+		c.worldY.push_back(position.y);
+		c.worldZ.push_back(position.z);
+		c.worldScale.push_back(scale);
+		c.localBoundsX.push_back(0.0f);
+		c.localBoundsY.push_back(0.0f);
+		c.localBoundsZ.push_back(0.0f);
+		c.localBoundsRadius.push_back(0.0f);
+		c.boundsX.push_back(position.x);
+		c.boundsY.push_back(position.y);
+		c.boundsZ.push_back(position.z);
+		c.boundsRadius.push_back(0.0f);
+		c.meshes.push_back(0);
+		c.materials.push_back(0);
+	}
+
+	void Scene::destroyEntity(const Entity entity)
+	{
+		if (!isAlive(entity))
+		{
+			return;
+		}
+
+		Slot& slot = slots[entity & SLOT_MASK];
+		destroyed.push_back(slot.denseIndex);
+		pendingRenderableChanges.push_back(entity);
+		slot.denseIndex = NO_PARENT;
+		++slot.generation;
+		freeSlots.push_back(entity & SLOT_MASK);
+	}
+
+	bool Scene::isAlive(const Entity entity) const
+	{
+		const uint32_t slot = entity & SLOT_MASK;
+		return entity != NULL_ENTITY && slot < slots.size() && slots[slot].denseIndex != NO_PARENT
+			&& slots[slot].generation == static_cast<uint8_t>(entity >> SLOT_BITS);
+	}
+
+	uint32_t Scene::getDenseIndex(const Entity entity) const
+	{
+		if (!isAlive(entity))
+		{
+			throw std::out_of_range("Scene: unknown entity.");
+		}
+
+		return slots[entity & SLOT_MASK].denseIndex;
+	}
+
+	void Scene::setLocalTransform(const Entity entity, const glm::vec3& position, const float scale)
+	{
+		const uint32_t index = getDenseIndex(entity);
+		components.localX[index] = position.x;
+		components.localY[index] = position.y;
+		components.localZ[index] = position.z;
+		components.localScale[index] = scale;
+	}
+
+	void Scene::setRenderable(const Entity entity, const uint32_t mesh, const uint16_t material, const glm::vec4& localBounds)
+	{
+		const uint32_t index = getDenseIndex(entity);
+		if ((components.meshes[index] != 0) != (mesh != 0))
+		{
+			pendingRenderableChanges.push_back(entity);
+			++structureVersion;
+		}
+		components.meshes[index] = mesh;
+		components.materials[index] = material;
+		components.localBoundsX[index] = localBounds.x;
+		components.localBoundsY[index] = localBounds.y;
+		components.localBoundsZ[index] = localBounds.z;
+		components.localBoundsRadius[index] = localBounds.w;
+	}
+
+	void Scene::update(ThreadPool* threadPool)
+	{
+		TESSERA_PROFILE_ZONE("Scene update");
+
+		if (!destroyed.empty() || orderChanged)
+		{
+			rebuild();
+		}
+
+		if (levelsChanged)
+		{
+			collectLevels();
+			levelsChanged = false;
+		}
+
+		// Published after rebuild(), which destroys the descendants of destroyed entities.
+		renderableChanges.swap(pendingRenderableChanges);
+		pendingRenderableChanges.clear();
+
+		// Each level reads the world transforms of the one before, so levels run one after another.
+		for (size_t level = 0; level + 1 < levels.size(); ++level)
+		{
+			const uint32_t first = levels[level];
+			const uint32_t count = levels[level + 1] - first;
+
+			if (!threadPool || count < 2 * MIN_ENTITIES_PER_TASK)
+			{
+				updateRange(first, first + count);
+				continue;
+			}
+
+			const uint32_t taskCount = std::min(count / MIN_ENTITIES_PER_TASK, static_cast<uint32_t>(threadPool->getWorkerCount()) + 1);
+			const uint32_t perTask = (count + taskCount - 1) / taskCount;
+
+			std::vector<std::future<void>> tasks;
+			tasks.reserve(taskCount - 1);
+			for (uint32_t task = 1; task < taskCount; ++task)
+			{
+				const uint32_t taskFirst = first + task * perTask;
+				const uint32_t taskLast = std::min(taskFirst + perTask, first + count);
+				tasks.push_back(threadPool->submit([this, taskFirst, taskLast] { updateRange(taskFirst, taskLast); }));
+			}
+
+			updateRange(first, first + perTask);
+			for (const auto& task : tasks)
+			{
+				threadPool->waitFor(task);
+			}
+			for (auto& task : tasks)
+			{
+				task.get();
+			}
+		}
+	}
+
+	void Scene::updateRange(const uint32_t first, const uint32_t last)
+	{
+		Components& c = components;
+		const uint32_t* parents = c.parents.data();
+
+		// Separate loops for roots and children keep both free of branches.
+		if (c.depths[first] == 0)
+		{
+			std::copy(c.localX.begin() + first, c.localX.begin() + last, c.worldX.begin() + first);
+			std::copy(c.localY.begin() + first, c.localY.begin() + last, c.worldY.begin() + first);
+			std::copy(c.localZ.begin() + first, c.localZ.begin() + last, c.worldZ.begin() + first);
+			std::copy(c.localScale.begin() + first, c.localScale.begin() + last, c.worldScale.begin() + first);
+		}
+		else
+		{
+			float* worldX = c.worldX.data();
+			float* worldY = c.worldY.data();
+			float* worldZ = c.worldZ.data();
+			float* worldScale = c.worldScale.data();
+
+			for (uint32_t i = first; i < last; ++i)
+			{
+				const uint32_t parent = parents[i];
+				const float parentScale = worldScale[parent];
+				worldX[i] = worldX[parent] + c.localX[i] * parentScale;
+				worldY[i] = worldY[parent] + c.localY[i] * parentScale;
+				worldZ[i] = worldZ[parent] + c.localZ[i] * parentScale;
+				worldScale[i] = c.localScale[i] * parentScale;
+			}
+		}
+
+		const float* worldX = c.worldX.data();
+		const float* worldY = c.worldY.data();
+		const float* worldZ = c.worldZ.data();
+		const float* worldScale = c.worldScale.data();
+		const float* localBoundsX = c.localBoundsX.data();
+		const float* localBoundsY = c.localBoundsY.data();
+		const float* localBoundsZ = c.localBoundsZ.data();
+		const float* localBoundsRadius = c.localBoundsRadius.data();
+		float* boundsX = c.boundsX.data();
+		float* boundsY = c.boundsY.data();
+		float* boundsZ = c.boundsZ.data();
+		float* boundsRadius = c.boundsRadius.data();
+
+		for (uint32_t i = first; i < last; ++i)
+		{
+			boundsX[i] = worldX[i] + localBoundsX[i] * worldScale[i];
+			boundsY[i] = worldY[i] + localBoundsY[i] * worldScale[i];
+			boundsZ[i] = worldZ[i] + localBoundsZ[i] * worldScale[i];
+			boundsRadius[i] = localBoundsRadius[i] * worldScale[i];
+		}
+	}
+
+	void Scene::rebuild()
+	{
+		Components& c = components;
+		const uint32_t count = getEntityCount();
+
+		std::vector<uint8_t> removed(count, KEPT);
+		for (const uint32_t index : destroyed)
+		{
+			removed[index] = DESTROYED;
+		}
+
+		// Parents come before their children, so a single pass reaches every descendant.
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			if (removed[i] == KEPT && c.parents[i] != NO_PARENT && removed[c.parents[i]] != KEPT)
+			{
+				removed[i] = DESCENDANT_DESTROYED;
+				pendingRenderableChanges.push_back(c.entities[i]);
+				Slot& slot = slots[c.entities[i] & SLOT_MASK];
+				slot.denseIndex = NO_PARENT;
+				++slot.generation;
+				freeSlots.push_back(c.entities[i] & SLOT_MASK);
+			}
+		}
+
+		std::vector<uint32_t> order;
+		order.reserve(count - destroyed.size());
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			if (removed[i] == KEPT)
+			{
+				order.push_back(i);
+			}
+		}
+
+		// Stable, so parents stay ahead of their children within the order they were created in.
+		if (orderChanged)
+		{
+			std::ranges::stable_sort(order, {}, [&c](const uint32_t index) { return c.depths[index]; });
+		}
+
+		std::vector<uint32_t> newIndices(count, NO_PARENT);
+		for (uint32_t i = 0; i < order.size(); ++i)
+		{
+			newIndices[order[i]] = i;
+		}
+
+		permute(c.entities, order);
+		permute(c.parents, order);
+		permute(c.depths, order);
+		permute(c.localX, order);
+		permute(c.localY, order);
+		permute(c.localZ, order);
+		permute(c.localScale, order);
+		permute(c.worldX, order);
+		permute(c.worldY, order);
+		permute(c.worldZ, order);
+		permute(c.worldScale, order);
+		permute(c.localBoundsX, order);
+		permute(c.localBoundsY, order);
+		permute(c.localBoundsZ, order);
+		permute(c.localBoundsRadius, order);
+		permute(c.boundsX, order);
+		permute(c.boundsY, order);
+		permute(c.boundsZ, order);
+		permute(c.boundsRadius, order);
+		permute(c.meshes, order);
+		permute(c.materials, order);
+
+		for (uint32_t i = 0; i < order.size(); ++i)
+		{
+			if (c.parents[i] != NO_PARENT)
+			{
+				c.parents[i] = newIndices[c.parents[i]];
+			}
+			slots[c.entities[i] & SLOT_MASK].denseIndex = i;
+		}
+
+		destroyed.clear();
+		orderChanged = false;
+		levelsChanged = true;
+		++structureVersion;
+	}
+
+	void Scene::collectLevels()
+	{
+		const std::vector<uint32_t>& depths = components.depths;
+
+		levels.clear();
+		for (uint32_t i = 0; i < depths.size(); ++i)
+		{
+			if (i == 0 || depths[i] != depths[i - 1])
+			{
+				levels.push_back(i);
+			}
+		}
+		levels.push_back(getEntityCount());
+	}
+
+}
@@ -0,0 +1,110 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace tessera
+{
+
+	class ThreadPool;
+
+	// Index into the slots of a Scene in the low bits, generation of the slot in the high bits.
+	using Entity = uint32_t;
+	inline constexpr Entity NULL_ENTITY = UINT32_MAX;
+
+	/**
+	 * @brief Entities with their transform hierarchy and render components, stored as a sparse set of arrays.
+	 *
+	 * Entities are handles into a slot table, and each slot refers to a dense index shared by every
+	 * component array. The arrays are kept without holes and sorted by hierarchy depth, so parents come
+	 * before their children and each level of the hierarchy is one contiguous range. Systems walk them
+	 * linearly, one field at a time, which keeps loops branch-free and lets the compiler vectorize them.
+	 *
+	 * Transforms are a translation with a uniform scale, the form InstanceData and GpuObject give to
+	 * shaders. update() computes world transforms and bounds level by level, splitting each level across
+	 * the ThreadPool. Creating entities out of depth order and destroying them is cheap: both only mark
+	 * the arrays to be reordered, which happens once at the next update().
+	 *
+	 * Not thread-safe; the render thread owns the scene, see SceneManager.
+	 */
+	class Scene final
+	{
+	public:
+		// Parallel arrays indexed by dense index; world arrays are valid after update().
+		struct Components
+		{
+			std::vector<Entity> entities;
+			// Dense index of the parent, NO_PARENT for roots.
+			std::vector<uint32_t> parents;
+			std::vector<uint32_t> depths;
+
+			std::vector<float> localX, localY, localZ, localScale;
+			std::vector<float> worldX, worldY, worldZ, worldScale;
+
+			// Bounding sphere of the mesh in local space, and after update() in world space.
+			std::vector<float> localBoundsX, localBoundsY, localBoundsZ, localBoundsRadius;
+			std::vector<float> boundsX, boundsY, boundsZ, boundsRadius;
+
+			// MeshHandle of the BufferManager, 0 for entities that draw nothing.
+			std::vector<uint32_t> meshes;
+			std::vector<uint16_t> materials;
+		};
+
+		// parent must be alive; it moves and scales the new entity along.
+		Entity createEntity(const glm::vec3& position = glm::vec3(0.0f), float scale = 1.0f, Entity parent = NULL_ENTITY);
+		// Destroys the descendants as well. The handle is invalid right away, the components are gone after the next update().
+		void destroyEntity(Entity entity);
+		[[nodiscard]] bool isAlive(Entity entity) const;
+		// Throws std::out_of_range for entities that are not alive. Only stable until the next update().
+		[[nodiscard]] uint32_t getDenseIndex(Entity entity) const;
+
+		void setLocalTransform(Entity entity, const glm::vec3& position, float scale);
+		// Draw mesh with material. localBounds is the bounding sphere of the mesh, center in xyz and radius in w.
+		void setRenderable(Entity entity, uint32_t mesh, uint16_t material, const glm::vec4& localBounds);
+		void clearRenderable(Entity entity) { setRenderable(entity, 0, 0, glm::vec4(0.0f)); }
+
+		// Apply pending destructions and reordering, then compute world transforms and bounds, on threadPool when given.
+		void update(ThreadPool* threadPool);
+
+		[[nodiscard]] uint32_t getEntityCount() const { return static_cast<uint32_t>(components.entities.size()); }
+		[[nodiscard]] const Components& getComponents() const { return components; }
+		// Changes whenever entities are created, removed, reordered or start or stop being renderable, so structures over dense indices know to rebuild.
+		[[nodiscard]] uint64_t getStructureVersion() const { return structureVersion; }
+		// Entities that were destroyed or started or stopped being renderable before the last update(), possibly more than once each.
+		[[nodiscard]] const std::vector<Entity>& getRenderableChanges() const { return renderableChanges; }
+
+		static constexpr uint32_t NO_PARENT = UINT32_MAX;
+	private:
+		struct Slot
+		{
+			uint32_t denseIndex = NO_PARENT;
+			uint8_t generation = 0;
+		};
+
+		void append(Entity entity, uint32_t parentIndex, const glm::vec3& position, float scale);
+		// Drop the destroyed entities and restore depth order in one pass over every array.
+		void rebuild();
+		void collectLevels();
+		void updateRange(uint32_t first, uint32_t last);
+
+		Components components;
+		std::vector<Slot> slots;
+		std::vector<uint32_t> freeSlots;
+		// Dense indices destroyed since the last update().
+		std::vector<uint32_t> destroyed;
+		// Collected until update() publishes them as renderableChanges.
+		std::vector<Entity> pendingRenderableChanges;
+		std::vector<Entity> renderableChanges;
+		bool orderChanged = false;
+		// First dense index of every hierarchy level, followed by the entity count.
+		std::vector<uint32_t> levels;
+		bool levelsChanged = false;
+		uint64_t structureVersion = 0;
+
+		static constexpr uint32_t SLOT_BITS = 24;
+		static constexpr uint32_t SLOT_MASK = (1u << SLOT_BITS) - 1;
+		// Smaller levels are updated on the calling thread, since a task costs more than the work.
+		static constexpr uint32_t MIN_ENTITIES_PER_TASK = 4096;
+	};
+
+}
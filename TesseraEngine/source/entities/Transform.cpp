@@ -0,0 +1,22 @@
+#include "Transform.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace tessera
+{
+
+	glm::mat4 Transform::toMatrix() const
+	{
+		return glm::translate(glm::mat4(1.0f), position) * glm::mat4_cast(rotation) * glm::scale(glm::mat4(1.0f), glm::vec3(scale));
+	}
+
+	Transform interpolate(const Transform& from, const Transform& to, const float alpha)
+	{
+		Transform result;
+		result.position = glm::mix(from.position, to.position, alpha);
+		result.rotation = glm::slerp(from.rotation, to.rotation, alpha);
+		result.scale = glm::mix(from.scale, to.scale, alpha);
+		return result;
+	}
+
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+namespace tessera
+{
+
+	// Placement of a simulated entity or camera: translation, rotation and uniform scale.
+	struct Transform
+	{
+		glm::vec3 position{ 0.0f };
+		glm::quat rotation{ 1.0f, 0.0f, 0.0f, 0.0f };
+		float scale = 1.0f;
+
+		// Local to world matrix; the inverse is the view matrix of a camera.
+		[[nodiscard]] glm::mat4 toMatrix() const;
+	};
+
+	// Linear in position and scale, spherical in rotation. alpha 0 gives from, 1 gives to.
+	[[nodiscard]] Transform interpolate(const Transform& from, const Transform& to, float alpha);
+
+}
@@ -0,0 +1,189 @@
+#include "Vertex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+
+namespace tessera
+{
+
+	namespace
+	{
+		// IEEE 754 binary32 to binary16 conversion with round-to-nearest-even.
+		uint16_t toHalf(const float value)
+		{
+			uint32_t bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+
+			const uint32_t sign = (bits >> 16) & 0x8000u;
+			const uint32_t exponent = (bits >> 23) & 0xFFu;
+			uint32_t mantissa = bits & 0x7FFFFFu;
+
+			// NaN and infinity.
+			if (exponent == 0xFFu)
+			{
+				return static_cast<uint16_t>(sign | 0x7C00u | (mantissa ? 0x200u : 0u));
+			}
+
+			const int32_t halfExponent = static_cast<int32_t>(exponent) - 127 + 15;
+
+			// Overflow saturates to infinity.
+			if (halfExponent >= 0x1F)
+			{
+				return static_cast<uint16_t>(sign | 0x7C00u);
+			}
+
+			// Subnormal halves, or zero when even those cannot represent the value.
+			if (halfExponent <= 0)
+			{
+				if (halfExponent < -10)
+				{
+					return static_cast<uint16_t>(sign);
+				}
+
+				mantissa |= 0x800000u;
+				const uint32_t shift = static_cast<uint32_t>(14 - halfExponent);
+				uint32_t halfMantissa = mantissa >> shift;
+				const uint32_t remainder = mantissa & ((1u << shift) - 1);
+				const uint32_t halfway = 1u << (shift - 1);
+				if (remainder > halfway || (remainder == halfway && (halfMantissa & 1u)))
+				{
+					++halfMantissa;
+				}
+				return static_cast<uint16_t>(sign | halfMantissa);
+			}
+
+			uint32_t half = sign | (static_cast<uint32_t>(halfExponent) << 10) | (mantissa >> 13);
+			const uint32_t remainder = mantissa & 0x1FFFu;
+			// Carry into the exponent is intended: it rounds up to the next power of two (or infinity).
+			if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u)))
+			{
+				++half;
+			}
+			return static_cast<uint16_t>(half);
+		}
+
+		uint8_t toUnorm8(const float value)
+		{
+			return static_cast<uint8_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+		}
+
+		int8_t toSnorm8(const float value)
+		{
+			return static_cast<int8_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 127.0f));
+		}
+	}
+
+	VkVertexInputBindingDescription Vertex::getBindingDescription(const VertexLayout layout)
+	{
+		VkVertexInputBindingDescription bindingDescription;
+		bindingDescription.binding = 0;
+		bindingDescription.stride = getStride(layout);
+		bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+		return bindingDescription;
+	}
+
+	std::vector<VkVertexInputAttributeDescription> Vertex::getAttributeDescriptions(const VertexLayout layout)
+	{
+		std::vector<VkVertexInputAttributeDescription> attributeDescriptions(3);
+		for (uint32_t location = 0; location < attributeDescriptions.size(); ++location)
+		{
+			attributeDescriptions[location].binding = 0;
+			attributeDescriptions[location].location = location;
+		}
+
+		switch (layout)
+		{
+			case VertexLayout::FULL:
+				attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
+				attributeDescriptions[0].offset = offsetof(Vertex, position);
+				attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
+				attributeDescriptions[1].offset = offsetof(Vertex, color);
+				attributeDescriptions[2].format = VK_FORMAT_R32G32B32_SFLOAT;
+				attributeDescriptions[2].offset = offsetof(Vertex, normal);
+				break;
+			// Four component formats are used since three component 8 and 16-bit formats are not guaranteed vertex buffer support.
+			case VertexLayout::COMPACT:
+				attributeDescriptions[0].format = VK_FORMAT_R16G16B16A16_SFLOAT;
+				attributeDescriptions[0].offset = offsetof(CompactVertex, position);
+				attributeDescriptions[1].format = VK_FORMAT_R8G8B8A8_UNORM;
+				attributeDescriptions[1].offset = offsetof(CompactVertex, color);
+				attributeDescriptions[2].format = VK_FORMAT_R8G8B8A8_SNORM;
+				attributeDescriptions[2].offset = offsetof(CompactVertex, normal);
+				break;
+		}
+
+		return attributeDescriptions;
+	}
+
+	VkVertexInputBindingDescription InstanceData::getBindingDescription()
+	{
+		VkVertexInputBindingDescription bindingDescription;
+		bindingDescription.binding = BINDING;
+		bindingDescription.stride = sizeof(InstanceData);
+		bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
+		return bindingDescription;
+	}
+
+	std::vector<VkVertexInputAttributeDescription> InstanceData::getAttributeDescriptions()
+	{
+		std::vector<VkVertexInputAttributeDescription> attributeDescriptions(2);
+		attributeDescriptions[0].binding = BINDING;
+		attributeDescriptions[0].location = FIRST_LOCATION;
+		attributeDescriptions[0].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+		attributeDescriptions[0].offset = offsetof(InstanceData, transform);
+		attributeDescriptions[1].binding = BINDING;
+		attributeDescriptions[1].location = FIRST_LOCATION + 1;
+		attributeDescriptions[1].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+		attributeDescriptions[1].offset = offsetof(InstanceData, color);
+
+		return attributeDescriptions;
+	}
+
+	uint32_t Vertex::getStride(const VertexLayout layout)
+	{
+		switch (layout)
+		{
+			case VertexLayout::FULL:	return sizeof(Vertex);
+			case VertexLayout::COMPACT:	return sizeof(CompactVertex);
+		}
+
+		throw std::invalid_argument("Vertex: unknown vertex layout.");
+	}
+
+	std::vector<uint8_t> Vertex::pack(const std::vector<Vertex>& meshVertices, const VertexLayout layout)
+	{
+		std::vector<uint8_t> packed(meshVertices.size() * getStride(layout));
+
+		if (layout == VertexLayout::FULL)
+		{
+			std::memcpy(packed.data(), meshVertices.data(), packed.size());
+			return packed;
+		}
+
+		auto* compactVertices = reinterpret_cast<CompactVertex*>(packed.data());
+		for (size_t i = 0; i < meshVertices.size(); ++i)
+		{
+			const Vertex& vertex = meshVertices[i];
+			CompactVertex& compactVertex = compactVertices[i];
+
+			for (int component = 0; component < 3; ++component)
+			{
+				compactVertex.position[component] = toHalf(vertex.position[component]);
+				compactVertex.color[component] = toUnorm8(vertex.color[component]);
+				compactVertex.normal[component] = toSnorm8(vertex.normal[component]);
+			}
+
+			compactVertex.position[3] = toHalf(1.0f);
+			compactVertex.color[3] = 255;
+			compactVertex.normal[3] = 0;
+		}
+
+		return packed;
+	}
+
+}
@@ -1,6 +1,6 @@
 #pragma once
 
-#include <array>
+#include <cstdint>
 #include <vector>
 #include <glm/glm.hpp>
 #include <vulkan/vulkan_core.h>
@@ -8,46 +8,65 @@
 namespace tessera
 {
 
+	/**
+	 * @brief Memory layout of vertices inside the GPU vertex buffer.
+	 *
+	 * FULL keeps 32-bit floats for every attribute (36 bytes per vertex).
+	 * COMPACT stores half-float positions and normalized 8-bit colors and normals (16 bytes per vertex).
+	 */
+	enum class VertexLayout : uint8_t
+	{
+		FULL,
+		COMPACT
+	};
+
+	// Vertex as produced by loaders, before it is packed into one of the GPU layouts.
 	struct Vertex
 	{
-		glm::vec2 position;
+		glm::vec3 position;
 		glm::vec3 color;
+		glm::vec3 normal;
+
+		static VkVertexInputBindingDescription getBindingDescription(VertexLayout layout);
+		static std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions(VertexLayout layout);
+		static uint32_t getStride(VertexLayout layout);
+
+		// Interleave and quantize vertices according to layout.
+		static std::vector<uint8_t> pack(const std::vector<Vertex>& meshVertices, VertexLayout layout);
+	};
+
+	struct CompactVertex
+	{
+		uint16_t position[4];	// Half floats, w unused.
+		uint8_t color[4];		// Unorm, alpha unused.
+		int8_t normal[4];		// Snorm, w unused.
+	};
+
+	static_assert(sizeof(CompactVertex) == 16);
+
+	// Per-instance attributes, read from their own vertex binding by instanced pipelines.
+	struct InstanceData
+	{
+		glm::vec4 transform{ 0.0f, 0.0f, 0.0f, 1.0f };	// Translation in xyz, uniform scale in w.
+		glm::vec4 color{ 1.0f };						// Multiplies the vertex color, alpha unused.
+
+		static VkVertexInputBindingDescription getBindingDescription();
+		static std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions();
 
-		static VkVertexInputBindingDescription getBindingDescription()
-		{
-			VkVertexInputBindingDescription bindingDescription;
-			bindingDescription.binding = 0;
-			bindingDescription.stride = sizeof(Vertex);
-			bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-			return bindingDescription;
-		}
-
-		static std::array<VkVertexInputAttributeDescription, 2> getAttributeDescriptions()
-		{
-			std::array<VkVertexInputAttributeDescription, 2> attributeDescriptions{};
-			attributeDescriptions[0].binding = 0;
-			attributeDescriptions[0].location = 0;
-			attributeDescriptions[0].format = VK_FORMAT_R32G32_SFLOAT;
-			attributeDescriptions[0].offset = offsetof(Vertex, position);
-
-			attributeDescriptions[1].binding = 0;
-			attributeDescriptions[1].location = 1;
-			attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-			attributeDescriptions[1].offset = offsetof(Vertex, color);
-
-			return attributeDescriptions;
-		}
+		// Binding 0 holds the vertices; the instance attributes follow the vertex attributes.
+		static constexpr uint32_t BINDING = 1;
+		static constexpr uint32_t FIRST_LOCATION = 3;
 	};
 
+	// Fallback geometry used when no mesh asset is available.
 	const std::vector<Vertex> vertices = {
-		{{-0.5f, -0.5f}, {1.0f, 0.0f, 0.0f}},
-		{{0.5f, -0.5f}, {0.0f, 1.0f, 0.0f}},
-		{{0.5f, 0.5f}, {0.0f, 0.0f, 1.0f}},
-		{{-0.5f, 0.5f}, {1.0f, 1.0f, 1.0f}}
+		{{-0.5f, -0.5f, 0.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 1.0f}},
+		{{0.5f, -0.5f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}},
+		{{0.5f, 0.5f, 0.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 1.0f}},
+		{{-0.5f, 0.5f, 0.0f}, {1.0f, 1.0f, 1.0f}, {0.0f, 0.0f, 1.0f}}
 	};
 
-	const std::vector<uint16_t> indices = {
+	const std::vector<uint32_t> indices = {
 		0, 1, 2, 2, 3, 0
 	};
 }
@@ -1,8 +1,11 @@
 #include "GlfwInitializer.h"
 
+#include <algorithm>
 #include <functional>
 #include <stdexcept>
 
+#include "utils/CpuProfiler.h"
+#include "utils/EngineConfig.h"
 #include "utils/TesseraLog.h"
 #include "utils/interfaces/ServiceLocator.h"
 #include "vulkan/QueueManager.h"
@@ -10,8 +13,36 @@
 namespace tessera::glfw
 {
 
+	namespace
+	{
+		std::chrono::steady_clock::duration toFrameInterval(const int frameRate)
+		{
+			return frameRate > 0
+				? std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / frameRate))
+				: std::chrono::steady_clock::duration::zero();
+		}
+
+		void inputCallback([[maybe_unused]] GLFWwindow* window)
+		{
+			ServiceLocator::getServicePointer<GlfwInitializer>()->onInput();
+		}
+	}
+
 	void GlfwInitializer::init()
 	{
+		const auto& config = ServiceLocator::getService<EngineConfig>();
+		headless = config->getBool("render.headless", false);
+		headlessFrameCount = config->getInt("render.headlessFrames", DEFAULT_HEADLESS_FRAME_COUNT);
+		unfocusedFrameInterval = toFrameInterval(config->getInt("render.unfocusedFrameRate", 0));
+		idleFrameInterval = toFrameInterval(config->getInt("render.idleFrameRate", 0));
+		idleTimeout = std::chrono::seconds(std::max(config->getInt("render.idleSeconds", DEFAULT_IDLE_SECONDS), 0));
+
+		if (headless)
+		{
+			TesseraLog::send(LogType::INFO, "GlfwInitializer", "Running headless, no window is created.");
+			return;
+		}
+
 		glfwInit();
 		glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
 		glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
@@ -28,25 +59,135 @@ namespace tessera::glfw
 		});
 
 		glfwSetFramebufferSizeCallback(windowObject, framebufferResizeCallback);
+		glfwSetKeyCallback(windowObject, [](GLFWwindow* callbackWindow, int, int, int, int) { inputCallback(callbackWindow); });
+		glfwSetMouseButtonCallback(windowObject, [](GLFWwindow* callbackWindow, int, int, int) { inputCallback(callbackWindow); });
+		glfwSetCursorPosCallback(windowObject, [](GLFWwindow* callbackWindow, double, double) { inputCallback(callbackWindow); });
+		glfwSetScrollCallback(windowObject, [](GLFWwindow* callbackWindow, double, double) { inputCallback(callbackWindow); });
 	}
 
-	void GlfwInitializer::mainLoop(const std::function<void()>& tickCallback) const
+	void GlfwInitializer::mainLoop(const std::function<void()>& beforeInputCallback, const std::function<void()>& tickCallback)
 	{
+		if (headless)
+		{
+			// A frame count of 0 keeps rendering until the process is stopped.
+			for (int frame = 0; headlessFrameCount <= 0 || frame < headlessFrameCount; ++frame)
+			{
+				beforeInputCallback();
+				tickCallback();
+			}
+			return;
+		}
+
+		lastInputTime = std::chrono::steady_clock::now();
+		lastFrameTime = lastInputTime;
+
 		while (!glfwWindowShouldClose(window.get()))
 		{
-			glfwPollEvents();
+			beforeInputCallback();
+			waitForNextFrame();
+
+			// Closing the window while waiting should not cost one more frame.
+			if (glfwWindowShouldClose(window.get()))
+			{
+				break;
+			}
+
+			lastFrameTime = std::chrono::steady_clock::now();
 			tickCallback();
 		}
 	}
 
+	GlfwInitializer::WindowActivity GlfwInitializer::getActivity() const
+	{
+		// GLFW cannot tell whether other windows cover ours, so minimized and hidden windows are the ones known not to be seen.
+		int width = 0;
+		int height = 0;
+		glfwGetFramebufferSize(window.get(), &width, &height);
+		if (width == 0 || height == 0 || glfwGetWindowAttrib(window.get(), GLFW_ICONIFIED) || !glfwGetWindowAttrib(window.get(), GLFW_VISIBLE))
+		{
+			return WindowActivity::MINIMIZED;
+		}
+
+		if (!glfwGetWindowAttrib(window.get(), GLFW_FOCUSED))
+		{
+			return WindowActivity::UNFOCUSED;
+		}
+
+		if (idleTimeout > std::chrono::steady_clock::duration::zero() && std::chrono::steady_clock::now() - lastInputTime >= idleTimeout)
+		{
+			return WindowActivity::IDLE;
+		}
+
+		return WindowActivity::ACTIVE;
+	}
+
+	std::chrono::steady_clock::duration GlfwInitializer::getFrameInterval(const WindowActivity windowActivity) const
+	{
+		switch (windowActivity)
+		{
+		case WindowActivity::MINIMIZED:
+			return std::chrono::steady_clock::duration::max();
+		case WindowActivity::UNFOCUSED:
+			return unfocusedFrameInterval;
+		case WindowActivity::IDLE:
+			return idleFrameInterval;
+		default:
+			return std::chrono::steady_clock::duration::zero();
+		}
+	}
+
+	void GlfwInitializer::waitForNextFrame()
+	{
+		TESSERA_PROFILE_ZONE("Poll events");
+		glfwPollEvents();
+
+		while (!glfwWindowShouldClose(window.get()))
+		{
+			const WindowActivity currentActivity = getActivity();
+			if (currentActivity != activity)
+			{
+				static constexpr const char* ACTIVITY_NAMES[] = { "active", "idle", "unfocused", "minimized" };
+				TesseraLog::send(LogType::INFO, "GlfwInitializer", std::string("Window is ") + ACTIVITY_NAMES[static_cast<size_t>(currentActivity)] + ".");
+				activity = currentActivity;
+			}
+
+			const auto interval = getFrameInterval(currentActivity);
+			if (interval == std::chrono::steady_clock::duration::max())
+			{
+				// Nothing is presented while minimized; restoring the window sends the event ending the wait.
+				glfwWaitEvents();
+				continue;
+			}
+
+			const auto now = std::chrono::steady_clock::now();
+			if (now - lastFrameTime >= interval)
+			{
+				return;
+			}
+
+			// Input ends the wait early, and input or focus unthrottles the next iteration.
+			glfwWaitEventsTimeout(std::chrono::duration<double>(lastFrameTime + interval - now).count());
+		}
+	}
+
 	void GlfwInitializer::clean()
 	{
+		if (headless)
+		{
+			return;
+		}
+
 		glfwDestroyWindow(window.get());
 		glfwTerminate();
 	}
 
 	void GlfwInitializer::handleMinimization() const
 	{
+		if (headless)
+		{
+			return;
+		}
+
 		int width = 0;
 		int height = 0;
 		glfwGetFramebufferSize(window.get(), &width, &height);
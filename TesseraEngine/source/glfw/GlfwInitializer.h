@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <functional>
 #include <GLFW/glfw3.h>
 #include <memory>
@@ -11,21 +12,61 @@
 
 namespace tessera::glfw
 {
+	/**
+	 * @brief Window and event loop of the engine.
+	 *
+	 * The loop saves power when nobody is looking: while the window is minimized or hidden it blocks on
+	 * window events and renders nothing, and render.unfocusedFrameRate and render.idleFrameRate throttle
+	 * it while the window is in the background or has seen no input for render.idleSeconds. Throttled
+	 * frames wait in glfwWaitEventsTimeout, so input or focus ends the wait at once.
+	 */
 	class GlfwInitializer final : public Initializable
 	{
 	public:
 		void init() override;
-		void mainLoop(const std::function<void()>& tickCallback) const;
+		// beforeInputCallback runs right before events are polled, tickCallback right after.
+		// Headless, the loop runs render.headlessFrames times instead of until the window is closed.
+		void mainLoop(const std::function<void()>& beforeInputCallback, const std::function<void()>& tickCallback);
 		void clean() override;
 
 		[[nodiscard]] std::shared_ptr<GLFWwindow> getWindow() const { return window; }
+		// With render.headless no window, surface or swap chain exists and frames render into offscreen images.
+		[[nodiscard]] bool isHeadless() const { return headless; }
 		void handleMinimization() const;
+
+		// Called by the input callbacks of the window.
+		void onInput() { lastInputTime = std::chrono::steady_clock::now(); }
 	private:
+		enum class WindowActivity
+		{
+			ACTIVE,
+			IDLE,
+			UNFOCUSED,
+			MINIMIZED
+		};
+
+		[[nodiscard]] WindowActivity getActivity() const;
+		// Zero when frames are not throttled, max() while nothing should render at all.
+		[[nodiscard]] std::chrono::steady_clock::duration getFrameInterval(WindowActivity activity) const;
+		// Poll events, or wait for them until the next frame is due when the window does not need every frame.
+		void waitForNextFrame();
+
 		std::shared_ptr<GLFWwindow> window;
+		bool headless = false;
+		int headlessFrameCount = 0;
+
+		std::chrono::steady_clock::duration unfocusedFrameInterval{};
+		std::chrono::steady_clock::duration idleFrameInterval{};
+		std::chrono::steady_clock::duration idleTimeout{};
+		std::chrono::steady_clock::time_point lastInputTime;
+		std::chrono::steady_clock::time_point lastFrameTime;
+		WindowActivity activity = WindowActivity::ACTIVE;
 
 		static constexpr int WINDOW_WIDTH = 800;
 		static constexpr int WINDOW_HEIGHT = 600;
 		static constexpr std::string WINDOW_TITLE = "Tessera Engine";
+		static constexpr int DEFAULT_HEADLESS_FRAME_COUNT = 1000;
+		static constexpr int DEFAULT_IDLE_SECONDS = 60;
 	};
 
 	void framebufferResizeCallback(GLFWwindow* window, const int width, const int height);
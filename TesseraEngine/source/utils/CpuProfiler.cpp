@@ -0,0 +1,90 @@
+#include "CpuProfiler.h"
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+#include "utils/TesseraLog.h"
+
+namespace tessera
+{
+
+	int64_t CpuProfiler::now()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	void CpuProfiler::record(const char* name, const int64_t startNs, const int64_t endNs)
+	{
+		ThreadBuffer& buffer = getThreadBuffer();
+
+		// Only this thread writes writeIndex, so a relaxed load is enough; the release store publishes the event.
+		const uint64_t index = buffer.writeIndex.load(std::memory_order_relaxed);
+		buffer.events[index % EVENTS_PER_THREAD] = { name, startNs, endNs };
+		buffer.writeIndex.store(index + 1, std::memory_order_release);
+	}
+
+	CpuProfiler::ThreadBuffer& CpuProfiler::getThreadBuffer()
+	{
+		thread_local ThreadBuffer* threadBuffer = nullptr;
+
+		if (threadBuffer == nullptr)
+		{
+			std::lock_guard lock(registryMutex);
+			threadBuffers.emplace_back(std::make_unique<ThreadBuffer>());
+			threadBuffer = threadBuffers.back().get();
+			threadBuffer->threadId = static_cast<uint32_t>(threadBuffers.size());
+		}
+
+		return *threadBuffer;
+	}
+
+	void CpuProfiler::exportChromeTrace(const std::string& filename)
+	{
+		std::ofstream file(filename, std::ios::trunc);
+		if (!file.is_open())
+		{
+			throw std::runtime_error("CpuProfiler: failed to open " + filename + " for writing.");
+		}
+
+		std::lock_guard lock(registryMutex);
+
+		int64_t originNs = INT64_MAX;
+		for (const auto& buffer : threadBuffers)
+		{
+			const uint64_t end = buffer->writeIndex.load(std::memory_order_acquire);
+			const uint64_t begin = end > EVENTS_PER_THREAD ? end - EVENTS_PER_THREAD : 0;
+			for (uint64_t i = begin; i < end; ++i)
+			{
+				originNs = std::min(originNs, buffer->events[i % EVENTS_PER_THREAD].startNs);
+			}
+		}
+
+		file << std::fixed << std::setprecision(3);
+		file << "{\"traceEvents\":[";
+
+		size_t eventCount = 0;
+		for (const auto& buffer : threadBuffers)
+		{
+			const uint64_t end = buffer->writeIndex.load(std::memory_order_acquire);
+			const uint64_t begin = end > EVENTS_PER_THREAD ? end - EVENTS_PER_THREAD : 0;
+
+			for (uint64_t i = begin; i < end; ++i)
+			{
+				const auto& [name, startNs, endNs] = buffer->events[i % EVENTS_PER_THREAD];
+
+				// Zone names are literals from the source, so they need no JSON escaping.
+				file << (eventCount++ == 0 ? "\n" : ",\n")
+					<< "{\"name\":\"" << name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId
+					<< ",\"ts\":" << static_cast<double>(startNs - originNs) / 1000.0
+					<< ",\"dur\":" << static_cast<double>(endNs - startNs) / 1000.0 << "}";
+			}
+		}
+
+		file << "\n]}\n";
+
+		TesseraLog::send(LogType::INFO, "CpuProfiler", "Wrote " + std::to_string(eventCount) + " zones to " + filename + ".");
+	}
+
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace tessera
+{
+
+	struct CpuZoneEvent
+	{
+		const char* name = nullptr;
+		int64_t startNs = 0;
+		int64_t endNs = 0;
+	};
+
+	/**
+	 * @brief Collects CPU zones into per-thread ring buffers and exports them as a Chrome trace.
+	 *
+	 * Recording is wait-free: each thread only writes its own buffer and publishes it with one atomic store.
+	 * Buffers keep the newest events and are written out by exportChromeTrace(), which is best called after
+	 * the frame loop; while threads still record, zones being overwritten may appear truncated.
+	 */
+	class CpuProfiler final
+	{
+	public:
+		static void setEnabled(const bool isEnabled) { enabled.store(isEnabled, std::memory_order_relaxed); }
+		[[nodiscard]] static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+		[[nodiscard]] static int64_t now();
+		static void record(const char* name, int64_t startNs, int64_t endNs);
+
+		// Write the zones of every thread to filename in the Trace Event format (chrome://tracing, Perfetto).
+		static void exportChromeTrace(const std::string& filename);
+	private:
+		static constexpr size_t EVENTS_PER_THREAD = 8192;
+
+		struct ThreadBuffer
+		{
+			std::array<CpuZoneEvent, EVENTS_PER_THREAD> events;
+			std::atomic<uint64_t> writeIndex = 0;
+			uint32_t threadId = 0;
+		};
+
+		static ThreadBuffer& getThreadBuffer();
+
+		inline static std::atomic<bool> enabled = false;
+		inline static std::mutex registryMutex;
+		// Owned here rather than by the thread, so zones of finished threads are still exported.
+		inline static std::vector<std::unique_ptr<ThreadBuffer>> threadBuffers;
+	};
+
+	// Records the lifetime of the object as a zone named name, which must outlive the profiler (e.g. a string literal).
+	class ProfileZone final
+	{
+	public:
+		explicit ProfileZone(const char* zoneName) : name(zoneName), startNs(CpuProfiler::isEnabled() ? CpuProfiler::now() : 0) {}
+		~ProfileZone()
+		{
+			if (startNs != 0)
+			{
+				CpuProfiler::record(name, startNs, CpuProfiler::now());
+			}
+		}
+
+		ProfileZone(const ProfileZone&) = delete;
+		ProfileZone& operator=(const ProfileZone&) = delete;
+	private:
+		const char* name;
+		int64_t startNs;
+	};
+
+}
+
+#define TESSERA_PROFILE_CONCAT_INNER(a, b) a##b
+#define TESSERA_PROFILE_CONCAT(a, b) TESSERA_PROFILE_CONCAT_INNER(a, b)
+#define TESSERA_PROFILE_ZONE(name) const ::tessera::ProfileZone TESSERA_PROFILE_CONCAT(profileZone, __LINE__)(name)
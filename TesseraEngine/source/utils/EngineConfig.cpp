@@ -0,0 +1,128 @@
+#include "EngineConfig.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+
+#include "utils/TesseraLog.h"
+
+namespace tessera
+{
+
+	namespace
+	{
+		std::string trim(const std::string& text)
+		{
+			const auto first = std::ranges::find_if_not(text, [](const unsigned char c) { return std::isspace(c); });
+			const auto last = std::find_if_not(text.rbegin(), text.rend(), [](const unsigned char c) { return std::isspace(c); }).base();
+
+			return first < last ? std::string(first, last) : std::string();
+		}
+
+		std::string toLower(std::string text)
+		{
+			std::ranges::transform(text, text.begin(), [](const unsigned char c) { return static_cast<char>(std::tolower(c)); });
+			return text;
+		}
+	}
+
+	void EngineConfig::init()
+	{
+		load(CONFIG_PATH);
+
+		for (const auto& [key, value] : overrides)
+		{
+			values.insert_or_assign(key, value);
+		}
+	}
+
+	void EngineConfig::load(const std::string& filename)
+	{
+		std::ifstream file(filename);
+
+		if (!file.is_open())
+		{
+			TesseraLog::send(LogType::INFO, "EngineConfig", "No " + filename + " found, using default settings.");
+			return;
+		}
+
+		std::string section;
+		std::string line;
+		int lineNumber = 0;
+
+		while (std::getline(file, line))
+		{
+			++lineNumber;
+			line = trim(line.substr(0, line.find_first_of("#;")));
+
+			if (line.empty())
+			{
+				continue;
+			}
+
+			if (line.front() == '[' && line.back() == ']')
+			{
+				section = trim(line.substr(1, line.size() - 2));
+				continue;
+			}
+
+			const size_t separator = line.find('=');
+			if (separator == std::string::npos)
+			{
+				TesseraLog::send(LogType::WARNING, "EngineConfig", filename + ":" + std::to_string(lineNumber) + " is not a key = value pair.");
+				continue;
+			}
+
+			const std::string key = trim(line.substr(0, separator));
+			values[section.empty() ? key : section + "." + key] = trim(line.substr(separator + 1));
+		}
+	}
+
+	std::string EngineConfig::getString(const std::string& key, const std::string& defaultValue) const
+	{
+		const auto it = values.find(key);
+		return it != values.end() ? it->second : defaultValue;
+	}
+
+	int EngineConfig::getInt(const std::string& key, const int defaultValue) const
+	{
+		const auto it = values.find(key);
+		if (it == values.end())
+		{
+			return defaultValue;
+		}
+
+		try
+		{
+			return std::stoi(it->second);
+		}
+		catch (const std::exception&)
+		{
+			TesseraLog::send(LogType::WARNING, "EngineConfig", key + " = " + it->second + " is not an integer, using " + std::to_string(defaultValue) + ".");
+			return defaultValue;
+		}
+	}
+
+	bool EngineConfig::getBool(const std::string& key, const bool defaultValue) const
+	{
+		const auto it = values.find(key);
+		if (it == values.end())
+		{
+			return defaultValue;
+		}
+
+		const std::string value = toLower(it->second);
+		if (value == "true" || value == "1" || value == "yes" || value == "on")
+		{
+			return true;
+		}
+		if (value == "false" || value == "0" || value == "no" || value == "off")
+		{
+			return false;
+		}
+
+		TesseraLog::send(LogType::WARNING, "EngineConfig", key + " = " + it->second + " is not a boolean, using the default.");
+		return defaultValue;
+	}
+
+}
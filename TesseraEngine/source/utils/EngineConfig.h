@@ -0,0 +1,37 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+
+#include "utils/interfaces/Initializable.h"
+
+namespace tessera
+{
+
+	/**
+	 * @brief Runtime settings read from an ini file next to the executable.
+	 *
+	 * Keys are addressed as "section.key". A missing file or key leaves the default passed by the caller,
+	 * so every setting stays optional and deployments only list what they change.
+	 */
+	class EngineConfig final : public Initializable
+	{
+	public:
+		void init() override;
+		void clean() override {}
+
+		void load(const std::string& filename);
+
+		// Set before the engine is initialized, e.g. from command line arguments; overrides win over the ini file.
+		static void setOverride(const std::string& key, const std::string& value) { overrides[key] = value; }
+
+		[[nodiscard]] std::string getString(const std::string& key, const std::string& defaultValue) const;
+		[[nodiscard]] int getInt(const std::string& key, int defaultValue) const;
+		[[nodiscard]] bool getBool(const std::string& key, bool defaultValue) const;
+	private:
+		std::unordered_map<std::string, std::string> values;
+		inline static std::unordered_map<std::string, std::string> overrides;
+
+		static constexpr auto CONFIG_PATH = "engine.ini";
+	};
+
+}
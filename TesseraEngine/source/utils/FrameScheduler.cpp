@@ -0,0 +1,157 @@
+#include "FrameScheduler.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "utils/CpuProfiler.h"
+#include "utils/EngineConfig.h"
+#include "utils/TesseraLog.h"
+#include "utils/interfaces/ServiceLocator.h"
+
+namespace tessera
+{
+
+	void FrameScheduler::init()
+	{
+		const auto& config = ServiceLocator::getService<EngineConfig>();
+		const int tickRate = std::max(config->getInt("simulation.tickRate", DEFAULT_TICK_RATE), 1);
+		maxCatchUpTicks = static_cast<uint32_t>(std::max(config->getInt("simulation.maxCatchUpTicks", DEFAULT_MAX_CATCH_UP_TICKS), 1));
+		tickDuration = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / tickRate));
+	}
+
+	void FrameScheduler::start(SimulationState initialState, TickCallback callback)
+	{
+		if (isRunning())
+		{
+			throw std::runtime_error("FrameScheduler: the simulation is already running.");
+		}
+
+		tickCallback = std::move(callback);
+		previousState = initialState;
+		currentState = std::move(initialState);
+		// A thread that stopped on its own still has to be joined before it is replaced.
+		if (simulationThread.joinable())
+		{
+			simulationThread.join();
+		}
+
+		failure = nullptr;
+		stopping = false;
+		stopped = false;
+
+		// Its own thread rather than a ThreadPool task, which would keep a worker busy for as long as the simulation runs.
+		simulationThread = std::thread(&FrameScheduler::simulationLoop, this);
+		TesseraLog::send(LogType::INFO, "FrameScheduler", "Simulation started at " + std::to_string(1.0 / getTickSeconds()) + " ticks per second.");
+	}
+
+	void FrameScheduler::stop()
+	{
+		if (!simulationThread.joinable())
+		{
+			return;
+		}
+
+		stopping = true;
+		simulationThread.join();
+	}
+
+	void FrameScheduler::simulationLoop()
+	{
+		const double tickSeconds = getTickSeconds();
+		const auto maxLag = tickDuration * maxCatchUpTicks;
+
+		auto previousTime = std::chrono::steady_clock::now();
+		std::chrono::steady_clock::duration lag{};
+
+		while (!stopping.load(std::memory_order_relaxed))
+		{
+			const auto now = std::chrono::steady_clock::now();
+			lag = std::min(lag + (now - previousTime), maxLag);
+			previousTime = now;
+
+			while (lag >= tickDuration)
+			{
+				try
+				{
+					TESSERA_PROFILE_ZONE("Simulation tick");
+					previousState = currentState;
+					tickCallback(currentState, tickSeconds);
+					++currentState.tick;
+				}
+				catch (...)
+				{
+					// Handed to the render thread, which stops the engine where every other error does.
+					{
+						std::lock_guard lock(failureMutex);
+						failure = std::current_exception();
+					}
+					stopped.store(true, std::memory_order_release);
+					return;
+				}
+				lag -= tickDuration;
+
+				Snapshot& snapshot = snapshots.getWriteSlot();
+				snapshot.previous = previousState;
+				snapshot.current = currentState;
+				snapshot.tickTime = now - lag;
+				snapshots.publish();
+			}
+
+			std::this_thread::sleep_until(now + (tickDuration - lag));
+		}
+
+		stopped.store(true, std::memory_order_release);
+	}
+
+	void FrameScheduler::beginRenderFrame()
+	{
+		{
+			std::lock_guard lock(failureMutex);
+			if (failure)
+			{
+				std::rethrow_exception(std::exchange(failure, nullptr));
+			}
+		}
+
+		hasSnapshot = snapshots.acquire() || hasSnapshot;
+		if (!hasSnapshot)
+		{
+			return;
+		}
+
+		const Snapshot& snapshot = snapshots.getReadSlot();
+
+		// Past the newest tick the simulation has not caught up yet, so the newest state is held rather than extrapolated.
+		const auto sinceTick = std::chrono::steady_clock::now() - snapshot.tickTime;
+		const float alpha = std::clamp(std::chrono::duration<float>(sinceTick).count() / static_cast<float>(getTickSeconds()), 0.0f, 1.0f);
+		interpolate(snapshot.previous, snapshot.current, alpha, renderState);
+
+		if (renderCallback)
+		{
+			renderCallback(renderState);
+		}
+	}
+
+	void FrameScheduler::interpolate(const SimulationState& from, const SimulationState& to, const float alpha, SimulationState& result)
+	{
+		result.tick = to.tick;
+		result.camera = tessera::interpolate(from.camera, to.camera, alpha);
+
+		// Entities added by the tick have nothing to blend from.
+		result.transforms.resize(to.transforms.size());
+		for (size_t i = 0; i < to.transforms.size(); ++i)
+		{
+			result.transforms[i] = i < from.transforms.size() ? tessera::interpolate(from.transforms[i], to.transforms[i], alpha) : to.transforms[i];
+		}
+	}
+
+	void FrameScheduler::clean()
+	{
+		stop();
+		renderCallback = nullptr;
+		tickCallback = nullptr;
+	}
+
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "entities/Transform.h"
+#include "utils/TripleBuffer.h"
+#include "utils/interfaces/Initializable.h"
+
+namespace tessera
+{
+
+	// Everything the simulation hands to the renderer. Copied once per tick, so it holds only what rendering needs.
+	struct SimulationState
+	{
+		// Number of ticks simulated before this state.
+		uint64_t tick = 0;
+		Transform camera;
+		// Entities in an order chosen by the simulation; rendering interpolates them by index.
+		std::vector<Transform> transforms;
+	};
+
+	/**
+	 * @brief Runs the simulation at a fixed timestep on its own thread and hands interpolated states to the render thread.
+	 *
+	 * After every tick the previous and the new state are published through a TripleBuffer, so neither thread
+	 * ever waits for the other: a slow frame does not slow the simulation down, and a slow tick only makes
+	 * the renderer draw the newest state it has. beginRenderFrame() blends the two states by how far the
+	 * render time has moved past the newest tick, which keeps motion smooth at any frame rate while drawing
+	 * at most one tick behind the simulation.
+	 *
+	 * Ticks run at simulation.tickRate per second. After a stall at most simulation.maxCatchUpTicks are run
+	 * back to back and the rest of the time is dropped, so a simulation slower than real time cannot fall
+	 * further and further behind. Nothing runs until start() is called.
+	 */
+	class FrameScheduler final : public Initializable
+	{
+	public:
+		// Advances state by deltaSeconds. Runs on the simulation thread.
+		using TickCallback = std::function<void(SimulationState& state, double deltaSeconds)>;
+		// Applies the interpolated state to the renderer, e.g. UniformManager::setCamera(). Runs on the render thread.
+		using RenderCallback = std::function<void(const SimulationState& state)>;
+
+		void init() override;
+		void clean() override;
+
+		void start(SimulationState initialState, TickCallback tickCallback);
+		// Blocks until the tick in progress has finished. The last published state stays available to render.
+		void stop();
+		// False once the simulation thread has exited, including after a tick threw.
+		[[nodiscard]] bool isRunning() const { return !stopped.load(std::memory_order_acquire); }
+
+		void setRenderCallback(RenderCallback callback) { renderCallback = std::move(callback); }
+
+		/**
+		 * @brief Interpolate the newest published states for the frame about to be recorded and pass them to the render callback.
+		 *
+		 * Called once per frame on the render thread. Rethrows what a tick threw.
+		 */
+		void beginRenderFrame();
+		// Valid after beginRenderFrame() on the render thread.
+		[[nodiscard]] const SimulationState& getRenderState() const { return renderState; }
+
+		[[nodiscard]] double getTickSeconds() const { return std::chrono::duration<double>(tickDuration).count(); }
+	private:
+		struct Snapshot
+		{
+			SimulationState previous;
+			SimulationState current;
+			// When the tick producing current was due; render time past it advances the interpolation.
+			std::chrono::steady_clock::time_point tickTime;
+		};
+
+		void simulationLoop();
+		static void interpolate(const SimulationState& from, const SimulationState& to, float alpha, SimulationState& result);
+
+		std::chrono::steady_clock::duration tickDuration{};
+		uint32_t maxCatchUpTicks = 0;
+
+		// Owned by the simulation thread while it runs.
+		TickCallback tickCallback;
+		SimulationState previousState;
+		SimulationState currentState;
+
+		std::thread simulationThread;
+		std::atomic<bool> stopping = false;
+		// Set by the simulation thread when its loop exits, so a failed tick stops the scheduler right away.
+		std::atomic<bool> stopped = true;
+		std::mutex failureMutex;
+		std::exception_ptr failure;
+
+		TripleBuffer<Snapshot> snapshots;
+		bool hasSnapshot = false;
+		SimulationState renderState;
+		RenderCallback renderCallback;
+
+		static constexpr int DEFAULT_TICK_RATE = 60;
+		static constexpr int DEFAULT_MAX_CATCH_UP_TICKS = 5;
+	};
+
+}
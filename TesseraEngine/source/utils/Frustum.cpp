@@ -0,0 +1,126 @@
+#include "Frustum.h"
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define TESSERA_FRUSTUM_SSE2
+#include <emmintrin.h>
+#elif defined(_M_ARM64) || defined(__ARM_NEON)
+#define TESSERA_FRUSTUM_NEON
+#include <arm_neon.h>
+#endif
+
+namespace tessera
+{
+
+	Frustum Frustum::fromMatrix(const glm::mat4& matrix)
+	{
+		const auto row = [&](const int index)
+			{
+				return glm::vec4(matrix[0][index], matrix[1][index], matrix[2][index], matrix[3][index]);
+			};
+
+		Frustum frustum;
+		frustum.planes = { row(3) + row(0), row(3) - row(0), row(3) + row(1), row(3) - row(1), row(2), row(3) - row(2) };
+		for (auto& plane : frustum.planes)
+		{
+			plane /= glm::length(glm::vec3(plane));
+		}
+
+		return frustum;
+	}
+
+	FrustumTest Frustum::testBox(const glm::vec3& center, const glm::vec3& extents) const
+	{
+		FrustumTest result = FrustumTest::INSIDE;
+		for (const glm::vec4& plane : planes)
+		{
+			const glm::vec3 normal(plane);
+			const float distance = glm::dot(normal, center) + plane.w;
+			// Projection of the half extents onto the normal, the distance from the center to the nearest corner.
+			const float reach = glm::dot(glm::abs(normal), extents);
+
+			if (distance + reach < 0.0f)
+			{
+				return FrustumTest::OUTSIDE;
+			}
+			if (distance - reach < 0.0f)
+			{
+				result = FrustumTest::INTERSECTING;
+			}
+		}
+
+		return result;
+	}
+
+	uint32_t Frustum::testSpheres(const float* x, const float* y, const float* z, const float* radius, const uint32_t count, uint32_t* visible) const
+	{
+		uint32_t visibleCount = 0;
+		uint32_t i = 0;
+
+#if defined(TESSERA_FRUSTUM_SSE2)
+		for (; i + 4 <= count; i += 4)
+		{
+			const __m128 sphereX = _mm_loadu_ps(x + i);
+			const __m128 sphereY = _mm_loadu_ps(y + i);
+			const __m128 sphereZ = _mm_loadu_ps(z + i);
+			const __m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(radius + i));
+
+			__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+			for (const glm::vec4& plane : planes)
+			{
+				const __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(sphereX, _mm_set1_ps(plane.x)), _mm_mul_ps(sphereY, _mm_set1_ps(plane.y))),
+					_mm_add_ps(_mm_mul_ps(sphereZ, _mm_set1_ps(plane.z)), _mm_set1_ps(plane.w)));
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+			}
+
+			const int mask = _mm_movemask_ps(inside);
+			for (uint32_t lane = 0; lane < 4; ++lane)
+			{
+				visible[visibleCount] = i + lane;
+				visibleCount += (mask >> lane) & 1;
+			}
+		}
+#elif defined(TESSERA_FRUSTUM_NEON)
+		for (; i + 4 <= count; i += 4)
+		{
+			const float32x4_t sphereX = vld1q_f32(x + i);
+			const float32x4_t sphereY = vld1q_f32(y + i);
+			const float32x4_t sphereZ = vld1q_f32(z + i);
+			const float32x4_t negativeRadius = vnegq_f32(vld1q_f32(radius + i));
+
+			uint32x4_t inside = vdupq_n_u32(UINT32_MAX);
+			for (const glm::vec4& plane : planes)
+			{
+				float32x4_t distance = vdupq_n_f32(plane.w);
+				distance = vmlaq_n_f32(distance, sphereX, plane.x);
+				distance = vmlaq_n_f32(distance, sphereY, plane.y);
+				distance = vmlaq_n_f32(distance, sphereZ, plane.z);
+				inside = vandq_u32(inside, vcgeq_f32(distance, negativeRadius));
+			}
+
+			uint32_t lanes[4];
+			vst1q_u32(lanes, inside);
+			for (uint32_t lane = 0; lane < 4; ++lane)
+			{
+				visible[visibleCount] = i + lane;
+				visibleCount += lanes[lane] & 1;
+			}
+		}
+#endif
+
+		// The remainder, or every sphere without SIMD.
+		for (; i < count; ++i)
+		{
+			bool inside = true;
+			for (const glm::vec4& plane : planes)
+			{
+				inside &= plane.x * x[i] + plane.y * y[i] + plane.z * z[i] + plane.w >= -radius[i];
+			}
+
+			visible[visibleCount] = i;
+			visibleCount += inside ? 1 : 0;
+		}
+
+		return visibleCount;
+	}
+
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+namespace tessera
+{
+
+	// Relation of a volume to the frustum, from cheapest to most expensive to draw.
+	enum class FrustumTest : uint8_t
+	{
+		OUTSIDE,
+		INTERSECTING,
+		INSIDE
+	};
+
+	/**
+	 * @brief View frustum as six inward-facing planes, for culling on the CPU.
+	 *
+	 * testSpheres() checks bounding spheres four at a time with SSE2, or NEON on ARM, and falls back to
+	 * scalar code elsewhere. Spheres come as separate coordinate arrays, the layout of Scene::Components.
+	 */
+	struct Frustum
+	{
+		// Unit normal in xyz and distance in w; points inside have a non-negative distance to every plane.
+		std::array<glm::vec4, 6> planes{};
+
+		// Left, right, bottom, top, near and far planes of a view projection matrix; Vulkan clip space has a depth range of [0, w].
+		[[nodiscard]] static Frustum fromMatrix(const glm::mat4& matrix);
+
+		// Axis-aligned box given by its center and half extents.
+		[[nodiscard]] FrustumTest testBox(const glm::vec3& center, const glm::vec3& extents) const;
+
+		// Write the positions of the spheres at least partly inside into visible, which holds count entries, and return how many there are.
+		uint32_t testSpheres(const float* x, const float* y, const float* z, const float* radius, uint32_t count, uint32_t* visible) const;
+	};
+
+}
@@ -0,0 +1,208 @@
+#include "KtxReader.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+
+namespace tessera
+{
+
+	namespace
+	{
+		constexpr uint8_t KTX2_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+		struct Ktx2Header
+		{
+			uint8_t identifier[12];
+			uint32_t vkFormat;
+			uint32_t typeSize;
+			uint32_t pixelWidth;
+			uint32_t pixelHeight;
+			uint32_t pixelDepth;
+			uint32_t layerCount;
+			uint32_t faceCount;
+			uint32_t levelCount;
+			uint32_t supercompressionScheme;
+			uint32_t dfdByteOffset;
+			uint32_t dfdByteLength;
+			uint32_t kvdByteOffset;
+			uint32_t kvdByteLength;
+			uint64_t sgdByteOffset;
+			uint64_t sgdByteLength;
+		};
+
+		static_assert(sizeof(Ktx2Header) == 80);
+
+		struct Ktx2Level
+		{
+			uint64_t byteOffset;
+			uint64_t byteLength;
+			uint64_t uncompressedByteLength;
+		};
+
+		bool isRangeInside(const uint64_t offset, const uint64_t size, const size_t fileSize)
+		{
+			return offset <= fileSize && size <= fileSize - offset;
+		}
+
+		// Texel block of a format; bytes is 0 for formats the reader cannot size.
+		struct FormatBlock
+		{
+			uint32_t width = 1;
+			uint32_t height = 1;
+			uint32_t bytes = 0;
+		};
+
+		bool isInRange(const VkFormat format, const VkFormat first, const VkFormat last)
+		{
+			return format >= first && format <= last;
+		}
+
+		FormatBlock getFormatBlock(const VkFormat format)
+		{
+			// ASTC comes in pairs of UNORM and SRGB, in this order of block extents; the HDR formats in the same order.
+			constexpr uint32_t ASTC_BLOCKS[][2] = { { 4, 4 }, { 5, 4 }, { 5, 5 }, { 6, 5 }, { 6, 6 }, { 8, 5 }, { 8, 6 }, { 8, 8 },
+				{ 10, 5 }, { 10, 6 }, { 10, 8 }, { 10, 10 }, { 12, 10 }, { 12, 12 } };
+			if (isInRange(format, VK_FORMAT_ASTC_4x4_UNORM_BLOCK, VK_FORMAT_ASTC_12x12_SRGB_BLOCK))
+			{
+				const auto* block = ASTC_BLOCKS[(format - VK_FORMAT_ASTC_4x4_UNORM_BLOCK) / 2];
+				return { block[0], block[1], 16 };
+			}
+			if (isInRange(format, VK_FORMAT_ASTC_4x4_SFLOAT_BLOCK, VK_FORMAT_ASTC_12x12_SFLOAT_BLOCK))
+			{
+				const auto* block = ASTC_BLOCKS[format - VK_FORMAT_ASTC_4x4_SFLOAT_BLOCK];
+				return { block[0], block[1], 16 };
+			}
+
+			if (isInRange(format, VK_FORMAT_BC1_RGB_UNORM_BLOCK, VK_FORMAT_BC1_RGBA_SRGB_BLOCK)
+				|| isInRange(format, VK_FORMAT_BC4_UNORM_BLOCK, VK_FORMAT_BC4_SNORM_BLOCK)
+				|| isInRange(format, VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK, VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK)
+				|| isInRange(format, VK_FORMAT_EAC_R11_UNORM_BLOCK, VK_FORMAT_EAC_R11_SNORM_BLOCK))
+			{
+				return { 4, 4, 8 };
+			}
+			if (isInRange(format, VK_FORMAT_BC2_UNORM_BLOCK, VK_FORMAT_BC3_SRGB_BLOCK)
+				|| isInRange(format, VK_FORMAT_BC5_UNORM_BLOCK, VK_FORMAT_BC7_SRGB_BLOCK)
+				|| isInRange(format, VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK, VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK)
+				|| isInRange(format, VK_FORMAT_EAC_R11G11_UNORM_BLOCK, VK_FORMAT_EAC_R11G11_SNORM_BLOCK))
+			{
+				return { 4, 4, 16 };
+			}
+
+			// Uncompressed color formats, grouped by texel size.
+			if (isInRange(format, VK_FORMAT_R4G4_UNORM_PACK8, VK_FORMAT_R4G4_UNORM_PACK8) || isInRange(format, VK_FORMAT_R8_UNORM, VK_FORMAT_R8_SRGB))
+			{
+				return { 1, 1, 1 };
+			}
+			if (isInRange(format, VK_FORMAT_R4G4B4A4_UNORM_PACK16, VK_FORMAT_A1R5G5B5_UNORM_PACK16) || isInRange(format, VK_FORMAT_R8G8_UNORM, VK_FORMAT_R8G8_SRGB)
+				|| isInRange(format, VK_FORMAT_R16_UNORM, VK_FORMAT_R16_SFLOAT))
+			{
+				return { 1, 1, 2 };
+			}
+			if (isInRange(format, VK_FORMAT_R8G8B8_UNORM, VK_FORMAT_B8G8R8_SRGB))
+			{
+				return { 1, 1, 3 };
+			}
+			if (isInRange(format, VK_FORMAT_R8G8B8A8_UNORM, VK_FORMAT_A2B10G10R10_SINT_PACK32) || isInRange(format, VK_FORMAT_R16G16_UNORM, VK_FORMAT_R16G16_SFLOAT)
+				|| isInRange(format, VK_FORMAT_R32_UINT, VK_FORMAT_R32_SFLOAT) || isInRange(format, VK_FORMAT_B10G11R11_UFLOAT_PACK32, VK_FORMAT_E5B9G9R9_UFLOAT_PACK32))
+			{
+				return { 1, 1, 4 };
+			}
+			if (isInRange(format, VK_FORMAT_R16G16B16_UNORM, VK_FORMAT_R16G16B16_SFLOAT))
+			{
+				return { 1, 1, 6 };
+			}
+			if (isInRange(format, VK_FORMAT_R16G16B16A16_UNORM, VK_FORMAT_R16G16B16A16_SFLOAT) || isInRange(format, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32_SFLOAT))
+			{
+				return { 1, 1, 8 };
+			}
+			if (isInRange(format, VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32_SFLOAT))
+			{
+				return { 1, 1, 12 };
+			}
+			if (isInRange(format, VK_FORMAT_R32G32B32A32_UINT, VK_FORMAT_R32G32B32A32_SFLOAT))
+			{
+				return { 1, 1, 16 };
+			}
+
+			return {};
+		}
+	}
+
+	TextureView KtxReader::read(const MappedFile& file, const std::string& name)
+	{
+		if (file.getSize() < sizeof(Ktx2Header))
+		{
+			throw std::runtime_error("KtxReader: " + name + " is too small to be a KTX2 file.");
+		}
+
+		Ktx2Header header;
+		std::memcpy(&header, file.getData(), sizeof(header));
+
+		if (std::memcmp(header.identifier, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) != 0)
+		{
+			throw std::runtime_error("KtxReader: " + name + " is not a KTX2 file.");
+		}
+		if (header.vkFormat == VK_FORMAT_UNDEFINED || header.supercompressionScheme != 0)
+		{
+			throw std::runtime_error("KtxReader: " + name + " is supercompressed or needs transcoding, which is not supported.");
+		}
+		if (header.pixelWidth == 0 || header.pixelHeight == 0 || header.pixelDepth > 1 || header.layerCount > 1 || header.faceCount != 1)
+		{
+			throw std::runtime_error("KtxReader: " + name + " is not a single 2D texture.");
+		}
+
+		// Zero asks the loader to generate the mip chain; only the base level is stored then.
+		const uint32_t levelCount = std::max(header.levelCount, 1u);
+		const auto maxLevelCount = static_cast<uint32_t>(std::bit_width(std::max(header.pixelWidth, header.pixelHeight)));
+		if (levelCount > maxLevelCount)
+		{
+			throw std::runtime_error("KtxReader: " + name + " has more mip levels than its extent allows.");
+		}
+		if (!isRangeInside(sizeof(Ktx2Header), static_cast<uint64_t>(levelCount) * sizeof(Ktx2Level), file.getSize()))
+		{
+			throw std::runtime_error("KtxReader: " + name + " has a truncated level index.");
+		}
+
+		TextureView texture;
+		texture.format = static_cast<VkFormat>(header.vkFormat);
+
+		// Levels are copied tightly packed, so each must hold every block of its extent.
+		const FormatBlock block = getFormatBlock(texture.format);
+		if (block.bytes == 0)
+		{
+			throw std::runtime_error("KtxReader: " + name + " uses a format the reader cannot size.");
+		}
+		const uint64_t bytesPerBlock = static_cast<uint64_t>(std::max(header.pixelDepth, 1u)) * std::max(header.layerCount, 1u) * block.bytes;
+		texture.levels.reserve(levelCount);
+
+		for (uint32_t level = 0; level < levelCount; ++level)
+		{
+			Ktx2Level levelEntry;
+			std::memcpy(&levelEntry, file.getData() + sizeof(Ktx2Header) + level * sizeof(Ktx2Level), sizeof(levelEntry));
+
+			if (levelEntry.byteLength == 0 || !isRangeInside(levelEntry.byteOffset, levelEntry.byteLength, file.getSize()))
+			{
+				throw std::runtime_error("KtxReader: level " + std::to_string(level) + " of " + name + " lies outside of the file.");
+			}
+
+			TextureLevelView levelView;
+			levelView.data = file.getData() + levelEntry.byteOffset;
+			levelView.size = static_cast<size_t>(levelEntry.byteLength);
+			levelView.width = std::max(header.pixelWidth >> level, 1u);
+			levelView.height = std::max(header.pixelHeight >> level, 1u);
+
+			const uint64_t blocksX = (levelView.width + block.width - 1) / block.width;
+			const uint64_t blocksY = (levelView.height + block.height - 1) / block.height;
+			if (levelEntry.byteLength < blocksX * blocksY * bytesPerBlock)
+			{
+				throw std::runtime_error("KtxReader: level " + std::to_string(level) + " of " + name + " is smaller than its extent requires.");
+			}
+			texture.levels.push_back(levelView);
+		}
+
+		return texture;
+	}
+
+}
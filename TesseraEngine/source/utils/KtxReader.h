@@ -0,0 +1,43 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+#include "MappedFile.h"
+
+namespace tessera
+{
+
+	// Non-owning view of one mip level, tightly packed in texel blocks.
+	struct TextureLevelView
+	{
+		const void* data = nullptr;
+		size_t size = 0;
+		uint32_t width = 0;
+		uint32_t height = 0;
+	};
+
+	// Levels are ordered from the most detailed one down.
+	struct TextureView
+	{
+		VkFormat format = VK_FORMAT_UNDEFINED;
+		std::vector<TextureLevelView> levels;
+	};
+
+	/**
+	 * @brief Reader of KTX2 containers holding 2D textures in a Vulkan format.
+	 *
+	 * Block-compressed formats (BCn, ETC2, ASTC) are uploaded as stored, so the data is only validated
+	 * and viewed in place inside the mapped file. Supercompressed and Basis Universal files need a
+	 * transcoder and are rejected, as are arrays, cube maps, 3D textures and levels too small for their extent.
+	 */
+	class KtxReader
+	{
+	public:
+		// Views point into file; name is only used in error messages.
+		static TextureView read(const MappedFile& file, const std::string& name);
+	};
+
+}
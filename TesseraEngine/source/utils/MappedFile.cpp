@@ -0,0 +1,123 @@
+#include "MappedFile.h"
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace tessera
+{
+
+#ifdef _WIN32
+
+	MappedFile::MappedFile(const std::string& filename)
+	{
+		fileHandle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (fileHandle == INVALID_HANDLE_VALUE)
+		{
+			fileHandle = nullptr;
+			throw std::runtime_error("MappedFile: failed to open " + filename + ".");
+		}
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(fileHandle, &fileSize))
+		{
+			CloseHandle(fileHandle);
+			throw std::runtime_error("MappedFile: failed to query size of " + filename + ".");
+		}
+		size = static_cast<size_t>(fileSize.QuadPart);
+
+		// Empty files cannot be mapped, they are exposed as an empty range instead.
+		if (size == 0)
+		{
+			return;
+		}
+
+		mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mappingHandle == nullptr)
+		{
+			CloseHandle(fileHandle);
+			throw std::runtime_error("MappedFile: failed to create mapping of " + filename + ".");
+		}
+
+		data = static_cast<const uint8_t*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+		if (data == nullptr)
+		{
+			CloseHandle(mappingHandle);
+			CloseHandle(fileHandle);
+			throw std::runtime_error("MappedFile: failed to map " + filename + ".");
+		}
+	}
+
+	MappedFile::~MappedFile()
+	{
+		if (data != nullptr)
+		{
+			UnmapViewOfFile(data);
+		}
+		if (mappingHandle != nullptr)
+		{
+			CloseHandle(mappingHandle);
+		}
+		if (fileHandle != nullptr)
+		{
+			CloseHandle(fileHandle);
+		}
+	}
+
+#else
+
+	MappedFile::MappedFile(const std::string& filename)
+	{
+		fileDescriptor = open(filename.c_str(), O_RDONLY);
+		if (fileDescriptor < 0)
+		{
+			throw std::runtime_error("MappedFile: failed to open " + filename + ".");
+		}
+
+		struct stat fileStatus{};
+		if (fstat(fileDescriptor, &fileStatus) != 0)
+		{
+			close(fileDescriptor);
+			throw std::runtime_error("MappedFile: failed to query size of " + filename + ".");
+		}
+		size = static_cast<size_t>(fileStatus.st_size);
+
+		if (size == 0)
+		{
+			return;
+		}
+
+		void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+		if (mapping == MAP_FAILED)
+		{
+			close(fileDescriptor);
+			throw std::runtime_error("MappedFile: failed to map " + filename + ".");
+		}
+
+		data = static_cast<const uint8_t*>(mapping);
+	}
+
+	MappedFile::~MappedFile()
+	{
+		if (data != nullptr)
+		{
+			munmap(const_cast<uint8_t*>(data), size);
+		}
+		if (fileDescriptor >= 0)
+		{
+			close(fileDescriptor);
+		}
+	}
+
+#endif
+
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace tessera
+{
+
+	/**
+	 * @brief Read-only memory mapping of a whole file.
+	 *
+	 * The mapping stays valid for the lifetime of the object, so data can be copied straight
+	 * from the page cache without reading it into an intermediate buffer first.
+	 */
+	class MappedFile final
+	{
+	public:
+		explicit MappedFile(const std::string& filename);
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		[[nodiscard]] const uint8_t* getData() const { return data; }
+		[[nodiscard]] size_t getSize() const { return size; }
+	private:
+		const uint8_t* data = nullptr;
+		size_t size = 0;
+
+#ifdef _WIN32
+		void* fileHandle = nullptr;
+		void* mappingHandle = nullptr;
+#else
+		int fileDescriptor = -1;
+#endif
+	};
+
+}
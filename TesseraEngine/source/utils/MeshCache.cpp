@@ -0,0 +1,122 @@
+#include "MeshCache.h"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace tessera
+{
+
+	namespace
+	{
+		constexpr uint32_t MESH_CACHE_MAGIC = 0x48534D54; // "TMSH" little endian.
+		// Bump whenever the header, any vertex layout or the mesh optimization passes change.
+		constexpr uint32_t MESH_CACHE_VERSION = 2;
+		constexpr uint64_t BLOB_ALIGNMENT = 16;
+
+		struct MeshCacheHeader
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint8_t layout;
+			uint8_t indexType;
+			uint16_t reserved;
+			uint32_t vertexCount;
+			uint32_t indexCount;
+			uint32_t padding;
+			uint64_t vertexDataOffset;
+			uint64_t vertexDataSize;
+			uint64_t indexDataOffset;
+			uint64_t indexDataSize;
+		};
+
+		static_assert(sizeof(MeshCacheHeader) == 56);
+
+		uint64_t alignUp(const uint64_t value)
+		{
+			return (value + BLOB_ALIGNMENT - 1) / BLOB_ALIGNMENT * BLOB_ALIGNMENT;
+		}
+
+		bool isRangeInside(const uint64_t offset, const uint64_t size, const size_t fileSize)
+		{
+			return offset <= fileSize && size <= fileSize - offset;
+		}
+	}
+
+	void MeshCache::write(const std::string& filename, const Mesh& mesh)
+	{
+		MeshCacheHeader header{};
+		header.magic = MESH_CACHE_MAGIC;
+		header.version = MESH_CACHE_VERSION;
+		header.layout = static_cast<uint8_t>(mesh.layout);
+		header.indexType = static_cast<uint8_t>(mesh.indexType);
+		header.vertexCount = mesh.vertexCount;
+		header.indexCount = mesh.indexCount;
+		header.vertexDataOffset = alignUp(sizeof(MeshCacheHeader));
+		header.vertexDataSize = mesh.vertexData.size();
+		header.indexDataOffset = alignUp(header.vertexDataOffset + header.vertexDataSize);
+		header.indexDataSize = mesh.indexData.size();
+
+		std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+		if (!file.is_open())
+		{
+			throw std::runtime_error("MeshCache: failed to open " + filename + " for writing.");
+		}
+
+		constexpr char zeros[BLOB_ALIGNMENT] = {};
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(zeros, static_cast<std::streamsize>(header.vertexDataOffset - sizeof(header)));
+		file.write(reinterpret_cast<const char*>(mesh.vertexData.data()), static_cast<std::streamsize>(header.vertexDataSize));
+		file.write(zeros, static_cast<std::streamsize>(header.indexDataOffset - header.vertexDataOffset - header.vertexDataSize));
+		file.write(reinterpret_cast<const char*>(mesh.indexData.data()), static_cast<std::streamsize>(header.indexDataSize));
+
+		if (!file)
+		{
+			throw std::runtime_error("MeshCache: failed to write " + filename + ".");
+		}
+	}
+
+	std::optional<MeshView> MeshCache::read(const MappedFile& file, const VertexLayout expectedLayout)
+	{
+		if (file.getSize() < sizeof(MeshCacheHeader))
+		{
+			return std::nullopt;
+		}
+
+		MeshCacheHeader header;
+		std::memcpy(&header, file.getData(), sizeof(header));
+
+		if (header.magic != MESH_CACHE_MAGIC || header.version != MESH_CACHE_VERSION || header.layout != static_cast<uint8_t>(expectedLayout))
+		{
+			return std::nullopt;
+		}
+
+		const auto indexType = static_cast<VkIndexType>(header.indexType);
+		if (indexType != VK_INDEX_TYPE_UINT16 && indexType != VK_INDEX_TYPE_UINT32)
+		{
+			return std::nullopt;
+		}
+
+		const uint64_t indexSize = indexType == VK_INDEX_TYPE_UINT32 ? sizeof(uint32_t) : sizeof(uint16_t);
+		const bool sizesMatch = header.vertexDataSize == static_cast<uint64_t>(header.vertexCount) * Vertex::getStride(expectedLayout) &&
+			header.indexDataSize == static_cast<uint64_t>(header.indexCount) * indexSize;
+
+		if (!sizesMatch || !isRangeInside(header.vertexDataOffset, header.vertexDataSize, file.getSize()) ||
+			!isRangeInside(header.indexDataOffset, header.indexDataSize, file.getSize()))
+		{
+			return std::nullopt;
+		}
+
+		MeshView view;
+		view.layout = expectedLayout;
+		view.vertexCount = header.vertexCount;
+		view.vertexData = file.getData() + header.vertexDataOffset;
+		view.vertexDataSize = header.vertexDataSize;
+		view.indexType = indexType;
+		view.indexCount = header.indexCount;
+		view.indexData = file.getData() + header.indexDataOffset;
+		view.indexDataSize = header.indexDataSize;
+		return view;
+	}
+
+}
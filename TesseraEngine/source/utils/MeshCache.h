@@ -0,0 +1,26 @@
+#pragma once
+#include <optional>
+#include <string>
+
+#include "MappedFile.h"
+#include "entities/Mesh.h"
+
+namespace tessera
+{
+
+	/**
+	 * @brief Engine-native binary mesh format (.tmesh).
+	 *
+	 * A small fixed header followed by the packed vertex and index blobs, each 16-byte aligned, so a
+	 * memory-mapped file can be handed to the upload path without parsing or intermediate copies.
+	 */
+	class MeshCache
+	{
+	public:
+		static void write(const std::string& filename, const Mesh& mesh);
+
+		// Returns nothing when the file is not a valid cache of the expected layout; views point into file.
+		static std::optional<MeshView> read(const MappedFile& file, VertexLayout expectedLayout);
+	};
+
+}
@@ -0,0 +1,221 @@
+#include "MeshLoader.h"
+
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+
+#include "MeshOptimizer.h"
+
+namespace tessera
+{
+
+	namespace
+	{
+		struct ObjIndex
+		{
+			int32_t position = 0;
+			int32_t normal = 0;
+
+			bool operator==(const ObjIndex& other) const = default;
+		};
+
+		struct ObjIndexHash
+		{
+			size_t operator()(const ObjIndex& index) const
+			{
+				return std::hash<uint64_t>{}(static_cast<uint64_t>(static_cast<uint32_t>(index.position)) << 32 | static_cast<uint32_t>(index.normal));
+			}
+		};
+
+		// OBJ indices are 1-based, negative values are relative to the end of the list.
+		int32_t resolveIndex(const int32_t index, const size_t count)
+		{
+			const int32_t resolved = index < 0 ? static_cast<int32_t>(count) + index : index - 1;
+			if (resolved < 0 || static_cast<size_t>(resolved) >= count)
+			{
+				throw std::runtime_error("MeshLoader: OBJ face references a missing element.");
+			}
+			return resolved;
+		}
+
+		// Parses "v", "v/vt", "v//vn" and "v/vt/vn" face corners; filename and lineNumber only go into error messages.
+		ObjIndex parseCorner(const std::string& corner, const size_t positionCount, const size_t normalCount, const std::string& filename, const size_t lineNumber)
+		{
+			// The whole field must be an integer; std::stoi would accept trailing garbage and throw without context.
+			const auto parseIndex = [&](const std::string_view field)
+				{
+					int32_t value = 0;
+					const auto [end, error] = std::from_chars(field.data(), field.data() + field.size(), value);
+					if (error != std::errc() || end != field.data() + field.size())
+					{
+						throw std::runtime_error("MeshLoader: " + filename + ": malformed face corner \"" + corner + "\" on line " + std::to_string(lineNumber) + ".");
+					}
+					return value;
+				};
+
+			const std::string_view view(corner);
+			ObjIndex index;
+			const size_t firstSlash = view.find('/');
+			index.position = resolveIndex(parseIndex(view.substr(0, firstSlash)), positionCount);
+			index.normal = -1;
+
+			if (firstSlash == std::string_view::npos)
+			{
+				return index;
+			}
+
+			const size_t secondSlash = view.find('/', firstSlash + 1);
+			if (secondSlash != std::string_view::npos && secondSlash + 1 < view.size())
+			{
+				index.normal = resolveIndex(parseIndex(view.substr(secondSlash + 1)), normalCount);
+			}
+
+			return index;
+		}
+	}
+
+	Mesh MeshLoader::loadObj(const std::string& filename, const VertexLayout layout)
+	{
+		std::ifstream file(filename);
+		if (!file.is_open())
+		{
+			throw std::runtime_error("MeshLoader: failed to open file " + filename + ".");
+		}
+
+		std::vector<glm::vec3> positions;
+		std::vector<glm::vec3> colors;
+		std::vector<glm::vec3> normals;
+
+		std::vector<Vertex> meshVertices;
+		std::vector<uint32_t> meshIndices;
+		std::unordered_map<ObjIndex, uint32_t, ObjIndexHash> uniqueVertices;
+		bool hasNormals = true;
+
+		std::string line;
+		size_t lineNumber = 0;
+		std::vector<uint32_t> polygon;
+		while (std::getline(file, line))
+		{
+			++lineNumber;
+			std::istringstream stream(line);
+			std::string keyword;
+			stream >> keyword;
+
+			if (keyword == "v")
+			{
+				glm::vec3 position{};
+				stream >> position.x >> position.y >> position.z;
+				positions.push_back(position);
+
+				// Vertex colors are a common OBJ extension: "v x y z r g b".
+				glm::vec3 color(1.0f);
+				if (!(stream >> color.x >> color.y >> color.z))
+				{
+					color = glm::vec3(1.0f);
+				}
+				colors.push_back(color);
+			}
+			else if (keyword == "vn")
+			{
+				glm::vec3 normal{};
+				stream >> normal.x >> normal.y >> normal.z;
+				normals.push_back(normal);
+			}
+			else if (keyword == "f")
+			{
+				polygon.clear();
+				std::string corner;
+				while (stream >> corner)
+				{
+					const ObjIndex index = parseCorner(corner, positions.size(), normals.size(), filename, lineNumber);
+					hasNormals = hasNormals && index.normal >= 0;
+
+					const auto [it, inserted] = uniqueVertices.try_emplace(index, static_cast<uint32_t>(meshVertices.size()));
+					if (inserted)
+					{
+						const glm::vec3 normal = index.normal >= 0 ? normals[index.normal] : glm::vec3(0.0f);
+						meshVertices.push_back({ positions[index.position], colors[index.position], normal });
+					}
+					polygon.push_back(it->second);
+				}
+
+				// Triangle fan, valid for the convex polygons OBJ exporters emit.
+				for (size_t i = 2; i < polygon.size(); ++i)
+				{
+					meshIndices.push_back(polygon[0]);
+					meshIndices.push_back(polygon[i - 1]);
+					meshIndices.push_back(polygon[i]);
+				}
+			}
+		}
+
+		if (meshIndices.empty())
+		{
+			throw std::runtime_error("MeshLoader: " + filename + " contains no faces.");
+		}
+
+		// Area weighted smooth normals when the file does not provide them.
+		if (!hasNormals)
+		{
+			for (auto& vertex : meshVertices)
+			{
+				vertex.normal = glm::vec3(0.0f);
+			}
+
+			for (size_t i = 0; i < meshIndices.size(); i += 3)
+			{
+				Vertex& a = meshVertices[meshIndices[i]];
+				Vertex& b = meshVertices[meshIndices[i + 1]];
+				Vertex& c = meshVertices[meshIndices[i + 2]];
+				const glm::vec3 faceNormal = glm::cross(b.position - a.position, c.position - a.position);
+				a.normal += faceNormal;
+				b.normal += faceNormal;
+				c.normal += faceNormal;
+			}
+
+			for (auto& vertex : meshVertices)
+			{
+				const float length = glm::length(vertex.normal);
+				vertex.normal = length > 0.0f ? vertex.normal / length : glm::vec3(0.0f, 0.0f, 1.0f);
+			}
+		}
+
+		MeshOptimizer::optimize(meshIndices, meshVertices);
+
+		return build(meshVertices, meshIndices, layout);
+	}
+
+	Mesh MeshLoader::build(const std::vector<Vertex>& meshVertices, const std::vector<uint32_t>& meshIndices, const VertexLayout layout)
+	{
+		Mesh mesh;
+		mesh.layout = layout;
+		mesh.vertexCount = static_cast<uint32_t>(meshVertices.size());
+		mesh.vertexData = Vertex::pack(meshVertices, layout);
+		mesh.indexCount = static_cast<uint32_t>(meshIndices.size());
+
+		if (meshVertices.size() <= std::numeric_limits<uint16_t>::max())
+		{
+			mesh.indexType = VK_INDEX_TYPE_UINT16;
+			mesh.indexData.resize(meshIndices.size() * sizeof(uint16_t));
+			auto* narrowIndices = reinterpret_cast<uint16_t*>(mesh.indexData.data());
+			for (size_t i = 0; i < meshIndices.size(); ++i)
+			{
+				narrowIndices[i] = static_cast<uint16_t>(meshIndices[i]);
+			}
+		}
+		else
+		{
+			mesh.indexType = VK_INDEX_TYPE_UINT32;
+			mesh.indexData.resize(meshIndices.size() * sizeof(uint32_t));
+			std::memcpy(mesh.indexData.data(), meshIndices.data(), mesh.indexData.size());
+		}
+
+		return mesh;
+	}
+
+}
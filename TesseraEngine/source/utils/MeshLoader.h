@@ -0,0 +1,19 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include "entities/Mesh.h"
+
+namespace tessera
+{
+
+	class MeshLoader
+	{
+	public:
+		// Load a Wavefront OBJ file. Polygons are triangulated, missing normals are generated and the result is optimized.
+		static Mesh loadObj(const std::string& filename, VertexLayout layout);
+
+		static Mesh build(const std::vector<Vertex>& meshVertices, const std::vector<uint32_t>& meshIndices, VertexLayout layout);
+	};
+
+}
@@ -0,0 +1,365 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace tessera
+{
+
+	namespace
+	{
+		// Tuning from Tom Forsyth, "Linear-Speed Vertex Cache Optimisation".
+		constexpr uint32_t FORSYTH_CACHE_SIZE = 32;
+		constexpr float CACHE_DECAY_POWER = 1.5f;
+		constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+		constexpr float VALENCE_BOOST_SCALE = 2.0f;
+		constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+		// Post-transform cache size assumed when cutting overdraw clusters.
+		constexpr uint32_t SIMULATED_CACHE_SIZE = 16;
+
+		constexpr uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+
+		float vertexScore(const int32_t cachePosition, const uint32_t remainingTriangles)
+		{
+			if (remainingTriangles == 0)
+			{
+				return -1.0f;
+			}
+
+			float score = 0.0f;
+			if (cachePosition >= 0)
+			{
+				// The vertices of the last triangle get a fixed score so its neighbours are not always preferred.
+				if (cachePosition < 3)
+				{
+					score = LAST_TRIANGLE_SCORE;
+				}
+				else
+				{
+					const float scaler = 1.0f / static_cast<float>(FORSYTH_CACHE_SIZE - 3);
+					score = std::pow(1.0f - static_cast<float>(cachePosition - 3) * scaler, CACHE_DECAY_POWER);
+				}
+			}
+
+			// Prefer vertices with few remaining triangles to finish them off and avoid lone triangles later.
+			score += VALENCE_BOOST_SCALE * std::pow(static_cast<float>(remainingTriangles), -VALENCE_BOOST_POWER);
+			return score;
+		}
+
+		// FIFO cache simulation; counts misses for the triangle range [first, last).
+		uint32_t countCacheMisses(const std::vector<uint32_t>& meshIndices, const size_t first, const size_t last, std::vector<uint32_t>& timestamps, uint32_t& time, const uint32_t cacheSize)
+		{
+			uint32_t misses = 0;
+			for (size_t i = first * 3; i < last * 3; ++i)
+			{
+				const uint32_t vertex = meshIndices[i];
+				if (time - timestamps[vertex] >= cacheSize)
+				{
+					timestamps[vertex] = time++;
+					++misses;
+				}
+			}
+			return misses;
+		}
+	}
+
+	void MeshOptimizer::optimizeVertexCache(std::vector<uint32_t>& meshIndices, const size_t vertexCount)
+	{
+		const size_t triangleCount = meshIndices.size() / 3;
+		if (triangleCount == 0)
+		{
+			return;
+		}
+
+		// Vertex to triangle adjacency in compressed rows.
+		std::vector<uint32_t> remainingTriangles(vertexCount, 0);
+		for (const uint32_t index : meshIndices)
+		{
+			++remainingTriangles[index];
+		}
+
+		std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+		for (size_t vertex = 0; vertex < vertexCount; ++vertex)
+		{
+			adjacencyOffsets[vertex + 1] = adjacencyOffsets[vertex] + remainingTriangles[vertex];
+		}
+
+		std::vector<uint32_t> adjacency(meshIndices.size());
+		std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+		for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+		{
+			for (size_t corner = 0; corner < 3; ++corner)
+			{
+				adjacency[fill[meshIndices[triangle * 3 + corner]]++] = static_cast<uint32_t>(triangle);
+			}
+		}
+
+		std::vector<float> vertexScores(vertexCount);
+		for (size_t vertex = 0; vertex < vertexCount; ++vertex)
+		{
+			vertexScores[vertex] = vertexScore(-1, remainingTriangles[vertex]);
+		}
+
+		std::vector<float> triangleScores(triangleCount);
+		std::vector<bool> emitted(triangleCount, false);
+		for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+		{
+			triangleScores[triangle] = vertexScores[meshIndices[triangle * 3]] + vertexScores[meshIndices[triangle * 3 + 1]] + vertexScores[meshIndices[triangle * 3 + 2]];
+		}
+
+		std::vector<uint32_t> result;
+		result.reserve(meshIndices.size());
+
+		std::vector<uint32_t> cache;
+		std::vector<uint32_t> newCache;
+		cache.reserve(FORSYTH_CACHE_SIZE + 3);
+		newCache.reserve(FORSYTH_CACHE_SIZE + 3);
+
+		auto bestTriangle = static_cast<uint32_t>(std::distance(triangleScores.begin(), std::ranges::max_element(triangleScores)));
+		size_t scanCursor = 0;
+
+		while (result.size() < meshIndices.size())
+		{
+			// Nothing adjacent to the cache left, restart from the next triangle not emitted yet.
+			if (bestTriangle == INVALID_INDEX)
+			{
+				while (emitted[scanCursor])
+				{
+					++scanCursor;
+				}
+				bestTriangle = static_cast<uint32_t>(scanCursor);
+			}
+
+			emitted[bestTriangle] = true;
+			newCache.clear();
+
+			for (size_t corner = 0; corner < 3; ++corner)
+			{
+				const uint32_t vertex = meshIndices[bestTriangle * 3 + corner];
+				result.push_back(vertex);
+				newCache.push_back(vertex);
+
+				// Drop the triangle from the vertex adjacency list.
+				const uint32_t begin = adjacencyOffsets[vertex];
+				const uint32_t end = begin + remainingTriangles[vertex];
+				for (uint32_t i = begin; i < end; ++i)
+				{
+					if (adjacency[i] == bestTriangle)
+					{
+						std::swap(adjacency[i], adjacency[end - 1]);
+						break;
+					}
+				}
+				--remainingTriangles[vertex];
+			}
+
+			for (const uint32_t vertex : cache)
+			{
+				if (std::ranges::find(newCache, vertex) == newCache.end())
+				{
+					newCache.push_back(vertex);
+				}
+			}
+
+			// Vertices pushed out of the cache lose their position bonus.
+			if (newCache.size() > FORSYTH_CACHE_SIZE)
+			{
+				for (size_t i = FORSYTH_CACHE_SIZE; i < newCache.size(); ++i)
+				{
+					const uint32_t vertex = newCache[i];
+					const float score = vertexScore(-1, remainingTriangles[vertex]);
+					const float delta = score - vertexScores[vertex];
+					vertexScores[vertex] = score;
+					for (uint32_t j = adjacencyOffsets[vertex]; j < adjacencyOffsets[vertex] + remainingTriangles[vertex]; ++j)
+					{
+						triangleScores[adjacency[j]] += delta;
+					}
+				}
+				newCache.resize(FORSYTH_CACHE_SIZE);
+			}
+
+			std::swap(cache, newCache);
+
+			for (size_t position = 0; position < cache.size(); ++position)
+			{
+				const uint32_t vertex = cache[position];
+
+				const float score = vertexScore(static_cast<int32_t>(position), remainingTriangles[vertex]);
+				const float delta = score - vertexScores[vertex];
+				vertexScores[vertex] = score;
+
+				for (uint32_t j = adjacencyOffsets[vertex]; j < adjacencyOffsets[vertex] + remainingTriangles[vertex]; ++j)
+				{
+					triangleScores[adjacency[j]] += delta;
+				}
+			}
+
+			// Only triangles touching the cache changed score, so the next one is picked among them.
+			bestTriangle = INVALID_INDEX;
+			float bestScore = -std::numeric_limits<float>::max();
+			for (const uint32_t vertex : cache)
+			{
+				for (uint32_t j = adjacencyOffsets[vertex]; j < adjacencyOffsets[vertex] + remainingTriangles[vertex]; ++j)
+				{
+					const uint32_t triangle = adjacency[j];
+					if (triangleScores[triangle] > bestScore)
+					{
+						bestScore = triangleScores[triangle];
+						bestTriangle = triangle;
+					}
+				}
+			}
+		}
+
+		meshIndices = std::move(result);
+	}
+
+	void MeshOptimizer::optimizeOverdraw(std::vector<uint32_t>& meshIndices, const std::vector<Vertex>& meshVertices, const float threshold)
+	{
+		const size_t triangleCount = meshIndices.size() / 3;
+		if (triangleCount < 2)
+		{
+			return;
+		}
+
+		// Hard boundaries: triangles where every vertex misses the cache, so reordering there costs nothing.
+		// The first cluster always starts at 0, even when a degenerate first triangle misses fewer than three times.
+		std::vector<size_t> clusterStarts{ 0 };
+		{
+			std::vector<uint32_t> timestamps(meshVertices.size(), 0);
+			uint32_t time = SIMULATED_CACHE_SIZE + 1;
+			for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+			{
+				if (countCacheMisses(meshIndices, triangle, triangle + 1, timestamps, time, SIMULATED_CACHE_SIZE) == 3 && triangle != 0)
+				{
+					clusterStarts.push_back(triangle);
+				}
+			}
+		}
+		clusterStarts.push_back(triangleCount);
+
+		// Soft boundaries: split hard clusters further while the cold-cache ACMR stays within threshold.
+		std::vector<size_t> softStarts;
+		{
+			std::vector<uint32_t> timestamps(meshVertices.size(), 0);
+			uint32_t time = SIMULATED_CACHE_SIZE + 1;
+			for (size_t cluster = 0; cluster + 1 < clusterStarts.size(); ++cluster)
+			{
+				const size_t start = clusterStarts[cluster];
+				const size_t end = clusterStarts[cluster + 1];
+
+				time += SIMULATED_CACHE_SIZE + 1;
+				const float clusterAcmr = static_cast<float>(countCacheMisses(meshIndices, start, end, timestamps, time, SIMULATED_CACHE_SIZE)) / static_cast<float>(end - start);
+
+				size_t softStart = start;
+				softStarts.push_back(softStart);
+				time += SIMULATED_CACHE_SIZE + 1;
+				uint32_t misses = 0;
+				for (size_t triangle = start; triangle + 1 < end; ++triangle)
+				{
+					misses += countCacheMisses(meshIndices, triangle, triangle + 1, timestamps, time, SIMULATED_CACHE_SIZE);
+					if (static_cast<float>(misses) / static_cast<float>(triangle + 1 - softStart) <= clusterAcmr * threshold && triangle + 1 - softStart >= 8)
+					{
+						softStart = triangle + 1;
+						softStarts.push_back(softStart);
+						time += SIMULATED_CACHE_SIZE + 1;
+						misses = 0;
+					}
+				}
+			}
+		}
+		softStarts.push_back(triangleCount);
+
+		glm::vec3 meshCentroid(0.0f);
+		for (const auto& vertex : meshVertices)
+		{
+			meshCentroid += vertex.position;
+		}
+		meshCentroid = meshCentroid / static_cast<float>(std::max<size_t>(meshVertices.size(), 1));
+
+		const size_t clusterCount = softStarts.size() - 1;
+		std::vector<float> sortKeys(clusterCount);
+		for (size_t cluster = 0; cluster < clusterCount; ++cluster)
+		{
+			glm::vec3 centroid(0.0f);
+			glm::vec3 normal(0.0f);
+			float area = 0.0f;
+
+			for (size_t triangle = softStarts[cluster]; triangle < softStarts[cluster + 1]; ++triangle)
+			{
+				const glm::vec3& a = meshVertices[meshIndices[triangle * 3]].position;
+				const glm::vec3& b = meshVertices[meshIndices[triangle * 3 + 1]].position;
+				const glm::vec3& c = meshVertices[meshIndices[triangle * 3 + 2]].position;
+
+				const glm::vec3 faceNormal = glm::cross(b - a, c - a);
+				const float faceArea = glm::length(faceNormal);
+				centroid += (a + b + c) * (faceArea / 3.0f);
+				normal += faceNormal;
+				area += faceArea;
+			}
+
+			centroid = area > 0.0f ? centroid / area : centroid;
+			const float normalLength = glm::length(normal);
+			normal = normalLength > 0.0f ? normal / normalLength : normal;
+
+			// Clusters facing away from the mesh center are likely to occlude the rest and go first.
+			sortKeys[cluster] = glm::dot(centroid - meshCentroid, normal);
+		}
+
+		std::vector<size_t> clusterOrder(clusterCount);
+		std::iota(clusterOrder.begin(), clusterOrder.end(), 0);
+		std::ranges::stable_sort(clusterOrder, [&](const size_t a, const size_t b) { return sortKeys[a] > sortKeys[b]; });
+
+		std::vector<uint32_t> result;
+		result.reserve(meshIndices.size());
+		for (const size_t cluster : clusterOrder)
+		{
+			result.insert(result.end(), meshIndices.begin() + static_cast<std::ptrdiff_t>(softStarts[cluster] * 3), meshIndices.begin() + static_cast<std::ptrdiff_t>(softStarts[cluster + 1] * 3));
+		}
+
+		meshIndices = std::move(result);
+	}
+
+	void MeshOptimizer::optimizeVertexFetch(std::vector<uint32_t>& meshIndices, std::vector<Vertex>& meshVertices)
+	{
+		std::vector<uint32_t> remap(meshVertices.size(), INVALID_INDEX);
+		std::vector<Vertex> result;
+		result.reserve(meshVertices.size());
+
+		for (uint32_t& index : meshIndices)
+		{
+			if (remap[index] == INVALID_INDEX)
+			{
+				remap[index] = static_cast<uint32_t>(result.size());
+				result.push_back(meshVertices[index]);
+			}
+			index = remap[index];
+		}
+
+		meshVertices = std::move(result);
+	}
+
+	float MeshOptimizer::computeAcmr(const std::vector<uint32_t>& meshIndices, const size_t vertexCount, const uint32_t cacheSize)
+	{
+		const size_t triangleCount = meshIndices.size() / 3;
+		if (triangleCount == 0)
+		{
+			return 0.0f;
+		}
+
+		std::vector<uint32_t> timestamps(vertexCount, 0);
+		uint32_t time = cacheSize + 1;
+		return static_cast<float>(countCacheMisses(meshIndices, 0, triangleCount, timestamps, time, cacheSize)) / static_cast<float>(triangleCount);
+	}
+
+	void MeshOptimizer::optimize(std::vector<uint32_t>& meshIndices, std::vector<Vertex>& meshVertices)
+	{
+		optimizeVertexCache(meshIndices, meshVertices.size());
+		optimizeOverdraw(meshIndices, meshVertices);
+		optimizeVertexFetch(meshIndices, meshVertices);
+	}
+
+}
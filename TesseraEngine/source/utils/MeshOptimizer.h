@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "entities/Vertex.h"
+
+namespace tessera
+{
+
+	/**
+	 * @brief Load-time index and vertex reordering for triangle lists.
+	 *
+	 * The passes are meant to run in order: vertex cache, then overdraw, then vertex fetch,
+	 * since the fetch pass renumbers vertices in the order the final index buffer references them.
+	 */
+	class MeshOptimizer
+	{
+	public:
+		// Reorder triangles for post-transform vertex cache hits (Forsyth's linear-speed algorithm).
+		static void optimizeVertexCache(std::vector<uint32_t>& meshIndices, size_t vertexCount);
+
+		/**
+		 * @brief Reorder clusters of triangles so outward facing ones are drawn first.
+		 *
+		 * Clusters are cut wherever the simulated cache misses badly, which keeps most of the cache
+		 * efficiency of the previous pass. threshold is the acceptable ACMR degradation (e.g. 1.05).
+		 */
+		static void optimizeOverdraw(std::vector<uint32_t>& meshIndices, const std::vector<Vertex>& meshVertices, float threshold = 1.05f);
+
+		// Renumber vertices in order of first use and drop unreferenced ones.
+		static void optimizeVertexFetch(std::vector<uint32_t>& meshIndices, std::vector<Vertex>& meshVertices);
+
+		// Average cache misses per triangle for a FIFO cache of cacheSize entries.
+		static float computeAcmr(const std::vector<uint32_t>& meshIndices, size_t vertexCount, uint32_t cacheSize = 16);
+
+		// Order used by MeshLoader for every imported mesh.
+		static void optimize(std::vector<uint32_t>& meshIndices, std::vector<Vertex>& meshVertices);
+	};
+
+}
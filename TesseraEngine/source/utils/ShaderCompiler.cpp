@@ -0,0 +1,95 @@
+#include "ShaderCompiler.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+
+#include "ShaderLoader.h"
+
+namespace tessera
+{
+
+	namespace
+	{
+
+		// FNV-1a, which unlike std::hash is stable across runs and standard libraries.
+		uint64_t hashBytes(const std::string_view bytes, uint64_t hash = 0xcbf29ce484222325ull)
+		{
+			for (const char byte : bytes)
+			{
+				hash ^= static_cast<uint8_t>(byte);
+				hash *= 0x100000001b3ull;
+			}
+			return hash;
+		}
+
+		std::string quote(const std::string& path)
+		{
+			return "\"" + path + "\"";
+		}
+
+	}
+
+	std::vector<char> ShaderCompiler::compile(const std::string& sourcePath, const std::string& cacheDirectory, const std::string& compiler)
+	{
+		const std::vector<char> source = ShaderLoader::readFile(sourcePath);
+		const uint64_t hash = hashBytes(compiler, hashBytes({ source.data(), source.size() }));
+
+		std::ostringstream cacheName;
+		cacheName << std::filesystem::path(sourcePath).filename().string() << '.' << std::hex << std::setfill('0') << std::setw(16) << hash << ".spv";
+		const std::filesystem::path cachePath = std::filesystem::path(cacheDirectory) / cacheName.str();
+
+		if (std::filesystem::exists(cachePath))
+		{
+			return ShaderLoader::readFile(cachePath.string());
+		}
+
+		// Written under a name of its own and moved in place, so concurrent compilations never read a partial file.
+		std::filesystem::create_directories(cacheDirectory);
+		const std::filesystem::path temporaryPath = cachePath.string() + "." + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + ".tmp";
+
+		std::string command = quote(compiler) + " " + quote(sourcePath) + " -o " + quote(temporaryPath.string());
+#ifdef _WIN32
+		// cmd /c strips the outermost quotes, which would otherwise be those around the compiler path.
+		command = quote(command);
+#endif
+
+		// glslc reports errors on stderr itself.
+		if (std::system(command.c_str()) != 0)
+		{
+			std::filesystem::remove(temporaryPath);
+			throw std::runtime_error("ShaderCompiler: failed to compile " + sourcePath + ".");
+		}
+
+		std::filesystem::rename(temporaryPath, cachePath);
+		return ShaderLoader::readFile(cachePath.string());
+	}
+
+	std::string ShaderCompiler::findCompiler()
+	{
+#ifdef _WIN32
+		char* sdk = nullptr;
+		size_t length = 0;
+		if (_dupenv_s(&sdk, &length, "VULKAN_SDK") == 0 && sdk != nullptr)
+		{
+			const std::string compiler = (std::filesystem::path(sdk) / "Bin" / "glslc.exe").string();
+			std::free(sdk);
+			return compiler;
+		}
+#else
+		if (const char* sdk = std::getenv("VULKAN_SDK"))
+		{
+			return (std::filesystem::path(sdk) / "bin" / "glslc").string();
+		}
+#endif
+
+		return "glslc";
+	}
+
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <string>
+#include <vector>
+
+namespace tessera
+{
+
+	/**
+	 * @brief Compiles GLSL to SPIR-V at runtime by running glslc, with a content-addressed cache on disk.
+	 *
+	 * Cached binaries are named after a hash of the source text and the compiler, so an unchanged shader is
+	 * compiled once no matter how often it is edited back and forth, and stale binaries are never picked up.
+	 * Shaders do not use #include, so the source file alone determines the result.
+	 */
+	class ShaderCompiler
+	{
+	public:
+		// SPIR-V of the shader at sourcePath; the stage follows from its extension (.vert, .frag, .comp).
+		static std::vector<char> compile(const std::string& sourcePath, const std::string& cacheDirectory, const std::string& compiler);
+
+		// glslc of the Vulkan SDK when VULKAN_SDK is set, otherwise the one on PATH.
+		static std::string findCompiler();
+	};
+
+}
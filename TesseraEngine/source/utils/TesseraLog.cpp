@@ -1,18 +1,249 @@
 #include "TesseraLog.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
 #include <iostream>
+#include <memory>
 #include <ostream>
+#include <thread>
 
 namespace tessera
 {
-	void TesseraLog::send(const LogType logType, const std::string& title, const std::string& message)
+
+	namespace
+	{
+
+		/**
+		 * Bounded multi-producer queue of fixed-size message slots, drained by a single writer thread.
+		 * Each slot carries a sequence number telling producers and the writer whose turn it is.
+		 */
+		class AsyncLogBackend final
+		{
+		public:
+			AsyncLogBackend() : slots(std::make_unique<Slot[]>(CAPACITY)), writer([this] { writeLoop(); })
+			{
+				for (uint64_t i = 0; i < CAPACITY; ++i)
+				{
+					slots[i].sequence.store(i, std::memory_order_relaxed);
+				}
+			}
+
+			~AsyncLogBackend()
+			{
+				running.store(false, std::memory_order_release);
+				writer.join();
+			}
+
+			AsyncLogBackend(const AsyncLogBackend&) = delete;
+			AsyncLogBackend& operator=(const AsyncLogBackend&) = delete;
+
+			bool tryPush(const LogType logType, const std::string_view title, const std::string_view message)
+			{
+				uint64_t position = enqueuePosition.load(std::memory_order_relaxed);
+				Slot* slot;
+
+				for (;;)
+				{
+					slot = &slots[position & (CAPACITY - 1)];
+					const uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+					const auto difference = static_cast<int64_t>(sequence - position);
+
+					if (difference == 0)
+					{
+						if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+						{
+							break;
+						}
+					}
+					else if (difference < 0)
+					{
+						return false;
+					}
+					else
+					{
+						position = enqueuePosition.load(std::memory_order_relaxed);
+					}
+				}
+
+				slot->logType = logType;
+				slot->timestamp = std::chrono::system_clock::now();
+				slot->titleLength = static_cast<uint32_t>(std::min(title.size(), MAX_TITLE_LENGTH));
+				slot->messageLength = static_cast<uint32_t>(std::min(message.size(), TEXT_CAPACITY - slot->titleLength));
+				slot->truncated = slot->messageLength < message.size();
+				std::memcpy(slot->text, title.data(), slot->titleLength);
+				std::memcpy(slot->text + slot->titleLength, message.data(), slot->messageLength);
+
+				slot->sequence.store(position + 1, std::memory_order_release);
+				return true;
+			}
+
+			void countDropped() { droppedMessages.fetch_add(1, std::memory_order_relaxed); }
+
+			void flush() const
+			{
+				const uint64_t target = enqueuePosition.load(std::memory_order_acquire);
+				while (writtenPosition.load(std::memory_order_acquire) < target)
+				{
+					std::this_thread::sleep_for(std::chrono::microseconds(100));
+				}
+			}
+		private:
+			static constexpr uint64_t CAPACITY = 1024;
+			static constexpr size_t TEXT_CAPACITY = 1000;
+			static constexpr size_t MAX_TITLE_LENGTH = 64;
+			static constexpr auto IDLE_INTERVAL = std::chrono::milliseconds(2);
+
+			struct Slot
+			{
+				std::atomic<uint64_t> sequence = 0;
+				LogType logType = LogType::INFO;
+				std::chrono::system_clock::time_point timestamp;
+				uint32_t titleLength = 0;
+				uint32_t messageLength = 0;
+				bool truncated = false;
+				char text[TEXT_CAPACITY];
+			};
+
+			void writeLoop()
+			{
+				std::string batch;
+				batch.reserve(64 * 1024);
+
+				for (;;)
+				{
+					// Read the flag first so messages pushed before shutdown are still drained below.
+					const bool stopping = !running.load(std::memory_order_acquire);
+
+					writeBatch(batch);
+
+					if (stopping)
+					{
+						break;
+					}
+
+					if (batch.empty())
+					{
+						std::this_thread::sleep_for(IDLE_INTERVAL);
+					}
+				}
+			}
+
+			void writeBatch(std::string& batch)
+			{
+				batch.clear();
+
+				uint64_t position = writtenPosition.load(std::memory_order_relaxed);
+				for (;;)
+				{
+					Slot& slot = slots[position & (CAPACITY - 1)];
+					if (slot.sequence.load(std::memory_order_acquire) != position + 1)
+					{
+						break;
+					}
+
+					format(slot, batch);
+					slot.sequence.store(position + CAPACITY, std::memory_order_release);
+					++position;
+				}
+
+				if (const uint64_t dropped = droppedMessages.exchange(0, std::memory_order_relaxed); dropped > 0)
+				{
+					batch += "[WARNING] TesseraLog: dropped " + std::to_string(dropped) + " messages, the queue was full.\n";
+				}
+
+				if (!batch.empty())
+				{
+					std::cout.write(batch.data(), static_cast<std::streamsize>(batch.size()));
+					std::cout.flush();
+				}
+
+				writtenPosition.store(position, std::memory_order_release);
+			}
+
+			static void format(const Slot& slot, std::string& out)
+			{
+				const std::time_t seconds = std::chrono::system_clock::to_time_t(slot.timestamp);
+				const auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(slot.timestamp.time_since_epoch()).count() % 1000;
+
+				std::tm localTime{};
+#ifdef _WIN32
+				localtime_s(&localTime, &seconds);
+#else
+				localtime_r(&seconds, &localTime);
+#endif
+
+				char timestamp[32];
+				const size_t length = std::strftime(timestamp, sizeof(timestamp), "%H:%M:%S", &localTime);
+				std::snprintf(timestamp + length, sizeof(timestamp) - length, ".%03d", static_cast<int>(milliseconds));
+
+				out += '[';
+				out += timestamp;
+				out += "] [";
+				out += TesseraLog::toString(slot.logType);
+				out += "] ";
+				out.append(slot.text, slot.titleLength);
+				out += ": ";
+				out.append(slot.text + slot.titleLength, slot.messageLength);
+				if (slot.truncated)
+				{
+					out += "...";
+				}
+				out += '\n';
+			}
+
+			std::unique_ptr<Slot[]> slots;
+
+			alignas(64) std::atomic<uint64_t> enqueuePosition = 0;
+			alignas(64) std::atomic<uint64_t> writtenPosition = 0;
+			std::atomic<uint64_t> droppedMessages = 0;
+			std::atomic<bool> running = true;
+
+			// Declared last so the queue exists before the thread starts.
+			std::thread writer;
+		};
+
+		AsyncLogBackend& getBackend()
+		{
+			static AsyncLogBackend backend;
+			return backend;
+		}
+
+	}
+
+	void TesseraLog::send(const LogType logType, const std::string_view title, const std::string_view message)
 	{
 		if (!isLogTypeEnabled(logType))
 		{
 			return;
 		}
 
-	    std::cout << "[" << toString(logType) << "] " + title + ": " << message << std::endl;
+		AsyncLogBackend& backend = getBackend();
+		const bool mustNotDrop = logType == LogType::ERROR || logType == LogType::FATAL;
+
+		while (!backend.tryPush(logType, title, message))
+		{
+			if (!mustNotDrop)
+			{
+				backend.countDropped();
+				return;
+			}
+			std::this_thread::yield();
+		}
+
+		// The process is likely about to exit, make sure the reason is visible.
+		if (logType == LogType::FATAL)
+		{
+			backend.flush();
+		}
+	}
+
+	void TesseraLog::flush()
+	{
+		getBackend().flush();
 	}
 
 	std::string_view TesseraLog::toString(const LogType logType)
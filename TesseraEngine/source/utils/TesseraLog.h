@@ -1,7 +1,6 @@
 #pragma once
 #include <string>
-
-// TODO: Add timestamp to log message.
+#include <string_view>
 
 namespace tessera
 {
@@ -24,10 +23,32 @@ namespace tessera
 		return static_cast<LogType>(static_cast<int>(a) | static_cast<int>(b));
 	}
 
+// Log types compiled into the binary; TESSERA_LOG calls of other types vanish together with their arguments.
+#ifndef TESSERA_LOG_COMPILED_TYPES
+#ifdef NDEBUG
+#define TESSERA_LOG_COMPILED_TYPES ::tessera::LogType::DEFAULT
+#else
+#define TESSERA_LOG_COMPILED_TYPES ::tessera::LogType::ALL
+#endif
+#endif
+
+	/**
+	 * @brief Asynchronous logger.
+	 *
+	 * send() copies the message with its timestamp into a preallocated lock-free queue and returns;
+	 * a background thread formats and writes the queued messages in batches. When the queue is full
+	 * messages are dropped and counted, except errors, which wait for room instead of being lost.
+	 */
 	class TesseraLog final
 	{
 	public:
-		static void send(LogType logType, const std::string& title, const std::string& message);
+		static void send(LogType logType, std::string_view title, std::string_view message);
+
+		// Block until every message sent so far has been written.
+		static void flush();
+
+		static constexpr bool isCompiledIn(const LogType logType) { return static_cast<int>(logType) & static_cast<int>(TESSERA_LOG_COMPILED_TYPES); }
+		static std::string_view toString(LogType logType);
 	private:
 
 #ifdef NDEBUG
@@ -36,9 +57,17 @@ namespace tessera
 		inline static int logTypeMask = static_cast<int>(LogType::ALL);
 #endif
 
-		static bool isLogTypeEnabled(const LogType logType) { return static_cast<int>(logType) & logTypeMask; }
-		static std::string_view toString(LogType logType);
+		static bool isLogTypeEnabled(const LogType logType) { return isCompiledIn(logType) && (static_cast<int>(logType) & logTypeMask); }
 	};
 
 }
 
+// Prefer over TesseraLog::send on paths where building the message costs something and the type may be compiled out.
+#define TESSERA_LOG(logType, title, message)                          \
+	do                                                                \
+	{                                                                 \
+		if constexpr (::tessera::TesseraLog::isCompiledIn(logType))   \
+		{                                                             \
+			::tessera::TesseraLog::send(logType, title, message);     \
+		}                                                             \
+	} while (false)
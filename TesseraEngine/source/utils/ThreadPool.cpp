@@ -0,0 +1,142 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+namespace tessera
+{
+
+	thread_local size_t ThreadPool::workerIndex = SIZE_MAX;
+
+	void ThreadPool::init()
+	{
+		// One core is left to the main thread.
+		const unsigned int workerCount = std::max(2u, std::thread::hardware_concurrency()) - 1;
+
+		stopping = false;
+		queues.reserve(workerCount);
+		for (unsigned int i = 0; i < workerCount; ++i)
+		{
+			queues.push_back(std::make_unique<WorkerQueue>());
+		}
+
+		workers.reserve(workerCount);
+		for (unsigned int i = 0; i < workerCount; ++i)
+		{
+			workers.emplace_back(&ThreadPool::workerLoop, this, i);
+		}
+	}
+
+	void ThreadPool::clean()
+	{
+		{
+			std::lock_guard lock(sleepMutex);
+			stopping = true;
+		}
+		sleepCondition.notify_all();
+
+		for (auto& worker : workers)
+		{
+			worker.join();
+		}
+		workers.clear();
+		queues.clear();
+
+		// Nothing is rendered anymore, so owners waiting on their callbacks are about to be destroyed as well.
+		completions.clear();
+	}
+
+	void ThreadPool::push(std::function<void()> task)
+	{
+		const size_t queueIndex = workerIndex != SIZE_MAX ? workerIndex : nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+
+		// Counted before the task is visible so taking it never underflows, and under the sleep mutex so a worker
+		// about to sleep cannot miss the notification.
+		{
+			std::lock_guard lock(sleepMutex);
+			pendingTasks.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		{
+			std::lock_guard lock(queues[queueIndex]->mutex);
+			queues[queueIndex]->tasks.push_back(std::move(task));
+		}
+		sleepCondition.notify_one();
+	}
+
+	bool ThreadPool::runPendingTask()
+	{
+		std::function<void()> task;
+
+		// Own deque newest first: its data is likely still in cache.
+		if (workerIndex != SIZE_MAX)
+		{
+			WorkerQueue& own = *queues[workerIndex];
+			std::lock_guard lock(own.mutex);
+			if (!own.tasks.empty())
+			{
+				task = std::move(own.tasks.back());
+				own.tasks.pop_back();
+			}
+		}
+
+		// Steal the oldest task of another deque, starting after our own so thieves spread out.
+		const size_t start = workerIndex != SIZE_MAX ? workerIndex + 1 : 0;
+		for (size_t i = 0; !task && i < queues.size(); ++i)
+		{
+			WorkerQueue& victim = *queues[(start + i) % queues.size()];
+			std::lock_guard lock(victim.mutex);
+			if (!victim.tasks.empty())
+			{
+				task = std::move(victim.tasks.front());
+				victim.tasks.pop_front();
+			}
+		}
+
+		if (!task)
+		{
+			return false;
+		}
+
+		pendingTasks.fetch_sub(1, std::memory_order_relaxed);
+		task();
+		return true;
+	}
+
+	void ThreadPool::workerLoop(const size_t index)
+	{
+		workerIndex = index;
+
+		while (true)
+		{
+			if (runPendingTask())
+			{
+				continue;
+			}
+
+			std::unique_lock lock(sleepMutex);
+			sleepCondition.wait(lock, [this] { return stopping || pendingTasks.load(std::memory_order_relaxed) > 0; });
+
+			// Queued tasks are drained before shutting down so no future is left without a value.
+			if (stopping && pendingTasks.load(std::memory_order_relaxed) == 0)
+			{
+				return;
+			}
+		}
+	}
+
+	void ThreadPool::dispatchCompletions()
+	{
+		std::vector<std::function<void()>> ready;
+		{
+			std::lock_guard lock(completionsMutex);
+			ready.swap(completions);
+		}
+
+		// Callbacks may submit more work, which is why they run outside the lock.
+		for (const auto& completion : ready)
+		{
+			completion();
+		}
+	}
+
+}
@@ -0,0 +1,128 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "utils/interfaces/Initializable.h"
+
+namespace tessera
+{
+
+	/**
+	 * @brief Work-stealing job system with one worker per core besides the main thread.
+	 *
+	 * Every worker owns a deque: tasks submitted by a worker go to its own deque and are taken back
+	 * newest first, while idle workers steal the oldest tasks of the others. Tasks submitted from
+	 * other threads are spread over the deques round-robin.
+	 *
+	 * Used for work that must not stall the main loop: asset decoding, shader reads, pipeline compilation,
+	 * mesh optimization and command buffer recording. Tasks given a completion callback hand their result
+	 * back to the render thread, which runs the callbacks at frame boundaries through dispatchCompletions().
+	 */
+	class ThreadPool final : public Initializable
+	{
+	public:
+		void init() override;
+		void clean() override;
+
+		template <class F>
+		auto submit(F&& task) -> std::future<std::invoke_result_t<F>>;
+
+		/**
+		 * @brief Run task on a worker and onComplete with its ready future on the next dispatchCompletions().
+		 *
+		 * Calling get() on that future returns the result or rethrows what the task threw.
+		 */
+		template <class F, class C>
+		void submit(F&& task, C&& onComplete);
+
+		// Run the callbacks of completed tasks. Called by the render thread once per frame.
+		void dispatchCompletions();
+
+		// Block until future is ready, running queued tasks meanwhile so a waiting worker never deadlocks the pool.
+		template <class Future>
+		void waitFor(const Future& future);
+
+		[[nodiscard]] size_t getWorkerCount() const { return workers.size(); }
+	private:
+		struct WorkerQueue
+		{
+			std::mutex mutex;
+			std::deque<std::function<void()>> tasks;
+		};
+
+		void push(std::function<void()> task);
+		// Pop from the calling worker's deque, or steal from another one. False when every deque is empty.
+		bool runPendingTask();
+		void workerLoop(size_t index);
+
+		std::vector<std::thread> workers;
+		std::vector<std::unique_ptr<WorkerQueue>> queues;
+		std::atomic<size_t> nextQueue = 0;
+
+		// Tasks queued but not taken yet; workers sleep while it is 0.
+		std::atomic<size_t> pendingTasks = 0;
+		std::mutex sleepMutex;
+		std::condition_variable sleepCondition;
+		bool stopping = false;
+
+		std::mutex completionsMutex;
+		std::vector<std::function<void()>> completions;
+
+		// Index of the calling thread's deque; SIZE_MAX outside the pool.
+		static thread_local size_t workerIndex;
+	};
+
+	template <class F>
+	auto ThreadPool::submit(F&& task) -> std::future<std::invoke_result_t<F>>
+	{
+		using Result = std::invoke_result_t<F>;
+
+		// std::function requires copyable callables, so the move-only packaged_task is shared.
+		auto packagedTask = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+		std::future<Result> result = packagedTask->get_future();
+
+		push([packagedTask] { (*packagedTask)(); });
+		return result;
+	}
+
+	template <class F, class C>
+	void ThreadPool::submit(F&& task, C&& onComplete)
+	{
+		using Result = std::invoke_result_t<F>;
+
+		auto packagedTask = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+		auto result = std::make_shared<std::future<Result>>(packagedTask->get_future());
+
+		push([this, packagedTask, result, onComplete = std::forward<C>(onComplete)]
+			{
+				(*packagedTask)();
+
+				std::lock_guard lock(completionsMutex);
+				completions.emplace_back([result, onComplete] { onComplete(std::move(*result)); });
+			});
+	}
+
+	template <class Future>
+	void ThreadPool::waitFor(const Future& future)
+	{
+		while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		{
+			if (!runPendingTask())
+			{
+				// Whatever is left runs on other threads; nothing to help with.
+				future.wait();
+				return;
+			}
+		}
+	}
+
+}
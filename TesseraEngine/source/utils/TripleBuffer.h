@@ -0,0 +1,55 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace tessera
+{
+
+	/**
+	 * @brief Hands the newest value from one writer thread to one reader thread without either ever waiting.
+	 *
+	 * The writer fills getWriteSlot() and publishes it; the reader acquires the newest published slot and
+	 * keeps reading it until it acquires again. The third slot sits between them, so the writer never
+	 * touches what the reader holds. Values published while the reader is busy are skipped, only the
+	 * newest one is handed over. Slots are reused, so containers inside T keep their capacity.
+	 */
+	template <typename T>
+	class TripleBuffer
+	{
+	public:
+		// Writer thread only.
+		[[nodiscard]] T& getWriteSlot() { return slots[writeIndex]; }
+
+		// Writer thread only. Makes the write slot the newest value and takes the previous middle slot to write next.
+		void publish()
+		{
+			writeIndex = middle.exchange(static_cast<uint8_t>(writeIndex | FRESH_BIT), std::memory_order_acq_rel) & INDEX_MASK;
+		}
+
+		// Reader thread only. Returns false and keeps the current read slot when nothing was published since the last call.
+		bool acquire()
+		{
+			if ((middle.load(std::memory_order_relaxed) & FRESH_BIT) == 0)
+			{
+				return false;
+			}
+
+			readIndex = middle.exchange(readIndex, std::memory_order_acq_rel) & INDEX_MASK;
+			return true;
+		}
+
+		// Reader thread only.
+		[[nodiscard]] const T& getReadSlot() const { return slots[readIndex]; }
+	private:
+		static constexpr uint8_t INDEX_MASK = 0x3;
+		static constexpr uint8_t FRESH_BIT = 0x4;
+
+		std::array<T, 3> slots{};
+		uint8_t writeIndex = 0;
+		// Index of the slot between writer and reader, with FRESH_BIT while the reader has not taken it.
+		std::atomic<uint8_t> middle{ 1 };
+		uint8_t readIndex = 2;
+	};
+
+}
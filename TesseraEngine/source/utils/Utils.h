@@ -1,11 +1,19 @@
 #pragma once
 #include <chrono>
+#include <functional>
 #include <random>
 #include <string>
 
 namespace tessera
 {
 
+	// Boost style hash mixing, for building hashes of aggregates field by field.
+	template <class T>
+	void hashCombine(size_t& seed, const T& value)
+	{
+		seed ^= std::hash<T>{}(value) + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+	}
+
 	inline std::string generateHash()
 	{
 	    // Get current time in nanoseconds
@@ -26,6 +26,15 @@ namespace tessera
 		 */
 		virtual void init() {}
 
+		/**
+		 * @brief Cache pointers to other services once all of them are registered.
+		 *
+		 * Called by Application after every service has been initialized, so services
+		 * registered later in the initializer list can be resolved as well. Frame loop code
+		 * should use the cached pointers instead of looking services up on every call.
+		 */
+		virtual void resolveServices() {}
+
 		/**
 		 * @brief Clean up resources used by the Vulkan service.
 		 *
@@ -1,4 +1,5 @@
 #include "ServiceLocator.h"
 
 // Static initialization of services map
-std::unordered_map<const std::type_info*, std::shared_ptr<tessera::Service>> tessera::ServiceLocator::services;
\ No newline at end of file
+std::unordered_map<const std::type_info*, std::shared_ptr<tessera::Service>> tessera::ServiceLocator::services;
+std::shared_mutex tessera::ServiceLocator::servicesMutex;
\ No newline at end of file
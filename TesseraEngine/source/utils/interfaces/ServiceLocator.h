@@ -1,5 +1,7 @@
 #pragma once
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <stdexcept>
 #include <unordered_map>
 
@@ -9,6 +11,8 @@ namespace tessera
 {
 	/**
 	 * @brief Service Locator class for managing dependencies.
+	 *
+	 * Services are registered by the threads initializing them, so lookups take a shared lock.
 	 */
 	class ServiceLocator
 	{
@@ -22,6 +26,7 @@ namespace tessera
 		template<typename T>
 		static void registerService(const T* servicePointer, const std::shared_ptr<Service>& service)
 		{
+			std::unique_lock lock(servicesMutex);
 			services[&typeid(*servicePointer)] = service;
 		}
 
@@ -34,6 +39,7 @@ namespace tessera
 		template<typename T>
 		static std::shared_ptr<T> getService()
 		{
+			std::shared_lock lock(servicesMutex);
 			const auto it = services.find(&typeid(T));
 
 			if (it == services.end())
@@ -44,8 +50,32 @@ namespace tessera
 			return std::static_pointer_cast<T>(it->second);
 		}
 
+		/**
+		 * @brief Method to get a non-owning pointer to a service.
+		 *
+		 * Services live until Application::clean(), so the pointer stays valid for the whole run.
+		 * Meant to be resolved once and cached; it skips the reference count of getService().
+		 *
+		 * @tparam T The type of service to retrieve.
+		 * @return T* The pointer to the service instance.
+		 */
+		template<typename T>
+		static T* getServicePointer()
+		{
+			std::shared_lock lock(servicesMutex);
+			const auto it = services.find(&typeid(T));
+
+			if (it == services.end())
+			{
+				throw std::runtime_error(std::string("ServiceLocator: failed to get instance of service ") + typeid(T).name());
+			}
+
+			return static_cast<T*>(it->second.get());
+		}
+
 	private:
 		static std::unordered_map<const std::type_info*, std::shared_ptr<Service>> services; /**< Static member variable to store services. */
+		static std::shared_mutex servicesMutex;
 	};
 
 }
@@ -1,10 +1,22 @@
 #include "BufferManager.h"
 
-#include "CommandBufferManager.h"
-#include "QueueManager.h"
-#include "entities/Vertex.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <future>
+#include <optional>
+#include <stdexcept>
+#include <glm/gtc/packing.hpp>
+
+#include "DeletionQueue.h"
+#include "UploadManager.h"
+#include "utils/MappedFile.h"
+#include "utils/MeshCache.h"
+#include "utils/MeshLoader.h"
+#include "utils/TesseraLog.h"
+#include "utils/ThreadPool.h"
 #include "utils/interfaces/ServiceLocator.h"
-#include "vulkan/DeviceManager.h"
 
 namespace tessera::vulkan
 {
@@ -12,150 +24,267 @@ namespace tessera::vulkan
 	void BufferManager::init()
 	{
 		Initializable::init();
-		const auto& device = ServiceLocator::getService<DeviceManager>()->getLogicalDevice();
+		auto* memoryAllocator = ServiceLocator::getServicePointer<MemoryAllocator>();
+		auto* uploadManager = ServiceLocator::getServicePointer<UploadManager>();
+		deletionQueue = ServiceLocator::getServicePointer<DeletionQueue>();
+
+		// The cache is mapped and copied straight into staging memory, skipping parsing and quantization.
+		std::optional<MappedFile> cacheFile;
+		std::optional<MeshView> meshView;
+		if (isMeshCacheFresh())
+		{
+			cacheFile.emplace(MESH_CACHE_PATH);
+			meshView = MeshCache::read(*cacheFile, VERTEX_LAYOUT);
+			if (!meshView)
+			{
+				TesseraLog::send(LogType::WARNING, "BufferManager", std::string("Ignoring invalid mesh cache ") + MESH_CACHE_PATH + ".");
+			}
+		}
+
+		Mesh loadedMesh;
+		if (!meshView)
+		{
+			loadedMesh = loadMesh();
+			meshView = loadedMesh.getView();
+		}
 
-		createVertexBuffer(device);
-		createIndexBuffer(device);
+		// Sized so the startup mesh never makes them grow right away.
+		const bool wideIndices = meshView->indexType == VK_INDEX_TYPE_UINT32;
+		vertexBuffer.create(*memoryAllocator, *uploadManager, *deletionQueue, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, Vertex::getStride(VERTEX_LAYOUT),
+			std::max(VERTEX_CAPACITY, meshView->vertexCount));
+		indexBuffer16.create(*memoryAllocator, *uploadManager, *deletionQueue, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, sizeof(uint16_t),
+			wideIndices ? INDEX_CAPACITY : std::max(INDEX_CAPACITY, meshView->indexCount));
+		indexBuffer32.create(*memoryAllocator, *uploadManager, *deletionQueue, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, sizeof(uint32_t),
+			wideIndices ? meshView->indexCount : 0);
+
+		defaultMesh = addMesh(*meshView);
+
+		// Both copies go out in a single transfer submission; the first frame waits on it.
+		uploadManager->flush();
 	}
 
-	void BufferManager::createVertexBuffer(const VkDevice& device)
+	void BufferManager::loadMeshAsync(const std::string& filename, std::function<void(MeshHandle)> onLoaded)
 	{
-		const VkDeviceSize bufferSize = sizeof(vertices[0]) * vertices.size();
-
-		VkBuffer stagingBuffer;
-		VkDeviceMemory stagingBufferMemory;
-		createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
-
-		// Fill vertex buffer data.
-		void* data;
-		vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
-		memcpy(data, vertices.data(), bufferSize);
-		vkUnmapMemory(device, stagingBufferMemory);
-
-		createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, vertexBuffer, vertexBufferMemory);
-		copyBuffer(stagingBuffer, vertexBuffer, bufferSize);
-		vkDestroyBuffer(device, stagingBuffer, nullptr);
-		vkFreeMemory(device, stagingBufferMemory, nullptr);
+		// Parsing and optimization are the slow part and run on a worker; the upload is recorded on the render thread.
+		ServiceLocator::getService<ThreadPool>()->submit([filename] { return MeshLoader::loadObj(filename, VERTEX_LAYOUT); },
+			[this, filename, onLoaded = std::move(onLoaded)](std::future<Mesh> mesh)
+			{
+				try
+				{
+					onLoaded(addMesh(mesh.get().getView()));
+				}
+				// Completions run inside the frame loop, so a bad file of any kind must only cost its own mesh.
+				catch (const std::exception& error)
+				{
+					TesseraLog::send(LogType::ERROR, "BufferManager", filename + ": " + error.what());
+				}
+			});
 	}
 
-	void BufferManager::createBuffer(const VkDeviceSize size, const VkBufferUsageFlags usage, const VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory) const
+	MeshHandle BufferManager::addMesh(const MeshView& mesh)
 	{
-		const auto& device = ServiceLocator::getService<DeviceManager>()->getLogicalDevice();
+		if (mesh.layout != VERTEX_LAYOUT)
+		{
+			throw std::runtime_error("BufferManager: mesh does not use the vertex layout of the engine.");
+		}
 
-		// Create buffer structure.
-		VkBufferCreateInfo bufferInfo{};
-		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-		bufferInfo.size = size;
-		bufferInfo.usage = usage;
-		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		MeshEntry entry;
+		entry.indexType = mesh.indexType;
+		entry.indexCount = mesh.indexCount;
+		entry.boundingSphere = computeBoundingSphere(mesh);
 
-		if (vkCreateBuffer(device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS) 
+		GeometryBuffer& indexPool = getIndexPool(mesh.indexType);
+		entry.vertices = vertexBuffer.allocate(mesh.vertexCount);
+		try
 		{
-			throw std::runtime_error("VertexBufferManager: failed to create buffer.");
+			entry.indices = indexPool.allocate(mesh.indexCount);
 		}
+		catch (...)
+		{
+			// Nothing was uploaded to the range yet, so it can be reused right away.
+			vertexBuffer.free(entry.vertices);
+			throw;
+		}
+		vertexBuffer.upload(entry.vertices, mesh.vertexData);
+		indexPool.upload(entry.indices, mesh.indexData);
 
-		// Calculate memory requirements.
-		VkMemoryRequirements memRequirements;
-		vkGetBufferMemoryRequirements(device, buffer, &memRequirements);
-
-		// Allocate vertex buffer memory.
-		VkMemoryAllocateInfo allocInfo{};
-		allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-		allocInfo.allocationSize = memRequirements.size;
-		allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
+		const MeshHandle handle = nextMesh++;
+		meshes.emplace(handle, entry);
+		return handle;
+	}
 
-		if (vkAllocateMemory(device, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS) 
+	void BufferManager::removeMesh(const MeshHandle handle)
+	{
+		const auto it = meshes.find(handle);
+		if (it == meshes.end())
 		{
-			throw std::runtime_error("VertexBufferManager: failed to allocate buffer memory.");
+			return;
 		}
 
-		vkBindBufferMemory(device, buffer, bufferMemory, 0);
+		// Upload batches do not wait on the graphics queue, so the ranges are only handed back once no frame
+		// in flight can draw from them; until then a later addMesh() could overwrite them.
+		deletionQueue->push([this, vertices = it->second.vertices, indices = it->second.indices, indexType = it->second.indexType]
+			{
+				GeometryBuffer& indexPool = getIndexPool(indexType);
+				vertexBuffer.free(vertices);
+				indexPool.free(indices);
+
+				if (vertexBuffer.getFragmentation() > MAX_FRAGMENTATION)
+				{
+					vertexBuffer.defragment();
+				}
+				if (indexPool.getFragmentation() > MAX_FRAGMENTATION)
+				{
+					indexPool.defragment();
+				}
+			});
+		meshes.erase(it);
 	}
 
-	void BufferManager::copyBuffer(const VkBuffer srcBuffer, const VkBuffer dstBuffer, const VkDeviceSize size) const
+	void BufferManager::defragment()
 	{
-		const auto& commandPool = ServiceLocator::getService<CommandBufferManager>()->getCommandPool();
-		const auto& device = ServiceLocator::getService<DeviceManager>()->getLogicalDevice();
-		const auto& graphicsQueue = ServiceLocator::getService<QueueManager>()->getGraphicsQueue();
-
-		VkCommandBufferAllocateInfo allocInfo{};
-		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-		allocInfo.commandPool = commandPool;
-		allocInfo.commandBufferCount = 1;
-
-		VkCommandBuffer commandBuffer;
-		vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer);
-
-		VkCommandBufferBeginInfo beginInfo{};
-		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-		vkBeginCommandBuffer(commandBuffer, &beginInfo);
-			VkBufferCopy copyRegion;
-			copyRegion.srcOffset = 0; // Optional
-			copyRegion.dstOffset = 0; // Optional
-			copyRegion.size = size;
-			vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
-		vkEndCommandBuffer(commandBuffer);
-
-		VkSubmitInfo submitInfo{};
-		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-		submitInfo.commandBufferCount = 1;
-		submitInfo.pCommandBuffers = &commandBuffer;
-
-		vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-		vkQueueWaitIdle(graphicsQueue);
-		vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+		vertexBuffer.defragment();
+		indexBuffer16.defragment();
+		indexBuffer32.defragment();
 	}
 
-	void BufferManager::createIndexBuffer(const VkDevice& device)
+	MeshRange BufferManager::getMesh(const MeshHandle handle) const
 	{
-		const VkDeviceSize bufferSize = sizeof(indices[0]) * indices.size();
-
-		VkBuffer stagingBuffer;
-		VkDeviceMemory stagingBufferMemory;
-		createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+		const MeshEntry& entry = meshes.at(handle);
+
+		MeshRange range;
+		range.vertexOffset = static_cast<int32_t>(vertexBuffer.getOffset(entry.vertices));
+		range.firstIndex = getIndexPool(entry.indexType).getOffset(entry.indices);
+		range.indexCount = entry.indexCount;
+		range.indexType = entry.indexType;
+		range.boundingSphere = entry.boundingSphere;
+		return range;
+	}
 
-		void* data;
-		vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
-		memcpy(data, indices.data(), (size_t)bufferSize);
-		vkUnmapMemory(device, stagingBufferMemory);
+	DrawCommand BufferManager::makeDraw(const MeshHandle handle) const
+	{
+		const MeshRange range = getMesh(handle);
+
+		DrawCommand draw;
+		draw.vertexBuffer = getVertexBuffer();
+		draw.indexBuffer = getIndexBuffer(range.indexType);
+		draw.indexType = range.indexType;
+		draw.indexCount = range.indexCount;
+		draw.firstIndex = range.firstIndex;
+		draw.vertexOffset = range.vertexOffset;
+		return draw;
+	}
 
-		createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, indexBuffer, indexBufferMemory);
+	uint64_t BufferManager::getGeometryVersion() const
+	{
+		return vertexBuffer.getRelocations() + indexBuffer16.getRelocations() + indexBuffer32.getRelocations();
+	}
 
-		copyBuffer(stagingBuffer, indexBuffer, bufferSize);
+	GeometryBuffer& BufferManager::getIndexPool(const VkIndexType indexType)
+	{
+		return indexType == VK_INDEX_TYPE_UINT32 ? indexBuffer32 : indexBuffer16;
+	}
 
-		vkDestroyBuffer(device, stagingBuffer, nullptr);
-		vkFreeMemory(device, stagingBufferMemory, nullptr);
+	const GeometryBuffer& BufferManager::getIndexPool(const VkIndexType indexType) const
+	{
+		return indexType == VK_INDEX_TYPE_UINT32 ? indexBuffer32 : indexBuffer16;
 	}
 
-	uint32_t BufferManager::findMemoryType(const uint32_t typeFilter, const VkMemoryPropertyFlags properties) const
+	bool BufferManager::isMeshCacheFresh()
 	{
-		const auto& physicalDevice = ServiceLocator::getService<DeviceManager>()->getPhysicalDevice();
+		std::error_code error;
+		if (!std::filesystem::exists(MESH_CACHE_PATH, error))
+		{
+			return false;
+		}
 
-		VkPhysicalDeviceMemoryProperties memProperties;
-		vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
+		// Without a source file the cache is all there is.
+		if (!std::filesystem::exists(MESH_PATH, error))
+		{
+			return true;
+		}
 
-		for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) 
+		return std::filesystem::last_write_time(MESH_CACHE_PATH, error) >= std::filesystem::last_write_time(MESH_PATH, error);
+	}
+
+	glm::vec4 BufferManager::computeBoundingSphere(const MeshView& mesh)
+	{
+		if (mesh.vertexCount == 0)
 		{
-			if (typeFilter & 1 << i && (memProperties.memoryTypes[i].propertyFlags & properties) == properties)
+			return glm::vec4(0.0f);
+		}
+
+		// Positions are read back from the packed data, so cached and freshly loaded meshes get the same bounds.
+		const uint32_t stride = Vertex::getStride(mesh.layout);
+		const auto* vertexData = static_cast<const uint8_t*>(mesh.vertexData);
+		const auto readPosition = [&](const uint32_t vertex)
 			{
-				return i;
-			}
+				const uint8_t* packed = vertexData + static_cast<size_t>(vertex) * stride;
+				glm::vec3 position;
+				if (mesh.layout == VertexLayout::COMPACT)
+				{
+					CompactVertex compactVertex;
+					std::memcpy(&compactVertex, packed, sizeof(compactVertex));
+					position = { glm::unpackHalf1x16(compactVertex.position[0]), glm::unpackHalf1x16(compactVertex.position[1]),
+						glm::unpackHalf1x16(compactVertex.position[2]) };
+				}
+				else
+				{
+					std::memcpy(&position, packed, sizeof(position));
+				}
+				return position;
+			};
+
+		// Centered on the bounding box; not minimal, but only used for culling.
+		glm::vec3 minimum = readPosition(0);
+		glm::vec3 maximum = minimum;
+		for (uint32_t i = 1; i < mesh.vertexCount; ++i)
+		{
+			const glm::vec3 position = readPosition(i);
+			minimum = glm::min(minimum, position);
+			maximum = glm::max(maximum, position);
+		}
+
+		const glm::vec3 center = (minimum + maximum) * 0.5f;
+		float radiusSquared = 0.0f;
+		for (uint32_t i = 0; i < mesh.vertexCount; ++i)
+		{
+			const glm::vec3 offset = readPosition(i) - center;
+			radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
 		}
 
-		throw std::runtime_error("VertexBufferManager: failed to find suitable memory type.");
+		return { center, std::sqrt(radiusSquared) };
 	}
 
-	void BufferManager::clean()
+	Mesh BufferManager::loadMesh()
 	{
-		const auto& device = ServiceLocator::getService<DeviceManager>()->getLogicalDevice();
+		if (!std::filesystem::exists(MESH_PATH))
+		{
+			TesseraLog::send(LogType::INFO, "BufferManager", std::string("No mesh found at ") + MESH_PATH + ", using the built-in quad.");
+			return MeshLoader::build(vertices, indices, VERTEX_LAYOUT);
+		}
 
-		vkDestroyBuffer(device, indexBuffer, nullptr);
-		vkFreeMemory(device, indexBufferMemory, nullptr);
+		Mesh mesh = MeshLoader::loadObj(MESH_PATH, VERTEX_LAYOUT);
+		TESSERA_LOG(LogType::DEBUG, "BufferManager", "Loaded " + std::to_string(mesh.vertexCount) + " vertices and " + std::to_string(mesh.indexCount) + " indices from " + MESH_PATH + ".");
 
-		vkDestroyBuffer(device, vertexBuffer, nullptr);
-		vkFreeMemory(device, vertexBufferMemory, nullptr);
+		// A stale or missing cache only costs a slower startup, so failing to write it is not fatal.
+		try
+		{
+			MeshCache::write(MESH_CACHE_PATH, mesh);
+		}
+		catch (const std::runtime_error& error)
+		{
+			TesseraLog::send(LogType::WARNING, "BufferManager", error.what());
+		}
+
+		return mesh;
+	}
+
+	void BufferManager::clean()
+	{
+		meshes.clear();
+		indexBuffer32.destroy();
+		indexBuffer16.destroy();
+		vertexBuffer.destroy();
 	}
 }
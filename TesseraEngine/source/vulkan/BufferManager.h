@@ -1,31 +1,103 @@
 #pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <glm/glm.hpp>
+
+#include "DrawList.h"
+#include "GeometryBuffer.h"
+#include "entities/Mesh.h"
 #include "utils/interfaces/Initializable.h"
 #include <vulkan/vulkan_core.h>
 
 namespace tessera::vulkan
 {
 
+	class DeletionQueue;
+
+	using MeshHandle = uint32_t;
+
+	// Where a mesh lives in the shared geometry buffers, in the units of the draw parameters.
+	struct MeshRange
+	{
+		int32_t vertexOffset = 0;
+		uint32_t firstIndex = 0;
+		uint32_t indexCount = 0;
+		VkIndexType indexType = VK_INDEX_TYPE_UINT16;
+		// Sphere enclosing the mesh in model space: center in xyz, radius in w.
+		glm::vec4 boundingSphere{ 0.0f };
+	};
+
+	/**
+	 * @brief Every mesh of the engine, packed into one vertex buffer and one index buffer per index type.
+	 *
+	 * Meshes are addressed by vertexOffset and firstIndex, so draws over any of them share their bindings
+	 * and a single multi-draw can cover all of them. Adding a mesh may grow the buffers, and the deferred
+	 * release of a removed one defragments them once too much of the free space is scattered; both move the other meshes, so ranges
+	 * are looked up again when getGeometryVersion() changes.
+	 */
 	class BufferManager final : public Initializable
 	{
 	public:
 		void init() override;
 		void clean() override;
 
-		[[nodiscard]] VkBuffer getVertexBuffer() const { return vertexBuffer; }
-		[[nodiscard]] VkBuffer getIndexBuffer() const { return indexBuffer; }
+		// The mesh must use getVertexLayout(). Uploaded with the next flush of the UploadManager.
+		MeshHandle addMesh(const MeshView& mesh);
+		// Load and optimize an OBJ file on the ThreadPool; onLoaded runs on the render thread at the start of a later frame.
+		void loadMeshAsync(const std::string& filename, std::function<void(MeshHandle)> onLoaded);
+		// The handle is invalid right away; the ranges are freed, and maybe defragmented, once every frame that may draw them has retired.
+		void removeMesh(MeshHandle handle);
+		void defragment();
+
+		[[nodiscard]] MeshRange getMesh(MeshHandle handle) const;
+		// Draw of the whole mesh with its buffers bound; the pipeline is left to the caller.
+		[[nodiscard]] DrawCommand makeDraw(MeshHandle handle) const;
+		// Mesh loaded at startup.
+		[[nodiscard]] MeshHandle getDefaultMesh() const { return defaultMesh; }
+		// Changes whenever meshes are moved within the buffers, or the buffers are replaced.
+		[[nodiscard]] uint64_t getGeometryVersion() const;
+
+		[[nodiscard]] VkBuffer getVertexBuffer() const { return vertexBuffer.getBuffer(); }
+		[[nodiscard]] VkBuffer getIndexBuffer(const VkIndexType indexType) const { return getIndexPool(indexType).getBuffer(); }
+		// Pipelines are built before any mesh is loaded, so the layout is fixed for the whole engine.
+		static VertexLayout getVertexLayout() { return VERTEX_LAYOUT; }
 	private:
-		void createVertexBuffer(const VkDevice& device);
-		void createIndexBuffer(const VkDevice& device);
-		void createBuffer(const VkDeviceSize size, const VkBufferUsageFlags usage, const VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory) const;
-		void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) const;
+		struct MeshEntry
+		{
+			GeometryRange vertices = 0;
+			GeometryRange indices = 0;
+			uint32_t indexCount = 0;
+			VkIndexType indexType = VK_INDEX_TYPE_UINT16;
+			glm::vec4 boundingSphere{ 0.0f };
+		};
+
+		static Mesh loadMesh();
+		[[nodiscard]] static bool isMeshCacheFresh();
+		[[nodiscard]] static glm::vec4 computeBoundingSphere(const MeshView& mesh);
+		[[nodiscard]] GeometryBuffer& getIndexPool(VkIndexType indexType);
+		[[nodiscard]] const GeometryBuffer& getIndexPool(VkIndexType indexType) const;
 
-		[[nodiscard]] uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+		GeometryBuffer vertexBuffer;
+		// 16-bit indices stay 16-bit; vertexOffset lets them address vertices anywhere in the vertex buffer.
+		GeometryBuffer indexBuffer16;
+		GeometryBuffer indexBuffer32;
 
-		VkBuffer vertexBuffer = VK_NULL_HANDLE;
-		VkDeviceMemory vertexBufferMemory = VK_NULL_HANDLE;
-		VkBuffer indexBuffer = VK_NULL_HANDLE;
-		VkDeviceMemory indexBufferMemory = VK_NULL_HANDLE;
+		DeletionQueue* deletionQueue = nullptr;
+
+		std::unordered_map<MeshHandle, MeshEntry> meshes;
+		MeshHandle nextMesh = 1;
+		MeshHandle defaultMesh = 0;
+
+		static constexpr VertexLayout VERTEX_LAYOUT = VertexLayout::COMPACT;
+		static constexpr auto MESH_PATH = "models/model.obj";
+		static constexpr auto MESH_CACHE_PATH = "models/model.tmesh";
+		// Initial capacities in elements; 32-bit indices are rare, their buffer is created by the first mesh needing it.
+		static constexpr uint32_t VERTEX_CAPACITY = 1024 * 1024;
+		static constexpr uint32_t INDEX_CAPACITY = 4 * 1024 * 1024;
+		// Removing a mesh defragments once more than this share of the free space lies outside the largest free range.
+		static constexpr float MAX_FRAGMENTATION = 0.5f;
 	};
 	
 }
-
@@ -1,14 +1,26 @@
 #include "CommandBufferManager.h"
 
+#include <algorithm>
+#include <exception>
+#include <future>
 #include <stdexcept>
 
+#include "DebugManager.h"
+#include "DescriptorManager.h"
 #include "DeviceManager.h"
-#include "FramebufferManager.h"
+#include "GpuProfiler.h"
 #include "GraphicsPipelineManager.h"
+#include "IndirectDrawManager.h"
+#include "InstancingManager.h"
 #include "QueueManager.h"
+#include "RenderGraphManager.h"
+#include "SceneManager.h"
 #include "SurfaceManager.h"
+#include "UniformManager.h"
 #include "BufferManager.h"
-#include "entities/Vertex.h"
+#include "utils/CpuProfiler.h"
+#include "utils/EngineConfig.h"
+#include "utils/ThreadPool.h"
 #include "utils/interfaces/ServiceLocator.h"
 
 namespace tessera::vulkan
@@ -16,61 +28,142 @@ namespace tessera::vulkan
 
 	void CommandBufferManager::init()
 	{
+		device = ServiceLocator::getService<DeviceManager>()->getLogicalDevice();
+		numberOfBuffers = queryFramesInFlight();
+		sortDraws = ServiceLocator::getService<EngineConfig>()->getBool("render.sortDraws", true);
+
 		initCommandPool();
 		initCommandBuffers();
 	}
 
+	void CommandBufferManager::resolveServices()
+	{
+		renderGraphManager = ServiceLocator::getServicePointer<RenderGraphManager>();
+		indirectDrawManager = ServiceLocator::getServicePointer<IndirectDrawManager>();
+		instancingManager = ServiceLocator::getServicePointer<InstancingManager>();
+		sceneManager = ServiceLocator::getServicePointer<SceneManager>();
+		graphicsPipelineManager = ServiceLocator::getServicePointer<GraphicsPipelineManager>();
+		bufferManager = ServiceLocator::getServicePointer<BufferManager>();
+		threadPool = ServiceLocator::getServicePointer<ThreadPool>();
+		gpuProfiler = ServiceLocator::getServicePointer<GpuProfiler>();
+		descriptorManager = ServiceLocator::getServicePointer<DescriptorManager>();
+		uniformManager = ServiceLocator::getServicePointer<UniformManager>();
+	}
+
+	int CommandBufferManager::queryFramesInFlight()
+	{
+		const int framesInFlight = ServiceLocator::getService<EngineConfig>()->getInt("render.framesInFlight", DEFAULT_FRAMES_IN_FLIGHT);
+		return std::clamp(framesInFlight, 1, MAX_FRAMES_IN_FLIGHT);
+	}
+
 	void CommandBufferManager::initCommandPool()
 	{
-		const auto& deviceManager = ServiceLocator::getService<DeviceManager>();
-		const auto& physicalDevice = deviceManager->getPhysicalDevice();
-		const auto& device = deviceManager->getLogicalDevice();
+		const auto& physicalDevice = ServiceLocator::getService<DeviceManager>()->getPhysicalDevice();
 		const auto& surface = ServiceLocator::getService<SurfaceManager>()->getSurface();
 
-		const auto [graphicsFamily, presentFamily] = findQueueFamilies(physicalDevice, surface);
-		VkCommandPoolCreateInfo poolInfo{};
-		poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-		poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-		poolInfo.queueFamilyIndex = graphicsFamily.value();
-		
-		if (vkCreateCommandPool(device, &poolInfo, nullptr, &commandPool) != VK_SUCCESS)
+		const auto [graphicsFamily, presentFamily, transferFamily, computeFamily, computeQueueIndex] = findQueueFamilies(physicalDevice, surface);
+
+		// One pool per frame in flight, recycled in bulk with vkResetCommandPool once the frame's fence signals.
+		commandPools.resize(numberOfBuffers);
+		for (auto& framePool : commandPools)
 		{
-			throw std::runtime_error("CommandPoolManager: failed to create command pool.");
+			VkCommandPoolCreateInfo poolInfo{};
+			poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+			poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+			poolInfo.queueFamilyIndex = graphicsFamily.value();
+
+			if (vkCreateCommandPool(device, &poolInfo, nullptr, &framePool) != VK_SUCCESS)
+			{
+				throw std::runtime_error("CommandPoolManager: failed to create command pool.");
+			}
 		}
+
+		initSecondaryPools(graphicsFamily.value());
 	}
 
-	void CommandBufferManager::initCommandBuffers()
+	void CommandBufferManager::initSecondaryPools(const uint32_t graphicsFamily)
 	{
-		const auto& device = ServiceLocator::getService<DeviceManager>()->getLogicalDevice();
+		const auto sliceCount = static_cast<uint32_t>(ServiceLocator::getService<ThreadPool>()->getWorkerCount());
+
+		secondaryPools.assign(numberOfBuffers, std::vector<SecondaryPool>(sliceCount));
 
-		commandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+		for (auto& framePools : secondaryPools)
+		{
+			for (auto& [slicePool, sliceBuffers] : framePools)
+			{
+				VkCommandPoolCreateInfo poolInfo{};
+				poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+				poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+				poolInfo.queueFamilyIndex = graphicsFamily;
+
+				if (vkCreateCommandPool(device, &poolInfo, nullptr, &slicePool) != VK_SUCCESS)
+				{
+					throw std::runtime_error("CommandPoolManager: failed to create secondary command pool.");
+				}
 
-		VkCommandBufferAllocateInfo allocInfo{};
-		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-		allocInfo.commandPool = commandPool;
-		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-		allocInfo.commandBufferCount = static_cast<uint32_t>(commandBuffers.size());
+				VkCommandBufferAllocateInfo allocInfo{};
+				allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+				allocInfo.commandPool = slicePool;
+				allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+				allocInfo.commandBufferCount = static_cast<uint32_t>(sliceBuffers.size());
 
-		if (vkAllocateCommandBuffers(device, &allocInfo, commandBuffers.data()) != VK_SUCCESS)
+				if (vkAllocateCommandBuffers(device, &allocInfo, sliceBuffers.data()) != VK_SUCCESS)
+				{
+					throw std::runtime_error("CommandPoolManager: failed to allocate secondary command buffer.");
+				}
+			}
+		}
+	}
+
+	void CommandBufferManager::initCommandBuffers()
+	{
+		commandBuffers.resize(numberOfBuffers);
+
+		for (size_t frame = 0; frame < commandBuffers.size(); ++frame)
 		{
-			throw std::runtime_error("CommandPoolManager: failed to allocate command buffers.");
+			VkCommandBufferAllocateInfo allocInfo{};
+			allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			allocInfo.commandPool = commandPools[frame];
+			allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			allocInfo.commandBufferCount = 1;
+
+			if (vkAllocateCommandBuffers(device, &allocInfo, &commandBuffers[frame]) != VK_SUCCESS)
+			{
+				throw std::runtime_error("CommandPoolManager: failed to allocate command buffers.");
+			}
 		}
 	}
 
-	void CommandBufferManager::resetCommandBuffer(const int bufferId) const
+	void CommandBufferManager::resetFrame(const int frame) const
 	{
-		if (static_cast<size_t>(bufferId) >= commandBuffers.size() || bufferId < 0)
+		if (static_cast<size_t>(frame) >= commandPools.size() || frame < 0)
 		{
 			throw std::out_of_range("VkCommandBuffer: current frame number is larger than number of fences.");
 		}
-		vkResetCommandBuffer(commandBuffers[bufferId], 0);
+
+		vkResetCommandPool(device, commandPools[frame], 0);
+		for (const auto& [slicePool, sliceBuffers] : secondaryPools[frame])
+		{
+			vkResetCommandPool(device, slicePool, 0);
+		}
 	}
 
 	void CommandBufferManager::clean()
 	{
-		const auto& device = ServiceLocator::getService<DeviceManager>()->getLogicalDevice();
+		for (const auto& framePools : secondaryPools)
+		{
+			for (const auto& [slicePool, sliceBuffers] : framePools)
+			{
+				vkDestroyCommandPool(device, slicePool, nullptr);
+			}
+		}
+		secondaryPools.clear();
 
-		vkDestroyCommandPool(device, commandPool, nullptr);
+		for (const auto& framePool : commandPools)
+		{
+			vkDestroyCommandPool(device, framePool, nullptr);
+		}
+		commandPools.clear();
 	}
 
 	VkCommandBuffer CommandBufferManager::getCommandBuffer(const int bufferId) const
@@ -82,68 +175,288 @@ namespace tessera::vulkan
 		return commandBuffers[bufferId];
 	}
 
-	void recordCommandBuffer(const VkCommandBuffer commandBufferToRecord, const uint32_t imageIndex)
+	VkCommandBuffer CommandBufferManager::getSecondaryCommandBuffer(const int frame, const uint32_t slice, const DrawListPass pass) const
 	{
-		const auto& swapChainFramebuffers = ServiceLocator::getService<FramebufferManager>()->getSwapChainFramebuffers();
-		const auto& [swapChainImageFormat, swapChainExtent, swapChainImages] = ServiceLocator::getService<SwapChainManager>()->getSwapChainImageDetails();
-		const auto& graphicsPipelineManager = ServiceLocator::getService<GraphicsPipelineManager>();
-		const auto& graphicsPipeline = graphicsPipelineManager->getGraphicsPipeline();
-		const auto& renderPass = graphicsPipelineManager->getRenderPath();
-		const auto& bufferManager = ServiceLocator::getService<BufferManager>();
-
-		VkCommandBufferBeginInfo beginInfo{};
-		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-		beginInfo.flags = 0;
-		beginInfo.pInheritanceInfo = nullptr;
-
-		if (vkBeginCommandBuffer(commandBufferToRecord, &beginInfo) != VK_SUCCESS)
+		if (static_cast<size_t>(frame) >= secondaryPools.size() || frame < 0 || slice >= secondaryPools[frame].size())
 		{
-			throw std::runtime_error("CommandPoolManager: failed to begin recording command buffer.");
+			throw std::out_of_range("CommandPoolManager: secondary command buffer index out of range.");
 		}
+		return secondaryPools[frame][slice].commandBuffers[static_cast<size_t>(pass)];
+	}
+
+	namespace
+	{
+		// Below this many draws per slice the cost of a secondary command buffer outweighs recording in parallel.
+		constexpr size_t MIN_DRAWS_PER_SLICE = 64;
 
-		// Start the rendering pass
-		VkRenderPassBeginInfo renderPassInfo{};
-		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-		renderPassInfo.renderPass = renderPass;
-		renderPassInfo.framebuffer = swapChainFramebuffers[imageIndex];
-		renderPassInfo.renderArea.offset = { 0, 0 };
-		renderPassInfo.renderArea.extent = swapChainExtent;
-		renderPassInfo.clearValueCount = 1;
-		constexpr VkClearValue clearColor = { {{0.0f, 0.0f, 0.0f, 1.0f}} };
-		renderPassInfo.pClearValues = &clearColor;
-
-		// Draw.
-		vkCmdBeginRenderPass(commandBufferToRecord, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
-			// TODO: Maybe RAII initialization?
-			// Bind the graphics pipeline.
-			vkCmdBindPipeline(commandBufferToRecord, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
+		void setViewportAndScissor(const VkCommandBuffer commandBuffer, const VkExtent2D& extent)
+		{
 			VkViewport viewport;
 			viewport.x = 0.0f;
 			viewport.y = 0.0f;
-			viewport.width = static_cast<float>(swapChainExtent.width);
-			viewport.height = static_cast<float>(swapChainExtent.height);
+			viewport.width = static_cast<float>(extent.width);
+			viewport.height = static_cast<float>(extent.height);
 			viewport.minDepth = 0.0f;
 			viewport.maxDepth = 1.0f;
-			vkCmdSetViewport(commandBufferToRecord, 0, 1, &viewport);
+			vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
 
 			VkRect2D scissor;
 			scissor.offset = { 0, 0 };
-			scissor.extent = swapChainExtent;
-			vkCmdSetScissor(commandBufferToRecord, 0, 1, &scissor);
+			scissor.extent = extent;
+			vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+		}
+
+		// Bound once per command buffer since every pipeline of the draw list shares the layout; bindlessSet is VK_NULL_HANDLE without bindless tables.
+		struct DescriptorBindings
+		{
+			VkPipelineLayout layout = VK_NULL_HANDLE;
+			VkDescriptorSet frameSet = VK_NULL_HANDLE;
+			uint32_t frameOffset = 0;
+			VkDescriptorSet bindlessSet = VK_NULL_HANDLE;
+		};
+
+		void recordDraws(const VkCommandBuffer commandBuffer, const DrawCommand* first, const DrawCommand* last, const DescriptorBindings& bindings,
+			const DrawListPass pass)
+		{
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, bindings.layout, UniformManager::FRAME_SET, 1, &bindings.frameSet, 1, &bindings.frameOffset);
+			if (bindings.bindlessSet != VK_NULL_HANDLE)
+			{
+				vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, bindings.layout, DescriptorManager::BINDLESS_SET, 1, &bindings.bindlessSet, 0, nullptr);
+			}
+
+			uint32_t pushedMaterial = UINT32_MAX;
+			VkPipeline boundPipeline = VK_NULL_HANDLE;
+			VkBuffer boundVertexBuffer = VK_NULL_HANDLE;
+			VkBuffer boundIndexBuffer = VK_NULL_HANDLE;
+			VkBuffer boundInstanceBuffer = VK_NULL_HANDLE;
+			VkDeviceSize boundInstanceOffset = 0;
+
+			for (const DrawCommand* draw = first; draw != last; ++draw)
+			{
+				const VkPipeline pipeline = pass == DrawListPass::DEPTH_PREPASS ? draw->depthPipeline : draw->pipeline;
+				if (pipeline == VK_NULL_HANDLE)
+				{
+					continue;
+				}
+
+				if (pipeline != boundPipeline)
+				{
+					vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+					boundPipeline = pipeline;
+				}
+
+				if (draw->vertexBuffer != boundVertexBuffer)
+				{
+					constexpr VkDeviceSize offsets[] = { 0 };
+					vkCmdBindVertexBuffers(commandBuffer, 0, 1, &draw->vertexBuffer, offsets);
+					boundVertexBuffer = draw->vertexBuffer;
+				}
+
+				if (draw->instanceBuffer != VK_NULL_HANDLE && (draw->instanceBuffer != boundInstanceBuffer || draw->instanceOffset != boundInstanceOffset))
+				{
+					vkCmdBindVertexBuffers(commandBuffer, InstanceData::BINDING, 1, &draw->instanceBuffer, &draw->instanceOffset);
+					boundInstanceBuffer = draw->instanceBuffer;
+					boundInstanceOffset = draw->instanceOffset;
+				}
+
+				if (draw->indexBuffer != boundIndexBuffer)
+				{
+					vkCmdBindIndexBuffer(commandBuffer, draw->indexBuffer, 0, draw->indexType);
+					boundIndexBuffer = draw->indexBuffer;
+				}
+
+				// Switching materials only changes the index shaders read the bindless tables with.
+				if (bindings.bindlessSet != VK_NULL_HANDLE && draw->material != pushedMaterial)
+				{
+					const MaterialConstants constants{ draw->material };
+					vkCmdPushConstants(commandBuffer, bindings.layout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(constants), &constants);
+					pushedMaterial = draw->material;
+				}
+
+				vkCmdDrawIndexed(commandBuffer, draw->indexCount, draw->instanceCount, draw->firstIndex, draw->vertexOffset, draw->firstInstance);
+			}
+		}
+
+		void recordSlice(const VkCommandBuffer secondaryBuffer, const VkCommandBufferInheritanceInfo& inheritanceInfo, const VkExtent2D& extent,
+			const DescriptorBindings& bindings, const DrawCommand* first, const DrawCommand* last, const DrawListPass pass)
+		{
+			TESSERA_PROFILE_ZONE("Record slice");
+
+			VkCommandBufferBeginInfo secondaryBeginInfo{};
+			secondaryBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+			secondaryBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+			secondaryBeginInfo.pInheritanceInfo = &inheritanceInfo;
+
+			if (vkBeginCommandBuffer(secondaryBuffer, &secondaryBeginInfo) != VK_SUCCESS)
+			{
+				throw std::runtime_error("CommandPoolManager: failed to begin recording secondary command buffer.");
+			}
+
+			// Dynamic state and bindings are not inherited from the primary command buffer.
+			setViewportAndScissor(secondaryBuffer, extent);
+			recordDraws(secondaryBuffer, first, last, bindings, pass);
+
+			if (vkEndCommandBuffer(secondaryBuffer) != VK_SUCCESS)
+			{
+				throw std::runtime_error("CommandPoolManager: failed to record secondary command buffer.");
+			}
+		}
+	}
+
+	void CommandBufferManager::buildDrawList(const int frame)
+	{
+		DrawCommand draw = bufferManager->makeDraw(bufferManager->getDefaultMesh());
+		draw.pipeline = graphicsPipelineManager->getGraphicsPipeline();
+		draw.depthPipeline = graphicsPipelineManager->getDepthPipeline();
+
+		drawList.clear();
+		drawList.push_back(draw);
+		instancingManager->appendDraws(drawList);
+		sceneManager->appendDraws(drawList, frame);
+
+		if (drawListCallback)
+		{
+			drawListCallback(drawList);
+		}
+
+		// The main pass then only shades fragments matching the prepass depth, so solid draws left out of it would vanish.
+		if (renderGraphManager->isDepthPrepassEnabled())
+		{
+			for (const DrawCommand& listed : drawList)
+			{
+				if (listed.pass == DrawPass::SOLID && listed.pipeline != VK_NULL_HANDLE && listed.depthPipeline == VK_NULL_HANDLE)
+				{
+					throw std::runtime_error("CommandPoolManager: solid draws need a depth pipeline with render.depthPrepass.");
+				}
+			}
+		}
 
-			const VkBuffer vertexBuffers[] = { bufferManager->getVertexBuffer() };
-			constexpr VkDeviceSize offsets[] = { 0 };
-			vkCmdBindVertexBuffers(commandBufferToRecord, 0, 1, vertexBuffers, offsets);
-			vkCmdBindIndexBuffer(commandBufferToRecord, bufferManager->getIndexBuffer(), 0, VK_INDEX_TYPE_UINT16);
-			const auto numberOfIndices = static_cast<uint32_t>(indices.size());
+		if (sortDraws)
+		{
+			drawSorter.sort(drawList);
+		}
+	}
 
-			vkCmdDrawIndexed(commandBufferToRecord, numberOfIndices, 1, 0, 0, 0);
-		vkCmdEndRenderPass(commandBufferToRecord);
+	void CommandBufferManager::recordCommandBuffer(const VkCommandBuffer commandBufferToRecord, const uint32_t imageIndex, const int frame)
+	{
+		buildDrawList(frame);
 
+		VkCommandBufferBeginInfo beginInfo{};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = 0;
+		beginInfo.pInheritanceInfo = nullptr;
+
+		if (vkBeginCommandBuffer(commandBufferToRecord, &beginInfo) != VK_SUCCESS)
+		{
+			throw std::runtime_error("CommandPoolManager: failed to begin recording command buffer.");
+		}
+
+		gpuProfiler->beginFrame(commandBufferToRecord, frame);
+		gpuProfiler->beginScope(commandBufferToRecord, "Frame");
+
+		// Every pass gets its own GPU scope and debug label from the graph.
+		renderGraphManager->execute(commandBufferToRecord, imageIndex, frame);
+
+		// Frame.
+		gpuProfiler->endScope(commandBufferToRecord);
 		if (vkEndCommandBuffer(commandBufferToRecord) != VK_SUCCESS)
 		{
 			throw std::runtime_error("CommandPoolManager: failed to record command buffer");
 		}
 	}
 
+	void CommandBufferManager::recordMainPass(const RenderPassContext& context)
+	{
+		recordDrawList(context, DrawListPass::MAIN);
+	}
+
+	void CommandBufferManager::recordDepthPrepass(const RenderPassContext& context)
+	{
+		recordDrawList(context, DrawListPass::DEPTH_PREPASS);
+	}
+
+	void CommandBufferManager::recordDrawList(const RenderPassContext& context, const DrawListPass pass)
+	{
+		// A handful of indirect calls, however many objects there are, so there is nothing to record in parallel.
+		if (indirectDrawManager->isEnabled())
+		{
+			context.beginRenderPass(VK_SUBPASS_CONTENTS_INLINE);
+				setViewportAndScissor(context.commandBuffer, context.extent);
+				indirectDrawManager->recordDraws(context, pass == DrawListPass::DEPTH_PREPASS);
+			context.endRenderPass();
+			return;
+		}
+
+		const size_t sliceCount = std::min<size_t>(getRecordingSliceCount(), drawList.size() / MIN_DRAWS_PER_SLICE);
+		const bool recordInParallel = sliceCount > 1;
+		const VkCommandBuffer commandBufferToRecord = context.commandBuffer;
+		const VkExtent2D& extent = context.extent;
+		const DescriptorBindings bindings = { graphicsPipelineManager->getPipelineLayout(), uniformManager->getFrameSet(), uniformManager->getFrameOffset(),
+			descriptorManager->getBindlessSet() };
+
+		if (!recordInParallel)
+		{
+			context.beginRenderPass(VK_SUBPASS_CONTENTS_INLINE);
+				setViewportAndScissor(commandBufferToRecord, extent);
+				recordDraws(commandBufferToRecord, drawList.data(), drawList.data() + drawList.size(), bindings, pass);
+			context.endRenderPass();
+			return;
+		}
+
+		VkCommandBufferInheritanceInfo inheritanceInfo{};
+		VkCommandBufferInheritanceRenderingInfo renderingInheritance{};
+		context.fillInheritanceInfo(inheritanceInfo, renderingInheritance);
+
+		secondaryBuffers.resize(sliceCount);
+		sliceRecordings.clear();
+
+		const size_t drawsPerSlice = (drawList.size() + sliceCount - 1) / sliceCount;
+		const auto sliceBegin = [&](const size_t slice) { return drawList.data() + std::min(slice * drawsPerSlice, drawList.size()); };
+		for (size_t slice = 0; slice < sliceCount; ++slice)
+		{
+			secondaryBuffers[slice] = getSecondaryCommandBuffer(context.frame, static_cast<uint32_t>(slice), pass);
+		}
+
+		// Slice 0 is left to the render thread, which would otherwise sit idle while the others queue behind
+		// long jobs on the shared pool.
+		for (size_t slice = 1; slice < sliceCount; ++slice)
+		{
+			sliceRecordings.emplace_back(threadPool->submit([secondaryBuffer = secondaryBuffers[slice], &inheritanceInfo, &extent, &bindings,
+				first = sliceBegin(slice), last = sliceBegin(slice + 1), pass]
+				{
+					recordSlice(secondaryBuffer, inheritanceInfo, extent, bindings, first, last, pass);
+				}));
+		}
+
+		std::exception_ptr failure;
+		try
+		{
+			recordSlice(secondaryBuffers[0], inheritanceInfo, extent, bindings, sliceBegin(0), sliceBegin(1), pass);
+		}
+		catch (...)
+		{
+			failure = std::current_exception();
+		}
+
+		// The workers reference inheritanceInfo, extent and bindings, so every one of them must finish before a failure leaves this scope.
+		// Waiting runs queued tasks meanwhile, so slices stuck behind long jobs do not leave the render thread idle.
+		for (const auto& recording : sliceRecordings)
+		{
+			threadPool->waitFor(recording);
+		}
+		if (failure)
+		{
+			std::rethrow_exception(failure);
+		}
+		for (auto& recording : sliceRecordings)
+		{
+			recording.get();
+		}
+		sliceRecordings.clear();
+
+		context.beginRenderPass(VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+			vkCmdExecuteCommands(commandBufferToRecord, static_cast<uint32_t>(secondaryBuffers.size()), secondaryBuffers.data());
+		context.endRenderPass();
+	}
+
 }
@@ -1,29 +1,126 @@
 #pragma once
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <vector>
 #include <vulkan/vulkan_core.h>
 
+#include "DrawList.h"
+#include "DrawSorter.h"
 #include "utils/interfaces/Initializable.h"
 
+namespace tessera
+{
+	class ThreadPool;
+}
+
 namespace tessera::vulkan
 {
+
+	class BufferManager;
+	class DescriptorManager;
+	class GpuProfiler;
+	class GraphicsPipelineManager;
+	class IndirectDrawManager;
+	class InstancingManager;
+	class RenderGraphManager;
+	class SceneManager;
+	class UniformManager;
+	struct RenderPassContext;
 	
+	// Passes recording the draw list, each into secondary command buffers of its own.
+	enum class DrawListPass : uint8_t
+	{
+		DEPTH_PREPASS,
+		MAIN
+	};
+
 	class CommandBufferManager final : public Initializable
 	{
 	public:
 		void init() override;
-		void resetCommandBuffer(const int bufferId) const;
+		void resolveServices() override;
+		// Recycle every command buffer of frame at once. Only valid after the frame's in-flight fence has signaled.
+		void resetFrame(const int frame) const;
 		void clean() override;
 		[[nodiscard]] VkCommandBuffer getCommandBuffer(const int bufferId) const;
-		[[nodiscard]] VkCommandPool getCommandPool() const { return commandPool; }
-		static int getNumberOfBuffers() { return MAX_FRAMES_IN_FLIGHT; }
+		[[nodiscard]] int getNumberOfBuffers() const { return numberOfBuffers; }
+
+		// Frames in flight requested by render.framesInFlight, for services initialized before this one.
+		static int queryFramesInFlight();
+
+		/**
+		 * @brief Secondary command buffer owned by one recording slice of a frame.
+		 *
+		 * Every slice has its own pool per frame in flight, so slices can be recorded on different threads
+		 * without synchronization. The pools of a frame are reset together by resetFrame(). Each pool holds
+		 * one buffer per pass recording the draw list, since a frame executes them all.
+		 */
+		[[nodiscard]] VkCommandBuffer getSecondaryCommandBuffer(int frame, uint32_t slice, DrawListPass pass = DrawListPass::MAIN) const;
+		[[nodiscard]] uint32_t getRecordingSliceCount() const { return static_cast<uint32_t>(secondaryPools.empty() ? 0 : secondaryPools[0].size()); }
+
+		// Record the frame into commandBufferToRecord by executing the render graph.
+		void recordCommandBuffer(const VkCommandBuffer commandBufferToRecord, const uint32_t imageIndex, const int frame);
+
+		/**
+		 * @brief Record the draw list into the main pass of the render graph.
+		 *
+		 * Small draw lists are recorded inline. Larger ones are split into slices recorded into secondary
+		 * command buffers, the first on the render thread and the rest on the ThreadPool, and executed from
+		 * the primary buffer. With GPU-driven drawing
+		 * enabled, the indirect draws of the IndirectDrawManager are recorded instead.
+		 */
+		void recordMainPass(const RenderPassContext& context);
+		// Record the depth-only pipelines of the draw list into the depth prepass, the same way as recordMainPass().
+		void recordDepthPrepass(const RenderPassContext& context);
+
+		// Called with the draw list of every frame before it is sorted and recorded, so tools can replace or extend it.
+		void setDrawListCallback(std::function<void(DrawList&)> callback) { drawListCallback = std::move(callback); }
 	private:
+		static constexpr size_t DRAW_LIST_PASS_COUNT = 2;
+
+		struct SecondaryPool
+		{
+			VkCommandPool commandPool = VK_NULL_HANDLE;
+			std::array<VkCommandBuffer, DRAW_LIST_PASS_COUNT> commandBuffers{};
+		};
+
 		void initCommandPool();
 		void initCommandBuffers();
+		void initSecondaryPools(uint32_t graphicsFamily);
+		void buildDrawList(int frame);
+		void recordDrawList(const RenderPassContext& context, DrawListPass pass);
+
+		VkDevice device = VK_NULL_HANDLE;
+		// Rebuilt every frame; keeps its capacity so recording does not allocate.
+		DrawList drawList;
+		std::function<void(DrawList&)> drawListCallback;
+		DrawSorter drawSorter;
+		bool sortDraws = true;
+
+		// Resolved once in resolveServices() so recording does not go through the ServiceLocator.
+		RenderGraphManager* renderGraphManager = nullptr;
+		IndirectDrawManager* indirectDrawManager = nullptr;
+		InstancingManager* instancingManager = nullptr;
+		SceneManager* sceneManager = nullptr;
+		GraphicsPipelineManager* graphicsPipelineManager = nullptr;
+		BufferManager* bufferManager = nullptr;
+		ThreadPool* threadPool = nullptr;
+		GpuProfiler* gpuProfiler = nullptr;
+		DescriptorManager* descriptorManager = nullptr;
+		UniformManager* uniformManager = nullptr;
 
-		VkCommandPool commandPool = VK_NULL_HANDLE;
+		std::vector<VkCommandPool> commandPools;
 		std::vector<VkCommandBuffer> commandBuffers;
-		static constexpr int MAX_FRAMES_IN_FLIGHT = 2;
+		std::vector<std::vector<SecondaryPool>> secondaryPools; // [frame][slice]
+		// Filled by recordDrawList(); members so their capacity is reused every frame.
+		std::vector<VkCommandBuffer> secondaryBuffers;
+		std::vector<std::future<void>> sliceRecordings;
+		int numberOfBuffers = DEFAULT_FRAMES_IN_FLIGHT;
+		static constexpr int DEFAULT_FRAMES_IN_FLIGHT = 2;
+		static constexpr int MAX_FRAMES_IN_FLIGHT = 4;
 	};
 
-	void recordCommandBuffer(const VkCommandBuffer commandBufferToRecord, const uint32_t imageIndex);
 }
 
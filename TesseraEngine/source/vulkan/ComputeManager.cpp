@@ -0,0 +1,214 @@
+#include "ComputeManager.h"
+
+#include <stdexcept>
+#include <string>
+
+#include "CommandBufferManager.h"
+#include "DeviceManager.h"
+#include "QueueManager.h"
+#include "UploadManager.h"
+#include "utils/EngineConfig.h"
+#include "utils/TesseraLog.h"
+#include "utils/interfaces/ServiceLocator.h"
+
+namespace tessera::vulkan
+{
+
+	void ComputeManager::init()
+	{
+		Initializable::init();
+		const auto& queueManager = ServiceLocator::getService<QueueManager>();
+		const auto [graphicsFamily, presentFamily, transferFamily, computeFamily, computeQueueIndex] = queueManager->getQueueFamilyIndices();
+
+		sharedQueueFamilies = { graphicsFamily.value() };
+		if (!ServiceLocator::getService<EngineConfig>()->getBool("render.asyncCompute", false))
+		{
+			return;
+		}
+
+		// The fallback compute queue is the graphics queue itself, where the work is better recorded inline.
+		if (computeFamily.value() == graphicsFamily.value())
+		{
+			TesseraLog::send(LogType::INFO, "ComputeManager", "No compute queue family without graphics, compute work stays on the graphics queue.");
+			return;
+		}
+
+		const auto& deviceManager = ServiceLocator::getService<DeviceManager>();
+		device = deviceManager->getLogicalDevice();
+		timelineSemaphore = deviceManager->getCapabilities().timelineSemaphore;
+		computeQueue = queueManager->getComputeQueue();
+		sharedQueueFamilies.push_back(computeFamily.value());
+
+		VkCommandPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+		poolInfo.queueFamilyIndex = computeFamily.value();
+
+		if (vkCreateCommandPool(device, &poolInfo, nullptr, &commandPool) != VK_SUCCESS)
+		{
+			throw std::runtime_error("ComputeManager: failed to create command pool.");
+		}
+
+		frames.resize(CommandBufferManager::queryFramesInFlight());
+		for (ComputeFrame& frame : frames)
+		{
+			VkCommandBufferAllocateInfo allocInfo{};
+			allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			allocInfo.commandPool = commandPool;
+			allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			allocInfo.commandBufferCount = 1;
+
+			if (vkAllocateCommandBuffers(device, &allocInfo, &frame.commandBuffer) != VK_SUCCESS)
+			{
+				throw std::runtime_error("ComputeManager: failed to allocate command buffer.");
+			}
+
+			VkSemaphoreCreateInfo semaphoreInfo{};
+			semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+			if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &frame.finishedSemaphore) != VK_SUCCESS)
+			{
+				throw std::runtime_error("ComputeManager: failed to create semaphore.");
+			}
+		}
+
+		async = true;
+		TesseraLog::send(LogType::INFO, "ComputeManager", "Compute work runs on queue family " + std::to_string(computeFamily.value()) + ".");
+	}
+
+	void ComputeManager::resolveServices()
+	{
+		uploadManager = ServiceLocator::getServicePointer<UploadManager>();
+	}
+
+	void ComputeManager::addRecorder(Recorder recorder, const VkPipelineStageFlags stages)
+	{
+		if (!async)
+		{
+			throw std::runtime_error("ComputeManager: compute work can only be added with an async compute queue.");
+		}
+
+		recorders.emplace_back(std::move(recorder));
+		consumerStages |= stages;
+	}
+
+	void ComputeManager::recordFrame(const int frame)
+	{
+		if (recorders.empty())
+		{
+			return;
+		}
+
+		ComputeFrame& computeFrame = frames[frame];
+
+		// The graphics submission of the slot waited on this command buffer and has retired, so it is no longer pending.
+		VkCommandBufferBeginInfo beginInfo{};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+		if (vkBeginCommandBuffer(computeFrame.commandBuffer, &beginInfo) != VK_SUCCESS)
+		{
+			throw std::runtime_error("ComputeManager: failed to begin recording command buffer.");
+		}
+
+		for (const Recorder& recorder : recorders)
+		{
+			recorder(computeFrame.commandBuffer, frame);
+		}
+
+		if (vkEndCommandBuffer(computeFrame.commandBuffer) != VK_SUCCESS)
+		{
+			throw std::runtime_error("ComputeManager: failed to record command buffer.");
+		}
+
+		computeFrame.recorded = true;
+	}
+
+	void ComputeManager::submitFrame(const int frame, const uint64_t frameNumber)
+	{
+		if (recorders.empty() || !frames[frame].recorded)
+		{
+			return;
+		}
+
+		ComputeFrame& computeFrame = frames[frame];
+
+		// Compute work may read anything uploaded for this frame.
+		submitWaitSemaphores.clear();
+		submitWaitStages.clear();
+		submitWaitValues.clear();
+		uploadManager->consumeGraphicsWaits(frameNumber, submitWaitSemaphores, submitWaitStages, submitWaitValues);
+
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.waitSemaphoreCount = static_cast<uint32_t>(submitWaitSemaphores.size());
+		submitInfo.pWaitSemaphores = submitWaitSemaphores.data();
+		submitInfo.pWaitDstStageMask = submitWaitStages.data();
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &computeFrame.commandBuffer;
+		submitInfo.signalSemaphoreCount = 1;
+		submitInfo.pSignalSemaphores = &computeFrame.finishedSemaphore;
+
+		// Only the upload timeline has a non-zero value; the binary signal ignores its entry.
+		const uint64_t signalValue = 0;
+		VkTimelineSemaphoreSubmitInfo timelineInfo{};
+		timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+		timelineInfo.waitSemaphoreValueCount = static_cast<uint32_t>(submitWaitValues.size());
+		timelineInfo.pWaitSemaphoreValues = submitWaitValues.data();
+		timelineInfo.signalSemaphoreValueCount = 1;
+		timelineInfo.pSignalSemaphoreValues = &signalValue;
+
+		if (timelineSemaphore)
+		{
+			submitInfo.pNext = &timelineInfo;
+		}
+
+		if (vkQueueSubmit(computeQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+		{
+			throw std::runtime_error("ComputeManager: failed to submit command buffer.");
+		}
+
+		computeFrame.recorded = false;
+		computeFrame.submitted = true;
+		computeFrame.carriesUploadWaits = !submitWaitSemaphores.empty();
+	}
+
+	void ComputeManager::consumeGraphicsWaits(const int frame, std::vector<VkSemaphore>& waitSemaphores, std::vector<VkPipelineStageFlags>& waitStages, std::vector<uint64_t>& waitValues)
+	{
+		if (frames.empty() || !frames[frame].submitted)
+		{
+			return;
+		}
+
+		ComputeFrame& computeFrame = frames[frame];
+
+		// Waiting at the consuming stages alone lets the graphics queue start the passes before them.
+		waitSemaphores.push_back(computeFrame.finishedSemaphore);
+		waitStages.push_back(computeFrame.carriesUploadWaits ? VkPipelineStageFlags{ VK_PIPELINE_STAGE_ALL_COMMANDS_BIT } : consumerStages);
+		waitValues.push_back(0);
+
+		computeFrame.submitted = false;
+		computeFrame.carriesUploadWaits = false;
+	}
+
+	void ComputeManager::clean()
+	{
+		if (!async)
+		{
+			return;
+		}
+
+		for (const ComputeFrame& frame : frames)
+		{
+			vkDestroySemaphore(device, frame.finishedSemaphore, nullptr);
+		}
+		frames.clear();
+		recorders.clear();
+
+		// Command buffers are freed together with the pool.
+		vkDestroyCommandPool(device, commandPool, nullptr);
+		commandPool = VK_NULL_HANDLE;
+		async = false;
+	}
+
+}
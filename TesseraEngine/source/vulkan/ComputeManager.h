@@ -0,0 +1,92 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+#include "utils/interfaces/Initializable.h"
+
+namespace tessera::vulkan
+{
+
+	class UploadManager;
+
+	/**
+	 * @brief Compute work of the frame submitted to a dedicated compute queue, overlapping the graphics queue.
+	 *
+	 * Recorders added through addRecorder() are recorded into one command buffer per frame in flight.
+	 * submitFrame() submits it after the uploads of the frame, taking over their graphics waits, and
+	 * signals a semaphore the graphics submission of the same frame waits on at the stages reading the
+	 * results. The graphics queue of the frame before keeps running meanwhile.
+	 *
+	 * Enabled by render.asyncCompute on devices with a compute family without graphics support. Otherwise
+	 * nothing is submitted and the work stays in the graphics command buffer. Buffers written on one queue
+	 * and read on the other must be created with getSharedQueueFamilies().
+	 */
+	class ComputeManager final : public Initializable
+	{
+	public:
+		using Recorder = std::function<void(VkCommandBuffer commandBuffer, int frame)>;
+
+		void init() override;
+		void resolveServices() override;
+		void clean() override;
+
+		[[nodiscard]] bool isAsync() const { return async; }
+
+		/**
+		 * @brief Record work into every frame's compute command buffer, in the order of the calls.
+		 *
+		 * Only valid when isAsync(). The recorder runs on the render thread before the graphics command buffer is recorded.
+		 * @param consumerStages Graphics stages reading what the work writes, e.g. VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT.
+		 */
+		void addRecorder(Recorder recorder, VkPipelineStageFlags consumerStages);
+
+		// Record the compute command buffer of frame. Called once the frame's slot has retired.
+		void recordFrame(int frame);
+		// Submit what recordFrame() recorded, after the uploads flushed for frameNumber.
+		void submitFrame(int frame, uint64_t frameNumber);
+
+		/**
+		 * @brief Append the wait the graphics submission of frame needs for its compute work.
+		 *
+		 * waitValues receives 0, the signal is a binary semaphore.
+		 */
+		void consumeGraphicsWaits(int frame, std::vector<VkSemaphore>& waitSemaphores, std::vector<VkPipelineStageFlags>& waitStages, std::vector<uint64_t>& waitValues);
+
+		// Queue families a buffer passed between compute and graphics work is shared between.
+		[[nodiscard]] const std::vector<uint32_t>& getSharedQueueFamilies() const { return sharedQueueFamilies; }
+	private:
+		struct ComputeFrame
+		{
+			VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+			// Signaled by the compute submission and waited on by the graphics submission of the same frame.
+			VkSemaphore finishedSemaphore = VK_NULL_HANDLE;
+			bool recorded = false;
+			bool submitted = false;
+			// The upload waits moved to the compute submission, so graphics has to wait at every stage.
+			bool carriesUploadWaits = false;
+		};
+
+		bool async = false;
+		// Upload waits taken over from the graphics submission may be on the upload timeline.
+		bool timelineSemaphore = false;
+
+		VkDevice device = VK_NULL_HANDLE;
+		VkQueue computeQueue = VK_NULL_HANDLE;
+		VkCommandPool commandPool = VK_NULL_HANDLE;
+		std::vector<ComputeFrame> frames;
+		std::vector<Recorder> recorders;
+		VkPipelineStageFlags consumerStages = 0;
+		std::vector<uint32_t> sharedQueueFamilies;
+
+		// Reused every frame to avoid reallocating the submit wait lists.
+		std::vector<VkSemaphore> submitWaitSemaphores;
+		std::vector<VkPipelineStageFlags> submitWaitStages;
+		std::vector<uint64_t> submitWaitValues;
+
+		// Resolved once in resolveServices() so submitting does not go through the ServiceLocator.
+		UploadManager* uploadManager = nullptr;
+	};
+
+}
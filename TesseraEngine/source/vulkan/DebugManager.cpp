@@ -1,16 +1,46 @@
 #include "DebugManager.h"
 
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <functional>
 #include <stdexcept>
+#include <string>
+#include <string_view>
 #include <vulkan/vulkan_core.h>
 
 #include "InstanceManager.h"
+#include "utils/EngineConfig.h"
 #include "utils/interfaces/ServiceLocator.h"
 
 namespace tessera::vulkan
 {
 
+	namespace
+	{
+		constexpr std::array<VkValidationFeatureEnableEXT, 1> PERFORMANCE_ENABLES = { VK_VALIDATION_FEATURE_ENABLE_BEST_PRACTICES_EXT };
+		constexpr std::array<VkValidationFeatureDisableEXT, 7> PERFORMANCE_DISABLES = {
+			VK_VALIDATION_FEATURE_DISABLE_SHADERS_EXT, VK_VALIDATION_FEATURE_DISABLE_THREAD_SAFETY_EXT, VK_VALIDATION_FEATURE_DISABLE_API_PARAMETERS_EXT,
+			VK_VALIDATION_FEATURE_DISABLE_OBJECT_LIFETIMES_EXT, VK_VALIDATION_FEATURE_DISABLE_CORE_CHECKS_EXT, VK_VALIDATION_FEATURE_DISABLE_UNIQUE_HANDLES_EXT,
+			VK_VALIDATION_FEATURE_DISABLE_SHADER_VALIDATION_CACHE_EXT };
+		constexpr std::array<VkValidationFeatureEnableEXT, 2> GPU_ASSISTED_ENABLES = {
+			VK_VALIDATION_FEATURE_ENABLE_GPU_ASSISTED_EXT, VK_VALIDATION_FEATURE_ENABLE_GPU_ASSISTED_RESERVE_BINDING_SLOT_EXT };
+		constexpr std::array<VkValidationFeatureEnableEXT, 1> SYNCHRONIZATION_ENABLES = { VK_VALIDATION_FEATURE_ENABLE_SYNCHRONIZATION_VALIDATION_EXT };
+
+		constexpr uint32_t DEFAULT_MESSAGE_REPEATS = 3;
+		constexpr uint32_t DEFAULT_MAX_MESSAGES_PER_SECOND = 50;
+	}
+
 	void DebugManager::init()
 	{
+        const auto& instanceManager = ServiceLocator::getService<InstanceManager>();
+        if (instanceManager->isDebugUtilsEnabled())
+        {
+            const auto& instance = instanceManager->getInstance();
+            cmdBeginDebugUtilsLabel = reinterpret_cast<PFN_vkCmdBeginDebugUtilsLabelEXT>(vkGetInstanceProcAddr(instance, "vkCmdBeginDebugUtilsLabelEXT"));
+            cmdEndDebugUtilsLabel = reinterpret_cast<PFN_vkCmdEndDebugUtilsLabelEXT>(vkGetInstanceProcAddr(instance, "vkCmdEndDebugUtilsLabelEXT"));
+        }
+
         if (!validationLayersAreEnabled())
         {
             return;
@@ -32,22 +62,100 @@ namespace tessera::vulkan
         createInfo.messageSeverity = VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
         createInfo.messageType = VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT;
         createInfo.pfnUserCallback = debugCallback;
+
+        // Left on in staging builds, so neither loader chatter nor verbose messages are worth their logging cost.
+        if (getValidationTier() == ValidationTier::PERFORMANCE)
+        {
+            createInfo.messageSeverity = VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
+            createInfo.messageType = VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT;
+        }
+
+        const auto& config = ServiceLocator::getService<EngineConfig>();
+        messageFilter.configure(static_cast<uint32_t>(std::max(config->getInt("debug.messageRepeats", DEFAULT_MESSAGE_REPEATS), 0)),
+            static_cast<uint32_t>(std::max(config->getInt("debug.maxMessagesPerSecond", DEFAULT_MAX_MESSAGES_PER_SECOND), 0)));
     }
 
+	bool DebugManager::populateValidationFeatures(VkValidationFeaturesEXT& validationFeatures)
+	{
+		validationFeatures = {};
+		validationFeatures.sType = VK_STRUCTURE_TYPE_VALIDATION_FEATURES_EXT;
+
+		// The arrays are static, so the structure stays valid after returning.
+		switch (getValidationTier())
+		{
+		case ValidationTier::PERFORMANCE:
+			validationFeatures.enabledValidationFeatureCount = static_cast<uint32_t>(PERFORMANCE_ENABLES.size());
+			validationFeatures.pEnabledValidationFeatures = PERFORMANCE_ENABLES.data();
+			validationFeatures.disabledValidationFeatureCount = static_cast<uint32_t>(PERFORMANCE_DISABLES.size());
+			validationFeatures.pDisabledValidationFeatures = PERFORMANCE_DISABLES.data();
+			return true;
+		case ValidationTier::GPU_ASSISTED:
+			validationFeatures.enabledValidationFeatureCount = static_cast<uint32_t>(GPU_ASSISTED_ENABLES.size());
+			validationFeatures.pEnabledValidationFeatures = GPU_ASSISTED_ENABLES.data();
+			return true;
+		case ValidationTier::SYNCHRONIZATION:
+			validationFeatures.enabledValidationFeatureCount = static_cast<uint32_t>(SYNCHRONIZATION_ENABLES.size());
+			validationFeatures.pEnabledValidationFeatures = SYNCHRONIZATION_ENABLES.data();
+			return true;
+		default:
+			return false;
+		}
+	}
+
 	void DebugManager::clean()
 	{
+        cmdBeginDebugUtilsLabel = nullptr;
+        cmdEndDebugUtilsLabel = nullptr;
+
         if(validationLayersAreEnabled())
         {
             destroyDebugUtilsMessengerExt(debugMessenger, nullptr);
+
+            if (const uint64_t suppressed = messageFilter.getSuppressedCount(); suppressed > 0)
+            {
+                TesseraLog::send(LogType::INFO, "DebugManager", std::to_string(suppressed) + " repeated or rate limited validation messages were not logged.");
+            }
         }
 	}
 
+    void DebugManager::beginLabel(const VkCommandBuffer commandBuffer, const char* name)
+    {
+        if (cmdBeginDebugUtilsLabel == nullptr)
+        {
+            return;
+        }
+
+        VkDebugUtilsLabelEXT label{};
+        label.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT;
+        label.pLabelName = name;
+        cmdBeginDebugUtilsLabel(commandBuffer, &label);
+    }
+
+    void DebugManager::endLabel(const VkCommandBuffer commandBuffer)
+    {
+        if (cmdEndDebugUtilsLabel != nullptr)
+        {
+            cmdEndDebugUtilsLabel(commandBuffer);
+        }
+    }
+
 	VkBool32 DebugManager::debugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
 												[[maybe_unused]] VkDebugUtilsMessageTypeFlagsEXT messageType,
 	                                           const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData,
 	                                           [[maybe_unused]] void* pUserData)
     {
-        TesseraLog::send(getLogType(messageSeverity), "Vulkan", pCallbackData->pMessage);
+        // Loader messages come without an ID and share one name, so only their text tells them apart.
+        const uint64_t messageId = pCallbackData->messageIdNumber != 0
+            ? static_cast<uint32_t>(pCallbackData->messageIdNumber)
+            : std::hash<std::string_view>{}(pCallbackData->pMessage);
+
+        std::string note;
+        if (!messageFilter.admit(messageId, note))
+        {
+            return VK_FALSE;
+        }
+
+        TesseraLog::send(getLogType(messageSeverity), "Vulkan", note.empty() ? std::string(pCallbackData->pMessage) : note + pCallbackData->pMessage);
         return VK_FALSE;
     }
 
@@ -137,13 +245,41 @@ namespace tessera::vulkan
         }
 	}
 
-	bool DebugManager::validationLayersAreEnabled()
+	ValidationTier DebugManager::getValidationTier()
 	{
+		// Asked by every service creating instance or device objects; read once, so an unknown name warns once.
+		static const ValidationTier tier = []
+			{
+				static constexpr std::array<std::string_view, 5> TIER_NAMES = { "off", "performance", "full", "gpu", "sync" };
+
 #ifdef NDEBUG
-        return false;
+				constexpr ValidationTier defaultTier = ValidationTier::OFF;
 #else
-        return true;
+				constexpr ValidationTier defaultTier = ValidationTier::FULL;
 #endif
+
+				const std::string name = ServiceLocator::getService<EngineConfig>()->getString("debug.validation", "");
+				if (name.empty())
+				{
+					return defaultTier;
+				}
+
+				const auto namedTier = std::ranges::find(TIER_NAMES, name);
+				if (namedTier == TIER_NAMES.end())
+				{
+					TesseraLog::send(LogType::WARNING, "DebugManager", "Unknown validation tier " + name + ", using the default of the build.");
+					return defaultTier;
+				}
+
+				return static_cast<ValidationTier>(namedTier - TIER_NAMES.begin());
+			}();
+
+		return tier;
+	}
+
+	bool DebugManager::validationLayersAreEnabled()
+	{
+		return getValidationTier() != ValidationTier::OFF;
 	}
 
 	std::vector<const char*> DebugManager::getValidationLayers()
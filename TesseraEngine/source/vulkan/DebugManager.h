@@ -1,28 +1,58 @@
 #pragma once
+#include <cstdint>
 #include <vector>
 #include <vulkan/vulkan_core.h>
 
+#include "DebugMessageFilter.h"
 #include "utils/TesseraLog.h"
 #include "utils/interfaces/Initializable.h"
 
 namespace tessera::vulkan
 {
 
+	// Checks of the validation layer selected by debug.validation, from cheapest to most thorough.
+	enum class ValidationTier : uint8_t
+	{
+		// No layer and no messenger; nothing is checked or logged.
+		OFF,
+		// Best practices warnings only, with every correctness check disabled.
+		PERFORMANCE,
+		FULL,
+		// Full validation plus instrumented shaders checking descriptor indexing and buffer accesses on the GPU.
+		GPU_ASSISTED,
+		// Full validation plus hazards between commands, barriers and queue submissions.
+		SYNCHRONIZATION
+	};
+
+	/**
+	 * @brief Validation layer and debug messenger of the instance.
+	 *
+	 * debug.validation picks the ValidationTier, off by default in release builds and full in debug builds.
+	 * Tiers other than full configure the layer through VK_EXT_validation_features. Messages pass through a
+	 * DebugMessageFilter, which limits repeats of one message ID and the messages logged per second.
+	 */
 	class DebugManager final : public Initializable
 	{
 	public:
 		void init() override;
 
 		static void populate(VkDebugUtilsMessengerCreateInfoEXT& createInfo);
+		// Layer configuration of the tier, or false when the tier uses the defaults of the layer.
+		static bool populateValidationFeatures(VkValidationFeaturesEXT& validationFeatures);
 
 		void clean() override;
 
 		static void checkValidationLayerSupport();
 
+		static ValidationTier getValidationTier();
 		static bool validationLayersAreEnabled();
 
 		static std::vector<const char*> getValidationLayers();
 
+		// Command buffer regions shown by RenderDoc, Nsight and validation messages; no-ops without VK_EXT_debug_utils.
+		static void beginLabel(VkCommandBuffer commandBuffer, const char* name);
+		static void endLabel(VkCommandBuffer commandBuffer);
+
 	private:
 		static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback(
 			VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
@@ -40,6 +70,12 @@ namespace tessera::vulkan
 
 		VkDebugUtilsMessengerEXT debugMessenger = nullptr;
 
+		// Shared with the messenger chained to instance creation, which exists before this service.
+		inline static DebugMessageFilter messageFilter;
+
+		inline static PFN_vkCmdBeginDebugUtilsLabelEXT cmdBeginDebugUtilsLabel = nullptr;
+		inline static PFN_vkCmdEndDebugUtilsLabelEXT cmdEndDebugUtilsLabel = nullptr;
+
 	};
 
 }
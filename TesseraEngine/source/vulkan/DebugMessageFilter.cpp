@@ -0,0 +1,77 @@
+#include "DebugMessageFilter.h"
+
+namespace tessera::vulkan
+{
+
+	void DebugMessageFilter::configure(const uint32_t newRepeatLimit, const uint32_t newMaxPerSecond)
+	{
+		std::lock_guard lock(mutex);
+		repeatLimit = newRepeatLimit;
+		maxPerSecond = newMaxPerSecond;
+		history.clear();
+		windowCount = 0;
+		rateDropped = 0;
+		totalSuppressed = 0;
+	}
+
+	bool DebugMessageFilter::admit(const uint64_t messageId, std::string& note)
+	{
+		note.clear();
+		const auto now = std::chrono::steady_clock::now();
+
+		std::lock_guard lock(mutex);
+		MessageHistory& message = history[messageId];
+		++message.count;
+
+		// Still happening is worth knowing now and then, but not every frame.
+		const bool repeated = repeatLimit > 0 && message.count > repeatLimit;
+		if (repeated && now - message.lastReport < REPORT_INTERVAL)
+		{
+			++message.suppressed;
+			++totalSuppressed;
+			return false;
+		}
+
+		if (now - windowStart >= std::chrono::seconds(1))
+		{
+			windowStart = now;
+			windowCount = 0;
+		}
+
+		// Rate-dropped copies keep counting, so the next report still includes them.
+		if (maxPerSecond > 0 && windowCount >= maxPerSecond)
+		{
+			++message.suppressed;
+			++totalSuppressed;
+			++rateDropped;
+			return false;
+		}
+
+		if (repeated)
+		{
+			note = "Repeated " + std::to_string(message.suppressed) + " more times since the last report. ";
+			message.suppressed = 0;
+		}
+		else if (repeatLimit > 0 && message.count == repeatLimit)
+		{
+			note = "Logged " + std::to_string(repeatLimit) + " times, further copies are suppressed. ";
+		}
+
+		if (rateDropped > 0)
+		{
+			note += std::to_string(rateDropped) + " messages were dropped over the rate limit. ";
+			rateDropped = 0;
+		}
+
+		++windowCount;
+		message.lastReport = now;
+		return true;
+	}
+
+	uint64_t DebugMessageFilter::getSuppressedCount()
+	{
+		std::lock_guard lock(mutex);
+		return totalSuppressed;
+	}
+
+}
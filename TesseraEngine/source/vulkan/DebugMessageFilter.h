@@ -0,0 +1,57 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace tessera::vulkan
+{
+
+	/**
+	 * @brief Decides which debug messenger messages reach the log, so repeated warnings cannot swamp a frame.
+	 *
+	 * Messages are told apart by their ID. Each ID is logged repeatLimit times; later copies are only
+	 * counted, and reported at most every REPORT_INTERVAL along with the message. On top of that, at most
+	 * maxPerSecond messages are logged per second over all IDs. Dropped counts are added to the next
+	 * message logged. Thread-safe, since layers call the messenger from whichever thread calls Vulkan.
+	 */
+	class DebugMessageFilter final
+	{
+	public:
+		// 0 disables the respective limit.
+		void configure(uint32_t repeatLimit, uint32_t maxPerSecond);
+
+		/**
+		 * @brief Count a message and decide whether to log it.
+		 *
+		 * @param note Set to what was suppressed since the last report, to be logged along with the message; empty otherwise.
+		 * @return Whether the message should be logged.
+		 */
+		[[nodiscard]] bool admit(uint64_t messageId, std::string& note);
+
+		[[nodiscard]] uint64_t getSuppressedCount();
+	private:
+		struct MessageHistory
+		{
+			uint64_t count = 0;
+			// Copies not logged since the last report.
+			uint64_t suppressed = 0;
+			std::chrono::steady_clock::time_point lastReport;
+		};
+
+		std::mutex mutex;
+		std::unordered_map<uint64_t, MessageHistory> history;
+		uint32_t repeatLimit = 0;
+		uint32_t maxPerSecond = 0;
+
+		std::chrono::steady_clock::time_point windowStart;
+		uint32_t windowCount = 0;
+		// Messages over the rate limit since the last one logged.
+		uint64_t rateDropped = 0;
+		uint64_t totalSuppressed = 0;
+
+		static constexpr std::chrono::seconds REPORT_INTERVAL{ 5 };
+	};
+
+}
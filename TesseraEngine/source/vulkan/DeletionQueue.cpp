@@ -0,0 +1,57 @@
+#include "DeletionQueue.h"
+
+#include <vector>
+
+#include "QueueManager.h"
+#include "utils/interfaces/ServiceLocator.h"
+
+namespace tessera::vulkan
+{
+
+	void DeletionQueue::resolveServices()
+	{
+		queueManager = ServiceLocator::getServicePointer<QueueManager>();
+	}
+
+	void DeletionQueue::push(std::function<void()> deleter)
+	{
+		std::lock_guard lock(deletionMutex);
+
+		// Frame numbers only grow, so the deque stays sorted by retire frame.
+		const uint64_t submittedFrames = queueManager != nullptr ? queueManager->getFrameNumber() : 0;
+		pendingDeletions.push_back({ submittedFrames, std::move(deleter) });
+	}
+
+	void DeletionQueue::collect(const uint64_t completedFrames)
+	{
+		std::vector<std::function<void()>> deleters;
+
+		{
+			std::lock_guard lock(deletionMutex);
+
+			while (!pendingDeletions.empty() && pendingDeletions.front().retireFrame <= completedFrames)
+			{
+				deleters.emplace_back(std::move(pendingDeletions.front().deleter));
+				pendingDeletions.pop_front();
+			}
+		}
+
+		// Deleters may push replacements of their own, so they run outside the lock.
+		for (const auto& deleter : deleters)
+		{
+			deleter();
+		}
+	}
+
+	void DeletionQueue::clean()
+	{
+		// Application idles the device before cleaning, so everything left is safe to destroy.
+		while (!pendingDeletions.empty())
+		{
+			const auto deleter = std::move(pendingDeletions.front().deleter);
+			pendingDeletions.pop_front();
+			deleter();
+		}
+	}
+
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+#include "utils/interfaces/Initializable.h"
+
+namespace tessera::vulkan
+{
+
+	class QueueManager;
+
+	/**
+	 * @brief Destroys GPU objects once every frame that may still use them has retired.
+	 *
+	 * Deleters are tagged with the number of frames submitted when they were pushed and run from the
+	 * frame loop once that many frames completed, so replacing a resource never waits for the device to idle.
+	 */
+	class DeletionQueue final : public Initializable
+	{
+	public:
+		void clean() override;
+		void resolveServices() override;
+
+		// Callable from any thread, including ThreadPool workers and completions.
+		void push(std::function<void()> deleter);
+
+		// Run the deleters of every frame up to completedFrames.
+		void collect(uint64_t completedFrames);
+	private:
+		struct PendingDeletion
+		{
+			uint64_t retireFrame = 0;
+			std::function<void()> deleter;
+		};
+
+		QueueManager* queueManager = nullptr;
+
+		std::mutex deletionMutex;
+		std::deque<PendingDeletion> pendingDeletions;
+	};
+
+}
@@ -0,0 +1,118 @@
+#include "DescriptorAllocator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace tessera::vulkan
+{
+
+	void DescriptorAllocator::create(const VkDevice logicalDevice, const uint32_t setsPerPool, const std::vector<DescriptorRatio>& descriptorRatios)
+	{
+		device = logicalDevice;
+		poolSets = setsPerPool;
+		ratios = descriptorRatios;
+	}
+
+	VkDescriptorSet DescriptorAllocator::allocate(const VkDescriptorSetLayout layout)
+	{
+		if (currentPool == VK_NULL_HANDLE)
+		{
+			currentPool = acquirePool();
+		}
+
+		VkDescriptorSetAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocInfo.descriptorPool = currentPool;
+		allocInfo.descriptorSetCount = 1;
+		allocInfo.pSetLayouts = &layout;
+
+		VkDescriptorSet descriptorSet;
+		VkResult result = vkAllocateDescriptorSets(device, &allocInfo, &descriptorSet);
+
+		// Exhausted pools are left alone until the next reset; a fresh one always fits a single set.
+		if (result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL)
+		{
+			currentPool = acquirePool();
+			allocInfo.descriptorPool = currentPool;
+			result = vkAllocateDescriptorSets(device, &allocInfo, &descriptorSet);
+		}
+
+		if (result != VK_SUCCESS)
+		{
+			throw std::runtime_error("DescriptorAllocator: failed to allocate descriptor set.");
+		}
+
+		return descriptorSet;
+	}
+
+	void DescriptorAllocator::reset()
+	{
+		for (const VkDescriptorPool pool : usedPools)
+		{
+			vkResetDescriptorPool(device, pool, 0);
+			freePools.push_back(pool);
+		}
+
+		usedPools.clear();
+		currentPool = VK_NULL_HANDLE;
+	}
+
+	VkDescriptorPool DescriptorAllocator::acquirePool()
+	{
+		VkDescriptorPool pool;
+		if (!freePools.empty())
+		{
+			pool = freePools.back();
+			freePools.pop_back();
+		}
+		else
+		{
+			pool = createPool();
+		}
+
+		usedPools.push_back(pool);
+		return pool;
+	}
+
+	VkDescriptorPool DescriptorAllocator::createPool() const
+	{
+		std::vector<VkDescriptorPoolSize> poolSizes;
+		poolSizes.reserve(ratios.size());
+		for (const auto& [type, perSet] : ratios)
+		{
+			poolSizes.push_back({ type, std::max(1u, static_cast<uint32_t>(std::ceil(perSet * static_cast<float>(poolSets)))) });
+		}
+
+		VkDescriptorPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolInfo.maxSets = poolSets;
+		poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+		poolInfo.pPoolSizes = poolSizes.data();
+
+		VkDescriptorPool pool;
+		if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &pool) != VK_SUCCESS)
+		{
+			throw std::runtime_error("DescriptorAllocator: failed to create descriptor pool.");
+		}
+
+		return pool;
+	}
+
+	void DescriptorAllocator::destroy()
+	{
+		for (const VkDescriptorPool pool : usedPools)
+		{
+			vkDestroyDescriptorPool(device, pool, nullptr);
+		}
+		for (const VkDescriptorPool pool : freePools)
+		{
+			vkDestroyDescriptorPool(device, pool, nullptr);
+		}
+
+		usedPools.clear();
+		freePools.clear();
+		currentPool = VK_NULL_HANDLE;
+	}
+
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+namespace tessera::vulkan
+{
+
+	// Descriptors of one type reserved per set a pool is sized for.
+	struct DescriptorRatio
+	{
+		VkDescriptorType type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		float perSet = 1.0f;
+	};
+
+	/**
+	 * @brief Linear descriptor set allocator recycled in bulk.
+	 *
+	 * Sets come from a list of pools created without FREE_DESCRIPTOR_SET_BIT, so allocation is a pointer
+	 * bump in the driver. A new pool is added whenever the current one runs out, and reset() returns every
+	 * set at once with vkResetDescriptorPool, keeping the pools for the next round.
+	 */
+	class DescriptorAllocator final
+	{
+	public:
+		void create(VkDevice logicalDevice, uint32_t setsPerPool, const std::vector<DescriptorRatio>& descriptorRatios);
+		void destroy();
+
+		[[nodiscard]] VkDescriptorSet allocate(VkDescriptorSetLayout layout);
+		// Only valid once nothing executing on the GPU uses the sets any more.
+		void reset();
+
+		[[nodiscard]] size_t getPoolCount() const { return usedPools.size() + freePools.size(); }
+	private:
+		[[nodiscard]] VkDescriptorPool acquirePool();
+		[[nodiscard]] VkDescriptorPool createPool() const;
+
+		VkDevice device = VK_NULL_HANDLE;
+		uint32_t poolSets = 0;
+		std::vector<DescriptorRatio> ratios;
+
+		VkDescriptorPool currentPool = VK_NULL_HANDLE;
+		// Every pool allocated from since the last reset, including the current one.
+		std::vector<VkDescriptorPool> usedPools;
+		std::vector<VkDescriptorPool> freePools;
+	};
+
+}
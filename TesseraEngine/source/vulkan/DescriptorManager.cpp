@@ -0,0 +1,229 @@
+#include "DescriptorManager.h"
+
+#include <array>
+#include <stdexcept>
+#include <string>
+
+#include "CommandBufferManager.h"
+#include "DeletionQueue.h"
+#include "DeviceManager.h"
+#include "utils/EngineConfig.h"
+#include "utils/TesseraLog.h"
+#include "utils/interfaces/ServiceLocator.h"
+
+namespace tessera::vulkan
+{
+
+	void DescriptorManager::init()
+	{
+		Initializable::init();
+		const auto& deviceManager = ServiceLocator::getService<DeviceManager>();
+		device = deviceManager->getLogicalDevice();
+		deletionQueue = ServiceLocator::getServicePointer<DeletionQueue>();
+
+		// Sized for a few uniform and storage buffers and textures per set; pools are added as frames need more.
+		const std::vector<DescriptorRatio> ratios = {
+			{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2.0f },
+			{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1.0f },
+			{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2.0f },
+			{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4.0f }
+		};
+
+		frameAllocators.resize(CommandBufferManager::queryFramesInFlight());
+		for (auto& allocator : frameAllocators)
+		{
+			allocator.create(device, FRAME_SETS_PER_POOL, ratios);
+		}
+
+		const bool bindlessRequested = ServiceLocator::getService<EngineConfig>()->getBool("render.bindless", true);
+		if (bindlessRequested && !deviceManager->getCapabilities().descriptorIndexing)
+		{
+			TesseraLog::send(LogType::INFO, "DescriptorManager", "Descriptor indexing is not supported, bindless tables are disabled.");
+		}
+
+		if (bindlessRequested && deviceManager->getCapabilities().descriptorIndexing)
+		{
+			createBindlessSet();
+			bindlessEnabled = true;
+		}
+	}
+
+	void DescriptorManager::createBindlessSet()
+	{
+		textures.capacity = MAX_BINDLESS_TEXTURES;
+		buffers.capacity = MAX_BINDLESS_BUFFERS;
+
+		const std::array<VkDescriptorSetLayoutBinding, 2> bindings = { {
+			{ BINDLESS_TEXTURE_BINDING, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, textures.capacity, VK_SHADER_STAGE_ALL, nullptr },
+			{ BINDLESS_BUFFER_BINDING, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, buffers.capacity, VK_SHADER_STAGE_ALL, nullptr }
+		} };
+
+		// Slots are written while frames using other slots execute, and most of them are never written at all.
+		constexpr VkDescriptorBindingFlags bindingFlag = VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT
+			| VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT;
+		const std::array<VkDescriptorBindingFlags, 2> bindingFlags = { bindingFlag, bindingFlag };
+
+		VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{};
+		bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+		bindingFlagsInfo.bindingCount = static_cast<uint32_t>(bindingFlags.size());
+		bindingFlagsInfo.pBindingFlags = bindingFlags.data();
+
+		VkDescriptorSetLayoutCreateInfo layoutInfo{};
+		layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		layoutInfo.pNext = &bindingFlagsInfo;
+		layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+		layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+		layoutInfo.pBindings = bindings.data();
+
+		if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &bindlessLayout) != VK_SUCCESS)
+		{
+			throw std::runtime_error("DescriptorManager: failed to create bindless descriptor set layout.");
+		}
+
+		const std::array<VkDescriptorPoolSize, 2> poolSizes = { {
+			{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, textures.capacity },
+			{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, buffers.capacity }
+		} };
+
+		VkDescriptorPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+		poolInfo.maxSets = 1;
+		poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+		poolInfo.pPoolSizes = poolSizes.data();
+
+		if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &bindlessPool) != VK_SUCCESS)
+		{
+			throw std::runtime_error("DescriptorManager: failed to create bindless descriptor pool.");
+		}
+
+		VkDescriptorSetAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocInfo.descriptorPool = bindlessPool;
+		allocInfo.descriptorSetCount = 1;
+		allocInfo.pSetLayouts = &bindlessLayout;
+
+		if (vkAllocateDescriptorSets(device, &allocInfo, &bindlessSet) != VK_SUCCESS)
+		{
+			throw std::runtime_error("DescriptorManager: failed to allocate bindless descriptor set.");
+		}
+
+		TESSERA_LOG(LogType::DEBUG, "DescriptorManager", "Bindless tables hold " + std::to_string(textures.capacity) + " textures and "
+			+ std::to_string(buffers.capacity) + " storage buffers.");
+	}
+
+	void DescriptorManager::resetFrame(const int frame)
+	{
+		frameAllocators.at(frame).reset();
+	}
+
+	VkDescriptorSet DescriptorManager::allocateFrameSet(const int frame, const VkDescriptorSetLayout layout)
+	{
+		return frameAllocators.at(frame).allocate(layout);
+	}
+
+	BindlessIndex DescriptorManager::addTexture(const VkImageView imageView, const VkSampler sampler, const VkImageLayout layout)
+	{
+		std::lock_guard lock(bindlessMutex);
+		const BindlessIndex index = acquireIndex(textures, "texture");
+
+		VkDescriptorImageInfo imageInfo{};
+		imageInfo.sampler = sampler;
+		imageInfo.imageView = imageView;
+		imageInfo.imageLayout = layout;
+
+		VkWriteDescriptorSet write{};
+		write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		write.dstSet = bindlessSet;
+		write.dstBinding = BINDLESS_TEXTURE_BINDING;
+		write.dstArrayElement = index;
+		write.descriptorCount = 1;
+		write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		write.pImageInfo = &imageInfo;
+
+		vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+		return index;
+	}
+
+	BindlessIndex DescriptorManager::addBuffer(const VkBuffer buffer, const VkDeviceSize offset, const VkDeviceSize range)
+	{
+		std::lock_guard lock(bindlessMutex);
+		const BindlessIndex index = acquireIndex(buffers, "buffer");
+
+		VkDescriptorBufferInfo bufferInfo{};
+		bufferInfo.buffer = buffer;
+		bufferInfo.offset = offset;
+		bufferInfo.range = range;
+
+		VkWriteDescriptorSet write{};
+		write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		write.dstSet = bindlessSet;
+		write.dstBinding = BINDLESS_BUFFER_BINDING;
+		write.dstArrayElement = index;
+		write.descriptorCount = 1;
+		write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		write.pBufferInfo = &bufferInfo;
+
+		vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+		return index;
+	}
+
+	void DescriptorManager::removeTexture(const BindlessIndex index)
+	{
+		releaseIndex(textures, index);
+	}
+
+	void DescriptorManager::removeBuffer(const BindlessIndex index)
+	{
+		releaseIndex(buffers, index);
+	}
+
+	BindlessIndex DescriptorManager::acquireIndex(BindlessTable& table, const char* tableName)
+	{
+		if (!bindlessEnabled)
+		{
+			throw std::runtime_error("DescriptorManager: bindless tables are disabled.");
+		}
+
+		if (!table.freeIndices.empty())
+		{
+			const BindlessIndex index = table.freeIndices.back();
+			table.freeIndices.pop_back();
+			return index;
+		}
+
+		if (table.nextIndex == table.capacity)
+		{
+			throw std::runtime_error(std::string("DescriptorManager: bindless ") + tableName + " table is full.");
+		}
+
+		return table.nextIndex++;
+	}
+
+	void DescriptorManager::releaseIndex(BindlessTable& table, const BindlessIndex index)
+	{
+		// The slot keeps its descriptor, which is only overwritten once no frame can read it.
+		deletionQueue->push([this, &table, index]
+			{
+				std::lock_guard lock(bindlessMutex);
+				table.freeIndices.push_back(index);
+			});
+	}
+
+	void DescriptorManager::clean()
+	{
+		for (auto& allocator : frameAllocators)
+		{
+			allocator.destroy();
+		}
+		frameAllocators.clear();
+
+		if (bindlessEnabled)
+		{
+			vkDestroyDescriptorPool(device, bindlessPool, nullptr);
+			vkDestroyDescriptorSetLayout(device, bindlessLayout, nullptr);
+			bindlessEnabled = false;
+		}
+	}
+
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+#include "DescriptorAllocator.h"
+#include "utils/interfaces/Initializable.h"
+
+namespace tessera::vulkan
+{
+
+	class DeletionQueue;
+
+	using BindlessIndex = uint32_t;
+
+	// Material index pushed before every draw whose material differs from the previous one; read by shaders as an index into the bindless tables.
+	struct MaterialConstants
+	{
+		uint32_t material = 0;
+	};
+
+	/**
+	 * @brief Per-frame descriptor sets and the bindless resource tables.
+	 *
+	 * Sets allocated for a frame come from a DescriptorAllocator of that frame in flight and are all
+	 * recycled by resetFrame(). With descriptor indexing the engine also keeps one global set of
+	 * update-after-bind arrays, BINDLESS_TEXTURE_BINDING and BINDLESS_BUFFER_BINDING, bound once per
+	 * command buffer: resources are registered once and shaders pick them by index, so switching
+	 * materials is a push constant instead of a descriptor set bind.
+	 *
+	 * Enabled by render.bindless on devices supporting descriptor indexing.
+	 */
+	class DescriptorManager final : public Initializable
+	{
+	public:
+		void init() override;
+		void clean() override;
+
+		// Only valid once the frame's in-flight fence has signaled.
+		void resetFrame(int frame);
+		// Valid until the frame slot is reset again.
+		[[nodiscard]] VkDescriptorSet allocateFrameSet(int frame, VkDescriptorSetLayout layout);
+
+		[[nodiscard]] bool isBindlessEnabled() const { return bindlessEnabled; }
+		// VK_NULL_HANDLE without bindless tables.
+		[[nodiscard]] VkDescriptorSetLayout getBindlessLayout() const { return bindlessLayout; }
+		[[nodiscard]] VkDescriptorSet getBindlessSet() const { return bindlessSet; }
+
+		// Register a resource in the bindless tables. Safe to call while frames using the tables are recorded or executing.
+		[[nodiscard]] BindlessIndex addTexture(VkImageView imageView, VkSampler sampler, VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		[[nodiscard]] BindlessIndex addBuffer(VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+		// The index is handed out again once the frames in flight, which may still read it, have retired.
+		void removeTexture(BindlessIndex index);
+		void removeBuffer(BindlessIndex index);
+
+		// Set index in the layout of the main pipelines; FRAME_SET of the UniformManager comes first.
+		static constexpr uint32_t BINDLESS_SET = 1;
+		static constexpr uint32_t BINDLESS_TEXTURE_BINDING = 0;
+		static constexpr uint32_t BINDLESS_BUFFER_BINDING = 1;
+	private:
+		// Indices of one binding of the bindless set.
+		struct BindlessTable
+		{
+			uint32_t capacity = 0;
+			uint32_t nextIndex = 0;
+			std::vector<BindlessIndex> freeIndices;
+		};
+
+		void createBindlessSet();
+		[[nodiscard]] BindlessIndex acquireIndex(BindlessTable& table, const char* tableName);
+		void releaseIndex(BindlessTable& table, BindlessIndex index);
+
+		VkDevice device = VK_NULL_HANDLE;
+		DeletionQueue* deletionQueue = nullptr;
+		std::vector<DescriptorAllocator> frameAllocators;
+
+		bool bindlessEnabled = false;
+		VkDescriptorSetLayout bindlessLayout = VK_NULL_HANDLE;
+		VkDescriptorPool bindlessPool = VK_NULL_HANDLE;
+		VkDescriptorSet bindlessSet = VK_NULL_HANDLE;
+		// Guards the tables and writes to the bindless set, which must be externally synchronized.
+		std::mutex bindlessMutex;
+		BindlessTable textures;
+		BindlessTable buffers;
+
+		static constexpr uint32_t FRAME_SETS_PER_POOL = 256;
+		// Far below the update-after-bind limits every device with descriptor indexing guarantees (500000).
+		static constexpr uint32_t MAX_BINDLESS_TEXTURES = 16384;
+		static constexpr uint32_t MAX_BINDLESS_BUFFERS = 16384;
+	};
+
+}
@@ -0,0 +1,155 @@
+#include "DeviceCapabilities.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include "ExtensionManager.h"
+#include "utils/TesseraLog.h"
+
+namespace tessera::vulkan
+{
+
+	DeviceCapabilities DeviceCapabilities::query(const VkPhysicalDevice physicalDevice, const uint32_t instanceApiVersion)
+	{
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+		// Core entry points are used rather than extension aliases, so both the instance and the device need the version.
+		const uint32_t apiVersion = std::min(instanceApiVersion, properties.apiVersion);
+
+		VkPhysicalDeviceVulkan13Features vulkan13Features{};
+		vulkan13Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+
+		VkPhysicalDeviceVulkan12Features vulkan12Features{};
+		vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+		vulkan12Features.pNext = apiVersion >= VK_API_VERSION_1_3 ? &vulkan13Features : nullptr;
+
+		VkPhysicalDeviceFeatures2 features{};
+		features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		features.pNext = apiVersion >= VK_API_VERSION_1_2 ? &vulkan12Features : nullptr;
+
+		// vkGetPhysicalDeviceFeatures2 is core from 1.1; older devices only report the core features.
+		if (apiVersion >= VK_API_VERSION_1_1)
+		{
+			vkGetPhysicalDeviceFeatures2(physicalDevice, &features);
+		}
+		else
+		{
+			vkGetPhysicalDeviceFeatures(physicalDevice, &features.features);
+		}
+
+		DeviceCapabilities capabilities;
+		capabilities.drawIndirectFirstInstance = features.features.drawIndirectFirstInstance == VK_TRUE;
+		capabilities.multiDrawIndirect = features.features.multiDrawIndirect == VK_TRUE;
+		capabilities.timelineSemaphore = vulkan12Features.timelineSemaphore == VK_TRUE;
+		capabilities.hostQueryReset = vulkan12Features.hostQueryReset == VK_TRUE;
+		capabilities.drawIndirectCount = vulkan12Features.drawIndirectCount == VK_TRUE;
+
+		// Bindless tables need every one of these, so they are enabled together or not at all.
+		capabilities.descriptorIndexing = vulkan12Features.descriptorIndexing && vulkan12Features.runtimeDescriptorArray
+			&& vulkan12Features.shaderSampledImageArrayNonUniformIndexing && vulkan12Features.descriptorBindingPartiallyBound
+			&& vulkan12Features.descriptorBindingSampledImageUpdateAfterBind && vulkan12Features.descriptorBindingStorageBufferUpdateAfterBind
+			&& vulkan12Features.descriptorBindingUpdateUnusedWhilePending;
+		capabilities.storageBufferNonUniformIndexing = capabilities.descriptorIndexing && vulkan12Features.shaderStorageBufferArrayNonUniformIndexing;
+
+		capabilities.bufferDeviceAddress = vulkan12Features.bufferDeviceAddress == VK_TRUE;
+		capabilities.dynamicRendering = vulkan13Features.dynamicRendering == VK_TRUE;
+		capabilities.synchronization2 = vulkan13Features.synchronization2 == VK_TRUE;
+
+		// Queried through vkGetPhysicalDeviceMemoryProperties2, which is core from 1.1.
+		capabilities.memoryBudget = apiVersion >= VK_API_VERSION_1_1 && isDeviceExtensionSupported(physicalDevice, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+		return capabilities;
+	}
+
+	void DeviceCapabilities::disable(const std::string& names)
+	{
+		std::stringstream stream(names);
+		std::string name;
+		while (std::getline(stream, name, ','))
+		{
+			name.erase(0, name.find_first_not_of(" \t"));
+			name.erase(name.find_last_not_of(" \t") + 1);
+			if (name.empty())
+			{
+				continue;
+			}
+
+			const auto flag = std::ranges::find_if(FLAGS, [&](const auto& entry) { return name == entry.first; });
+			if (flag == FLAGS.end())
+			{
+				TesseraLog::send(LogType::WARNING, "DeviceCapabilities", "Unknown capability " + name + " in device.disableFeatures.");
+				continue;
+			}
+
+			this->*flag->second = false;
+		}
+
+		storageBufferNonUniformIndexing = storageBufferNonUniformIndexing && descriptorIndexing;
+	}
+
+	std::vector<const char*> DeviceCapabilities::getExtensionNames() const
+	{
+		std::vector<const char*> extensions;
+		if (memoryBudget)
+		{
+			extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+		}
+
+		return extensions;
+	}
+
+	std::string DeviceCapabilities::toString() const
+	{
+		std::string names;
+		for (const auto& [name, flag] : FLAGS)
+		{
+			if (this->*flag)
+			{
+				names += names.empty() ? name : std::string(", ") + name;
+			}
+		}
+
+		return names.empty() ? "none" : names;
+	}
+
+	DeviceFeatureChain::DeviceFeatureChain(const DeviceCapabilities& capabilities)
+	{
+		features.drawIndirectFirstInstance = capabilities.drawIndirectFirstInstance ? VK_TRUE : VK_FALSE;
+		features.multiDrawIndirect = capabilities.multiDrawIndirect ? VK_TRUE : VK_FALSE;
+
+		vulkan13Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+		vulkan13Features.dynamicRendering = capabilities.dynamicRendering ? VK_TRUE : VK_FALSE;
+		vulkan13Features.synchronization2 = capabilities.synchronization2 ? VK_TRUE : VK_FALSE;
+
+		vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+		vulkan12Features.timelineSemaphore = capabilities.timelineSemaphore ? VK_TRUE : VK_FALSE;
+		vulkan12Features.hostQueryReset = capabilities.hostQueryReset ? VK_TRUE : VK_FALSE;
+		vulkan12Features.drawIndirectCount = capabilities.drawIndirectCount ? VK_TRUE : VK_FALSE;
+		vulkan12Features.bufferDeviceAddress = capabilities.bufferDeviceAddress ? VK_TRUE : VK_FALSE;
+
+		if (capabilities.descriptorIndexing)
+		{
+			vulkan12Features.descriptorIndexing = VK_TRUE;
+			vulkan12Features.runtimeDescriptorArray = VK_TRUE;
+			vulkan12Features.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+			vulkan12Features.shaderStorageBufferArrayNonUniformIndexing = capabilities.storageBufferNonUniformIndexing ? VK_TRUE : VK_FALSE;
+			vulkan12Features.descriptorBindingPartiallyBound = VK_TRUE;
+			vulkan12Features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+			vulkan12Features.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+			vulkan12Features.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+		}
+
+		// Prepended, so the chain ends up in version order.
+		if (capabilities.dynamicRendering || capabilities.synchronization2)
+		{
+			next = &vulkan13Features;
+		}
+		if (capabilities.timelineSemaphore || capabilities.hostQueryReset || capabilities.drawIndirectCount || capabilities.descriptorIndexing
+			|| capabilities.bufferDeviceAddress)
+		{
+			vulkan12Features.pNext = next;
+			next = &vulkan12Features;
+		}
+	}
+
+}
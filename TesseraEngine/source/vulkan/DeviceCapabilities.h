@@ -0,0 +1,96 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+namespace tessera::vulkan
+{
+
+	/**
+	 * @brief Optional device features and extensions the engine makes use of, as one flag each.
+	 *
+	 * query() reads the features from the VkPhysicalDeviceFeatures2 chain of every version that both the instance
+	 * and the device support, and the extensions from the device's extension list. DeviceManager enables what is supported and not disabled by device.disableFeatures,
+	 * and the rest of the engine branches on what was enabled, see DeviceManager::getCapabilities().
+	 */
+	struct DeviceCapabilities
+	{
+		// Indirect draws may carry a non-zero firstInstance, which GPU-driven drawing uses as the object index.
+		bool drawIndirectFirstInstance = false;
+		// One indirect call may issue more than one draw.
+		bool multiDrawIndirect = false;
+		// Frames and uploads are paced with timeline semaphores instead of fences (Vulkan 1.2).
+		bool timelineSemaphore = false;
+		// Query pools can be reset from the CPU, which queues without graphics or compute support rely on (Vulkan 1.2).
+		bool hostQueryReset = false;
+		// The number of indirect draws may be read from a buffer with vkCmdDrawIndexedIndirectCount (Vulkan 1.2).
+		bool drawIndirectCount = false;
+		// Partially bound, update-after-bind descriptor arrays indexed dynamically in shaders, as bindless tables need (Vulkan 1.2).
+		bool descriptorIndexing = false;
+		// Storage buffer arrays may be indexed non-uniformly too. Only with descriptorIndexing.
+		bool storageBufferNonUniformIndexing = false;
+		// Buffers may be accessed through 64 bit addresses in shaders (Vulkan 1.2).
+		bool bufferDeviceAddress = false;
+		// Passes may render into image views with vkCmdBeginRendering, without render pass and framebuffer objects (Vulkan 1.3).
+		bool dynamicRendering = false;
+		// vkCmdPipelineBarrier2 and vkQueueSubmit2 with 64 bit stage and access masks (Vulkan 1.3).
+		bool synchronization2 = false;
+		// Heap usage and budget of the process can be queried along the memory properties (VK_EXT_memory_budget).
+		bool memoryBudget = false;
+
+		using Flag = bool DeviceCapabilities::*;
+		// Names used by device.disableFeatures and the log.
+		static constexpr std::array<std::pair<const char*, Flag>, 11> FLAGS = { {
+			{ "drawIndirectFirstInstance", &DeviceCapabilities::drawIndirectFirstInstance },
+			{ "multiDrawIndirect", &DeviceCapabilities::multiDrawIndirect },
+			{ "timelineSemaphore", &DeviceCapabilities::timelineSemaphore },
+			{ "hostQueryReset", &DeviceCapabilities::hostQueryReset },
+			{ "drawIndirectCount", &DeviceCapabilities::drawIndirectCount },
+			{ "descriptorIndexing", &DeviceCapabilities::descriptorIndexing },
+			{ "storageBufferNonUniformIndexing", &DeviceCapabilities::storageBufferNonUniformIndexing },
+			{ "bufferDeviceAddress", &DeviceCapabilities::bufferDeviceAddress },
+			{ "dynamicRendering", &DeviceCapabilities::dynamicRendering },
+			{ "synchronization2", &DeviceCapabilities::synchronization2 },
+			{ "memoryBudget", &DeviceCapabilities::memoryBudget }
+		} };
+
+		[[nodiscard]] static DeviceCapabilities query(VkPhysicalDevice physicalDevice, uint32_t instanceApiVersion);
+
+		// Clear the flags named in a comma separated list. Unknown names are reported and ignored.
+		void disable(const std::string& names);
+
+		// Device extensions to enable for the set flags.
+		[[nodiscard]] std::vector<const char*> getExtensionNames() const;
+
+		// Names of the set flags, comma separated.
+		[[nodiscard]] std::string toString() const;
+	};
+
+	/**
+	 * @brief Feature structures enabling exactly the given capabilities, to chain into VkDeviceCreateInfo.
+	 *
+	 * The version structures are only chained when a capability of their version is enabled, since they
+	 * may not be chained at all on devices of an older version.
+	 */
+	class DeviceFeatureChain final
+	{
+	public:
+		explicit DeviceFeatureChain(const DeviceCapabilities& capabilities);
+
+		// Points into itself.
+		DeviceFeatureChain(const DeviceFeatureChain&) = delete;
+		DeviceFeatureChain& operator=(const DeviceFeatureChain&) = delete;
+
+		[[nodiscard]] const VkPhysicalDeviceFeatures* getFeatures() const { return &features; }
+		[[nodiscard]] const void* getNext() const { return next; }
+	private:
+		VkPhysicalDeviceFeatures features{};
+		VkPhysicalDeviceVulkan12Features vulkan12Features{};
+		VkPhysicalDeviceVulkan13Features vulkan13Features{};
+		void* next = nullptr;
+	};
+
+}
@@ -9,6 +9,8 @@
 #include "InstanceManager.h"
 #include "QueueManager.h"
 #include "SurfaceManager.h"
+#include "utils/EngineConfig.h"
+#include "utils/TesseraLog.h"
 #include "utils/interfaces/ServiceLocator.h"
 
 namespace tessera::vulkan
@@ -16,17 +18,19 @@ namespace tessera::vulkan
 
 	void DeviceManager::init()
 	{
-		const auto& instance = ServiceLocator::getService<InstanceManager>()->getInstance();
+		const auto& instanceManager = ServiceLocator::getService<InstanceManager>();
+		const auto& instance = instanceManager->getInstance();
 		const auto& surface = ServiceLocator::getService<SurfaceManager>()->getSurface();
 
-		physicalDeviceManager.pickAnySuitableDevice(instance, surface);
+		physicalDeviceManager.pickBestDevice(instance, surface, instanceManager->getApiVersion(),
+			ServiceLocator::getService<EngineConfig>()->getString("device.preferred", ""));
 		const auto physicalDevice = physicalDeviceManager.getPhysicalDevice();
 		assert(physicalDevice);
 
-		const auto [graphicsFamily, presentFamily] = findQueueFamilies(physicalDevice, surface);
-		std::set uniqueQueueFamilies = { graphicsFamily.value(), presentFamily.value() };
+		const auto [graphicsFamily, presentFamily, transferFamily, computeFamily, computeQueueIndex] = findQueueFamilies(physicalDevice, surface);
+		std::set uniqueQueueFamilies = { graphicsFamily.value(), presentFamily.value(), transferFamily.value(), computeFamily.value() };
 
-		constexpr float queuePriority = 1.0f;
+		constexpr float queuePriorities[] = { 1.0f, 1.0f };
 		std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
 
 		for (uint32_t queueFamily : uniqueQueueFamilies) 
@@ -34,21 +38,28 @@ namespace tessera::vulkan
 			VkDeviceQueueCreateInfo queueCreateInfo{};
 			queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
 			queueCreateInfo.queueFamilyIndex = queueFamily;
-			queueCreateInfo.queueCount = 1;
-			queueCreateInfo.pQueuePriorities = &queuePriority;
+			queueCreateInfo.queueCount = queueFamily == computeFamily.value() ? computeQueueIndex + 1 : 1;
+			queueCreateInfo.pQueuePriorities = queuePriorities;
 			queueCreateInfos.emplace_back(queueCreateInfo);
 		}
 
-		// Specifying used device features.
-		constexpr VkPhysicalDeviceFeatures deviceFeatures{};
+		// Every optional feature the device supports is enabled, unless the config turns it off to compare or work around a driver.
+		capabilities = DeviceCapabilities::query(physicalDevice, instanceManager->getApiVersion());
+		capabilities.disable(ServiceLocator::getService<EngineConfig>()->getString("device.disableFeatures", ""));
+		const DeviceFeatureChain enabledFeatures(capabilities);
 
 		VkDeviceCreateInfo createInfo{};
 		createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+		createInfo.pNext = enabledFeatures.getNext();
 		createInfo.pQueueCreateInfos = queueCreateInfos.data();
 		createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
-		createInfo.pEnabledFeatures = &deviceFeatures;
+		createInfo.pEnabledFeatures = enabledFeatures.getFeatures();
 
-		const auto requiredExtensions = getRequiredDeviceExtensions();
+		auto requiredExtensions = getRequiredDeviceExtensions();
+		for (const char* extension : capabilities.getExtensionNames())
+		{
+			requiredExtensions.push_back(extension);
+		}
 		createInfo.enabledExtensionCount = static_cast<uint32_t>(requiredExtensions.size());
 		createInfo.ppEnabledExtensionNames = requiredExtensions.data();
 
@@ -69,6 +80,7 @@ namespace tessera::vulkan
 			throw std::runtime_error("VulkanLogicalDeviceManager: failed to create logical device.");
 		}
 
+		TesseraLog::send(LogType::INFO, "DeviceManager", "Enabled capabilities: " + capabilities.toString() + ".");
 	}
 
 	void DeviceManager::clean()
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "DeviceCapabilities.h"
 #include "PhysicalDeviceManager.h"
 #include "utils/interfaces/Initializable.h"
 
@@ -16,9 +17,13 @@ namespace tessera::vulkan
 
 		[[nodiscard]] VkDevice getLogicalDevice() const { return logicalDevice; }
 		[[nodiscard]] VkPhysicalDevice getPhysicalDevice() const { return physicalDeviceManager.getPhysicalDevice(); }
+		// What the device was created with: supported, minus device.disableFeatures.
+		[[nodiscard]] const DeviceCapabilities& getCapabilities() const { return capabilities; }
 	private:
 		VkDevice logicalDevice = VK_NULL_HANDLE;
+		DeviceCapabilities capabilities;
 		PhysicalDeviceManager physicalDeviceManager;
+
 	};
 	
 }
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+namespace tessera::vulkan
+{
+
+	// Passes are recorded in this order. Solid draws are grouped by state, blended ones ordered back to front.
+	enum class DrawPass : uint8_t
+	{
+		SOLID,
+		BLENDED
+	};
+
+	// One indexed draw with everything needed to bind it; consecutive draws sharing state skip the rebinds.
+	struct DrawCommand
+	{
+		VkPipeline pipeline = VK_NULL_HANDLE;
+		// Depth-only variant drawn in the depth prepass, required for solid draws with render.depthPrepass. Blended draws
+		// leave it VK_NULL_HANDLE and bring a pipeline testing with LESS, since the main pass pipelines test for EQUAL then.
+		VkPipeline depthPipeline = VK_NULL_HANDLE;
+		VkBuffer vertexBuffer = VK_NULL_HANDLE;
+		VkBuffer indexBuffer = VK_NULL_HANDLE;
+		// Bound to InstanceData::BINDING for instanced pipelines, VK_NULL_HANDLE otherwise.
+		VkBuffer instanceBuffer = VK_NULL_HANDLE;
+		VkDeviceSize instanceOffset = 0;
+		VkIndexType indexType = VK_INDEX_TYPE_UINT16;
+		uint32_t indexCount = 0;
+		uint32_t firstIndex = 0;
+		int32_t vertexOffset = 0;
+		uint32_t instanceCount = 1;
+		uint32_t firstInstance = 0;
+
+		// Index into the material table, pushed as MaterialConstants. Draws sharing a material are kept
+		// together within a pipeline, and only draws of the same material are merged.
+		uint16_t material = 0;
+
+		// Only used to order draws, see DrawSorter.
+		DrawPass pass = DrawPass::SOLID;
+		// View depth of the draw; smaller is nearer.
+		float depth = 0.0f;
+	};
+
+	using DrawList = std::vector<DrawCommand>;
+
+}
@@ -0,0 +1,181 @@
+#include "DrawSorter.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+
+namespace tessera::vulkan
+{
+
+	namespace
+	{
+		// Key layout, from the most significant bit.
+		constexpr uint32_t PASS_BITS = 2;
+		constexpr uint32_t PIPELINE_BITS = 12;
+		constexpr uint32_t MATERIAL_BITS = 16;
+		constexpr uint32_t BUFFER_BITS = 12;
+		constexpr uint32_t DEPTH_BITS = 64 - PASS_BITS - PIPELINE_BITS - MATERIAL_BITS - BUFFER_BITS;
+
+		constexpr uint32_t MAX_STATE_IDS = 1u << std::min(PIPELINE_BITS, BUFFER_BITS);
+
+		// Bits of a non-negative float order like the float itself, so the top bits quantize it monotonically.
+		uint64_t quantizeDepth(const float depth)
+		{
+			const float clamped = std::max(depth, 0.0f);
+			return std::bit_cast<uint32_t>(clamped) >> (32 - DEPTH_BITS - 1);
+		}
+	}
+
+	uint32_t DrawSorter::getStateId(std::unordered_map<uint64_t, uint32_t>& ids, const uint64_t handle)
+	{
+		if (const auto id = ids.find(handle); id != ids.end())
+		{
+			return id->second;
+		}
+
+		// Ids only group equal state, so starting over merely regroups the draws of one frame.
+		if (ids.size() >= MAX_STATE_IDS)
+		{
+			ids.clear();
+		}
+
+		const auto id = static_cast<uint32_t>(ids.size());
+		ids.emplace(handle, id);
+		return id;
+	}
+
+	uint64_t DrawSorter::makeSortKey(const DrawCommand& draw)
+	{
+		const uint64_t pass = static_cast<uint64_t>(draw.pass);
+		const uint64_t pipeline = getStateId(pipelineIds, reinterpret_cast<uint64_t>(draw.pipeline));
+		const uint64_t material = draw.material;
+		const uint64_t buffer = getStateId(bufferIds, reinterpret_cast<uint64_t>(draw.vertexBuffer));
+		const uint64_t depth = quantizeDepth(draw.depth);
+
+		uint64_t key = pass << (64 - PASS_BITS);
+		if (draw.pass == DrawPass::BLENDED)
+		{
+			// Back to front for correct blending; state only breaks ties.
+			constexpr uint64_t depthMask = (uint64_t{1} << DEPTH_BITS) - 1;
+			key |= (depthMask - depth) << (PIPELINE_BITS + MATERIAL_BITS + BUFFER_BITS);
+			key |= pipeline << (MATERIAL_BITS + BUFFER_BITS);
+			key |= material << BUFFER_BITS;
+			key |= buffer;
+		}
+		else
+		{
+			// By state, then front to back so early depth testing rejects hidden fragments.
+			key |= pipeline << (MATERIAL_BITS + BUFFER_BITS + DEPTH_BITS);
+			key |= material << (BUFFER_BITS + DEPTH_BITS);
+			key |= buffer << DEPTH_BITS;
+			key |= depth;
+		}
+
+		return key;
+	}
+
+	bool DrawSorter::tryMerge(DrawCommand& first, const DrawCommand& second)
+	{
+		if (first.pipeline != second.pipeline || first.depthPipeline != second.depthPipeline || first.vertexBuffer != second.vertexBuffer || first.indexBuffer != second.indexBuffer
+			|| first.indexType != second.indexType || first.instanceBuffer != second.instanceBuffer || first.instanceOffset != second.instanceOffset
+			|| first.vertexOffset != second.vertexOffset || first.material != second.material)
+		{
+			return false;
+		}
+
+		// The same geometry with consecutive instances.
+		if (first.firstIndex == second.firstIndex && first.indexCount == second.indexCount && first.firstInstance + first.instanceCount == second.firstInstance)
+		{
+			first.instanceCount += second.instanceCount;
+			return true;
+		}
+
+		// Consecutive index ranges with the same instances.
+		if (first.firstInstance == second.firstInstance && first.instanceCount == second.instanceCount && first.firstIndex + first.indexCount == second.firstIndex)
+		{
+			first.indexCount += second.indexCount;
+			return true;
+		}
+
+		return false;
+	}
+
+	void DrawSorter::sort(DrawList& drawList)
+	{
+		if (drawList.size() < 2)
+		{
+			return;
+		}
+
+		keys.clear();
+		for (size_t i = 0; i < drawList.size(); ++i)
+		{
+			keys.emplace_back(makeSortKey(drawList[i]), static_cast<uint32_t>(i));
+		}
+
+		if (keys.size() < RADIX_SORT_THRESHOLD)
+		{
+			std::ranges::stable_sort(keys, {}, &KeyedDraw::first);
+		}
+		else
+		{
+			radixSort();
+		}
+
+		sortedDraws.clear();
+		for (const auto& [key, index] : keys)
+		{
+			if (sortedDraws.empty() || !tryMerge(sortedDraws.back(), drawList[index]))
+			{
+				sortedDraws.push_back(drawList[index]);
+			}
+		}
+
+		drawList.swap(sortedDraws);
+	}
+
+	void DrawSorter::radixSort()
+	{
+		constexpr uint32_t DIGIT_BITS = 8;
+		constexpr uint32_t DIGIT_COUNT = 64 / DIGIT_BITS;
+		constexpr uint32_t BUCKETS = 1u << DIGIT_BITS;
+
+		// All histograms in one pass over the keys.
+		std::array<std::array<uint32_t, BUCKETS>, DIGIT_COUNT> histograms{};
+		for (const auto& [key, index] : keys)
+		{
+			for (uint32_t digit = 0; digit < DIGIT_COUNT; ++digit)
+			{
+				++histograms[digit][(key >> (digit * DIGIT_BITS)) & (BUCKETS - 1)];
+			}
+		}
+
+		scratchKeys.resize(keys.size());
+		for (uint32_t digit = 0; digit < DIGIT_COUNT; ++digit)
+		{
+			auto& histogram = histograms[digit];
+
+			// Most digits are equal for every key (unused pass bits, few pipelines), so their passes are skipped.
+			const uint64_t firstBucket = (keys.front().first >> (digit * DIGIT_BITS)) & (BUCKETS - 1);
+			if (histogram[firstBucket] == keys.size())
+			{
+				continue;
+			}
+
+			uint32_t offset = 0;
+			for (auto& count : histogram)
+			{
+				const uint32_t bucketSize = count;
+				count = offset;
+				offset += bucketSize;
+			}
+
+			for (const auto& keyedDraw : keys)
+			{
+				scratchKeys[histogram[(keyedDraw.first >> (digit * DIGIT_BITS)) & (BUCKETS - 1)]++] = keyedDraw;
+			}
+			keys.swap(scratchKeys);
+		}
+	}
+
+}
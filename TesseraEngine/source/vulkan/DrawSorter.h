@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+#include "DrawList.h"
+
+namespace tessera::vulkan
+{
+
+	/**
+	 * @brief Orders a draw list to minimize state changes and merges draws that can be issued as one.
+	 *
+	 * Every draw gets a 64-bit key: the pass in the top bits, then pipeline, material, vertex buffer
+	 * and depth for solid draws, or depth first (far to near) for blended ones. The keys are radix
+	 * sorted, which keeps draws with equal keys in submission order. Adjacent draws left with the
+	 * same state and contiguous index or instance ranges are merged afterwards.
+	 *
+	 * Pipelines and buffers are keyed by small ids assigned on first use, so sorting groups equal
+	 * state without ordering it by handle value. The buffers are kept between frames, so sorting
+	 * does not allocate once they have grown.
+	 */
+	class DrawSorter final
+	{
+	public:
+		void sort(DrawList& drawList);
+
+		[[nodiscard]] uint64_t makeSortKey(const DrawCommand& draw);
+		// Extend first by second when both can be issued as a single draw.
+		static bool tryMerge(DrawCommand& first, const DrawCommand& second);
+	private:
+		using KeyedDraw = std::pair<uint64_t, uint32_t>; // Sort key, index into the draw list.
+
+		void radixSort();
+		[[nodiscard]] static uint32_t getStateId(std::unordered_map<uint64_t, uint32_t>& ids, uint64_t handle);
+
+		std::unordered_map<uint64_t, uint32_t> pipelineIds;
+		std::unordered_map<uint64_t, uint32_t> bufferIds;
+
+		std::vector<KeyedDraw> keys;
+		std::vector<KeyedDraw> scratchKeys;
+		DrawList sortedDraws;
+
+		// Below this many draws a comparison sort beats the radix sort's histogram passes.
+		static constexpr size_t RADIX_SORT_THRESHOLD = 256;
+	};
+
+}
@@ -1,5 +1,7 @@
 #include "ExtensionManager.h"
 
+#include <algorithm>
+#include <cstring>
 #include <set>
 #include <stdexcept>
 #include <unordered_set>
@@ -7,15 +9,22 @@
 #include <GLFW/glfw3.h>
 
 #include "DebugManager.h"
+#include "glfw/GlfwInitializer.h"
+#include "utils/interfaces/ServiceLocator.h"
 
 namespace tessera::vulkan
 {
 	std::vector<const char*> getRequiredInstanceExtensions()
 	{
-		uint32_t glfwExtensionCount = 0;
-		const char** glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+		std::vector<const char*> extensions;
 
-		std::vector extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+		// Surface extensions are only needed to present to a window.
+		if (!ServiceLocator::getService<glfw::GlfwInitializer>()->isHeadless())
+		{
+			uint32_t glfwExtensionCount = 0;
+			const char** glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+			extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+		}
 
 		if (DebugManager::validationLayersAreEnabled()) 
 		{
@@ -54,8 +63,26 @@ namespace tessera::vulkan
 		}
 	}
 
+	bool isInstanceExtensionSupported(const char* extensionName, const char* layerName)
+	{
+		uint32_t extensionCount = 0;
+		vkEnumerateInstanceExtensionProperties(layerName, &extensionCount, nullptr);
+		std::vector<VkExtensionProperties> extensions(extensionCount);
+		vkEnumerateInstanceExtensionProperties(layerName, &extensionCount, extensions.data());
+
+		return std::ranges::any_of(extensions, [extensionName](const VkExtensionProperties& extension)
+			{
+				return strcmp(extension.extensionName, extensionName) == 0;
+			});
+	}
+
 	std::vector<const char*> getRequiredDeviceExtensions()
 	{
+		if (ServiceLocator::getService<glfw::GlfwInitializer>()->isHeadless())
+		{
+			return {};
+		}
+
 		return { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
 	}
 
@@ -80,5 +107,18 @@ namespace tessera::vulkan
 
 		return requiredExtensionsSet.empty();
 	}
+
+	bool isDeviceExtensionSupported(const VkPhysicalDevice& device, const char* extensionName)
+	{
+		uint32_t extensionCount = 0;
+		vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+		std::vector<VkExtensionProperties> extensions(extensionCount);
+		vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, extensions.data());
+
+		return std::ranges::any_of(extensions, [extensionName](const VkExtensionProperties& extension)
+			{
+				return strcmp(extension.extensionName, extensionName) == 0;
+			});
+	}
 }
 
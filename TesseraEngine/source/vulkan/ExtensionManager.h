@@ -8,10 +8,13 @@ namespace tessera::vulkan
 	// Instance extensions.
 	std::vector<const char*> getRequiredInstanceExtensions();
 	void checkIfAllGlsfRequiredExtensionsAreSupported();
+	// layerName asks for the extensions a layer provides instead of those of the implementation.
+	bool isInstanceExtensionSupported(const char* extensionName, const char* layerName = nullptr);
 
 	// Logical device extensions.
 	std::vector<const char*> getRequiredDeviceExtensions();
 	bool isDeviceExtensionSupported(const VkPhysicalDevice& device);
+	bool isDeviceExtensionSupported(const VkPhysicalDevice& device, const char* extensionName);
 }
 
 
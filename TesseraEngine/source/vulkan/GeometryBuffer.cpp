@@ -0,0 +1,257 @@
+#include "GeometryBuffer.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "DeletionQueue.h"
+#include "UploadManager.h"
+#include "utils/TesseraLog.h"
+
+namespace tessera::vulkan
+{
+
+	void GeometryBuffer::create(MemoryAllocator& allocator, UploadManager& uploader, DeletionQueue& deleter, const VkBufferUsageFlags bufferUsage,
+		const uint32_t bytesPerElement, const uint32_t initialCapacity)
+	{
+		memoryAllocator = &allocator;
+		uploadManager = &uploader;
+		deletionQueue = &deleter;
+		// Relocation copies out of the buffer as well as into it.
+		usage = bufferUsage | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+		elementSize = bytesPerElement;
+
+		// Empty buffers are created by the first allocation.
+		if (initialCapacity > 0)
+		{
+			createBuffer(initialCapacity, buffer, memory);
+			capacity = initialCapacity;
+			freeRanges.emplace(0, initialCapacity);
+		}
+	}
+
+	GeometryRange GeometryBuffer::allocate(const uint32_t count)
+	{
+		if (count == 0)
+		{
+			throw std::runtime_error("GeometryBuffer: cannot allocate an empty range.");
+		}
+
+		uint32_t offset = 0;
+		if (!tryAllocate(count, offset))
+		{
+			// Doubling keeps the number of relocations logarithmic in the final size.
+			const uint64_t required = static_cast<uint64_t>(used) + count;
+			const uint64_t newCapacity = std::max<uint64_t>(required, static_cast<uint64_t>(capacity) * 2);
+			if (newCapacity > UINT32_MAX)
+			{
+				throw std::runtime_error("GeometryBuffer: capacity exceeds the element offsets of a draw.");
+			}
+
+			relocate(static_cast<uint32_t>(newCapacity));
+			if (!tryAllocate(count, offset))
+			{
+				throw std::runtime_error("GeometryBuffer: failed to allocate from a grown buffer.");
+			}
+		}
+
+		const GeometryRange range = nextRange++;
+		ranges.emplace(range, Range{ offset, count });
+		return range;
+	}
+
+	bool GeometryBuffer::tryAllocate(const uint32_t count, uint32_t& resultOffset)
+	{
+		// First fit over the ordered free list.
+		for (auto it = freeRanges.begin(); it != freeRanges.end(); ++it)
+		{
+			const auto [rangeOffset, rangeCount] = *it;
+			if (rangeCount < count)
+			{
+				continue;
+			}
+
+			freeRanges.erase(it);
+			if (rangeCount > count)
+			{
+				freeRanges.emplace(rangeOffset + count, rangeCount - count);
+			}
+
+			used += count;
+			resultOffset = rangeOffset;
+			return true;
+		}
+
+		return false;
+	}
+
+	void GeometryBuffer::free(const GeometryRange range)
+	{
+		const auto rangeIt = ranges.find(range);
+		if (rangeIt == ranges.end())
+		{
+			return;
+		}
+
+		uint32_t offset = rangeIt->second.offset;
+		uint32_t count = rangeIt->second.count;
+		used -= count;
+		ranges.erase(rangeIt);
+
+		// Merge with the neighbours on both sides.
+		const auto next = freeRanges.lower_bound(offset);
+		if (next != freeRanges.end() && offset + count == next->first)
+		{
+			count += next->second;
+			freeRanges.erase(next);
+		}
+
+		const auto following = freeRanges.lower_bound(offset);
+		if (following != freeRanges.begin())
+		{
+			const auto previous = std::prev(following);
+			if (previous->first + previous->second == offset)
+			{
+				offset = previous->first;
+				count += previous->second;
+				freeRanges.erase(previous);
+			}
+		}
+
+		freeRanges.emplace(offset, count);
+	}
+
+	void GeometryBuffer::upload(const GeometryRange range, const void* data)
+	{
+		const Range& target = ranges.at(range);
+		uploadManager->uploadToBuffer(data, static_cast<VkDeviceSize>(target.count) * elementSize, buffer, static_cast<VkDeviceSize>(target.offset) * elementSize);
+	}
+
+	void GeometryBuffer::defragment()
+	{
+		if (freeRanges.size() <= 1 && (freeRanges.empty() || freeRanges.begin()->first + freeRanges.begin()->second == capacity))
+		{
+			return;
+		}
+
+		relocate(capacity);
+	}
+
+	float GeometryBuffer::getFragmentation() const
+	{
+		const uint32_t freeCount = capacity - used;
+		if (freeCount == 0)
+		{
+			return 0.0f;
+		}
+
+		uint32_t largest = 0;
+		for (const auto& [offset, count] : freeRanges)
+		{
+			largest = std::max(largest, count);
+		}
+
+		return 1.0f - static_cast<float>(largest) / static_cast<float>(freeCount);
+	}
+
+	void GeometryBuffer::relocate(const uint32_t newCapacity)
+	{
+		VkBuffer newBuffer;
+		MemoryAllocation newMemory;
+		createBuffer(newCapacity, newBuffer, newMemory);
+
+		if (buffer != VK_NULL_HANDLE && !ranges.empty())
+		{
+			// Uploads into the old buffer may still be recorded in the current batch.
+			uploadManager->enqueueTransferBarrier();
+
+			std::vector<Range*> liveRanges;
+			liveRanges.reserve(ranges.size());
+			for (auto& [handle, range] : ranges)
+			{
+				liveRanges.push_back(&range);
+			}
+			std::ranges::sort(liveRanges, {}, &Range::offset);
+
+			// Ranges already adjacent in the old buffer stay adjacent, so each run of them is a single copy.
+			VkBufferCopy copy{};
+			uint32_t packedOffset = 0;
+			for (Range* range : liveRanges)
+			{
+				const VkDeviceSize srcOffset = static_cast<VkDeviceSize>(range->offset) * elementSize;
+				const VkDeviceSize dstOffset = static_cast<VkDeviceSize>(packedOffset) * elementSize;
+				const VkDeviceSize size = static_cast<VkDeviceSize>(range->count) * elementSize;
+
+				if (copy.size > 0 && copy.srcOffset + copy.size == srcOffset)
+				{
+					copy.size += size;
+				}
+				else
+				{
+					if (copy.size > 0)
+					{
+						uploadManager->enqueueBufferCopy(buffer, newBuffer, copy);
+					}
+					copy = { srcOffset, dstOffset, size };
+				}
+
+				range->offset = packedOffset;
+				packedOffset += range->count;
+			}
+			uploadManager->enqueueBufferCopy(buffer, newBuffer, copy);
+
+			TESSERA_LOG(LogType::DEBUG, "GeometryBuffer", "Relocated " + std::to_string(ranges.size()) + " ranges of " + std::to_string(used)
+				+ " elements into a buffer of " + std::to_string(newCapacity) + " elements.");
+		}
+
+		if (buffer != VK_NULL_HANDLE)
+		{
+			releaseBuffer(buffer, memory);
+		}
+
+		buffer = newBuffer;
+		memory = newMemory;
+		capacity = newCapacity;
+		freeRanges.clear();
+		if (used < capacity)
+		{
+			freeRanges.emplace(used, capacity - used);
+		}
+		++relocations;
+	}
+
+	void GeometryBuffer::createBuffer(const uint32_t elementCapacity, VkBuffer& newBuffer, MemoryAllocation& newMemory) const
+	{
+		// Written on the transfer queue and read on the graphics queue.
+		memoryAllocator->createBuffer(static_cast<VkDeviceSize>(elementCapacity) * elementSize, usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, newBuffer, newMemory,
+			uploadManager->getSharedQueueFamilies());
+	}
+
+	void GeometryBuffer::releaseBuffer(const VkBuffer oldBuffer, const MemoryAllocation& oldMemory) const
+	{
+		// The relocation copies read the old buffer until their batch completes, and frames already submitted draw from it until they retire.
+		uploadManager->enqueueRelease([allocator = memoryAllocator, deleter = deletionQueue, oldBuffer, oldMemory]
+			{
+				deleter->push([allocator, oldBuffer, oldMemory]
+					{
+						allocator->destroyBuffer(oldBuffer, oldMemory);
+					});
+			});
+	}
+
+	void GeometryBuffer::destroy()
+	{
+		if (buffer != VK_NULL_HANDLE)
+		{
+			memoryAllocator->destroyBuffer(buffer, memory);
+			buffer = VK_NULL_HANDLE;
+		}
+
+		ranges.clear();
+		freeRanges.clear();
+		capacity = 0;
+		used = 0;
+	}
+
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+#include <vulkan/vulkan_core.h>
+
+#include "MemoryAllocator.h"
+
+namespace tessera::vulkan
+{
+
+	class DeletionQueue;
+	class UploadManager;
+
+	using GeometryRange = uint32_t;
+
+	/**
+	 * @brief Device-local buffer shared by many meshes, sub-allocated in whole elements.
+	 *
+	 * Ranges are handed out first fit from a coalescing free list and addressed by element offset, so
+	 * draws over any of them bind the buffer once. Growing or defragmenting the buffer relocates every
+	 * live range, packed from the start, into a new buffer with copies on the transfer queue; offsets
+	 * change then and getRelocations() counts how often that happened. The old buffer is released once
+	 * the copies landed and the frames in flight retired.
+	 */
+	class GeometryBuffer final
+	{
+	public:
+		void create(MemoryAllocator& allocator, UploadManager& uploader, DeletionQueue& deleter, VkBufferUsageFlags bufferUsage, uint32_t bytesPerElement, uint32_t initialCapacity);
+		void destroy();
+
+		// Grows the buffer when no free range fits.
+		[[nodiscard]] GeometryRange allocate(uint32_t count);
+		void free(GeometryRange range);
+		// Copy the whole range worth of data into it.
+		void upload(GeometryRange range, const void* data);
+
+		// Relocate the live ranges over the free space between them; does nothing if it is already one block.
+		void defragment();
+
+		[[nodiscard]] uint32_t getOffset(GeometryRange range) const { return ranges.at(range).offset; }
+		[[nodiscard]] VkBuffer getBuffer() const { return buffer; }
+		[[nodiscard]] uint32_t getCapacity() const { return capacity; }
+		[[nodiscard]] uint32_t getUsed() const { return used; }
+		// Share of the free space outside of the largest free range, from 0 when it is in one piece to almost 1.
+		[[nodiscard]] float getFragmentation() const;
+		[[nodiscard]] uint64_t getRelocations() const { return relocations; }
+	private:
+		struct Range
+		{
+			uint32_t offset = 0;
+			uint32_t count = 0;
+		};
+
+		// Returns false when no free range is large enough.
+		bool tryAllocate(uint32_t count, uint32_t& resultOffset);
+		void relocate(uint32_t newCapacity);
+		void createBuffer(uint32_t elementCapacity, VkBuffer& newBuffer, MemoryAllocation& newMemory) const;
+		void releaseBuffer(VkBuffer oldBuffer, const MemoryAllocation& oldMemory) const;
+
+		MemoryAllocator* memoryAllocator = nullptr;
+		UploadManager* uploadManager = nullptr;
+		DeletionQueue* deletionQueue = nullptr;
+		VkBufferUsageFlags usage = 0;
+		uint32_t elementSize = 0;
+
+		VkBuffer buffer = VK_NULL_HANDLE;
+		MemoryAllocation memory;
+		uint32_t capacity = 0;
+		uint32_t used = 0;
+		uint64_t relocations = 0;
+
+		std::unordered_map<GeometryRange, Range> ranges;
+		// Element offset to element count, coalesced on free.
+		std::map<uint32_t, uint32_t> freeRanges;
+		GeometryRange nextRange = 1;
+	};
+
+}
@@ -0,0 +1,249 @@
+#include "GpuProfiler.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+#include "CommandBufferManager.h"
+#include "DeviceManager.h"
+#include "QueueManager.h"
+#include "utils/EngineConfig.h"
+#include "utils/TesseraLog.h"
+#include "utils/interfaces/ServiceLocator.h"
+
+namespace tessera::vulkan
+{
+
+	namespace
+	{
+		constexpr uint32_t UNRECORDED_SCOPE = UINT32_MAX;
+
+		uint64_t toTimestampMask(const uint32_t validBits)
+		{
+			return validBits >= 64 ? UINT64_MAX : (uint64_t{ 1 } << validBits) - 1;
+		}
+	}
+
+	void GpuProfiler::init()
+	{
+		const auto& config = ServiceLocator::getService<EngineConfig>();
+		if (!config->getBool("profiling.gpu", false))
+		{
+			return;
+		}
+
+		const auto& deviceManager = ServiceLocator::getService<DeviceManager>();
+		device = deviceManager->getLogicalDevice();
+		hostQueryReset = deviceManager->getCapabilities().hostQueryReset;
+
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(deviceManager->getPhysicalDevice(), &properties);
+		timestampPeriodNs = properties.limits.timestampPeriod;
+
+		uint32_t queueFamilyCount = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties(deviceManager->getPhysicalDevice(), &queueFamilyCount, nullptr);
+		std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+		vkGetPhysicalDeviceQueueFamilyProperties(deviceManager->getPhysicalDevice(), &queueFamilyCount, queueFamilies.data());
+
+		const auto [graphicsFamily, presentFamily, transferFamily, computeFamily, computeQueueIndex] = ServiceLocator::getService<QueueManager>()->getQueueFamilyIndices();
+		graphicsTimestampMask = toTimestampMask(queueFamilies[graphicsFamily.value()].timestampValidBits);
+		transferTimestampMask = toTimestampMask(queueFamilies[transferFamily.value()].timestampValidBits);
+
+		if (queueFamilies[graphicsFamily.value()].timestampValidBits == 0)
+		{
+			TesseraLog::send(LogType::WARNING, "GpuProfiler", "The graphics queue does not support timestamps, GPU profiling is disabled.");
+			return;
+		}
+		if (queueFamilies[transferFamily.value()].timestampValidBits == 0)
+		{
+			transferTimestampMask = 0;
+		}
+
+		frames.resize(CommandBufferManager::queryFramesInFlight());
+		for (auto& frameQueries : frames)
+		{
+			VkQueryPoolCreateInfo poolInfo{};
+			poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+			poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+			poolInfo.queryCount = MAX_QUERIES_PER_FRAME;
+
+			if (vkCreateQueryPool(device, &poolInfo, nullptr, &frameQueries.queryPool) != VK_SUCCESS)
+			{
+				throw std::runtime_error("GpuProfiler: failed to create timestamp query pool.");
+			}
+			frameQueries.scopes.reserve(MAX_QUERIES_PER_FRAME / 2);
+		}
+
+		queryResults.resize(MAX_QUERIES_PER_FRAME);
+		logInterval = static_cast<uint32_t>(std::max(0, config->getInt("profiling.logIntervalFrames", 300)));
+		enabled = true;
+	}
+
+	void GpuProfiler::beginFrame(const VkCommandBuffer commandBuffer, const int frame)
+	{
+		if (!enabled)
+		{
+			return;
+		}
+
+		if (static_cast<size_t>(frame) >= frames.size() || frame < 0)
+		{
+			throw std::out_of_range("GpuProfiler: current frame number is larger than number of query pools.");
+		}
+
+		FrameQueries& frameQueries = frames[frame];
+		if (frameQueries.recorded)
+		{
+			resolveFrame(frameQueries);
+			publishFrame();
+		}
+
+		vkCmdResetQueryPool(commandBuffer, frameQueries.queryPool, 0, MAX_QUERIES_PER_FRAME);
+		frameQueries.scopes.clear();
+		frameQueries.queryCount = 0;
+		frameQueries.recorded = true;
+
+		currentFrame = frame;
+		openScopes.clear();
+	}
+
+	void GpuProfiler::beginScope(const VkCommandBuffer commandBuffer, const char* name)
+	{
+		if (!enabled || currentFrame < 0 || frames[currentFrame].queryCount + 2 > MAX_QUERIES_PER_FRAME)
+		{
+			openScopes.push_back(UNRECORDED_SCOPE);
+			return;
+		}
+
+		FrameQueries& frameQueries = frames[currentFrame];
+
+		Scope scope;
+		scope.name = name;
+		scope.beginQuery = frameQueries.queryCount++;
+		scope.endQuery = frameQueries.queryCount++;
+
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frameQueries.queryPool, scope.beginQuery);
+
+		openScopes.push_back(static_cast<uint32_t>(frameQueries.scopes.size()));
+		frameQueries.scopes.push_back(scope);
+	}
+
+	void GpuProfiler::endScope(const VkCommandBuffer commandBuffer)
+	{
+		if (openScopes.empty())
+		{
+			throw std::runtime_error("GpuProfiler: endScope without matching beginScope.");
+		}
+
+		const uint32_t scopeIndex = openScopes.back();
+		openScopes.pop_back();
+
+		if (scopeIndex == UNRECORDED_SCOPE)
+		{
+			return;
+		}
+
+		FrameQueries& frameQueries = frames[currentFrame];
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frameQueries.queryPool, frameQueries.scopes[scopeIndex].endQuery);
+	}
+
+	void GpuProfiler::addTransferSample(const std::string& name, const uint64_t beginTicks, const uint64_t endTicks)
+	{
+		std::lock_guard lock(timingMutex);
+		accumulate(name, toMilliseconds(beginTicks, endTicks, transferTimestampMask));
+	}
+
+	std::vector<GpuScopeTiming> GpuProfiler::getTimings() const
+	{
+		std::lock_guard lock(timingMutex);
+		return timings;
+	}
+
+	void GpuProfiler::resolveFrame(FrameQueries& frameQueries)
+	{
+		if (frameQueries.queryCount == 0)
+		{
+			return;
+		}
+
+		// The frame has retired, so without VK_QUERY_RESULT_WAIT_BIT this only returns VK_NOT_READY for scopes left open.
+		const VkResult result = vkGetQueryPoolResults(device, frameQueries.queryPool, 0, frameQueries.queryCount,
+			frameQueries.queryCount * sizeof(uint64_t), queryResults.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+
+		if (result != VK_SUCCESS)
+		{
+			return;
+		}
+
+		std::lock_guard lock(timingMutex);
+		for (const auto& [name, beginQuery, endQuery] : frameQueries.scopes)
+		{
+			accumulate(name, toMilliseconds(queryResults[beginQuery], queryResults[endQuery], graphicsTimestampMask));
+		}
+	}
+
+	double GpuProfiler::toMilliseconds(const uint64_t beginTicks, const uint64_t endTicks, const uint64_t timestampMask) const
+	{
+		// Masking keeps the difference correct when the counter wraps around its valid bits.
+		const uint64_t ticks = (endTicks - beginTicks) & timestampMask;
+		return static_cast<double>(ticks) * timestampPeriodNs / 1'000'000.0;
+	}
+
+	void GpuProfiler::accumulate(const std::string& name, const double milliseconds)
+	{
+		const auto it = std::ranges::find(pendingTimes, name, &std::pair<std::string, double>::first);
+		if (it != pendingTimes.end())
+		{
+			it->second += milliseconds;
+		}
+		else
+		{
+			pendingTimes.emplace_back(name, milliseconds);
+		}
+	}
+
+	void GpuProfiler::publishFrame()
+	{
+		std::lock_guard lock(timingMutex);
+
+		for (const auto& [name, milliseconds] : pendingTimes)
+		{
+			const auto it = std::ranges::find(timings, name, &GpuScopeTiming::name);
+			if (it == timings.end())
+			{
+				timings.push_back({ name, milliseconds, milliseconds });
+				continue;
+			}
+
+			it->lastMs = milliseconds;
+			it->averageMs += (milliseconds - it->averageMs) * AVERAGE_WEIGHT;
+		}
+		pendingTimes.clear();
+
+		++publishedFrames;
+		if (logInterval == 0 || publishedFrames % logInterval != 0)
+		{
+			return;
+		}
+
+		std::ostringstream report;
+		report << std::fixed << std::setprecision(3);
+		for (const auto& [name, lastMs, averageMs] : timings)
+		{
+			report << "\n\t" << name << ": " << lastMs << " ms (avg " << averageMs << " ms)";
+		}
+		TesseraLog::send(LogType::INFO, "GpuProfiler", "GPU times after " + std::to_string(publishedFrames) + " frames:" + report.str());
+	}
+
+	void GpuProfiler::clean()
+	{
+		for (const auto& frameQueries : frames)
+		{
+			vkDestroyQueryPool(device, frameQueries.queryPool, nullptr);
+		}
+		frames.clear();
+		enabled = false;
+	}
+
+}
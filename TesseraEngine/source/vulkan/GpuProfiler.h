@@ -0,0 +1,100 @@
+#pragma once
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+#include "utils/interfaces/Initializable.h"
+
+namespace tessera::vulkan
+{
+
+	struct GpuScopeTiming
+	{
+		std::string name;
+		double lastMs = 0.0;
+		// Exponential moving average over roughly the last 1 / AVERAGE_WEIGHT frames.
+		double averageMs = 0.0;
+	};
+
+	/**
+	 * @brief GPU time of named scopes measured with timestamp queries.
+	 *
+	 * Every frame in flight owns a query pool. Its results are read back when the slot is reused, after the
+	 * frame's fence or timeline value was waited on, so reading never stalls. Upload batches measure their own
+	 * copies and report them through addTransferSample(). Enabled with profiling.gpu in engine.ini.
+	 */
+	class GpuProfiler final : public Initializable
+	{
+	public:
+		void init() override;
+		void clean() override;
+
+		[[nodiscard]] bool isEnabled() const { return enabled; }
+
+		/**
+		 * @brief Read back the results of the frame that last used this slot and reset its queries.
+		 *
+		 * Must be the first command recorded into the frame's primary command buffer, outside a render pass.
+		 */
+		void beginFrame(VkCommandBuffer commandBuffer, int frame);
+
+		// Scopes nest and must be closed in the command buffer they were opened in. Not valid inside a subpass recorded with secondary command buffers.
+		void beginScope(VkCommandBuffer commandBuffer, const char* name);
+		void endScope(VkCommandBuffer commandBuffer);
+
+		// Whether work on the transfer queue can be timed; requires host query reset and transfer timestamps.
+		[[nodiscard]] bool canTimeTransfers() const { return enabled && transferTimestampMask != 0 && hostQueryReset; }
+
+		// Add a pair of timestamps written on the transfer queue. Thread safe.
+		void addTransferSample(const std::string& name, uint64_t beginTicks, uint64_t endTicks);
+
+		[[nodiscard]] std::vector<GpuScopeTiming> getTimings() const;
+		// Frames whose timings were read back so far; lastMs of the timings changes whenever it grows.
+		[[nodiscard]] uint64_t getPublishedFrameCount() const { std::lock_guard lock(timingMutex); return publishedFrames; }
+	private:
+		struct Scope
+		{
+			const char* name = nullptr;
+			uint32_t beginQuery = 0;
+			uint32_t endQuery = 0;
+		};
+
+		struct FrameQueries
+		{
+			VkQueryPool queryPool = VK_NULL_HANDLE;
+			std::vector<Scope> scopes;
+			uint32_t queryCount = 0;
+			bool recorded = false;
+		};
+
+		void resolveFrame(FrameQueries& frameQueries);
+		[[nodiscard]] double toMilliseconds(uint64_t beginTicks, uint64_t endTicks, uint64_t timestampMask) const;
+		void accumulate(const std::string& name, double milliseconds);
+		void publishFrame();
+
+		VkDevice device = VK_NULL_HANDLE;
+		bool enabled = false;
+		bool hostQueryReset = false;
+		double timestampPeriodNs = 1.0;
+		uint64_t graphicsTimestampMask = 0;
+		uint64_t transferTimestampMask = 0;
+
+		std::vector<FrameQueries> frames;
+		int currentFrame = -1;
+		std::vector<uint32_t> openScopes;
+		std::vector<uint64_t> queryResults;
+
+		mutable std::mutex timingMutex;
+		// Sums per scope name accumulated since the last published frame.
+		std::vector<std::pair<std::string, double>> pendingTimes;
+		std::vector<GpuScopeTiming> timings;
+		uint64_t publishedFrames = 0;
+		uint32_t logInterval = 0;
+
+		static constexpr uint32_t MAX_QUERIES_PER_FRAME = 64;
+		static constexpr double AVERAGE_WEIGHT = 0.05;
+	};
+
+}
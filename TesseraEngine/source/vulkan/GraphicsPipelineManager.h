@@ -1,6 +1,7 @@
 #pragma once
 #include <vector>
 #include <vulkan/vulkan_core.h>
+#include "PipelineRegistry.h"
 #include "SwapChainManager.h"
 
 namespace tessera::vulkan
@@ -12,18 +13,24 @@ namespace tessera::vulkan
 		void init() override;
 		void clean() override;
 
-		[[nodiscard]] VkRenderPass getRenderPath() const { return renderPass; }
-		[[nodiscard]] VkPipeline getGraphicsPipeline() const { return graphicsPipeline; }
-
+		// Looked up every frame, since shader reloads replace the pipelines.
+		[[nodiscard]] VkPipeline getGraphicsPipeline() const { return pipelineRegistry->get(pipelineHandle); }
+		[[nodiscard]] PipelineHandle getPipelineHandle() const { return pipelineHandle; }
+		// Same as the graphics pipeline, with per-instance transforms and colors from InstanceData.
+		[[nodiscard]] VkPipeline getInstancedPipeline() const { return pipelineRegistry->get(instancedPipelineHandle); }
+		// Depth-only variants for the depth prepass; VK_NULL_HANDLE when it is disabled.
+		[[nodiscard]] VkPipeline getDepthPipeline() const { return getOptionalPipeline(depthPipelineHandle); }
+		[[nodiscard]] VkPipeline getInstancedDepthPipeline() const { return getOptionalPipeline(instancedDepthPipelineHandle); }
+		[[nodiscard]] VkPipelineLayout getPipelineLayout() const { return pipelineLayout; }
 	private:
-		static VkShaderModule createShaderModule(const std::vector<char>& code, const VkDevice& device);
-		void initRenderPath(const VkDevice& device, const SwapChainImageDetails& swapChainImageDetails);
+		[[nodiscard]] VkPipeline getOptionalPipeline(const PipelineHandle handle) const { return handle != 0 ? pipelineRegistry->get(handle) : VK_NULL_HANDLE; }
 
-		VkRenderPass renderPass = VK_NULL_HANDLE;
 		VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
-		VkPipeline graphicsPipeline = VK_NULL_HANDLE;
-		VkShaderModule vertexShaderModule = VK_NULL_HANDLE;
-		VkShaderModule fragmentShaderModule = VK_NULL_HANDLE;
+		PipelineRegistry* pipelineRegistry = nullptr;
+		PipelineHandle pipelineHandle = 0;
+		PipelineHandle instancedPipelineHandle = 0;
+		PipelineHandle depthPipelineHandle = 0;
+		PipelineHandle instancedDepthPipelineHandle = 0;
 	};
 	
 }
@@ -2,6 +2,7 @@
 
 #include <stdexcept>
 
+#include "DeletionQueue.h"
 #include "utils/interfaces/ServiceLocator.h"
 
 namespace tessera::vulkan
@@ -39,6 +40,22 @@ namespace tessera::vulkan
 		}
 	}
 
+	void ImageViewManager::recreate()
+	{
+		const auto& device = ServiceLocator::getService<DeviceManager>()->getLogicalDevice();
+
+		ServiceLocator::getService<DeletionQueue>()->push([device, imageViews = std::move(swapChainImageViews)]
+			{
+				for (const auto& imageView : imageViews)
+				{
+					vkDestroyImageView(device, imageView, nullptr);
+				}
+			});
+		swapChainImageViews.clear();
+
+		init();
+	}
+
 	void ImageViewManager::clean()
 	{
 		const auto& device = ServiceLocator::getService<DeviceManager>()->getLogicalDevice();
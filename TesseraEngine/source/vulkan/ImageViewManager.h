@@ -13,7 +13,10 @@ namespace tessera::vulkan
 		void init() override;
 		void clean() override;
 
-		[[nodiscard]] std::vector<VkImageView> getSwapChainImageViews() const { return swapChainImageViews; }
+		// Hand the current objects to the DeletionQueue and create new ones for the current swap chain.
+		void recreate();
+
+		[[nodiscard]] const std::vector<VkImageView>& getSwapChainImageViews() const { return swapChainImageViews; }
 	private:
 		std::vector<VkImageView> swapChainImageViews;
 	};
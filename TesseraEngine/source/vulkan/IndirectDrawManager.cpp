@@ -0,0 +1,488 @@
+#include "IndirectDrawManager.h"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+#include "BufferManager.h"
+#include "CommandBufferManager.h"
+#include "ComputeManager.h"
+#include "DeletionQueue.h"
+#include "DeviceManager.h"
+#include "PipelineCacheManager.h"
+#include "RenderGraph.h"
+#include "RenderGraphManager.h"
+#include "ShaderLibrary.h"
+#include "UniformManager.h"
+#include "UploadManager.h"
+#include "utils/EngineConfig.h"
+#include "utils/Frustum.h"
+#include "utils/TesseraLog.h"
+#include "utils/interfaces/ServiceLocator.h"
+
+namespace tessera::vulkan
+{
+
+	void IndirectDrawManager::init()
+	{
+		if (!isRequested())
+		{
+			return;
+		}
+
+		const auto& deviceManager = ServiceLocator::getService<DeviceManager>();
+
+		if (!isSupported())
+		{
+			TesseraLog::send(LogType::WARNING, "IndirectDrawManager", "drawIndirectFirstInstance is not supported, drawing the CPU draw list instead.");
+			return;
+		}
+
+		device = deviceManager->getLogicalDevice();
+		drawCountEnabled = deviceManager->getCapabilities().drawIndirectCount;
+		multiDrawEnabled = deviceManager->getCapabilities().multiDrawIndirect;
+
+		bufferManager = ServiceLocator::getServicePointer<BufferManager>();
+		memoryAllocator = ServiceLocator::getServicePointer<MemoryAllocator>();
+		uploadManager = ServiceLocator::getServicePointer<UploadManager>();
+		deletionQueue = ServiceLocator::getServicePointer<DeletionQueue>();
+		uniformManager = ServiceLocator::getServicePointer<UniformManager>();
+		pipelineRegistry = ServiceLocator::getServicePointer<PipelineRegistry>();
+
+		const auto& computeManager = ServiceLocator::getService<ComputeManager>();
+		drawQueueFamilies = computeManager->getSharedQueueFamilies();
+
+		frames.resize(CommandBufferManager::queryFramesInFlight());
+		createDescriptorObjects();
+		createPipelines();
+		createFrameBuffers(MIN_CAPACITY);
+		enabled = true;
+
+		// Otherwise the render graph records culling in its own pass.
+		if (computeManager->isAsync())
+		{
+			computeManager->addRecorder([this](const VkCommandBuffer commandBuffer, const int frame) { recordCulling(commandBuffer, frame); },
+				VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT);
+		}
+
+		// Same scene as the CPU path until objects are set.
+		setObjects({ makeMeshObject(bufferManager->getDefaultMesh(), glm::vec3(0.0f), 1.0f) });
+
+		TesseraLog::send(LogType::INFO, "IndirectDrawManager", std::string("GPU-driven drawing enabled, ")
+			+ (drawCountEnabled ? "compacting visible draws." : "without drawIndirectCount every object keeps a draw."));
+	}
+
+	bool IndirectDrawManager::isRequested()
+	{
+		return ServiceLocator::getService<EngineConfig>()->getBool("render.gpuDriven", false);
+	}
+
+	bool IndirectDrawManager::isSupported()
+	{
+		// The vertex shader finds its object through firstInstance, which indirect draws can only set with this feature.
+		return ServiceLocator::getService<DeviceManager>()->getCapabilities().drawIndirectFirstInstance;
+	}
+
+	void IndirectDrawManager::createDescriptorObjects()
+	{
+		// Objects, draws and draw count. The vertex shader only reads the objects.
+		std::array<VkDescriptorSetLayoutBinding, 3> bindings{};
+		for (uint32_t binding = 0; binding < bindings.size(); ++binding)
+		{
+			bindings[binding].binding = binding;
+			bindings[binding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			bindings[binding].descriptorCount = 1;
+			bindings[binding].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		}
+		bindings[0].stageFlags |= VK_SHADER_STAGE_VERTEX_BIT;
+
+		VkDescriptorSetLayoutCreateInfo layoutInfo{};
+		layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+		layoutInfo.pBindings = bindings.data();
+
+		if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS)
+		{
+			throw std::runtime_error("IndirectDrawManager: failed to create descriptor set layout.");
+		}
+
+		VkDescriptorPoolSize poolSize{};
+		poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		poolSize.descriptorCount = static_cast<uint32_t>(bindings.size() * frames.size());
+
+		VkDescriptorPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolInfo.maxSets = static_cast<uint32_t>(frames.size());
+		poolInfo.poolSizeCount = 1;
+		poolInfo.pPoolSizes = &poolSize;
+
+		if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS)
+		{
+			throw std::runtime_error("IndirectDrawManager: failed to create descriptor pool.");
+		}
+
+		const std::vector layouts(frames.size(), descriptorSetLayout);
+		std::vector<VkDescriptorSet> descriptorSets(frames.size());
+
+		VkDescriptorSetAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocInfo.descriptorPool = descriptorPool;
+		allocInfo.descriptorSetCount = static_cast<uint32_t>(layouts.size());
+		allocInfo.pSetLayouts = layouts.data();
+
+		if (vkAllocateDescriptorSets(device, &allocInfo, descriptorSets.data()) != VK_SUCCESS)
+		{
+			throw std::runtime_error("IndirectDrawManager: failed to allocate descriptor sets.");
+		}
+
+		for (size_t frame = 0; frame < frames.size(); ++frame)
+		{
+			frames[frame].descriptorSet = descriptorSets[frame];
+		}
+	}
+
+	void IndirectDrawManager::createPipelines()
+	{
+		VkPushConstantRange cullConstants{};
+		cullConstants.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		cullConstants.size = sizeof(CullingConstants);
+
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.setLayoutCount = 1;
+		pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+		pipelineLayoutInfo.pushConstantRangeCount = 1;
+		pipelineLayoutInfo.pPushConstantRanges = &cullConstants;
+
+		if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &cullPipelineLayout) != VK_SUCCESS)
+		{
+			throw std::runtime_error("IndirectDrawManager: failed to create culling pipeline layout.");
+		}
+
+		VkPushConstantRange drawConstants{};
+		drawConstants.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+		drawConstants.size = sizeof(glm::mat4);
+		pipelineLayoutInfo.pPushConstantRanges = &drawConstants;
+
+		if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &drawPipelineLayout) != VK_SUCCESS)
+		{
+			throw std::runtime_error("IndirectDrawManager: failed to create draw pipeline layout.");
+		}
+
+		const auto& shaderLibrary = ServiceLocator::getService<ShaderLibrary>();
+		const auto modules = shaderLibrary->load({ "cull.comp", "indirect.vert", "shader.frag" });
+		cullShaderModule = modules[0];
+		cullPipeline = createCullPipeline();
+
+		// The draw pipeline goes through the PipelineRegistry, which rebuilds it by itself.
+		shaderLibrary->addReloadListener([this](const VkShaderModule oldModule, const VkShaderModule newModule) { onShaderReloaded(oldModule, newModule); });
+
+		PipelineDescription description;
+		description.vertexShader = modules[1];
+		description.fragmentShader = modules[2];
+		description.vertexLayout = BufferManager::getVertexLayout();
+		description.layout = drawPipelineLayout;
+
+		const auto& renderGraphManager = ServiceLocator::getService<RenderGraphManager>();
+		renderGraphManager->setMainPassState(description);
+		drawPipelineHandle = pipelineRegistry->compileNow(description);
+
+		if (renderGraphManager->isDepthPrepassEnabled())
+		{
+			renderGraphManager->setDepthPrepassState(description);
+			depthPipelineHandle = pipelineRegistry->compileNow(description);
+		}
+	}
+
+	VkPipeline IndirectDrawManager::createCullPipeline() const
+	{
+		VkComputePipelineCreateInfo computeInfo{};
+		computeInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		computeInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		computeInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+		computeInfo.stage.module = cullShaderModule;
+		computeInfo.stage.pName = "main";
+		computeInfo.layout = cullPipelineLayout;
+
+		const VkPipelineCache pipelineCache = ServiceLocator::getService<PipelineCacheManager>()->getPipelineCache();
+		VkPipeline pipeline;
+		if (vkCreateComputePipelines(device, pipelineCache, 1, &computeInfo, nullptr, &pipeline) != VK_SUCCESS)
+		{
+			throw std::runtime_error("IndirectDrawManager: failed to create culling pipeline.");
+		}
+
+		return pipeline;
+	}
+
+	void IndirectDrawManager::onShaderReloaded(const VkShaderModule oldModule, const VkShaderModule newModule)
+	{
+		if (oldModule != cullShaderModule)
+		{
+			return;
+		}
+
+		// The pipeline is small, so it is rebuilt right away; a failure keeps the previous one, which outlives its module.
+		cullShaderModule = newModule;
+		try
+		{
+			const VkPipeline previousPipeline = cullPipeline;
+			cullPipeline = createCullPipeline();
+			deletionQueue->push([device = device, previousPipeline] { vkDestroyPipeline(device, previousPipeline, nullptr); });
+		}
+		catch (const std::runtime_error& error)
+		{
+			TesseraLog::send(LogType::ERROR, "IndirectDrawManager", error.what());
+		}
+	}
+
+	void IndirectDrawManager::createFrameBuffers(const uint32_t newCapacity)
+	{
+		capacity = newCapacity;
+		++buffersVersion;
+
+		for (auto& frameDraws : frames)
+		{
+			memoryAllocator->createBuffer(sizeof(VkDrawIndexedIndirectCommand) * capacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, frameDraws.drawBuffer, frameDraws.drawMemory, drawQueueFamilies);
+			memoryAllocator->createBuffer(sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, frameDraws.countBuffer, frameDraws.countMemory, drawQueueFamilies);
+		}
+	}
+
+	void IndirectDrawManager::releaseFrameBuffers()
+	{
+		std::vector<std::pair<VkBuffer, MemoryAllocation>> oldBuffers;
+		for (auto& frameDraws : frames)
+		{
+			oldBuffers.emplace_back(frameDraws.drawBuffer, frameDraws.drawMemory);
+			oldBuffers.emplace_back(frameDraws.countBuffer, frameDraws.countMemory);
+			frameDraws.drawBuffer = VK_NULL_HANDLE;
+			frameDraws.countBuffer = VK_NULL_HANDLE;
+		}
+
+		deletionQueue->push([allocator = memoryAllocator, oldBuffers = std::move(oldBuffers)]
+			{
+				for (const auto& [buffer, allocation] : oldBuffers)
+				{
+					allocator->destroyBuffer(buffer, allocation);
+				}
+			});
+	}
+
+	void IndirectDrawManager::setObjects(const std::vector<GpuObject>& newObjects)
+	{
+		if (!enabled)
+		{
+			return;
+		}
+
+		// Only one index buffer is bound for all draws.
+		indexType = newObjects.empty() ? VK_INDEX_TYPE_UINT16 : bufferManager->getMesh(newObjects.front().mesh).indexType;
+		for (const GpuObject& object : newObjects)
+		{
+			if (bufferManager->getMesh(object.mesh).indexType != indexType)
+			{
+				throw std::runtime_error("IndirectDrawManager: objects mix meshes with different index types.");
+			}
+		}
+
+		objects = newObjects;
+		geometryVersion = bufferManager->getGeometryVersion();
+
+		if (objects.size() > capacity)
+		{
+			releaseFrameBuffers();
+			createFrameBuffers(std::bit_ceil(static_cast<uint32_t>(objects.size())));
+		}
+
+		objectCount = static_cast<uint32_t>(objects.size());
+		uploadObjects();
+	}
+
+	void IndirectDrawManager::uploadObjects()
+	{
+		// Frames in flight still cull the old objects, so the buffer is replaced rather than overwritten.
+		if (objectBuffer != VK_NULL_HANDLE)
+		{
+			deletionQueue->push([allocator = memoryAllocator, buffer = objectBuffer, allocation = objectMemory]
+				{
+					allocator->destroyBuffer(buffer, allocation);
+				});
+			objectBuffer = VK_NULL_HANDLE;
+		}
+
+		++buffersVersion;
+
+		const VkDeviceSize size = sizeof(GpuObject) * std::max<size_t>(objects.size(), 1);
+		memoryAllocator->createBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			objectBuffer, objectMemory, uploadManager->getSharedQueueFamilies());
+
+		if (!objects.empty())
+		{
+			uploadManager->uploadToBuffer(objects.data(), sizeof(GpuObject) * objects.size(), objectBuffer);
+		}
+	}
+
+	GpuObject IndirectDrawManager::makeMeshObject(const MeshHandle mesh, const glm::vec3& position, const float scale) const
+	{
+		const MeshRange range = bufferManager->getMesh(mesh);
+		const glm::vec4 bounds = range.boundingSphere;
+
+		GpuObject object;
+		object.boundingSphere = glm::vec4(glm::vec3(bounds) * scale + position, bounds.w * scale);
+		object.transform = glm::vec4(position, scale);
+		object.indexCount = range.indexCount;
+		object.firstIndex = range.firstIndex;
+		object.vertexOffset = range.vertexOffset;
+		object.mesh = mesh;
+		return object;
+	}
+
+	void IndirectDrawManager::updateDescriptorSet(FrameDraws& frameDraws) const
+	{
+		const std::array<VkDescriptorBufferInfo, 3> bufferInfos = { {
+			{ objectBuffer, 0, VK_WHOLE_SIZE },
+			{ frameDraws.drawBuffer, 0, VK_WHOLE_SIZE },
+			{ frameDraws.countBuffer, 0, VK_WHOLE_SIZE }
+		} };
+
+		std::array<VkWriteDescriptorSet, 3> writes{};
+		for (uint32_t binding = 0; binding < writes.size(); ++binding)
+		{
+			writes[binding].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			writes[binding].dstSet = frameDraws.descriptorSet;
+			writes[binding].dstBinding = binding;
+			writes[binding].descriptorCount = 1;
+			writes[binding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			writes[binding].pBufferInfo = &bufferInfos[binding];
+		}
+
+		vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+		frameDraws.descriptorVersion = buffersVersion;
+	}
+
+	void IndirectDrawManager::recordCulling(const VkCommandBuffer commandBuffer, const int frame)
+	{
+		// Objects keep their own index count, which may draw only part of the mesh.
+		if (geometryVersion != bufferManager->getGeometryVersion())
+		{
+			for (GpuObject& object : objects)
+			{
+				const MeshRange range = bufferManager->getMesh(object.mesh);
+				object.firstIndex = range.firstIndex;
+				object.vertexOffset = range.vertexOffset;
+			}
+			geometryVersion = bufferManager->getGeometryVersion();
+			uploadObjects();
+		}
+
+		FrameDraws& frameDraws = frames[frame];
+
+		// The previous frame that used these descriptors has retired, so they can be rewritten.
+		if (frameDraws.descriptorVersion != buffersVersion)
+		{
+			updateDescriptorSet(frameDraws);
+		}
+
+		if (drawCountEnabled)
+		{
+			vkCmdFillBuffer(commandBuffer, frameDraws.countBuffer, 0, sizeof(uint32_t), 0);
+
+			VkBufferMemoryBarrier resetBarrier{};
+			resetBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+			resetBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			resetBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+			resetBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			resetBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			resetBarrier.buffer = frameDraws.countBuffer;
+			resetBarrier.offset = 0;
+			resetBarrier.size = VK_WHOLE_SIZE;
+
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 1, &resetBarrier, 0, nullptr);
+		}
+
+		if (objectCount > 0)
+		{
+			CullingConstants constants{};
+			constants.frustumPlanes = Frustum::fromMatrix(uniformManager->getFrameConstants().viewProjection).planes;
+			constants.objectCount = objectCount;
+			constants.compact = drawCountEnabled ? 1 : 0;
+
+			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipeline);
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipelineLayout, 0, 1, &frameDraws.descriptorSet, 0, nullptr);
+			vkCmdPushConstants(commandBuffer, cullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants), &constants);
+			vkCmdDispatch(commandBuffer, (objectCount + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+		}
+
+		// The draws and their count are read as indirect parameters by the main pass. On the compute queue the
+		// semaphore the graphics submission waits on covers this as well.
+		VkMemoryBarrier drawBarrier{};
+		drawBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		drawBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		drawBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0, 1, &drawBarrier, 0, nullptr, 0, nullptr);
+	}
+
+	void IndirectDrawManager::recordDraws(const RenderPassContext& context, const bool depthOnly) const
+	{
+		if (objectCount == 0)
+		{
+			return;
+		}
+
+		const FrameDraws& frameDraws = frames[context.frame];
+		const VkCommandBuffer commandBuffer = context.commandBuffer;
+
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineRegistry->get(depthOnly ? depthPipelineHandle : drawPipelineHandle));
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, drawPipelineLayout, 0, 1, &frameDraws.descriptorSet, 0, nullptr);
+		const glm::mat4& viewProjection = uniformManager->getFrameConstants().viewProjection;
+		vkCmdPushConstants(commandBuffer, drawPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(viewProjection), &viewProjection);
+
+		const VkBuffer vertexBuffer = bufferManager->getVertexBuffer();
+		constexpr VkDeviceSize offsets[] = { 0 };
+		vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertexBuffer, offsets);
+		vkCmdBindIndexBuffer(commandBuffer, bufferManager->getIndexBuffer(indexType), 0, indexType);
+
+		constexpr auto stride = static_cast<uint32_t>(sizeof(VkDrawIndexedIndirectCommand));
+		if (drawCountEnabled)
+		{
+			vkCmdDrawIndexedIndirectCount(commandBuffer, frameDraws.drawBuffer, 0, frameDraws.countBuffer, 0, objectCount, stride);
+		}
+		else if (multiDrawEnabled)
+		{
+			vkCmdDrawIndexedIndirect(commandBuffer, frameDraws.drawBuffer, 0, objectCount, stride);
+		}
+		else
+		{
+			// Still no CPU culling work; only the number of calls grows with the objects.
+			for (uint32_t draw = 0; draw < objectCount; ++draw)
+			{
+				vkCmdDrawIndexedIndirect(commandBuffer, frameDraws.drawBuffer, static_cast<VkDeviceSize>(draw) * stride, 1, stride);
+			}
+		}
+	}
+
+	void IndirectDrawManager::clean()
+	{
+		if (!enabled)
+		{
+			return;
+		}
+
+		for (const auto& frameDraws : frames)
+		{
+			memoryAllocator->destroyBuffer(frameDraws.countBuffer, frameDraws.countMemory);
+			memoryAllocator->destroyBuffer(frameDraws.drawBuffer, frameDraws.drawMemory);
+		}
+		frames.clear();
+		memoryAllocator->destroyBuffer(objectBuffer, objectMemory);
+
+		vkDestroyPipeline(device, cullPipeline, nullptr);
+		vkDestroyPipelineLayout(device, drawPipelineLayout, nullptr);
+		vkDestroyPipelineLayout(device, cullPipelineLayout, nullptr);
+		vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+		vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
+	}
+
+}
@@ -0,0 +1,143 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include <vulkan/vulkan_core.h>
+
+#include "BufferManager.h"
+#include "MemoryAllocator.h"
+#include "PipelineRegistry.h"
+#include "utils/interfaces/Initializable.h"
+
+namespace tessera::vulkan
+{
+
+	class ComputeManager;
+	class DeletionQueue;
+	class UniformManager;
+	class UploadManager;
+	struct RenderPassContext;
+
+	// One object drawn by the GPU-driven path. Laid out as ObjectData in shaders/cull.comp and shaders/indirect.vert (std430).
+	struct GpuObject
+	{
+		glm::vec4 boundingSphere{ 0.0f };		// World space center in xyz, radius in w.
+		glm::vec4 transform{ 0.0f, 0.0f, 0.0f, 1.0f };	// Translation in xyz, uniform scale in w.
+		uint32_t indexCount = 0;
+		uint32_t firstIndex = 0;
+		int32_t vertexOffset = 0;
+		// MeshHandle the draw parameters were taken from; refreshes them when meshes move within the geometry buffers.
+		uint32_t mesh = 0;
+	};
+
+	static_assert(sizeof(GpuObject) == 48);
+
+	/**
+	 * @brief GPU-driven drawing of the objects in a storage buffer.
+	 *
+	 * A compute pass culls every object against the view frustum and writes the indirect draws of
+	 * the visible ones, which the main pass issues with a single vkCmdDrawIndexedIndirectCount. The
+	 * CPU cost of a frame no longer depends on the number of objects. Without drawIndirectCount the
+	 * draws keep one slot per object and culled ones draw no instances.
+	 *
+	 * Enabled by render.gpuDriven; replaces the CPU draw list while enabled. With the ComputeManager on an
+	 * async compute queue, culling is submitted there and overlaps the graphics work of the previous frame.
+	 */
+	class IndirectDrawManager final : public Initializable
+	{
+	public:
+		void init() override;
+		void clean() override;
+
+		// Whether render.gpuDriven asks for this path, for services initialized before this one.
+		static bool isRequested();
+		// Whether the device allows it; init() falls back to the CPU draw list otherwise.
+		static bool isSupported();
+		[[nodiscard]] bool isEnabled() const { return enabled; }
+
+		// Replace every object. Takes effect with the next recorded frame. All of them must use meshes with one index type.
+		void setObjects(const std::vector<GpuObject>& newObjects);
+		[[nodiscard]] uint32_t getObjectCount() const { return objectCount; }
+
+		// Object drawing the whole mesh at position, scaled by scale.
+		[[nodiscard]] GpuObject makeMeshObject(MeshHandle mesh, const glm::vec3& position, float scale) const;
+
+		// Reset the draw count and cull the objects; recorded outside of any render pass, or into the async compute command buffer.
+		void recordCulling(VkCommandBuffer commandBuffer, int frame);
+		// Issue the draws written by recordCulling(); recorded inside the main pass, and the depth prepass with depthOnly.
+		void recordDraws(const RenderPassContext& context, bool depthOnly) const;
+	private:
+		// Written by the culling pass of one frame in flight.
+		struct FrameDraws
+		{
+			VkBuffer drawBuffer = VK_NULL_HANDLE;
+			MemoryAllocation drawMemory;
+			VkBuffer countBuffer = VK_NULL_HANDLE;
+			MemoryAllocation countMemory;
+			VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+			// Compared with buffersVersion to rewrite the descriptors once the frame is recorded again.
+			uint64_t descriptorVersion = 0;
+		};
+
+		struct CullingConstants
+		{
+			std::array<glm::vec4, 6> frustumPlanes;
+			uint32_t objectCount;
+			uint32_t compact;
+		};
+
+		void createDescriptorObjects();
+		void createPipelines();
+		[[nodiscard]] VkPipeline createCullPipeline() const;
+		void onShaderReloaded(VkShaderModule oldModule, VkShaderModule newModule);
+		void createFrameBuffers(uint32_t capacity);
+		void uploadObjects();
+		void releaseFrameBuffers();
+		void updateDescriptorSet(FrameDraws& frameDraws) const;
+
+		bool enabled = false;
+		bool drawCountEnabled = false;
+		bool multiDrawEnabled = false;
+
+		VkDevice device = VK_NULL_HANDLE;
+		VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
+		VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+		VkPipelineLayout cullPipelineLayout = VK_NULL_HANDLE;
+		VkPipeline cullPipeline = VK_NULL_HANDLE;
+		VkPipelineLayout drawPipelineLayout = VK_NULL_HANDLE;
+		// Looked up every frame, since shader reloads replace the pipeline.
+		PipelineHandle drawPipelineHandle = 0;
+		// Only compiled with the depth prepass enabled.
+		PipelineHandle depthPipelineHandle = 0;
+		// Owned by the ShaderLibrary; tells reloads of the culling shader apart.
+		VkShaderModule cullShaderModule = VK_NULL_HANDLE;
+
+		VkBuffer objectBuffer = VK_NULL_HANDLE;
+		MemoryAllocation objectMemory;
+		uint32_t objectCount = 0;
+		// Kept to rewrite the draw parameters once the BufferManager moved the meshes.
+		std::vector<GpuObject> objects;
+		uint64_t geometryVersion = 0;
+		VkIndexType indexType = VK_INDEX_TYPE_UINT16;
+		// Objects the draw and count buffers of every frame have room for.
+		uint32_t capacity = 0;
+		uint64_t buffersVersion = 1;
+		std::vector<FrameDraws> frames;
+
+		// Left null unless init() enabled GPU-driven drawing.
+		BufferManager* bufferManager = nullptr;
+		MemoryAllocator* memoryAllocator = nullptr;
+		UploadManager* uploadManager = nullptr;
+		PipelineRegistry* pipelineRegistry = nullptr;
+		DeletionQueue* deletionQueue = nullptr;
+		// Objects are culled against the frustum of its camera and drawn with it.
+		UniformManager* uniformManager = nullptr;
+		// Queue families the draw and count buffers are shared between, written by culling and read by drawing.
+		std::vector<uint32_t> drawQueueFamilies;
+
+		static constexpr uint32_t WORKGROUP_SIZE = 64;
+		static constexpr uint32_t MIN_CAPACITY = 1024;
+	};
+
+}
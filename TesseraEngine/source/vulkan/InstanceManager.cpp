@@ -1,10 +1,12 @@
 #include "InstanceManager.h"
 
+#include <algorithm>
 #include <stdexcept>
 #include <GLFW/glfw3.h>
 
 #include "DebugManager.h"
 #include "ExtensionManager.h"
+#include "utils/TesseraLog.h"
 
 namespace tessera::vulkan
 {
@@ -24,7 +26,8 @@ namespace tessera::vulkan
 		appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
 		appInfo.pEngineName = "Tessera Engine";
 		appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-		appInfo.apiVersion = VK_API_VERSION_1_0;
+		apiVersion = std::min(queryInstanceVersion(), MAX_API_VERSION);
+		appInfo.apiVersion = apiVersion;
 
 		VkInstanceCreateInfo createInfo{};
 		createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
@@ -32,11 +35,18 @@ namespace tessera::vulkan
 
 		checkIfAllGlsfRequiredExtensionsAreSupported();
 
-		const std::vector<const char*> requiredExtensions = getRequiredInstanceExtensions();
-		createInfo.enabledExtensionCount = static_cast<uint32_t>(requiredExtensions.size());
-		createInfo.ppEnabledExtensionNames = requiredExtensions.data();
+		std::vector<const char*> extensions = getRequiredInstanceExtensions();
+		debugUtilsEnabled = DebugManager::validationLayersAreEnabled();
+
+		// Command buffer labels cost nothing when no tool listens, so keep them in release builds when available.
+		if (!debugUtilsEnabled && isInstanceExtensionSupported(VK_EXT_DEBUG_UTILS_EXTENSION_NAME))
+		{
+			extensions.emplace_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+			debugUtilsEnabled = true;
+		}
 
 		VkDebugUtilsMessengerCreateInfoEXT debugCreateInfo{};
+		VkValidationFeaturesEXT validationFeatures{};
 
 		const std::vector<const char*> validationLayers = DebugManager::getValidationLayers();
 		if (DebugManager::validationLayersAreEnabled()) 
@@ -46,6 +56,20 @@ namespace tessera::vulkan
 
 			DebugManager::populate(debugCreateInfo);
 			createInfo.pNext = &debugCreateInfo;
+
+			// The layer itself provides VK_EXT_validation_features.
+			if (DebugManager::populateValidationFeatures(validationFeatures))
+			{
+				if (isInstanceExtensionSupported(VK_EXT_VALIDATION_FEATURES_EXTENSION_NAME, validationLayers.front()))
+				{
+					extensions.emplace_back(VK_EXT_VALIDATION_FEATURES_EXTENSION_NAME);
+					debugCreateInfo.pNext = &validationFeatures;
+				}
+				else
+				{
+					TesseraLog::send(LogType::WARNING, "InstanceManager", "The validation layer does not support VK_EXT_validation_features, using full validation.");
+				}
+			}
 		}
 		else 
 		{
@@ -53,12 +77,33 @@ namespace tessera::vulkan
 			createInfo.pNext = nullptr;
 		}
 
+		createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+		createInfo.ppEnabledExtensionNames = extensions.data();
+
 		if (vkCreateInstance(&createInfo, nullptr, &instance) != VK_SUCCESS)
 		{
 			throw std::runtime_error("VulkanInstanceManager: failed to create instance.");
 		}
 	}
 
+	uint32_t InstanceManager::queryInstanceVersion()
+	{
+		// Vulkan 1.0 loaders do not export vkEnumerateInstanceVersion.
+		const auto enumerateInstanceVersion = reinterpret_cast<PFN_vkEnumerateInstanceVersion>(vkGetInstanceProcAddr(nullptr, "vkEnumerateInstanceVersion"));
+		if (enumerateInstanceVersion == nullptr)
+		{
+			return VK_API_VERSION_1_0;
+		}
+
+		uint32_t version = VK_API_VERSION_1_0;
+		if (enumerateInstanceVersion(&version) != VK_SUCCESS)
+		{
+			return VK_API_VERSION_1_0;
+		}
+
+		return version;
+	}
+
 	void InstanceManager::clean()
 	{
 		vkDestroyInstance(instance, nullptr);
@@ -13,10 +13,20 @@ namespace tessera::vulkan
 		void clean() override;
 
 		[[nodiscard]] VkInstance getInstance() const { return instance; }
+		// Vulkan version the instance was created with; device level features above it cannot be used.
+		[[nodiscard]] uint32_t getApiVersion() const { return apiVersion; }
+		// VK_EXT_debug_utils is enabled with validation, or whenever a layer such as RenderDoc provides it.
+		[[nodiscard]] bool isDebugUtilsEnabled() const { return debugUtilsEnabled; }
 	private:
 		void createInstance();
+		static uint32_t queryInstanceVersion();
 
 		VkInstance instance = VK_NULL_HANDLE;
+		uint32_t apiVersion = VK_API_VERSION_1_0;
+		bool debugUtilsEnabled = false;
+
+		// Highest version the engine requests; timeline semaphores are core from 1.2, dynamic rendering from 1.3.
+		static constexpr uint32_t MAX_API_VERSION = VK_API_VERSION_1_3;
 	};
 
 }
@@ -0,0 +1,121 @@
+#include "InstancingManager.h"
+
+#include <ranges>
+#include <stdexcept>
+
+#include "BufferManager.h"
+#include "DeletionQueue.h"
+#include "GraphicsPipelineManager.h"
+#include "UploadManager.h"
+#include "utils/interfaces/ServiceLocator.h"
+
+namespace tessera::vulkan
+{
+
+	void InstancingManager::init()
+	{
+		bufferManager = ServiceLocator::getServicePointer<BufferManager>();
+		graphicsPipelineManager = ServiceLocator::getServicePointer<GraphicsPipelineManager>();
+		memoryAllocator = ServiceLocator::getServicePointer<MemoryAllocator>();
+		uploadManager = ServiceLocator::getServicePointer<UploadManager>();
+		deletionQueue = ServiceLocator::getServicePointer<DeletionQueue>();
+	}
+
+	InstanceBatchHandle InstancingManager::createBatch(const MeshHandle mesh, const std::vector<InstanceData>& instances)
+	{
+		const InstanceBatchHandle handle = nextHandle++;
+		Batch batch = createBuffer(instances);
+		batch.mesh = mesh;
+		batches.emplace(handle, batch);
+		return handle;
+	}
+
+	void InstancingManager::updateBatch(const InstanceBatchHandle handle, const std::vector<InstanceData>& instances)
+	{
+		const auto batch = batches.find(handle);
+		if (batch == batches.end())
+		{
+			throw std::out_of_range("InstancingManager: unknown instance batch.");
+		}
+
+		const MeshHandle mesh = batch->second.mesh;
+		releaseBuffer(batch->second);
+		batch->second = createBuffer(instances);
+		batch->second.mesh = mesh;
+	}
+
+	void InstancingManager::destroyBatch(const InstanceBatchHandle handle)
+	{
+		if (const auto batch = batches.find(handle); batch != batches.end())
+		{
+			releaseBuffer(batch->second);
+			batches.erase(batch);
+		}
+	}
+
+	InstancingManager::Batch InstancingManager::createBuffer(const std::vector<InstanceData>& instances) const
+	{
+		Batch batch;
+		batch.instanceCount = static_cast<uint32_t>(instances.size());
+		if (instances.empty())
+		{
+			return batch;
+		}
+
+		const VkDeviceSize size = sizeof(InstanceData) * instances.size();
+		memoryAllocator->createBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			batch.buffer, batch.memory, uploadManager->getSharedQueueFamilies());
+		uploadManager->uploadToBuffer(instances.data(), size, batch.buffer);
+
+		return batch;
+	}
+
+	void InstancingManager::releaseBuffer(const Batch& batch) const
+	{
+		if (batch.buffer == VK_NULL_HANDLE)
+		{
+			return;
+		}
+
+		deletionQueue->push([allocator = memoryAllocator, buffer = batch.buffer, memory = batch.memory]
+			{
+				allocator->destroyBuffer(buffer, memory);
+			});
+	}
+
+	DrawCommand InstancingManager::makeDraw(const InstanceBatchHandle handle) const
+	{
+		const Batch& batch = batches.at(handle);
+
+		DrawCommand draw = bufferManager->makeDraw(batch.mesh);
+		draw.pipeline = graphicsPipelineManager->getInstancedPipeline();
+		draw.depthPipeline = graphicsPipelineManager->getInstancedDepthPipeline();
+		draw.instanceBuffer = batch.buffer;
+		draw.instanceCount = batch.instanceCount;
+		return draw;
+	}
+
+	void InstancingManager::appendDraws(DrawList& drawList) const
+	{
+		for (const auto& [handle, batch] : batches)
+		{
+			if (batch.instanceCount > 0)
+			{
+				drawList.push_back(makeDraw(handle));
+			}
+		}
+	}
+
+	void InstancingManager::clean()
+	{
+		for (const auto& batch : batches | std::views::values)
+		{
+			if (batch.buffer != VK_NULL_HANDLE)
+			{
+				memoryAllocator->destroyBuffer(batch.buffer, batch.memory);
+			}
+		}
+		batches.clear();
+	}
+
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+#include "BufferManager.h"
+#include "DrawList.h"
+#include "MemoryAllocator.h"
+#include "entities/Vertex.h"
+#include "utils/interfaces/Initializable.h"
+
+namespace tessera::vulkan
+{
+
+	class DeletionQueue;
+	class GraphicsPipelineManager;
+	class UploadManager;
+
+	using InstanceBatchHandle = uint32_t;
+
+	/**
+	 * @brief Batches of instances of a mesh, each drawn with a single instanced draw.
+	 *
+	 * The instance data of a batch lives in a device-local vertex buffer bound to InstanceData::BINDING.
+	 * Every batch is appended to the draw list of each frame until destroyed. Batches are meant to be
+	 * changed from the thread recording frames.
+	 */
+	class InstancingManager final : public Initializable
+	{
+	public:
+		void init() override;
+		void clean() override;
+
+		InstanceBatchHandle createBatch(MeshHandle mesh, const std::vector<InstanceData>& instances);
+		// Frames in flight keep drawing the previous instances, so the data goes into a new buffer.
+		void updateBatch(InstanceBatchHandle handle, const std::vector<InstanceData>& instances);
+		void destroyBatch(InstanceBatchHandle handle);
+
+		// Instanced draw of every instance of the batch.
+		[[nodiscard]] DrawCommand makeDraw(InstanceBatchHandle handle) const;
+		void appendDraws(DrawList& drawList) const;
+	private:
+		struct Batch
+		{
+			VkBuffer buffer = VK_NULL_HANDLE;
+			MemoryAllocation memory;
+			uint32_t instanceCount = 0;
+			MeshHandle mesh = 0;
+		};
+
+		[[nodiscard]] Batch createBuffer(const std::vector<InstanceData>& instances) const;
+		void releaseBuffer(const Batch& batch) const;
+
+		std::map<InstanceBatchHandle, Batch> batches;
+		InstanceBatchHandle nextHandle = 1;
+
+		// Batches are uploaded and released through these long after init().
+		BufferManager* bufferManager = nullptr;
+		GraphicsPipelineManager* graphicsPipelineManager = nullptr;
+		MemoryAllocator* memoryAllocator = nullptr;
+		UploadManager* uploadManager = nullptr;
+		DeletionQueue* deletionQueue = nullptr;
+	};
+
+}
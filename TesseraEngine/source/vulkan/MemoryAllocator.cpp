@@ -0,0 +1,541 @@
+#include "MemoryAllocator.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "DeviceManager.h"
+#include "utils/EngineConfig.h"
+#include "utils/TesseraLog.h"
+#include "utils/interfaces/ServiceLocator.h"
+
+namespace tessera::vulkan
+{
+
+	namespace
+	{
+		VkDeviceSize alignUp(const VkDeviceSize value, const VkDeviceSize alignment)
+		{
+			return (value + alignment - 1) / alignment * alignment;
+		}
+
+		double toMegabytes(const VkDeviceSize bytes)
+		{
+			return static_cast<double>(bytes) / (1024.0 * 1024.0);
+		}
+
+		constexpr const char* CATEGORY_NAMES[MEMORY_CATEGORY_COUNT] = { "Buffers", "Images", "Staging" };
+	}
+
+	void MemoryAllocator::init()
+	{
+		const auto& deviceManager = ServiceLocator::getService<DeviceManager>();
+		physicalDevice = deviceManager->getPhysicalDevice();
+		device = deviceManager->getLogicalDevice();
+		memoryBudgetEnabled = deviceManager->getCapabilities().memoryBudget;
+
+		const auto& config = ServiceLocator::getService<EngineConfig>();
+		logStatisticsEnabled = config->getBool("profiling.memory", false);
+		logInterval = static_cast<uint32_t>(std::max(config->getInt("profiling.logIntervalFrames", 300), 0));
+
+		// Memory properties never change for the lifetime of the physical device, so they are queried once.
+		vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+
+		VkPhysicalDeviceProperties deviceProperties;
+		vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+		nonCoherentAtomSize = std::max<VkDeviceSize>(deviceProperties.limits.nonCoherentAtomSize, 1);
+		maxMemoryAllocationCount = deviceProperties.limits.maxMemoryAllocationCount;
+	}
+
+	void MemoryAllocator::clean()
+	{
+		std::lock_guard lock(allocatorMutex);
+
+		for (const auto& [memory, block] : blocks)
+		{
+			if (block.usedBytes > 0)
+			{
+				TesseraLog::send(LogType::WARNING, "MemoryAllocator", "Memory block destroyed with " + std::to_string(block.usedBytes) + " bytes still allocated.");
+			}
+
+			destroyBlock(block);
+		}
+
+		blocks.clear();
+	}
+
+	MemoryAllocation MemoryAllocator::allocate(const VkMemoryRequirements& requirements, const VkMemoryPropertyFlags properties, const ResourceKind kind,
+		const MemoryCategory category)
+	{
+		std::lock_guard lock(allocatorMutex);
+
+		const uint32_t memoryTypeIndex = findMemoryType(requirements.memoryTypeBits, properties);
+
+		VkDeviceSize alignment = std::max<VkDeviceSize>(requirements.alignment, 1);
+		VkDeviceSize size = requirements.size;
+
+		// Mapped ranges of non-coherent memory are flushed in multiples of nonCoherentAtomSize,
+		// so neighbouring suballocations must not share an atom.
+		if (isHostVisible(memoryTypeIndex) && !isHostCoherent(memoryTypeIndex))
+		{
+			alignment = std::max(alignment, nonCoherentAtomSize);
+			size = alignUp(size, nonCoherentAtomSize);
+		}
+
+		const VkDeviceSize preferredBlockSize = getPreferredBlockSize(memoryTypeIndex);
+
+		// Big resources get their own allocation instead of wasting most of a shared block. Lazily allocated memory is
+		// committed per allocation as tiles spill into it, so a shared block would be committed for all its neighbours.
+		if (size > preferredBlockSize / 2 || isLazilyAllocated(memoryTypeIndex))
+		{
+			MemoryBlock& block = createBlock(size, memoryTypeIndex, kind, true);
+			block.usedBytes = size;
+			block.freeRanges.clear();
+			categories[static_cast<size_t>(category)].bytes += size;
+			++categories[static_cast<size_t>(category)].allocations;
+			return { block.memory, 0, size, block.mappedData, memoryTypeIndex, category };
+		}
+
+		VkDeviceSize offset = 0;
+		for (auto& [memory, block] : blocks)
+		{
+			if (block.dedicated || block.memoryTypeIndex != memoryTypeIndex || block.kind != kind)
+			{
+				continue;
+			}
+
+			if (trySuballocate(block, size, alignment, offset))
+			{
+				categories[static_cast<size_t>(category)].bytes += size;
+				++categories[static_cast<size_t>(category)].allocations;
+				void* mappedData = block.mappedData ? static_cast<char*>(block.mappedData) + offset : nullptr;
+				return { block.memory, offset, size, mappedData, memoryTypeIndex, category };
+			}
+		}
+
+		MemoryBlock& block = createBlock(preferredBlockSize, memoryTypeIndex, kind, false);
+		if (!trySuballocate(block, size, alignment, offset))
+		{
+			throw std::runtime_error("MemoryAllocator: failed to suballocate from a freshly created memory block.");
+		}
+
+		categories[static_cast<size_t>(category)].bytes += size;
+		++categories[static_cast<size_t>(category)].allocations;
+		void* mappedData = block.mappedData ? static_cast<char*>(block.mappedData) + offset : nullptr;
+		return { block.memory, offset, size, mappedData, memoryTypeIndex, category };
+	}
+
+	void MemoryAllocator::free(const MemoryAllocation& allocation)
+	{
+		if (!allocation.isValid())
+		{
+			return;
+		}
+
+		std::lock_guard lock(allocatorMutex);
+
+		const auto it = blocks.find(allocation.memory);
+		if (it == blocks.end())
+		{
+			throw std::runtime_error("MemoryAllocator: attempt to free memory that was not allocated by this allocator.");
+		}
+
+		categories[static_cast<size_t>(allocation.category)].bytes -= allocation.size;
+		--categories[static_cast<size_t>(allocation.category)].allocations;
+
+		MemoryBlock& block = it->second;
+		if (block.dedicated)
+		{
+			destroyBlock(block);
+			blocks.erase(it);
+			return;
+		}
+
+		releaseRange(block, allocation.offset, allocation.size);
+		block.usedBytes -= allocation.size;
+
+		if (block.usedBytes > 0)
+		{
+			return;
+		}
+
+		// Keep one empty block per memory type and kind around to avoid allocation churn.
+		const bool hasSiblingBlock = std::ranges::any_of(blocks, [&](const auto& entry)
+			{
+				const MemoryBlock& other = entry.second;
+				return other.memory != block.memory && !other.dedicated && other.memoryTypeIndex == block.memoryTypeIndex && other.kind == block.kind;
+			});
+
+		if (hasSiblingBlock)
+		{
+			destroyBlock(block);
+			blocks.erase(it);
+		}
+	}
+
+	void MemoryAllocator::createBuffer(const VkDeviceSize size, const VkBufferUsageFlags usage, const VkMemoryPropertyFlags properties, VkBuffer& buffer, MemoryAllocation& allocation,
+		const std::vector<uint32_t>& sharedQueueFamilies)
+	{
+		VkBufferCreateInfo bufferInfo{};
+		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferInfo.size = size;
+		bufferInfo.usage = usage;
+
+		if (sharedQueueFamilies.size() > 1)
+		{
+			bufferInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+			bufferInfo.queueFamilyIndexCount = static_cast<uint32_t>(sharedQueueFamilies.size());
+			bufferInfo.pQueueFamilyIndices = sharedQueueFamilies.data();
+		}
+		else
+		{
+			bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		}
+
+		if (vkCreateBuffer(device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS)
+		{
+			throw std::runtime_error("MemoryAllocator: failed to create buffer.");
+		}
+
+		VkMemoryRequirements memRequirements;
+		vkGetBufferMemoryRequirements(device, buffer, &memRequirements);
+
+		// Buffers only ever copied from out of host memory stage uploads.
+		const bool staging = usage == VK_BUFFER_USAGE_TRANSFER_SRC_BIT && (properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0;
+		// Allocation fails at runtime once the budget is exhausted, which must not leak the buffer or hand it out.
+		try
+		{
+			allocation = allocate(memRequirements, properties, ResourceKind::LINEAR, staging ? MemoryCategory::STAGING : MemoryCategory::BUFFER);
+			if (vkBindBufferMemory(device, buffer, allocation.memory, allocation.offset) != VK_SUCCESS)
+			{
+				free(allocation);
+				throw std::runtime_error("MemoryAllocator: failed to bind buffer memory.");
+			}
+		}
+		catch (...)
+		{
+			vkDestroyBuffer(device, buffer, nullptr);
+			buffer = VK_NULL_HANDLE;
+			throw;
+		}
+	}
+
+	void MemoryAllocator::destroyBuffer(const VkBuffer buffer, const MemoryAllocation& allocation)
+	{
+		vkDestroyBuffer(device, buffer, nullptr);
+		free(allocation);
+	}
+
+	void MemoryAllocator::createImage(const VkImageCreateInfo& imageInfo, const VkMemoryPropertyFlags properties, VkImage& image, MemoryAllocation& allocation)
+	{
+		if (vkCreateImage(device, &imageInfo, nullptr, &image) != VK_SUCCESS)
+		{
+			throw std::runtime_error("MemoryAllocator: failed to create image.");
+		}
+
+		VkMemoryRequirements memRequirements;
+		vkGetImageMemoryRequirements(device, image, &memRequirements);
+
+		const ResourceKind kind = imageInfo.tiling == VK_IMAGE_TILING_OPTIMAL ? ResourceKind::OPTIMAL : ResourceKind::LINEAR;
+		try
+		{
+			allocation = allocate(memRequirements, properties, kind, MemoryCategory::IMAGE);
+			if (vkBindImageMemory(device, image, allocation.memory, allocation.offset) != VK_SUCCESS)
+			{
+				free(allocation);
+				throw std::runtime_error("MemoryAllocator: failed to bind image memory.");
+			}
+		}
+		catch (...)
+		{
+			vkDestroyImage(device, image, nullptr);
+			image = VK_NULL_HANDLE;
+			throw;
+		}
+	}
+
+	void MemoryAllocator::destroyImage(const VkImage image, const MemoryAllocation& allocation)
+	{
+		vkDestroyImage(device, image, nullptr);
+		free(allocation);
+	}
+
+	uint32_t MemoryAllocator::findMemoryType(const uint32_t typeFilter, const VkMemoryPropertyFlags properties) const
+	{
+		for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++)
+		{
+			if (typeFilter & 1 << i && (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties)
+			{
+				return i;
+			}
+		}
+
+		throw std::runtime_error("MemoryAllocator: failed to find suitable memory type.");
+	}
+
+	bool MemoryAllocator::hasMemoryType(const uint32_t typeFilter, const VkMemoryPropertyFlags properties) const
+	{
+		for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++)
+		{
+			if (typeFilter & 1 << i && (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	MemoryAllocator::MemoryBlock& MemoryAllocator::createBlock(const VkDeviceSize size, const uint32_t memoryTypeIndex, const ResourceKind kind, const bool dedicated)
+	{
+		if (maxMemoryAllocationCount > 0 && blocks.size() >= maxMemoryAllocationCount)
+		{
+			throw std::runtime_error("MemoryAllocator: maxMemoryAllocationCount limit reached.");
+		}
+
+		const uint32_t heapIndex = memoryProperties.memoryTypes[memoryTypeIndex].heapIndex;
+		checkBudget(heapIndex, size);
+
+		VkMemoryAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		allocInfo.allocationSize = size;
+		allocInfo.memoryTypeIndex = memoryTypeIndex;
+
+		MemoryBlock block;
+		if (vkAllocateMemory(device, &allocInfo, nullptr, &block.memory) != VK_SUCCESS)
+		{
+			throw std::runtime_error("MemoryAllocator: failed to allocate device memory.");
+		}
+
+		// Host visible blocks stay mapped for their whole lifetime.
+		if (isHostVisible(memoryTypeIndex) && vkMapMemory(device, block.memory, 0, VK_WHOLE_SIZE, 0, &block.mappedData) != VK_SUCCESS)
+		{
+			vkFreeMemory(device, block.memory, nullptr);
+			throw std::runtime_error("MemoryAllocator: failed to map memory block.");
+		}
+
+		block.size = size;
+		block.memoryTypeIndex = memoryTypeIndex;
+		block.kind = kind;
+		block.dedicated = dedicated;
+		block.freeRanges.emplace(0, size);
+		heapBlockBytes[heapIndex] += size;
+
+		TESSERA_LOG(LogType::DEBUG, "MemoryAllocator", "Allocated " + std::string(dedicated ? "dedicated " : "") + "memory block of "
+			+ std::to_string(size) + " bytes in memory type " + std::to_string(memoryTypeIndex) + ".");
+
+		const VkDeviceMemory memory = block.memory;
+		return blocks.emplace(memory, std::move(block)).first->second;
+	}
+
+	void MemoryAllocator::destroyBlock(const MemoryBlock& block)
+	{
+		heapBlockBytes[memoryProperties.memoryTypes[block.memoryTypeIndex].heapIndex] -= block.size;
+
+		if (block.mappedData)
+		{
+			vkUnmapMemory(device, block.memory);
+		}
+
+		vkFreeMemory(device, block.memory, nullptr);
+	}
+
+	bool MemoryAllocator::trySuballocate(MemoryBlock& block, const VkDeviceSize size, const VkDeviceSize alignment, VkDeviceSize& resultOffset)
+	{
+		// First fit over the ordered free list.
+		for (auto it = block.freeRanges.begin(); it != block.freeRanges.end(); ++it)
+		{
+			const auto [rangeOffset, rangeSize] = *it;
+			const VkDeviceSize alignedOffset = alignUp(rangeOffset, alignment);
+			const VkDeviceSize padding = alignedOffset - rangeOffset;
+
+			if (rangeSize < padding + size)
+			{
+				continue;
+			}
+
+			block.freeRanges.erase(it);
+
+			if (padding > 0)
+			{
+				block.freeRanges.emplace(rangeOffset, padding);
+			}
+
+			const VkDeviceSize tail = rangeSize - padding - size;
+			if (tail > 0)
+			{
+				block.freeRanges.emplace(alignedOffset + size, tail);
+			}
+
+			block.usedBytes += size;
+			resultOffset = alignedOffset;
+			return true;
+		}
+
+		return false;
+	}
+
+	void MemoryAllocator::releaseRange(MemoryBlock& block, VkDeviceSize offset, VkDeviceSize size)
+	{
+		auto next = block.freeRanges.lower_bound(offset);
+
+		// Merge with the preceding free range.
+		if (next != block.freeRanges.begin())
+		{
+			const auto previous = std::prev(next);
+			if (previous->first + previous->second == offset)
+			{
+				offset = previous->first;
+				size += previous->second;
+				block.freeRanges.erase(previous);
+			}
+		}
+
+		// Merge with the following free range.
+		if (next != block.freeRanges.end() && offset + size == next->first)
+		{
+			size += next->second;
+			block.freeRanges.erase(next);
+		}
+
+		block.freeRanges.emplace(offset, size);
+	}
+
+	VkDeviceSize MemoryAllocator::getPreferredBlockSize(const uint32_t memoryTypeIndex) const
+	{
+		const uint32_t heapIndex = memoryProperties.memoryTypes[memoryTypeIndex].heapIndex;
+		const VkDeviceSize heapSize = memoryProperties.memoryHeaps[heapIndex].size;
+
+		return heapSize <= SMALL_HEAP_THRESHOLD ? heapSize / 8 : LARGE_HEAP_BLOCK_SIZE;
+	}
+
+	bool MemoryAllocator::isHostVisible(const uint32_t memoryTypeIndex) const
+	{
+		return memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+	}
+
+	bool MemoryAllocator::isHostCoherent(const uint32_t memoryTypeIndex) const
+	{
+		return memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+	}
+
+	bool MemoryAllocator::isLazilyAllocated(const uint32_t memoryTypeIndex) const
+	{
+		return memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
+	}
+
+	MemoryStatistics MemoryAllocator::getStatistics()
+	{
+		std::lock_guard lock(allocatorMutex);
+		return collectStatistics();
+	}
+
+	MemoryStatistics MemoryAllocator::collectStatistics() const
+	{
+		VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties{};
+		budgetProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+		VkPhysicalDeviceMemoryProperties2 properties{};
+		properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+		properties.pNext = &budgetProperties;
+
+		// Budgets change with the other processes on the device, so they are queried every time.
+		if (memoryBudgetEnabled)
+		{
+			vkGetPhysicalDeviceMemoryProperties2(physicalDevice, &properties);
+		}
+
+		MemoryStatistics statistics;
+		statistics.categories = categories;
+		statistics.heaps.resize(memoryProperties.memoryHeapCount);
+		for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; ++i)
+		{
+			MemoryHeapStatistics& heap = statistics.heaps[i];
+			heap.size = memoryProperties.memoryHeaps[i].size;
+			heap.deviceLocal = (memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+			heap.blockBytes = heapBlockBytes[i];
+
+			if (memoryBudgetEnabled)
+			{
+				heap.usage = budgetProperties.heapUsage[i];
+				heap.budget = budgetProperties.heapBudget[i];
+			}
+			else
+			{
+				heap.usage = heap.blockBytes;
+				heap.budget = static_cast<VkDeviceSize>(static_cast<double>(heap.size) * ESTIMATED_BUDGET_RATIO);
+			}
+		}
+
+		return statistics;
+	}
+
+	void MemoryAllocator::checkBudget(const uint32_t heapIndex, const VkDeviceSize additionalBytes)
+	{
+		checkBudget(collectStatistics().heaps[heapIndex], heapIndex, additionalBytes);
+	}
+
+	void MemoryAllocator::checkBudget(const MemoryHeapStatistics& heap, const uint32_t heapIndex, const VkDeviceSize additionalBytes)
+	{
+		const VkDeviceSize usage = heap.usage + additionalBytes;
+		const bool overThreshold = static_cast<double>(usage) > static_cast<double>(heap.budget) * BUDGET_WARNING_RATIO;
+
+		// Exceeding the budget is not an error yet, but the driver may start to evict or fail allocations.
+		if (overThreshold && !heapWarned[heapIndex])
+		{
+			std::ostringstream message;
+			message << std::fixed << std::setprecision(1) << "Heap " << heapIndex << (heap.deviceLocal ? " (device local)" : "")
+				<< " is about to use " << toMegabytes(usage) << " MB of its " << toMegabytes(heap.budget) << " MB budget.";
+			TesseraLog::send(LogType::WARNING, "MemoryAllocator", message.str());
+		}
+		heapWarned[heapIndex] = overThreshold;
+	}
+
+	void MemoryAllocator::update(const uint64_t frameNumber)
+	{
+		const bool logDue = logStatisticsEnabled && logInterval > 0 && frameNumber > 0 && frameNumber % logInterval == 0;
+		if (!logDue && frameNumber % BUDGET_CHECK_INTERVAL_FRAMES != 0)
+		{
+			return;
+		}
+
+		MemoryStatistics statistics;
+		{
+			std::lock_guard lock(allocatorMutex);
+			statistics = collectStatistics();
+			for (uint32_t i = 0; i < statistics.heaps.size(); ++i)
+			{
+				checkBudget(statistics.heaps[i], i, 0);
+			}
+		}
+
+		if (logDue)
+		{
+			logStatistics(statistics, frameNumber);
+		}
+	}
+
+	void MemoryAllocator::logStatistics(const MemoryStatistics& statistics, const uint64_t frameNumber) const
+	{
+		std::ostringstream report;
+		report << std::fixed << std::setprecision(1);
+		for (size_t i = 0; i < statistics.heaps.size(); ++i)
+		{
+			const MemoryHeapStatistics& heap = statistics.heaps[i];
+			report << "\n\tHeap " << i << (heap.deviceLocal ? " (device local)" : "") << ": " << toMegabytes(heap.usage) << " of "
+				<< toMegabytes(heap.budget) << " MB budget" << (memoryBudgetEnabled ? "" : " (estimated)") << ", " << toMegabytes(heap.blockBytes)
+				<< " MB in blocks of " << toMegabytes(heap.size) << " MB";
+		}
+
+		for (size_t i = 0; i < MEMORY_CATEGORY_COUNT; ++i)
+		{
+			report << "\n\t" << CATEGORY_NAMES[i] << ": " << toMegabytes(statistics.categories[i].bytes) << " MB in "
+				<< statistics.categories[i].allocations << " allocations";
+		}
+
+		TesseraLog::send(LogType::INFO, "MemoryAllocator", "Memory after " + std::to_string(frameNumber) + " frames:" + report.str());
+	}
+
+}
@@ -0,0 +1,159 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+#include "utils/interfaces/Initializable.h"
+
+namespace tessera::vulkan
+{
+
+	/**
+	 * @brief Kind of resource bound to the allocation.
+	 *
+	 * Linear resources (buffers) and optimal tiling images are never placed in the same memory block,
+	 * so bufferImageGranularity never has to be taken into account between neighbouring suballocations.
+	 */
+	enum class ResourceKind : uint8_t
+	{
+		LINEAR,
+		OPTIMAL
+	};
+
+	// What the memory is reported as in MemoryStatistics.
+	enum class MemoryCategory : uint8_t
+	{
+		BUFFER,
+		IMAGE,
+		// Host visible buffers only ever copied from.
+		STAGING
+	};
+
+	inline constexpr size_t MEMORY_CATEGORY_COUNT = 3;
+
+	struct MemoryAllocation
+	{
+		VkDeviceMemory memory = VK_NULL_HANDLE;
+		VkDeviceSize offset = 0;
+		VkDeviceSize size = 0;
+		void* mappedData = nullptr;
+		uint32_t memoryTypeIndex = 0;
+		MemoryCategory category = MemoryCategory::BUFFER;
+
+		[[nodiscard]] bool isValid() const { return memory != VK_NULL_HANDLE; }
+	};
+
+	struct MemoryHeapStatistics
+	{
+		VkDeviceSize size = 0;
+		bool deviceLocal = false;
+		// Memory blocks this allocator holds in the heap.
+		VkDeviceSize blockBytes = 0;
+		// Of the whole process with VK_EXT_memory_budget, otherwise estimated from blockBytes and the heap size.
+		VkDeviceSize usage = 0;
+		VkDeviceSize budget = 0;
+	};
+
+	struct MemoryCategoryStatistics
+	{
+		VkDeviceSize bytes = 0;
+		uint32_t allocations = 0;
+	};
+
+	struct MemoryStatistics
+	{
+		std::vector<MemoryHeapStatistics> heaps;
+		// Indexed by MemoryCategory; the bytes resources asked for, without what blocks keep free.
+		std::array<MemoryCategoryStatistics, MEMORY_CATEGORY_COUNT> categories{};
+	};
+
+	/**
+	 * @brief Suballocates buffers and images from large memory blocks and keeps track of the memory budget.
+	 *
+	 * Usage and budget of every heap come from VK_EXT_memory_budget when the device supports it, and are
+	 * estimated otherwise. A warning is logged when a new block would take a heap past BUDGET_WARNING_RATIO
+	 * of its budget, and with profiling.memory the statistics are logged every profiling.logIntervalFrames frames.
+	 */
+	class MemoryAllocator final : public Initializable
+	{
+	public:
+		void init() override;
+		void clean() override;
+
+		[[nodiscard]] MemoryAllocation allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, ResourceKind kind, MemoryCategory category);
+		void free(const MemoryAllocation& allocation);
+
+		// Buffers accessed from several queue families (e.g. written by the transfer queue, read by graphics) are created concurrent.
+		void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, MemoryAllocation& allocation,
+			const std::vector<uint32_t>& sharedQueueFamilies = {});
+		void destroyBuffer(VkBuffer buffer, const MemoryAllocation& allocation);
+		void createImage(const VkImageCreateInfo& imageInfo, VkMemoryPropertyFlags properties, VkImage& image, MemoryAllocation& allocation);
+		void destroyImage(VkImage image, const MemoryAllocation& allocation);
+
+		[[nodiscard]] uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+		// Whether findMemoryType() would succeed, for optional properties such as VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT.
+		[[nodiscard]] bool hasMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+		[[nodiscard]] const VkPhysicalDeviceMemoryProperties& getMemoryProperties() const { return memoryProperties; }
+
+		// Queries the current budget, so it also reflects other processes.
+		[[nodiscard]] MemoryStatistics getStatistics();
+
+		// Refresh the budget warnings every BUDGET_CHECK_INTERVAL_FRAMES frames and log the statistics when due. Called once per frame.
+		void update(uint64_t frameNumber);
+	private:
+		struct MemoryBlock
+		{
+			VkDeviceMemory memory = VK_NULL_HANDLE;
+			VkDeviceSize size = 0;
+			void* mappedData = nullptr;
+			uint32_t memoryTypeIndex = 0;
+			ResourceKind kind = ResourceKind::LINEAR;
+			bool dedicated = false;
+			VkDeviceSize usedBytes = 0;
+			std::map<VkDeviceSize, VkDeviceSize> freeRanges; // Offset -> size, kept coalesced.
+		};
+
+		MemoryBlock& createBlock(VkDeviceSize size, uint32_t memoryTypeIndex, ResourceKind kind, bool dedicated);
+		void destroyBlock(const MemoryBlock& block);
+		// Called with allocatorMutex held, as are the two below.
+		[[nodiscard]] MemoryStatistics collectStatistics() const;
+		// Warn once per crossing when additionalBytes would take the heap past BUDGET_WARNING_RATIO of its budget.
+		void checkBudget(const MemoryHeapStatistics& heap, uint32_t heapIndex, VkDeviceSize additionalBytes);
+		void checkBudget(uint32_t heapIndex, VkDeviceSize additionalBytes);
+		void logStatistics(const MemoryStatistics& statistics, uint64_t frameNumber) const;
+		static bool trySuballocate(MemoryBlock& block, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& resultOffset);
+		static void releaseRange(MemoryBlock& block, VkDeviceSize offset, VkDeviceSize size);
+
+		[[nodiscard]] VkDeviceSize getPreferredBlockSize(uint32_t memoryTypeIndex) const;
+		[[nodiscard]] bool isHostVisible(uint32_t memoryTypeIndex) const;
+		[[nodiscard]] bool isHostCoherent(uint32_t memoryTypeIndex) const;
+		[[nodiscard]] bool isLazilyAllocated(uint32_t memoryTypeIndex) const;
+
+		VkDevice device = VK_NULL_HANDLE;
+		VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+		VkPhysicalDeviceMemoryProperties memoryProperties{};
+		bool memoryBudgetEnabled = false;
+		bool logStatisticsEnabled = false;
+		uint32_t logInterval = 0;
+		VkDeviceSize nonCoherentAtomSize = 1;
+		uint32_t maxMemoryAllocationCount = 0;
+
+		std::mutex allocatorMutex;
+		std::unordered_map<VkDeviceMemory, MemoryBlock> blocks;
+		std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS> heapBlockBytes{};
+		std::array<bool, VK_MAX_MEMORY_HEAPS> heapWarned{};
+		std::array<MemoryCategoryStatistics, MEMORY_CATEGORY_COUNT> categories{};
+
+		static constexpr VkDeviceSize LARGE_HEAP_BLOCK_SIZE = 64ull * 1024 * 1024;
+		static constexpr VkDeviceSize SMALL_HEAP_THRESHOLD = 1024ull * 1024 * 1024;
+		// Other processes and the driver need some room, so the budget estimated without the extension is a part of the heap.
+		static constexpr double ESTIMATED_BUDGET_RATIO = 0.8;
+		static constexpr double BUDGET_WARNING_RATIO = 0.9;
+		static constexpr uint64_t BUDGET_CHECK_INTERVAL_FRAMES = 60;
+	};
+
+}
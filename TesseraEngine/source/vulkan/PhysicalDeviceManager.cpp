@@ -1,15 +1,47 @@
 #include "PhysicalDeviceManager.h"
 
+#include <algorithm>
+#include <cctype>
+#include <charconv>
 #include <stdexcept>
-#include <vector>
+#include <tuple>
 
+#include "DeviceCapabilities.h"
 #include "ExtensionManager.h"
 #include "QueueManager.h"
 #include "SwapChainManager.h"
+#include "utils/TesseraLog.h"
 
 namespace tessera::vulkan
 {
-	void PhysicalDeviceManager::pickAnySuitableDevice(const VkInstance& instance, const VkSurfaceKHR& surface)
+
+	namespace
+	{
+		const char* getTypeName(const VkPhysicalDeviceType type)
+		{
+			switch (type)
+			{
+				case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+					return "discrete";
+				case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+					return "integrated";
+				case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+					return "virtual";
+				case VK_PHYSICAL_DEVICE_TYPE_CPU:
+					return "CPU";
+				default:
+					return "other";
+			}
+		}
+
+		std::string toLower(std::string text)
+		{
+			std::ranges::transform(text, text.begin(), [](const unsigned char c) { return static_cast<char>(std::tolower(c)); });
+			return text;
+		}
+	}
+
+	void PhysicalDeviceManager::pickBestDevice(const VkInstance& instance, const VkSurfaceKHR& surface, const uint32_t instanceApiVersion, const std::string& preferred)
 	{
 		uint32_t deviceCount = 0;
 		vkEnumeratePhysicalDevices(instance, &deviceCount, nullptr);
@@ -22,38 +54,143 @@ namespace tessera::vulkan
 		std::vector<VkPhysicalDevice> devices(deviceCount);
 		vkEnumeratePhysicalDevices(instance, &deviceCount, devices.data());
 
-		for (const auto& device : devices) 
+		std::vector<Candidate> candidates;
+		for (uint32_t i = 0; i < deviceCount; ++i)
 		{
-			if (isDeviceSuitable(device, surface)) 
+			Candidate candidate = scoreDevice(devices[i], i, instanceApiVersion);
+			if (!isDeviceSuitable(devices[i], surface))
 			{
-				physicalDevice = device;
-				return;
+				TesseraLog::send(LogType::INFO, "PhysicalDeviceManager", "GPU " + std::to_string(i) + ", " + candidate.name + ": not suitable.");
+				continue;
 			}
+
+			TesseraLog::send(LogType::INFO, "PhysicalDeviceManager", "GPU " + std::to_string(i) + ", " + candidate.name + ": " + candidate.summary
+				+ ", score " + std::to_string(candidate.score) + ".");
+			candidates.push_back(std::move(candidate));
+		}
+
+		if (candidates.empty())
+		{
+			throw std::runtime_error("VulkanPhysicalDeviceManager: failed to find a suitable GPU!");
 		}
 
-		throw std::runtime_error("VulkanPhysicalDeviceManager: failed to find a suitable GPU!");
+		// Memory breaks ties between equal scores; beyond that the order of the driver is kept, which usually lists the primary GPU first.
+		const Candidate* picked = findPreferred(candidates, preferred);
+		std::string reason = "the preferred GPU";
+		if (picked == nullptr)
+		{
+			picked = &*std::ranges::max_element(candidates, [](const Candidate& a, const Candidate& b)
+				{
+					return std::tie(a.score, a.deviceLocalMegabytes) < std::tie(b.score, b.deviceLocalMegabytes);
+				});
+			reason = "the highest score";
+		}
+
+		physicalDevice = picked->device;
+		TesseraLog::send(LogType::INFO, "PhysicalDeviceManager", "Using GPU " + std::to_string(picked->index) + ", " + picked->name + ", which has " + reason + ".");
 	}
 
-	bool PhysicalDeviceManager::isDeviceSuitable(const VkPhysicalDevice& device, const VkSurfaceKHR& surface)
+	const PhysicalDeviceManager::Candidate* PhysicalDeviceManager::findPreferred(const std::vector<Candidate>& candidates, const std::string& preferred)
 	{
-		// Basic device properties like the name, type and supported Vulkan version.
-		[[maybe_unused]] VkPhysicalDeviceProperties deviceProperties;
-		vkGetPhysicalDeviceProperties(device, &deviceProperties);
+		if (preferred.empty())
+		{
+			return nullptr;
+		}
+
+		uint32_t index = 0;
+		const auto [end, error] = std::from_chars(preferred.data(), preferred.data() + preferred.size(), index);
+		const bool byIndex = error == std::errc{} && end == preferred.data() + preferred.size();
+
+		const std::string name = toLower(preferred);
+		const auto candidate = std::ranges::find_if(candidates, [&](const Candidate& c)
+			{
+				return byIndex ? c.index == index : toLower(c.name).find(name) != std::string::npos;
+			});
 
-		// The support for optional features like texture compression, 64 bit floats and multi viewport rendering.
-		[[maybe_unused]] VkPhysicalDeviceFeatures deviceFeatures;
-		vkGetPhysicalDeviceFeatures(device, &deviceFeatures);
+		if (candidate == candidates.end())
+		{
+			TesseraLog::send(LogType::WARNING, "PhysicalDeviceManager", "No suitable GPU matches the preferred " + preferred + ", picking by score.");
+			return nullptr;
+		}
 
+		return &*candidate;
+	}
+
+	PhysicalDeviceManager::Candidate PhysicalDeviceManager::scoreDevice(const VkPhysicalDevice& device, const uint32_t index, const uint32_t instanceApiVersion)
+	{
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(device, &properties);
+
+		Candidate candidate;
+		candidate.device = device;
+		candidate.index = index;
+		candidate.name = properties.deviceName;
+		candidate.summary = getTypeName(properties.deviceType);
+
+		switch (properties.deviceType)
+		{
+			case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+				candidate.score += DISCRETE_SCORE;
+				break;
+			case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+				candidate.score += INTEGRATED_SCORE;
+				break;
+			case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+				candidate.score += VIRTUAL_SCORE;
+				break;
+			default:
+				break;
+		}
+
+		// The capabilities the engine branches on most, which DeviceManager enables when they are supported.
+		const DeviceCapabilities capabilities = DeviceCapabilities::query(device, instanceApiVersion);
+		const std::pair<const char*, bool> features[] = {
+			{ "timeline semaphores", capabilities.timelineSemaphore },
+			{ "descriptor indexing", capabilities.descriptorIndexing },
+			{ "indirect draw count", capabilities.drawIndirectCount },
+			{ "dynamic rendering", capabilities.dynamicRendering }
+		};
+
+		for (const auto& [name, supported] : features)
+		{
+			if (supported)
+			{
+				candidate.score += FEATURE_SCORE;
+				candidate.summary += std::string(", ") + name;
+			}
+		}
+
+		// Integrated GPUs report shared system memory as device-local, which the type score already accounts for.
+		VkPhysicalDeviceMemoryProperties memoryProperties;
+		vkGetPhysicalDeviceMemoryProperties(device, &memoryProperties);
+
+		VkDeviceSize deviceLocalMemory = 0;
+		for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; ++i)
+		{
+			if (memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+			{
+				deviceLocalMemory += memoryProperties.memoryHeaps[i].size;
+			}
+		}
+
+		candidate.deviceLocalMegabytes = deviceLocalMemory / (1024 * 1024);
+		candidate.summary += ", " + std::to_string(candidate.deviceLocalMegabytes) + " MB device-local memory";
+
+		return candidate;
+	}
+
+	bool PhysicalDeviceManager::isDeviceSuitable(const VkPhysicalDevice& device, const VkSurfaceKHR& surface)
+	{
 		// Check if device can process the commands we want to use.
 		const QueueFamilyIndices indices = findQueueFamilies(device, surface);
 
 		// Check if physical device supports swap chain extension.
 		const bool extensionsSupported = isDeviceExtensionSupported(device);
 
-		// Check if physical device supports swap chain.
-		const SwapChainSupportDetails swapChainSupport = SwapChainManager::querySwapChainSupport(device, surface);
+		// Check if physical device supports swap chain. Headless, there is no surface to present to.
+		const bool swapChainSupported = surface == VK_NULL_HANDLE || SwapChainManager::querySwapChainSupport(device, surface).isComplete();
 		
-		return indices.isComplete() && extensionsSupported && swapChainSupport.isComplete();
+		return indices.isComplete() && extensionsSupported && swapChainSupported;
 	}
 
 }
@@ -1,20 +1,52 @@
 #pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
 #include <vulkan/vulkan_core.h>
 
 namespace tessera::vulkan
 {
 
+	/**
+	 * @brief Picks the GPU to render with.
+	 *
+	 * Every suitable device is scored: discrete GPUs above integrated ones above everything else, then
+	 * by the features the renderer makes use of, then by device-local memory. A preferred device, given
+	 * by index or by part of its name, overrides the scores as long as it is suitable. The candidates
+	 * and the reason for the choice are logged.
+	 */
 	class PhysicalDeviceManager final
 	{
 	public:
-		void pickAnySuitableDevice(const VkInstance& instance, const VkSurfaceKHR& surface);
+		// preferred is the index of a device or part of its name, case-insensitive; empty picks the highest score.
+		void pickBestDevice(const VkInstance& instance, const VkSurfaceKHR& surface, uint32_t instanceApiVersion, const std::string& preferred);
 
 		[[nodiscard]] VkPhysicalDevice getPhysicalDevice() const { return physicalDevice; }
 
 	private:
+		struct Candidate
+		{
+			VkPhysicalDevice device = VK_NULL_HANDLE;
+			uint32_t index = 0;
+			std::string name;
+			uint64_t score = 0;
+			// Compared only between equal scores, so no amount of memory outweighs a feature.
+			uint64_t deviceLocalMegabytes = 0;
+			// What the score is made of, for the log.
+			std::string summary;
+		};
+
 		static bool isDeviceSuitable(const VkPhysicalDevice& device, const VkSurfaceKHR& surface);
+		[[nodiscard]] static Candidate scoreDevice(const VkPhysicalDevice& device, uint32_t index, uint32_t instanceApiVersion);
+		[[nodiscard]] static const Candidate* findPreferred(const std::vector<Candidate>& candidates, const std::string& preferred);
 
 		VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+
+		// The type dominates, then the features.
+		static constexpr uint64_t DISCRETE_SCORE = 1'000'000;
+		static constexpr uint64_t INTEGRATED_SCORE = 100'000;
+		static constexpr uint64_t VIRTUAL_SCORE = 10'000;
+		static constexpr uint64_t FEATURE_SCORE = 5'000;
 	};
 	
 }
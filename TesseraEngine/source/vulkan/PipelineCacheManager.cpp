@@ -0,0 +1,153 @@
+#include "PipelineCacheManager.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "DeviceManager.h"
+#include "utils/TesseraLog.h"
+#include "utils/interfaces/ServiceLocator.h"
+
+namespace tessera::vulkan
+{
+
+	void PipelineCacheManager::init()
+	{
+		const auto& deviceManager = ServiceLocator::getService<DeviceManager>();
+		device = deviceManager->getLogicalDevice();
+		vkGetPhysicalDeviceProperties(deviceManager->getPhysicalDevice(), &deviceProperties);
+
+		const std::vector<char> initialData = loadCacheData();
+
+		VkPipelineCacheCreateInfo cacheInfo{};
+		cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+		cacheInfo.initialDataSize = initialData.size();
+		cacheInfo.pInitialData = initialData.empty() ? nullptr : initialData.data();
+
+		if (vkCreatePipelineCache(device, &cacheInfo, nullptr, &pipelineCache) != VK_SUCCESS)
+		{
+			// Drivers may still reject data that passed validation, an empty cache is always accepted.
+			cacheInfo.initialDataSize = 0;
+			cacheInfo.pInitialData = nullptr;
+			if (vkCreatePipelineCache(device, &cacheInfo, nullptr, &pipelineCache) != VK_SUCCESS)
+			{
+				throw std::runtime_error("PipelineCacheManager: failed to create pipeline cache.");
+			}
+		}
+	}
+
+	void PipelineCacheManager::clean()
+	{
+		saveCacheData();
+		vkDestroyPipelineCache(device, pipelineCache, nullptr);
+	}
+
+	std::vector<char> PipelineCacheManager::loadCacheData() const
+	{
+		std::ifstream file(PIPELINE_CACHE_PATH, std::ios::binary | std::ios::ate);
+		if (!file.is_open())
+		{
+			return {};
+		}
+
+		const auto fileSize = static_cast<size_t>(file.tellg());
+		if (fileSize < sizeof(CacheFileHeader))
+		{
+			return {};
+		}
+
+		CacheFileHeader header;
+		file.seekg(0);
+		file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+		if (header.dataSize != fileSize - sizeof(CacheFileHeader))
+		{
+			TesseraLog::send(LogType::WARNING, "PipelineCacheManager", "Pipeline cache file has an unexpected size, ignoring it.");
+			return {};
+		}
+
+		std::vector<char> data(header.dataSize);
+		file.read(data.data(), static_cast<std::streamsize>(data.size()));
+
+		if (!file || !isCompatible(header, data))
+		{
+			TesseraLog::send(LogType::INFO, "PipelineCacheManager", "Pipeline cache was created by another device or driver, rebuilding it.");
+			return {};
+		}
+
+		TESSERA_LOG(LogType::DEBUG, "PipelineCacheManager", "Loaded " + std::to_string(data.size()) + " bytes of pipeline cache.");
+		return data;
+	}
+
+	bool PipelineCacheManager::isCompatible(const CacheFileHeader& header, const std::vector<char>& data) const
+	{
+		if (header.magic != CACHE_FILE_MAGIC || header.version != CACHE_FILE_VERSION ||
+			header.vendorID != deviceProperties.vendorID || header.deviceID != deviceProperties.deviceID ||
+			header.driverVersion != deviceProperties.driverVersion ||
+			std::memcmp(header.pipelineCacheUUID, deviceProperties.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+		{
+			return false;
+		}
+
+		// The driver blob carries its own header, which must agree with ours.
+		if (data.size() < sizeof(VkPipelineCacheHeaderVersionOne))
+		{
+			return false;
+		}
+
+		VkPipelineCacheHeaderVersionOne driverHeader;
+		std::memcpy(&driverHeader, data.data(), sizeof(driverHeader));
+
+		return driverHeader.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+			driverHeader.vendorID == deviceProperties.vendorID && driverHeader.deviceID == deviceProperties.deviceID &&
+			std::memcmp(driverHeader.pipelineCacheUUID, deviceProperties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+	}
+
+	void PipelineCacheManager::saveCacheData() const
+	{
+		size_t dataSize = 0;
+		if (vkGetPipelineCacheData(device, pipelineCache, &dataSize, nullptr) != VK_SUCCESS || dataSize == 0)
+		{
+			return;
+		}
+
+		std::vector<char> data(dataSize);
+		if (vkGetPipelineCacheData(device, pipelineCache, &dataSize, data.data()) != VK_SUCCESS)
+		{
+			TesseraLog::send(LogType::WARNING, "PipelineCacheManager", "Failed to read back pipeline cache data.");
+			return;
+		}
+
+		CacheFileHeader header{};
+		header.magic = CACHE_FILE_MAGIC;
+		header.version = CACHE_FILE_VERSION;
+		header.vendorID = deviceProperties.vendorID;
+		header.deviceID = deviceProperties.deviceID;
+		header.driverVersion = deviceProperties.driverVersion;
+		std::memcpy(header.pipelineCacheUUID, deviceProperties.pipelineCacheUUID, VK_UUID_SIZE);
+		header.dataSize = dataSize;
+
+		// Written next to the target and renamed, so an interrupted write never leaves a corrupt cache behind.
+		const std::string temporaryPath = std::string(PIPELINE_CACHE_PATH) + ".tmp";
+		{
+			std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			file.write(data.data(), static_cast<std::streamsize>(dataSize));
+			if (!file)
+			{
+				TesseraLog::send(LogType::WARNING, "PipelineCacheManager", "Failed to write pipeline cache.");
+				return;
+			}
+		}
+
+		std::error_code error;
+		std::filesystem::rename(temporaryPath, PIPELINE_CACHE_PATH, error);
+		if (error)
+		{
+			TesseraLog::send(LogType::WARNING, "PipelineCacheManager", "Failed to replace pipeline cache: " + error.message());
+		}
+	}
+
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+#include "utils/interfaces/Initializable.h"
+
+namespace tessera::vulkan
+{
+
+	/**
+	 * @brief Owns the VkPipelineCache shared by every pipeline creation.
+	 *
+	 * The cache is seeded from disk at startup when it was produced by the same device and driver,
+	 * and written back on clean() so later launches skip recompiling pipelines from SPIR-V.
+	 */
+	class PipelineCacheManager final : public Initializable
+	{
+	public:
+		void init() override;
+		void clean() override;
+
+		[[nodiscard]] VkPipelineCache getPipelineCache() const { return pipelineCache; }
+	private:
+		// Prefix written in front of the driver blob, covering fields the Vulkan header lacks (driver version, size).
+		struct CacheFileHeader
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint32_t vendorID;
+			uint32_t deviceID;
+			uint32_t driverVersion;
+			uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+			uint64_t dataSize;
+		};
+
+		[[nodiscard]] std::vector<char> loadCacheData() const;
+		[[nodiscard]] bool isCompatible(const CacheFileHeader& header, const std::vector<char>& data) const;
+		void saveCacheData() const;
+
+		VkDevice device = VK_NULL_HANDLE;
+		VkPhysicalDeviceProperties deviceProperties{};
+		VkPipelineCache pipelineCache = VK_NULL_HANDLE;
+
+		static constexpr auto PIPELINE_CACHE_PATH = "pipeline_cache.bin";
+		static constexpr uint32_t CACHE_FILE_MAGIC = 0x43505354; // "TSPC" little endian.
+		static constexpr uint32_t CACHE_FILE_VERSION = 1;
+	};
+
+}
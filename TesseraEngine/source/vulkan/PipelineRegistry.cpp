@@ -0,0 +1,387 @@
+#include "PipelineRegistry.h"
+
+#include <chrono>
+#include <stdexcept>
+#include <vector>
+
+#include "DeletionQueue.h"
+#include "DeviceManager.h"
+#include "PipelineCacheManager.h"
+#include "utils/ThreadPool.h"
+#include "utils/TesseraLog.h"
+#include "utils/Utils.h"
+#include "utils/interfaces/ServiceLocator.h"
+
+namespace tessera::vulkan
+{
+
+	size_t PipelineDescription::hash() const
+	{
+		size_t seed = 0;
+		hashCombine(seed, vertexShader);
+		hashCombine(seed, fragmentShader);
+		hashCombine(seed, vertexLayout);
+		hashCombine(seed, instanced);
+		hashCombine(seed, topology);
+		hashCombine(seed, polygonMode);
+		hashCombine(seed, cullMode);
+		hashCombine(seed, frontFace);
+		hashCombine(seed, samples);
+		hashCombine(seed, depthTestEnable);
+		hashCombine(seed, depthWriteEnable);
+		hashCombine(seed, depthCompareOp);
+		hashCombine(seed, blendEnable);
+		hashCombine(seed, srcColorBlendFactor);
+		hashCombine(seed, dstColorBlendFactor);
+		hashCombine(seed, colorBlendOp);
+		hashCombine(seed, layout);
+		hashCombine(seed, renderPass);
+		hashCombine(seed, subpass);
+		for (const VkFormat format : colorFormats)
+		{
+			hashCombine(seed, format);
+		}
+		hashCombine(seed, depthFormat);
+		for (const auto& [id, value] : specializationConstants)
+		{
+			hashCombine(seed, id);
+			hashCombine(seed, value);
+		}
+		return seed;
+	}
+
+	void PipelineRegistry::init()
+	{
+		device = ServiceLocator::getService<DeviceManager>()->getLogicalDevice();
+		pipelineCache = ServiceLocator::getService<PipelineCacheManager>()->getPipelineCache();
+		deletionQueue = ServiceLocator::getServicePointer<DeletionQueue>();
+	}
+
+	void PipelineRegistry::clean()
+	{
+		std::lock_guard lock(registryMutex);
+
+		for (auto& [handle, entry] : entries)
+		{
+			destroyPipeline(entry.pipeline);
+			if (entry.rebuild)
+			{
+				destroyPipeline(*entry.rebuild);
+			}
+		}
+
+		entries.clear();
+		handlesByHash.clear();
+	}
+
+	PipelineHandle PipelineRegistry::request(const PipelineDescription& description)
+	{
+		std::lock_guard lock(registryMutex);
+
+		const size_t hash = description.hash();
+		const auto [first, last] = handlesByHash.equal_range(hash);
+		for (auto it = first; it != last; ++it)
+		{
+			if (entries.at(it->second).description == description)
+			{
+				return it->second;
+			}
+		}
+
+		const PipelineHandle handle = nextHandle++;
+		entries.emplace(handle, Entry{ description, compile(description) });
+		handlesByHash.emplace(hash, handle);
+		return handle;
+	}
+
+	std::shared_future<VkPipeline> PipelineRegistry::compile(const PipelineDescription& description)
+	{
+		return ServiceLocator::getService<ThreadPool>()->submit([this, description] { return createPipeline(description); }).share();
+	}
+
+	void PipelineRegistry::replaceShader(const VkShaderModule oldModule, const VkShaderModule newModule)
+	{
+		std::lock_guard lock(registryMutex);
+
+		for (auto& [handle, entry] : entries)
+		{
+			if (entry.description.vertexShader != oldModule && entry.description.fragmentShader != oldModule)
+			{
+				continue;
+			}
+
+			// The description changes, so does its bucket. An identical description may now exist twice, which only costs a duplicate pipeline.
+			const auto [first, last] = handlesByHash.equal_range(entry.description.hash());
+			for (auto it = first; it != last; ++it)
+			{
+				if (it->second == handle)
+				{
+					handlesByHash.erase(it);
+					break;
+				}
+			}
+
+			if (entry.description.vertexShader == oldModule)
+			{
+				entry.description.vertexShader = newModule;
+			}
+			if (entry.description.fragmentShader == oldModule)
+			{
+				entry.description.fragmentShader = newModule;
+			}
+			handlesByHash.emplace(entry.description.hash(), handle);
+
+			// A rebuild of an earlier reload nobody looked up yet is superseded; frames never drew with it.
+			if (entry.rebuild)
+			{
+				const std::shared_future<VkPipeline> superseded = *entry.rebuild;
+				deletionQueue->push([this, superseded] { destroyPipeline(superseded); });
+			}
+			entry.rebuild = compile(entry.description);
+		}
+	}
+
+	PipelineHandle PipelineRegistry::compileNow(const PipelineDescription& description)
+	{
+		const PipelineHandle handle = request(description);
+		static_cast<void>(wait(handle));
+		return handle;
+	}
+
+	VkPipeline PipelineRegistry::get(const PipelineHandle handle)
+	{
+		const std::shared_future<VkPipeline> pipeline = find(handle);
+		if (pipeline.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		{
+			return VK_NULL_HANDLE;
+		}
+
+		return pipeline.get();
+	}
+
+	VkPipeline PipelineRegistry::getOrFallback(const PipelineHandle handle, const PipelineHandle fallback)
+	{
+		const VkPipeline pipeline = get(handle);
+		return pipeline != VK_NULL_HANDLE ? pipeline : wait(fallback);
+	}
+
+	VkPipeline PipelineRegistry::wait(const PipelineHandle handle)
+	{
+		// Compiles on the calling thread when the task has not been picked up by a worker yet.
+		const std::shared_future<VkPipeline> pipeline = find(handle);
+		ServiceLocator::getService<ThreadPool>()->waitFor(pipeline);
+		return pipeline.get();
+	}
+
+	std::shared_future<VkPipeline> PipelineRegistry::find(const PipelineHandle handle)
+	{
+		std::lock_guard lock(registryMutex);
+
+		const auto it = entries.find(handle);
+		if (it == entries.end())
+		{
+			throw std::out_of_range("PipelineRegistry: unknown pipeline handle.");
+		}
+
+		Entry& entry = it->second;
+		if (entry.rebuild && entry.rebuild->wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+		{
+			const std::shared_future<VkPipeline> rebuild = *entry.rebuild;
+			entry.rebuild.reset();
+
+			try
+			{
+				static_cast<void>(rebuild.get());
+			}
+			catch (const std::runtime_error& error)
+			{
+				TesseraLog::send(LogType::ERROR, "PipelineRegistry", std::string(error.what()) + " Keeping the pipeline built before the reload.");
+				return entry.pipeline;
+			}
+
+			// Frames in flight may still draw with the previous pipeline.
+			const std::shared_future<VkPipeline> previous = entry.pipeline;
+			deletionQueue->push([this, previous] { destroyPipeline(previous); });
+			entry.pipeline = rebuild;
+		}
+
+		return entry.pipeline;
+	}
+
+	void PipelineRegistry::destroyPipeline(const std::shared_future<VkPipeline>& pipeline) const
+	{
+		try
+		{
+			vkDestroyPipeline(device, pipeline.get(), nullptr);
+		}
+		catch (const std::runtime_error&)
+		{
+			// Failed compilations were reported when the pipeline was looked up, nothing to destroy.
+		}
+	}
+
+	VkPipeline PipelineRegistry::createPipeline(const PipelineDescription& description) const
+	{
+		VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
+		vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
+		vertShaderStageInfo.module = description.vertexShader;
+		vertShaderStageInfo.pName = "main";
+
+		VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
+		fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+		fragShaderStageInfo.module = description.fragmentShader;
+		fragShaderStageInfo.pName = "main";
+
+		// Constants a stage does not declare are ignored, so both stages share one map.
+		std::vector<VkSpecializationMapEntry> specializationEntries;
+		std::vector<uint32_t> specializationData;
+		for (const auto& [id, value] : description.specializationConstants)
+		{
+			specializationEntries.push_back({ id, static_cast<uint32_t>(specializationData.size() * sizeof(uint32_t)), sizeof(uint32_t) });
+			specializationData.push_back(value);
+		}
+
+		VkSpecializationInfo specializationInfo{};
+		specializationInfo.mapEntryCount = static_cast<uint32_t>(specializationEntries.size());
+		specializationInfo.pMapEntries = specializationEntries.data();
+		specializationInfo.dataSize = specializationData.size() * sizeof(uint32_t);
+		specializationInfo.pData = specializationData.data();
+
+		if (!specializationEntries.empty())
+		{
+			vertShaderStageInfo.pSpecializationInfo = &specializationInfo;
+			fragShaderStageInfo.pSpecializationInfo = &specializationInfo;
+		}
+
+		// Depth-only pipelines have no fragment stage and no color attachment to write.
+		const bool depthOnly = description.fragmentShader == VK_NULL_HANDLE;
+		const VkPipelineShaderStageCreateInfo shaderStages[] = { vertShaderStageInfo, fragShaderStageInfo };
+
+		// Dynamic state
+		const std::vector dynamicStates = {
+			VK_DYNAMIC_STATE_VIEWPORT,
+			VK_DYNAMIC_STATE_SCISSOR
+		};
+
+		VkPipelineDynamicStateCreateInfo dynamicState{};
+		dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+		dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+		dynamicState.pDynamicStates = dynamicStates.data();
+
+		// Vertex input
+		std::vector bindingDescriptions = { Vertex::getBindingDescription(description.vertexLayout) };
+		auto attributeDescriptions = Vertex::getAttributeDescriptions(description.vertexLayout);
+		if (description.instanced)
+		{
+			bindingDescriptions.push_back(InstanceData::getBindingDescription());
+			const auto instanceAttributes = InstanceData::getAttributeDescriptions();
+			attributeDescriptions.insert(attributeDescriptions.end(), instanceAttributes.begin(), instanceAttributes.end());
+		}
+
+		VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+		vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+		vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(bindingDescriptions.size());
+		vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
+		vertexInputInfo.pVertexBindingDescriptions = bindingDescriptions.data();
+		vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
+
+		// Input assembly
+		VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
+		inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+		inputAssembly.topology = description.topology;
+		inputAssembly.primitiveRestartEnable = VK_FALSE;
+
+		// Viewport and scissor are dynamic, only their count is baked in.
+		VkPipelineViewportStateCreateInfo viewportState{};
+		viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+		viewportState.viewportCount = 1;
+		viewportState.scissorCount = 1;
+
+		// Rasterizer
+		VkPipelineRasterizationStateCreateInfo rasterizer{};
+		rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+		rasterizer.depthClampEnable = VK_FALSE;
+		rasterizer.rasterizerDiscardEnable = VK_FALSE;
+		rasterizer.polygonMode = description.polygonMode;
+		rasterizer.lineWidth = 1.0f;
+		rasterizer.cullMode = description.cullMode;
+		rasterizer.frontFace = description.frontFace;
+		rasterizer.depthBiasEnable = VK_FALSE;
+
+		// Multisampling
+		VkPipelineMultisampleStateCreateInfo multisampling{};
+		multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+		multisampling.sampleShadingEnable = VK_FALSE;
+		multisampling.rasterizationSamples = description.samples;
+		multisampling.minSampleShading = 1.0f;
+
+		// Depth and stencil testing.
+		VkPipelineDepthStencilStateCreateInfo depthStencil{};
+		depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+		depthStencil.depthTestEnable = description.depthTestEnable ? VK_TRUE : VK_FALSE;
+		depthStencil.depthWriteEnable = description.depthWriteEnable ? VK_TRUE : VK_FALSE;
+		depthStencil.depthCompareOp = description.depthCompareOp;
+		depthStencil.depthBoundsTestEnable = VK_FALSE;
+		depthStencil.stencilTestEnable = VK_FALSE;
+
+		// Color blending.
+		VkPipelineColorBlendAttachmentState colorBlendAttachment{};
+		colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+		colorBlendAttachment.blendEnable = description.blendEnable ? VK_TRUE : VK_FALSE;
+		colorBlendAttachment.srcColorBlendFactor = description.srcColorBlendFactor;
+		colorBlendAttachment.dstColorBlendFactor = description.dstColorBlendFactor;
+		colorBlendAttachment.colorBlendOp = description.colorBlendOp;
+		colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+		colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+		colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+
+		VkPipelineColorBlendStateCreateInfo colorBlending{};
+		colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+		colorBlending.logicOpEnable = VK_FALSE;
+		colorBlending.logicOp = VK_LOGIC_OP_COPY;
+		colorBlending.attachmentCount = depthOnly ? 0 : 1;
+		colorBlending.pAttachments = &colorBlendAttachment;
+
+		VkPipelineRenderingCreateInfo renderingInfo{};
+		renderingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+		renderingInfo.colorAttachmentCount = static_cast<uint32_t>(description.colorFormats.size());
+		renderingInfo.pColorAttachmentFormats = description.colorFormats.data();
+		renderingInfo.depthAttachmentFormat = description.depthFormat;
+
+		VkGraphicsPipelineCreateInfo pipelineInfo{};
+		pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+		pipelineInfo.pNext = description.renderPass == VK_NULL_HANDLE ? &renderingInfo : nullptr;
+		pipelineInfo.stageCount = depthOnly ? 1 : 2;
+		pipelineInfo.pStages = shaderStages;
+		pipelineInfo.pVertexInputState = &vertexInputInfo;
+		pipelineInfo.pInputAssemblyState = &inputAssembly;
+		pipelineInfo.pViewportState = &viewportState;
+		pipelineInfo.pRasterizationState = &rasterizer;
+		pipelineInfo.pMultisampleState = &multisampling;
+		pipelineInfo.pDepthStencilState = &depthStencil;
+		pipelineInfo.pColorBlendState = &colorBlending;
+		pipelineInfo.pDynamicState = &dynamicState;
+		pipelineInfo.layout = description.layout;
+		pipelineInfo.renderPass = description.renderPass;
+		pipelineInfo.subpass = description.subpass;
+		pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+		pipelineInfo.basePipelineIndex = -1;
+
+		const auto start = std::chrono::steady_clock::now();
+
+		// The pipeline cache is internally synchronized, so workers may compile concurrently.
+		VkPipeline pipeline;
+		if (vkCreateGraphicsPipelines(device, pipelineCache, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS)
+		{
+			throw std::runtime_error("PipelineRegistry: failed to create graphics pipeline.");
+		}
+
+		const auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+		TESSERA_LOG(LogType::DEBUG, "PipelineRegistry", "Compiled pipeline in " + std::to_string(milliseconds) + " ms.");
+
+		return pipeline;
+	}
+
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include <cstdint>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+#include "entities/Vertex.h"
+#include "utils/interfaces/Initializable.h"
+
+namespace tessera::vulkan
+{
+
+	class DeletionQueue;
+
+	// Value of the specialization constant declared with constant_id = id, in every stage declaring it.
+	struct SpecializationConstant
+	{
+		uint32_t id = 0;
+		uint32_t value = 0;
+
+		bool operator==(const SpecializationConstant& other) const = default;
+	};
+
+	// Everything that distinguishes one graphics pipeline from another. Viewport and scissor are always dynamic.
+	struct PipelineDescription
+	{
+		VkShaderModule vertexShader = VK_NULL_HANDLE;
+		// VK_NULL_HANDLE for depth-only pipelines, e.g. of the depth prepass.
+		VkShaderModule fragmentShader = VK_NULL_HANDLE;
+		VertexLayout vertexLayout = VertexLayout::FULL;
+		// Adds the per-instance binding of InstanceData.
+		bool instanced = false;
+
+		VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+		VkPolygonMode polygonMode = VK_POLYGON_MODE_FILL;
+		VkCullModeFlags cullMode = VK_CULL_MODE_BACK_BIT;
+		VkFrontFace frontFace = VK_FRONT_FACE_CLOCKWISE;
+		// Must match the attachments of the render pass.
+		VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+
+		bool depthTestEnable = false;
+		bool depthWriteEnable = false;
+		VkCompareOp depthCompareOp = VK_COMPARE_OP_LESS;
+
+		bool blendEnable = false;
+		VkBlendFactor srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+		VkBlendFactor dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
+		VkBlendOp colorBlendOp = VK_BLEND_OP_ADD;
+
+		VkPipelineLayout layout = VK_NULL_HANDLE;
+		VkRenderPass renderPass = VK_NULL_HANDLE;
+		uint32_t subpass = 0;
+		// Attachments of the pass when it uses dynamic rendering, i.e. renderPass is VK_NULL_HANDLE.
+		std::vector<VkFormat> colorFormats;
+		VkFormat depthFormat = VK_FORMAT_UNDEFINED;
+
+		// Variants of the same shaders differ only here, and each one is compiled once like any other description.
+		std::vector<SpecializationConstant> specializationConstants;
+
+		bool operator==(const PipelineDescription& other) const = default;
+		[[nodiscard]] size_t hash() const;
+	};
+
+	using PipelineHandle = uint64_t;
+
+	/**
+	 * @brief Deduplicating store of graphics pipelines compiled on the ThreadPool.
+	 *
+	 * Identical descriptions resolve to the same handle and the same VkPipeline. Lookups never block
+	 * unless explicitly asked to, so draws can skip or fall back while a pipeline is still compiling.
+	 * Handles stay valid across shader reloads: the rebuilt pipeline replaces the old one once compiled.
+	 */
+	class PipelineRegistry final : public Initializable
+	{
+	public:
+		void init() override;
+		void clean() override;
+
+		// Queue compilation of description unless an identical pipeline was already requested.
+		PipelineHandle request(const PipelineDescription& description);
+
+		// Request, then block until the background compilation finished; for pipelines the first frame cannot do without.
+		PipelineHandle compileNow(const PipelineDescription& description);
+
+		// Returns VK_NULL_HANDLE while the pipeline is still compiling.
+		[[nodiscard]] VkPipeline get(PipelineHandle handle);
+		[[nodiscard]] VkPipeline getOrFallback(PipelineHandle handle, PipelineHandle fallback);
+		[[nodiscard]] VkPipeline wait(PipelineHandle handle);
+
+		// Rebuild every pipeline using oldModule with newModule in the background. Lookups return the old pipeline until then.
+		void replaceShader(VkShaderModule oldModule, VkShaderModule newModule);
+	private:
+		struct Entry
+		{
+			PipelineDescription description;
+			std::shared_future<VkPipeline> pipeline;
+			// Compiling with reloaded shaders; swapped in by the first lookup after it finished.
+			std::optional<std::shared_future<VkPipeline>> rebuild;
+		};
+
+		[[nodiscard]] VkPipeline createPipeline(const PipelineDescription& description) const;
+		[[nodiscard]] std::shared_future<VkPipeline> compile(const PipelineDescription& description);
+		// Current pipeline of handle, after swapping in a finished rebuild.
+		[[nodiscard]] std::shared_future<VkPipeline> find(PipelineHandle handle);
+		void destroyPipeline(const std::shared_future<VkPipeline>& pipeline) const;
+
+		VkDevice device = VK_NULL_HANDLE;
+		VkPipelineCache pipelineCache = VK_NULL_HANDLE;
+		DeletionQueue* deletionQueue = nullptr;
+
+		std::mutex registryMutex;
+		// Buckets keyed by description hash; collisions are resolved by comparing the full description.
+		std::unordered_multimap<size_t, PipelineHandle> handlesByHash;
+		std::unordered_map<PipelineHandle, Entry> entries;
+		PipelineHandle nextHandle = 1;
+	};
+
+}
@@ -1,12 +1,24 @@
 #include "QueueManager.h"
 
+#include <thread>
 #include <vector>
 
 #include "CommandBufferManager.h"
+#include "ComputeManager.h"
+#include "DeletionQueue.h"
+#include "DescriptorManager.h"
 #include "DeviceManager.h"
+#include "MemoryAllocator.h"
+#include "ShaderLibrary.h"
 #include "SurfaceManager.h"
 #include "SwapChainManager.h"
 #include "SyncObjectsManager.h"
+#include "TextureManager.h"
+#include "UniformManager.h"
+#include "UploadManager.h"
+#include "utils/CpuProfiler.h"
+#include "utils/EngineConfig.h"
+#include "utils/ThreadPool.h"
 #include "utils/interfaces/ServiceLocator.h"
 
 namespace tessera::vulkan
@@ -19,52 +31,172 @@ namespace tessera::vulkan
 		const auto& physicalDevice = ServiceLocator::getService<DeviceManager>()->getPhysicalDevice();
 		const auto& surface = ServiceLocator::getService<SurfaceManager>()->getSurface();
 
-		const auto [graphicsFamily, presentFamily] = findQueueFamilies(physicalDevice, surface);
+		queueFamilyIndices = findQueueFamilies(physicalDevice, surface);
+		const auto [graphicsFamily, presentFamily, transferFamily, computeFamily, computeQueueIndex] = queueFamilyIndices;
 
 		vkGetDeviceQueue(logicalDevice, graphicsFamily.value(), 0, &graphicsQueue);
 		vkGetDeviceQueue(logicalDevice, presentFamily.value(), 0, &presentQueue);
+		vkGetDeviceQueue(logicalDevice, transferFamily.value(), 0, &transferQueue);
+		vkGetDeviceQueue(logicalDevice, computeFamily.value(), computeQueueIndex, &computeQueue);
+	}
+
+	void QueueManager::resolveServices()
+	{
+		syncObjectsManager = ServiceLocator::getServicePointer<SyncObjectsManager>();
+		swapChainManager = ServiceLocator::getServicePointer<SwapChainManager>();
+		commandBufferManager = ServiceLocator::getServicePointer<CommandBufferManager>();
+		computeManager = ServiceLocator::getServicePointer<ComputeManager>();
+		uploadManager = ServiceLocator::getServicePointer<UploadManager>();
+		deletionQueue = ServiceLocator::getServicePointer<DeletionQueue>();
+		descriptorManager = ServiceLocator::getServicePointer<DescriptorManager>();
+		uniformManager = ServiceLocator::getServicePointer<UniformManager>();
+		textureManager = ServiceLocator::getServicePointer<TextureManager>();
+		threadPool = ServiceLocator::getServicePointer<ThreadPool>();
+		shaderLibrary = ServiceLocator::getServicePointer<ShaderLibrary>();
+		memoryAllocator = ServiceLocator::getServicePointer<MemoryAllocator>();
+
+		const auto& config = ServiceLocator::getService<EngineConfig>();
+		lowLatency = config->getBool("render.lowLatency", false);
+
+		const int maxFrameRate = config->getInt("render.maxFrameRate", 0);
+		minFrameTime = maxFrameRate > 0
+			? std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / maxFrameRate))
+			: std::chrono::steady_clock::duration::zero();
+	}
+
+	void QueueManager::waitBeforeInput()
+	{
+		TESSERA_PROFILE_ZONE("Wait before input");
+
+		if (minFrameTime > std::chrono::steady_clock::duration::zero())
+		{
+			const auto now = std::chrono::steady_clock::now();
+
+			// Do not try to catch up after a long frame, that would only release a burst of frames.
+			if (nextFrameStart < now)
+			{
+				nextFrameStart = now;
+			}
+			else
+			{
+				std::this_thread::sleep_until(nextFrameStart);
+			}
+			nextFrameStart += minFrameTime;
+		}
+
+		if (lowLatency)
+		{
+			syncObjectsManager->waitForPreviousFrame(currentFrame, frameNumber);
+		}
 	}
 
 	void QueueManager::drawFrame()
 	{
-		const auto& syncObjectsManager = ServiceLocator::getService<SyncObjectsManager>();
-		const auto& imageAvailableSemaphores = syncObjectsManager->getImageAvailableSemaphores();
-		const auto& renderFinishedSemaphores = syncObjectsManager->getRenderFinishedSemaphores();
-		const auto& inFlightFences = syncObjectsManager->getInFlightFences();
-		const auto& swapChainManager = ServiceLocator::getService<SwapChainManager>();
+		TESSERA_PROFILE_ZONE("Draw frame");
+
+		const auto& [imageAvailableSemaphore, renderFinishedSemaphore, inFlightFence] = syncObjectsManager->getFrameSyncSlot(currentFrame);
 		const auto& swapChain = swapChainManager->getSwapChain();
-		const auto& commandBufferManager = ServiceLocator::getService<CommandBufferManager>();
 		const auto& commandBuffer = commandBufferManager->getCommandBuffer(currentFrame);
+		const int numberOfBuffers = commandBufferManager->getNumberOfBuffers();
 
-		syncObjectsManager->waitForFences(currentFrame);
+		// Uploads waited on by retired frames can be recycled.
+		uint64_t completedFrames;
+		{
+			TESSERA_PROFILE_ZONE("Wait for frame");
+			completedFrames = syncObjectsManager->waitForFrame(currentFrame, frameNumber);
+		}
+		uploadManager->collectCompletedBatches(completedFrames);
+		deletionQueue->collect(completedFrames);
 
-		const std::optional<uint32_t> imageIndex = swapChainManager->acquireNextImage(currentFrame);
+		// Background loads finish here, so their uploads are recorded into this frame's batch.
+		threadPool->dispatchCompletions();
+		shaderLibrary->update(frameNumber);
+		memoryAllocator->update(frameNumber);
+		uploadManager->beginFrame(frameNumber);
+
+		std::optional<uint32_t> imageIndex;
+		{
+			TESSERA_PROFILE_ZONE("Acquire");
+			imageIndex = swapChainManager->acquireNextImage(currentFrame);
+		}
 		if(!imageIndex.has_value())
 		{
 			return;
 		}
 
-		commandBufferManager->resetCommandBuffer(currentFrame);
-		recordCommandBuffer(commandBuffer, *imageIndex);
+		// Only reset once work is guaranteed to be submitted, otherwise the next wait on this slot never returns.
+		syncObjectsManager->resetFences(currentFrame);
+		{
+			TESSERA_PROFILE_ZONE("Record");
+			commandBufferManager->resetFrame(currentFrame);
+			descriptorManager->resetFrame(currentFrame);
+			uniformManager->beginFrame(currentFrame, frameNumber);
+			textureManager->update(frameNumber);
+			computeManager->recordFrame(currentFrame);
+			commandBufferManager->recordCommandBuffer(commandBuffer, *imageIndex, currentFrame);
+		}
 
 		VkSubmitInfo submitInfo{};
 		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
-		const VkSemaphore waitSemaphores[] = { imageAvailableSemaphores[currentFrame] };
-		constexpr VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-		submitInfo.waitSemaphoreCount = 1;
-		submitInfo.pWaitSemaphores = waitSemaphores;
-		submitInfo.pWaitDstStageMask = waitStages;
+		waitSemaphores.clear();
+		waitStages.clear();
+		waitValues.clear();
+		// Offscreen images are never acquired, so there is nothing to wait for.
+		const bool presenting = !swapChainManager->isHeadless();
+		if (presenting)
+		{
+			waitSemaphores.push_back(imageAvailableSemaphore);
+			waitStages.push_back(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+			waitValues.push_back(0);
+		}
+		// Uploads recorded since the previous frame must land before this frame reads them. Compute work of
+		// the frame waits on them in its place, and the graphics submission on the compute work.
+		uploadManager->flush();
+		computeManager->submitFrame(currentFrame, frameNumber);
+		computeManager->consumeGraphicsWaits(currentFrame, waitSemaphores, waitStages, waitValues);
+		uploadManager->consumeGraphicsWaits(frameNumber, waitSemaphores, waitStages, waitValues);
+
+		submitInfo.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size());
+		submitInfo.pWaitSemaphores = waitSemaphores.data();
+		submitInfo.pWaitDstStageMask = waitStages.data();
 		submitInfo.commandBufferCount = 1;
 		submitInfo.pCommandBuffers = &commandBuffer;
 
-		const VkSemaphore signalSemaphores[] = { renderFinishedSemaphores[currentFrame] };
-		submitInfo.signalSemaphoreCount = 1;
-		submitInfo.pSignalSemaphores = signalSemaphores;
+		// The binary semaphore comes first since presentation waits on it alone. Headless it is skipped,
+		// signaling it again without a present waiting on it would be invalid.
+		const VkSemaphore signalSemaphores[] = { renderFinishedSemaphore, syncObjectsManager->getFrameTimeline() };
+		const uint64_t signalValues[] = { 0, frameNumber + 1 };
+		const uint32_t firstSignal = presenting ? 0 : 1;
+		submitInfo.signalSemaphoreCount = (syncObjectsManager->usesTimelineSemaphore() ? 2 : 1) - firstSignal;
+		submitInfo.pSignalSemaphores = signalSemaphores + firstSignal;
+
+		VkTimelineSemaphoreSubmitInfo timelineInfo{};
+		timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+		timelineInfo.waitSemaphoreValueCount = static_cast<uint32_t>(waitValues.size());
+		timelineInfo.pWaitSemaphoreValues = waitValues.data();
+		timelineInfo.signalSemaphoreValueCount = submitInfo.signalSemaphoreCount;
+		timelineInfo.pSignalSemaphoreValues = signalValues + firstSignal;
 
-		if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS)
+		if (syncObjectsManager->usesTimelineSemaphore())
 		{
-			throw std::runtime_error("QueueManager: failed to submit draw command buffer.");
+			submitInfo.pNext = &timelineInfo;
+		}
+
+		{
+			TESSERA_PROFILE_ZONE("Submit");
+			if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, inFlightFence) != VK_SUCCESS)
+			{
+				throw std::runtime_error("QueueManager: failed to submit draw command buffer.");
+			}
+		}
+
+		frameNumber.fetch_add(1, std::memory_order_release);
+
+		if (!presenting)
+		{
+			currentFrame = (currentFrame + 1) % numberOfBuffers;
+			return;
 		}
 
 		// Submit result back to swap chain to have it eventually show up on the screen. 
@@ -80,7 +212,11 @@ namespace tessera::vulkan
 		presentInfo.pImageIndices = &*imageIndex;
 		presentInfo.pResults = nullptr;
 
-		const VkResult result = vkQueuePresentKHR(presentQueue, &presentInfo);
+		VkResult result;
+		{
+			TESSERA_PROFILE_ZONE("Present");
+			result = vkQueuePresentKHR(presentQueue, &presentInfo);
+		}
 
 		if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || framebufferResized)
 		{
@@ -92,7 +228,6 @@ namespace tessera::vulkan
 			throw std::runtime_error("QueueManager: failed to present swap chain image.");
 		}
 
-		const int numberOfBuffers = commandBufferManager->getNumberOfBuffers();
 		currentFrame = (currentFrame + 1) % numberOfBuffers;
 	}
 
@@ -113,8 +248,12 @@ namespace tessera::vulkan
 				indices.graphicsFamily = i;
 			}
 
-			VkBool32 presentSupport = false;
-			vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, surface, &presentSupport);
+			// Without a surface nothing is presented, so the graphics family stands in for the present family.
+			VkBool32 presentSupport = surface == VK_NULL_HANDLE && (queueFamilies[i].queueFlags & VK_QUEUE_GRAPHICS_BIT);
+			if (surface != VK_NULL_HANDLE)
+			{
+				vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, surface, &presentSupport);
+			}
 			if (presentSupport)
 			{
 				indices.presentFamily = i;
@@ -126,12 +265,57 @@ namespace tessera::vulkan
 			}
 		}
 
-		return indices;
-	}
+		// Prefer a transfer-only family (usually backed by DMA engines), then any non-graphics family with transfer support.
+		for (uint32_t i = 0; i < queueFamilyCount && !indices.transferFamily.has_value(); ++i)
+		{
+			const VkQueueFlags flags = queueFamilies[i].queueFlags;
+			if ((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)))
+			{
+				indices.transferFamily = i;
+			}
+		}
 
-	bool QueueFamilyIndices::isComplete() const
-	{
-		return graphicsFamily.has_value() && presentFamily.has_value();
+		for (uint32_t i = 0; i < queueFamilyCount && !indices.transferFamily.has_value(); ++i)
+		{
+			const VkQueueFlags flags = queueFamilies[i].queueFlags;
+			if ((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & VK_QUEUE_GRAPHICS_BIT))
+			{
+				indices.transferFamily = i;
+			}
+		}
+
+		// Graphics queues always support transfer operations.
+		if (!indices.transferFamily.has_value())
+		{
+			indices.transferFamily = indices.graphicsFamily;
+		}
+
+		// Only a family without graphics runs compute work alongside the graphics queue rather than interleaved with it.
+		for (uint32_t i = 0; i < queueFamilyCount && !indices.computeFamily.has_value(); ++i)
+		{
+			const VkQueueFlags flags = queueFamilies[i].queueFlags;
+			if ((flags & VK_QUEUE_COMPUTE_BIT) && !(flags & VK_QUEUE_GRAPHICS_BIT))
+			{
+				// Queues are externally synchronized and uploads may be flushed from other threads, so sharing the family takes a second queue.
+				if (i != indices.transferFamily.value())
+				{
+					indices.computeFamily = i;
+				}
+				else if (queueFamilies[i].queueCount > 1)
+				{
+					indices.computeFamily = i;
+					indices.computeQueueIndex = 1;
+				}
+			}
+		}
+
+		// Graphics queues always support compute operations.
+		if (!indices.computeFamily.has_value())
+		{
+			indices.computeFamily = indices.graphicsFamily;
+		}
+
+		return indices;
 	}
 
 }
@@ -1,20 +1,46 @@
 #pragma once
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <optional>
+#include <vector>
 #include <GLFW/glfw3.h>
 
 #include "PhysicalDeviceManager.h"
 #include "utils/interfaces/Initializable.h"
 
+namespace tessera
+{
+	class ThreadPool;
+}
+
 namespace tessera::vulkan
 {
 
+	class CommandBufferManager;
+	class ComputeManager;
+	class DeletionQueue;
+	class DescriptorManager;
+	class MemoryAllocator;
+	class ShaderLibrary;
+	class SwapChainManager;
+	class SyncObjectsManager;
+	class TextureManager;
+	class UniformManager;
+	class UploadManager;
+
 	struct QueueFamilyIndices
 	{
 		std::optional<uint32_t> graphicsFamily;
 		std::optional<uint32_t> presentFamily;
+		// Dedicated transfer family when the device exposes one, the graphics family otherwise.
+		std::optional<uint32_t> transferFamily;
+		// Compute family without graphics support when the device exposes one, the graphics family otherwise.
+		std::optional<uint32_t> computeFamily;
+		// 1 when the compute and transfer queues come from the same family, which then creates two queues.
+		uint32_t computeQueueIndex = 0;
 
-		[[nodiscard]] inline bool isComplete() const;
+		[[nodiscard]] bool isComplete() const { return graphicsFamily.has_value() && presentFamily.has_value(); }
 	};
 
 	QueueFamilyIndices findQueueFamilies(const VkPhysicalDevice& physicalDevice, const VkSurfaceKHR& surface);
@@ -23,17 +49,60 @@ namespace tessera::vulkan
 	{
 	public:
 		void init() override;
+		void resolveServices() override;
 		void drawFrame();
+
+		/**
+		 * @brief Frame limiter run right before input is sampled.
+		 *
+		 * With render.lowLatency the previous frame is waited on, so input is read as late as possible and
+		 * no frame queues up behind it. render.maxFrameRate additionally caps the frame rate by sleeping.
+		 */
+		void waitBeforeInput();
 		void clean() override {}
 
 		void onFramebufferResized() { framebufferResized = true; }
 		[[nodiscard]] VkQueue getGraphicsQueue() const { return graphicsQueue; }
 		[[nodiscard]] VkQueue getPresentQueue() const { return presentQueue; }
+		[[nodiscard]] VkQueue getTransferQueue() const { return transferQueue; }
+		// The graphics queue unless the device has a dedicated compute family.
+		[[nodiscard]] VkQueue getComputeQueue() const { return computeQueue; }
+		[[nodiscard]] QueueFamilyIndices getQueueFamilyIndices() const { return queueFamilyIndices; }
+		// Safe to call from any thread; DeletionQueue reads it from workers.
+		[[nodiscard]] uint64_t getFrameNumber() const { return frameNumber.load(std::memory_order_acquire); }
 	private:
 		VkQueue graphicsQueue = VK_NULL_HANDLE;
 		VkQueue presentQueue = VK_NULL_HANDLE;
+		VkQueue transferQueue = VK_NULL_HANDLE;
+		VkQueue computeQueue = VK_NULL_HANDLE;
+		QueueFamilyIndices queueFamilyIndices;
+
+		// Resolved once in resolveServices() so drawFrame() does not go through the ServiceLocator.
+		SyncObjectsManager* syncObjectsManager = nullptr;
+		SwapChainManager* swapChainManager = nullptr;
+		CommandBufferManager* commandBufferManager = nullptr;
+		ComputeManager* computeManager = nullptr;
+		UploadManager* uploadManager = nullptr;
+		DeletionQueue* deletionQueue = nullptr;
+		DescriptorManager* descriptorManager = nullptr;
+		UniformManager* uniformManager = nullptr;
+		TextureManager* textureManager = nullptr;
+		ThreadPool* threadPool = nullptr;
+		ShaderLibrary* shaderLibrary = nullptr;
+		MemoryAllocator* memoryAllocator = nullptr;
+
+		// Reused every frame to avoid reallocating the submit wait lists.
+		std::vector<VkSemaphore> waitSemaphores;
+		std::vector<VkPipelineStageFlags> waitStages;
+		std::vector<uint64_t> waitValues;
+
+		bool lowLatency = false;
+		std::chrono::steady_clock::duration minFrameTime{};
+		std::chrono::steady_clock::time_point nextFrameStart{};
 
 		int currentFrame = 0;
+		// Only the render thread increments it.
+		std::atomic<uint64_t> frameNumber = 0;
 		bool framebufferResized = false;
 	};
 
@@ -0,0 +1,931 @@
+#include "RenderGraph.h"
+
+#include <algorithm>
+#include <numeric>
+#include <ranges>
+#include <stdexcept>
+
+#include "DebugManager.h"
+#include "DeletionQueue.h"
+#include "GpuProfiler.h"
+#include "utils/TesseraLog.h"
+
+namespace tessera::vulkan
+{
+
+	namespace
+	{
+		struct UsageInfo
+		{
+			VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+			VkPipelineStageFlags stages = 0;
+			VkAccessFlags readAccess = 0;
+			VkAccessFlags writeAccess = 0;
+			VkImageUsageFlags imageUsage = 0;
+		};
+
+		UsageInfo getUsageInfo(const RenderResourceUsage usage, const VkAttachmentLoadOp loadOp)
+		{
+			switch (usage)
+			{
+				using enum RenderResourceUsage;
+				case COLOR_ATTACHMENT:
+					return { VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+						loadOp == VK_ATTACHMENT_LOAD_OP_LOAD ? VkAccessFlags{VK_ACCESS_COLOR_ATTACHMENT_READ_BIT} : 0, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+						VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT };
+				case COLOR_RESOLVE:
+					return { VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+						VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT };
+				case DEPTH_STENCIL_ATTACHMENT:
+					return { VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+						VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT };
+				case DEPTH_STENCIL_READ_ONLY:
+					return { VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+						VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT, 0, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT };
+				case SAMPLED:
+					return { VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, 0, VK_IMAGE_USAGE_SAMPLED_BIT };
+				case TRANSFER_SOURCE:
+					return { VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT, 0, VK_IMAGE_USAGE_TRANSFER_SRC_BIT };
+			}
+
+			throw std::invalid_argument("RenderGraph: unknown resource usage.");
+		}
+
+		bool isAttachment(const RenderResourceUsage usage)
+		{
+			return usage == RenderResourceUsage::COLOR_ATTACHMENT || usage == RenderResourceUsage::COLOR_RESOLVE
+				|| usage == RenderResourceUsage::DEPTH_STENCIL_ATTACHMENT || usage == RenderResourceUsage::DEPTH_STENCIL_READ_ONLY;
+		}
+
+		// Whether the use depends on what earlier passes left in the image.
+		bool readsContents(const RenderResourceUsage usage, const VkAttachmentLoadOp loadOp)
+		{
+			return !isAttachment(usage) || usage == RenderResourceUsage::DEPTH_STENCIL_READ_ONLY || loadOp == VK_ATTACHMENT_LOAD_OP_LOAD;
+		}
+
+		constexpr VkMemoryPropertyFlags LAZY_MEMORY_PROPERTIES = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
+
+		VkImageAspectFlags getAspectMask(const VkFormat format)
+		{
+			switch (format)
+			{
+				case VK_FORMAT_D16_UNORM:
+				case VK_FORMAT_X8_D24_UNORM_PACK32:
+				case VK_FORMAT_D32_SFLOAT:
+					return VK_IMAGE_ASPECT_DEPTH_BIT;
+				case VK_FORMAT_D16_UNORM_S8_UINT:
+				case VK_FORMAT_D24_UNORM_S8_UINT:
+				case VK_FORMAT_D32_SFLOAT_S8_UINT:
+					return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+				case VK_FORMAT_S8_UINT:
+					return VK_IMAGE_ASPECT_STENCIL_BIT;
+				default:
+					return VK_IMAGE_ASPECT_COLOR_BIT;
+			}
+		}
+	}
+
+	void RenderPassContext::beginRenderPass(const VkSubpassContents contents) const
+	{
+		if (dynamicRendering != nullptr)
+		{
+			VkRenderingInfo renderingInfo{};
+			renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+			renderingInfo.flags = contents == VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS ? VkRenderingFlags{VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT} : 0;
+			renderingInfo.renderArea.offset = { 0, 0 };
+			renderingInfo.renderArea.extent = extent;
+			renderingInfo.layerCount = 1;
+			renderingInfo.colorAttachmentCount = static_cast<uint32_t>(dynamicRendering->colorAttachments.size());
+			renderingInfo.pColorAttachments = dynamicRendering->colorAttachments.data();
+			renderingInfo.pDepthAttachment = dynamicRendering->hasDepth ? &dynamicRendering->depthAttachment : nullptr;
+
+			vkCmdBeginRendering(commandBuffer, &renderingInfo);
+			return;
+		}
+
+		VkRenderPassBeginInfo renderPassInfo{};
+		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+		renderPassInfo.renderPass = renderPass;
+		renderPassInfo.framebuffer = framebuffer;
+		renderPassInfo.renderArea.offset = { 0, 0 };
+		renderPassInfo.renderArea.extent = extent;
+		renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues->size());
+		renderPassInfo.pClearValues = clearValues->data();
+
+		vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, contents);
+	}
+
+	void RenderPassContext::endRenderPass() const
+	{
+		if (dynamicRendering != nullptr)
+		{
+			vkCmdEndRendering(commandBuffer);
+			return;
+		}
+
+		vkCmdEndRenderPass(commandBuffer);
+	}
+
+	void RenderPassContext::fillInheritanceInfo(VkCommandBufferInheritanceInfo& inheritanceInfo, VkCommandBufferInheritanceRenderingInfo& renderingInheritance) const
+	{
+		inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+		inheritanceInfo.renderPass = renderPass;
+		inheritanceInfo.subpass = 0;
+		inheritanceInfo.framebuffer = framebuffer;
+
+		if (dynamicRendering == nullptr)
+		{
+			return;
+		}
+
+		renderingInheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO;
+		renderingInheritance.colorAttachmentCount = static_cast<uint32_t>(dynamicRendering->colorFormats.size());
+		renderingInheritance.pColorAttachmentFormats = dynamicRendering->colorFormats.data();
+		renderingInheritance.depthAttachmentFormat = dynamicRendering->depthFormat;
+		renderingInheritance.rasterizationSamples = dynamicRendering->samples;
+		inheritanceInfo.pNext = &renderingInheritance;
+	}
+
+	RenderPassBuilder& RenderPassBuilder::writeColor(const RenderResource resource, const VkAttachmentLoadOp loadOp, const VkClearColorValue clearColor)
+	{
+		VkClearValue clearValue{};
+		clearValue.color = clearColor;
+		graph.passes[pass].uses.push_back({ resource, RenderResourceUsage::COLOR_ATTACHMENT, loadOp, clearValue });
+		return *this;
+	}
+
+	RenderPassBuilder& RenderPassBuilder::resolveColor(const RenderResource source, const RenderResource target)
+	{
+		graph.passes[pass].uses.push_back({ target, RenderResourceUsage::COLOR_RESOLVE, VK_ATTACHMENT_LOAD_OP_DONT_CARE, {}, source });
+		return *this;
+	}
+
+	RenderPassBuilder& RenderPassBuilder::writeDepth(const RenderResource resource, const VkAttachmentLoadOp loadOp, const VkClearDepthStencilValue clearValue)
+	{
+		VkClearValue value{};
+		value.depthStencil = clearValue;
+		graph.passes[pass].uses.push_back({ resource, RenderResourceUsage::DEPTH_STENCIL_ATTACHMENT, loadOp, value });
+		return *this;
+	}
+
+	RenderPassBuilder& RenderPassBuilder::readDepth(const RenderResource resource)
+	{
+		graph.passes[pass].uses.push_back({ resource, RenderResourceUsage::DEPTH_STENCIL_READ_ONLY, VK_ATTACHMENT_LOAD_OP_LOAD, {} });
+		return *this;
+	}
+
+	RenderPassBuilder& RenderPassBuilder::read(const RenderResource resource, const RenderResourceUsage usage)
+	{
+		if (usage == RenderResourceUsage::COLOR_ATTACHMENT || usage == RenderResourceUsage::COLOR_RESOLVE || usage == RenderResourceUsage::DEPTH_STENCIL_ATTACHMENT)
+		{
+			throw std::invalid_argument("RenderGraph: attachments are written with writeColor(), resolveColor() or writeDepth().");
+		}
+
+		graph.passes[pass].uses.push_back({ resource, usage, VK_ATTACHMENT_LOAD_OP_LOAD, {} });
+		return *this;
+	}
+
+	RenderPassBuilder& RenderPassBuilder::setSideEffects()
+	{
+		graph.passes[pass].sideEffects = true;
+		return *this;
+	}
+
+	RenderResource RenderGraph::importImage(const std::string& name, const VkFormat format, const VkImageLayout finalLayout, const VkPipelineStageFlags availableStages)
+	{
+		Resource resource;
+		resource.name = name;
+		resource.imported = true;
+		resource.format = format;
+		resource.finalLayout = finalLayout;
+		resource.availableStages = availableStages;
+
+		resources.push_back(std::move(resource));
+		return static_cast<RenderResource>(resources.size() - 1);
+	}
+
+	RenderResource RenderGraph::createImage(const std::string& name, const TransientImageDescription& description)
+	{
+		Resource resource;
+		resource.name = name;
+		resource.format = description.format;
+		resource.samples = description.samples;
+
+		resources.push_back(std::move(resource));
+		return static_cast<RenderResource>(resources.size() - 1);
+	}
+
+	RenderPassBuilder RenderGraph::addPass(const std::string& name, RenderPassCallback record)
+	{
+		if (compiled)
+		{
+			throw std::logic_error("RenderGraph: passes cannot be added after compile().");
+		}
+
+		Pass pass;
+		pass.name = name;
+		pass.record = std::move(record);
+		passes.push_back(std::move(pass));
+
+		return { *this, static_cast<uint32_t>(passes.size() - 1) };
+	}
+
+	void RenderGraph::compile(const VkDevice logicalDevice, const bool useDynamicRendering)
+	{
+		device = logicalDevice;
+		dynamicRendering = useDynamicRendering;
+
+		cullPasses();
+		deriveBarriers();
+
+		for (uint32_t i = 0; i < passes.size(); ++i)
+		{
+			if (passes[i].culled)
+			{
+				continue;
+			}
+
+			if (dynamicRendering)
+			{
+				createRenderingAttachments(i);
+			}
+			else
+			{
+				createRenderPass(i);
+			}
+		}
+
+		compiled = true;
+	}
+
+	void RenderGraph::cullPasses()
+	{
+		// Walk backwards from the imported images, which leave the graph, keeping the passes that contribute to them.
+		std::vector<bool> needed(resources.size());
+		for (size_t i = 0; i < resources.size(); ++i)
+		{
+			needed[i] = resources[i].imported;
+		}
+
+		for (auto pass = passes.rbegin(); pass != passes.rend(); ++pass)
+		{
+			pass->culled = !pass->sideEffects && std::ranges::none_of(pass->uses, [&](const ResourceUse& use)
+				{
+					return getUsageInfo(use.usage, use.loadOp).writeAccess != 0 && needed[use.resource];
+				});
+
+			if (pass->culled)
+			{
+				TESSERA_LOG(LogType::DEBUG, "RenderGraph", "Culled pass " + pass->name + ", nothing uses what it writes.");
+				continue;
+			}
+
+			for (const auto& use : pass->uses)
+			{
+				if (readsContents(use.usage, use.loadOp))
+				{
+					needed[use.resource] = true;
+				}
+			}
+		}
+
+		for (uint32_t i = 0; i < passes.size(); ++i)
+		{
+			if (passes[i].culled)
+			{
+				continue;
+			}
+
+			for (const auto& use : passes[i].uses)
+			{
+				Resource& resource = resources[use.resource];
+
+				if (resource.firstPass == UINT32_MAX && !resource.imported && readsContents(use.usage, use.loadOp))
+				{
+					throw std::runtime_error("RenderGraph: pass " + passes[i].name + " reads " + resource.name + " before any pass writes it.");
+				}
+
+				resource.firstPass = std::min(resource.firstPass, i);
+				resource.lastPass = std::max(resource.lastPass, i);
+				resource.usage |= getUsageInfo(use.usage, use.loadOp).imageUsage;
+			}
+		}
+	}
+
+	void RenderGraph::deriveBarriers()
+	{
+		std::vector<ResourceState> states(resources.size());
+		for (size_t i = 0; i < resources.size(); ++i)
+		{
+			// Orders the first use after whatever made the image available, e.g. the acquire semaphore wait.
+			states[i].readStages = resources[i].availableStages;
+		}
+
+		for (uint32_t i = 0; i < passes.size(); ++i)
+		{
+			Pass& pass = passes[i];
+			if (pass.culled)
+			{
+				continue;
+			}
+
+			for (const auto& use : pass.uses)
+			{
+				const UsageInfo info = getUsageInfo(use.usage, use.loadOp);
+				Resource& resource = resources[use.resource];
+				ResourceState& state = states[use.resource];
+
+				const bool firstUse = resource.firstBarrierPass == UINT32_MAX;
+				// Writes wait for every earlier access, reads only for an earlier write not yet visible to their stages.
+				const bool hazard = info.writeAccess != 0
+					? (state.writeStages | state.readStages) != 0
+					: state.writeStages != 0 && (info.stages & ~state.visibleStages) != 0;
+
+				if (firstUse || hazard || state.layout != info.layout)
+				{
+					if (firstUse)
+					{
+						resource.firstBarrierPass = i;
+						resource.firstBarrierIndex = static_cast<uint32_t>(pass.barriers.size());
+					}
+
+					pass.barriers.push_back({ use.resource, firstUse ? VK_IMAGE_LAYOUT_UNDEFINED : state.layout, info.layout,
+						state.writeStages | state.readStages, state.writeAccess, info.stages, info.readAccess | info.writeAccess });
+
+					state.layout = info.layout;
+					state.readStages = 0;
+					state.visibleStages = info.stages;
+				}
+
+				if (info.writeAccess != 0)
+				{
+					state.writeStages = info.stages;
+					state.writeAccess = info.writeAccess;
+					state.readStages = 0;
+					state.visibleStages = 0;
+				}
+				else
+				{
+					state.readStages |= info.stages;
+				}
+			}
+		}
+
+		for (size_t i = 0; i < resources.size(); ++i)
+		{
+			Resource& resource = resources[i];
+			resource.finalState = states[i];
+
+			if (resource.imported && resource.firstPass != UINT32_MAX)
+			{
+				finalBarriers.push_back({ static_cast<RenderResource>(i), states[i].layout, resource.finalLayout,
+					states[i].writeStages | states[i].readStages, states[i].writeAccess, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0 });
+			}
+		}
+	}
+
+	void RenderGraph::createRenderPass(const uint32_t passIndex)
+	{
+		Pass& pass = passes[passIndex];
+
+		std::vector<VkAttachmentDescription> attachmentDescriptions;
+		std::vector<VkAttachmentReference> colorReferences;
+		std::vector<RenderResource> colorResources;
+		std::vector<std::pair<RenderResource, VkAttachmentReference>> resolves;
+		VkAttachmentReference depthReference{};
+		bool hasDepth = false;
+
+		for (const auto& use : pass.uses)
+		{
+			if (!isAttachment(use.usage))
+			{
+				continue;
+			}
+
+			const Resource& resource = resources[use.resource];
+			const VkImageLayout layout = getUsageInfo(use.usage, use.loadOp).layout;
+			// Nothing reads a transient attachment after its last pass, so tilers can skip writing it back to memory.
+			const bool keepContents = resource.imported || resource.lastPass > passIndex;
+
+			VkAttachmentDescription description{};
+			description.format = resource.format;
+			description.samples = resource.samples;
+			description.loadOp = use.loadOp;
+			description.storeOp = keepContents ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+			description.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+			description.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+			// Layout transitions are done by the graph's barriers, not by the render pass.
+			description.initialLayout = layout;
+			description.finalLayout = layout;
+
+			const VkAttachmentReference reference = { static_cast<uint32_t>(attachmentDescriptions.size()), layout };
+			if (use.usage == RenderResourceUsage::COLOR_ATTACHMENT)
+			{
+				colorReferences.push_back(reference);
+				colorResources.push_back(use.resource);
+			}
+			else if (use.usage == RenderResourceUsage::COLOR_RESOLVE)
+			{
+				resolves.emplace_back(use.resolveSource, reference);
+			}
+			else
+			{
+				depthReference = reference;
+				hasDepth = true;
+			}
+
+			attachmentDescriptions.push_back(description);
+			pass.attachments.push_back(use.resource);
+			pass.clearValues.push_back(use.clearValue);
+		}
+
+		if (attachmentDescriptions.empty())
+		{
+			return;
+		}
+
+		if (attachmentDescriptions.size() > MAX_ATTACHMENTS)
+		{
+			throw std::runtime_error("RenderGraph: pass " + pass.name + " has more attachments than supported.");
+		}
+
+		// Parallel to the color attachments; the resolve happens at the end of the subpass, while the samples are still in tile memory.
+		std::vector<VkAttachmentReference> resolveReferences(resolves.empty() ? 0 : colorReferences.size(), VkAttachmentReference{ VK_ATTACHMENT_UNUSED, VK_IMAGE_LAYOUT_UNDEFINED });
+		for (const auto& [source, reference] : resolves)
+		{
+			const auto color = std::ranges::find(colorResources, source);
+			if (color == colorResources.end() || resources[source].samples == VK_SAMPLE_COUNT_1_BIT)
+			{
+				throw std::runtime_error("RenderGraph: pass " + pass.name + " resolves " + resources[source].name + ", which is not one of its multisampled color attachments.");
+			}
+			resolveReferences[color - colorResources.begin()] = reference;
+		}
+
+		VkSubpassDescription subpass{};
+		subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+		subpass.colorAttachmentCount = static_cast<uint32_t>(colorReferences.size());
+		subpass.pColorAttachments = colorReferences.data();
+		subpass.pResolveAttachments = resolveReferences.empty() ? nullptr : resolveReferences.data();
+		subpass.pDepthStencilAttachment = hasDepth ? &depthReference : nullptr;
+
+		VkRenderPassCreateInfo renderPassInfo{};
+		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+		renderPassInfo.attachmentCount = static_cast<uint32_t>(attachmentDescriptions.size());
+		renderPassInfo.pAttachments = attachmentDescriptions.data();
+		renderPassInfo.subpassCount = 1;
+		renderPassInfo.pSubpasses = &subpass;
+
+		if (vkCreateRenderPass(device, &renderPassInfo, nullptr, &pass.renderPass) != VK_SUCCESS)
+		{
+			throw std::runtime_error("RenderGraph: failed to create render pass for " + pass.name + ".");
+		}
+	}
+
+	void RenderGraph::createRenderingAttachments(const uint32_t passIndex)
+	{
+		Pass& pass = passes[passIndex];
+		DynamicRenderingAttachments& rendering = pass.rendering;
+		std::vector<std::pair<RenderResource, RenderResource>> resolves;
+
+		for (const auto& use : pass.uses)
+		{
+			if (!isAttachment(use.usage))
+			{
+				continue;
+			}
+
+			const Resource& resource = resources[use.resource];
+			pass.attachments.push_back(use.resource);
+			pass.clearValues.push_back(use.clearValue);
+
+			if (use.usage == RenderResourceUsage::COLOR_RESOLVE)
+			{
+				resolves.emplace_back(use.resolveSource, use.resource);
+				continue;
+			}
+
+			// Same load and store operations as the render pass would use; the graph's barriers still do the layout transitions.
+			VkRenderingAttachmentInfo attachment{};
+			attachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+			attachment.imageLayout = getUsageInfo(use.usage, use.loadOp).layout;
+			attachment.loadOp = use.loadOp;
+			attachment.storeOp = resource.imported || resource.lastPass > passIndex ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+			attachment.clearValue = use.clearValue;
+			rendering.samples = resource.samples;
+
+			if (use.usage == RenderResourceUsage::COLOR_ATTACHMENT)
+			{
+				rendering.colorAttachments.push_back(attachment);
+				rendering.colorFormats.push_back(resource.format);
+				pass.colorResources.push_back(use.resource);
+				pass.resolveResources.push_back(UINT32_MAX);
+			}
+			else
+			{
+				rendering.depthAttachment = attachment;
+				rendering.depthFormat = resource.format;
+				rendering.hasDepth = true;
+				pass.depthResource = use.resource;
+			}
+		}
+
+		if (pass.attachments.size() > MAX_ATTACHMENTS)
+		{
+			throw std::runtime_error("RenderGraph: pass " + pass.name + " has more attachments than supported.");
+		}
+
+		// Color attachments are unsigned normalized or sRGB, for which averaging the samples is always supported.
+		for (const auto& [source, target] : resolves)
+		{
+			const auto color = std::ranges::find(pass.colorResources, source);
+			if (color == pass.colorResources.end() || resources[source].samples == VK_SAMPLE_COUNT_1_BIT)
+			{
+				throw std::runtime_error("RenderGraph: pass " + pass.name + " resolves " + resources[source].name + ", which is not one of its multisampled color attachments.");
+			}
+
+			const auto index = static_cast<size_t>(color - pass.colorResources.begin());
+			rendering.colorAttachments[index].resolveMode = VK_RESOLVE_MODE_AVERAGE_BIT;
+			rendering.colorAttachments[index].resolveImageLayout = getUsageInfo(RenderResourceUsage::COLOR_RESOLVE, VK_ATTACHMENT_LOAD_OP_DONT_CARE).layout;
+			pass.resolveResources[index] = target;
+		}
+	}
+
+	void RenderGraph::allocateTransients(MemoryAllocator& allocator, const VkExtent2D newExtent)
+	{
+		memoryAllocator = &allocator;
+		extent = newExtent;
+
+		std::vector<VkMemoryRequirements> requirements(resources.size());
+		for (size_t i = 0; i < resources.size(); ++i)
+		{
+			Resource& resource = resources[i];
+			if (resource.imported || resource.usage == 0)
+			{
+				continue;
+			}
+
+			// Never loaded or stored when a single pass uses it as an attachment only, so its contents need not leave the tile.
+			const bool passLocal = resource.firstPass == resource.lastPass && (resource.usage & ~ATTACHMENT_USAGE) == 0;
+
+			VkImageCreateInfo imageInfo{};
+			imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+			imageInfo.imageType = VK_IMAGE_TYPE_2D;
+			imageInfo.format = resource.format;
+			imageInfo.extent = { extent.width, extent.height, 1 };
+			imageInfo.mipLevels = 1;
+			imageInfo.arrayLayers = 1;
+			imageInfo.samples = resource.samples;
+			imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+			imageInfo.usage = passLocal ? resource.usage | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT : resource.usage;
+			imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+			imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+			if (vkCreateImage(device, &imageInfo, nullptr, &resource.image) != VK_SUCCESS)
+			{
+				throw std::runtime_error("RenderGraph: failed to create transient image " + resource.name + ".");
+			}
+			vkGetImageMemoryRequirements(device, resource.image, &requirements[i]);
+			resource.lazy = passLocal && allocator.hasMemoryType(requirements[i].memoryTypeBits, LAZY_MEMORY_PROPERTIES);
+		}
+
+		assignAliasSlots(requirements);
+
+		VkDeviceSize unaliasedSize = 0;
+		for (auto& slot : aliasSlots)
+		{
+			slot.allocation = allocator.allocate(slot.requirements, slot.lazy ? LAZY_MEMORY_PROPERTIES : VkMemoryPropertyFlags{VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT}, ResourceKind::OPTIMAL,
+				MemoryCategory::IMAGE);
+
+			for (const RenderResource member : slot.resources)
+			{
+				Resource& resource = resources[member];
+				unaliasedSize += slot.lazy ? 0 : requirements[member].size;
+				vkBindImageMemory(device, resource.image, slot.allocation.memory, slot.allocation.offset);
+
+				VkImageViewCreateInfo viewInfo{};
+				viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+				viewInfo.image = resource.image;
+				viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+				viewInfo.format = resource.format;
+				viewInfo.subresourceRange = { getAspectMask(resource.format), 0, 1, 0, 1 };
+
+				if (vkCreateImageView(device, &viewInfo, nullptr, &resource.view) != VK_SUCCESS)
+				{
+					throw std::runtime_error("RenderGraph: failed to create view of transient image " + resource.name + ".");
+				}
+			}
+		}
+
+		patchFirstBarriers();
+
+		if (!aliasSlots.empty())
+		{
+			const auto lazySlots = static_cast<size_t>(std::ranges::count_if(aliasSlots, &AliasSlot::lazy));
+			TESSERA_LOG(LogType::DEBUG, "RenderGraph", "Transient images use " + std::to_string(getTransientMemorySize()) + " bytes in "
+				+ std::to_string(aliasSlots.size() - lazySlots) + " allocations, " + std::to_string(unaliasedSize) + " bytes without aliasing. "
+				+ std::to_string(lazySlots) + " images are lazily allocated.");
+		}
+	}
+
+	void RenderGraph::assignAliasSlots(const std::vector<VkMemoryRequirements>& requirements)
+	{
+		std::vector<RenderResource> candidates;
+		for (size_t i = 0; i < resources.size(); ++i)
+		{
+			if (resources[i].image != VK_NULL_HANDLE && !resources[i].imported)
+			{
+				candidates.push_back(static_cast<RenderResource>(i));
+			}
+		}
+
+		// Largest first, so smaller images fill in around them.
+		std::ranges::sort(candidates, std::greater{}, [&](const RenderResource resource) { return requirements[resource].size; });
+
+		for (const RenderResource candidate : candidates)
+		{
+			const Resource& resource = resources[candidate];
+			const VkMemoryRequirements& candidateRequirements = requirements[candidate];
+
+			const auto slot = resource.lazy ? aliasSlots.end() : std::ranges::find_if(aliasSlots, [&](const AliasSlot& aliasSlot)
+				{
+					return !aliasSlot.lazy && (aliasSlot.requirements.memoryTypeBits & candidateRequirements.memoryTypeBits) != 0
+						&& std::ranges::all_of(aliasSlot.resources, [&](const RenderResource member)
+							{
+								return resources[member].lastPass < resource.firstPass || resource.lastPass < resources[member].firstPass;
+							});
+				});
+
+			if (slot == aliasSlots.end())
+			{
+				aliasSlots.push_back({ { candidate }, candidateRequirements, {}, resource.lazy });
+				continue;
+			}
+
+			slot->resources.push_back(candidate);
+			slot->requirements.size = std::max(slot->requirements.size, candidateRequirements.size);
+			slot->requirements.alignment = std::max(slot->requirements.alignment, candidateRequirements.alignment);
+			slot->requirements.memoryTypeBits &= candidateRequirements.memoryTypeBits;
+		}
+
+		for (auto& slot : aliasSlots)
+		{
+			std::ranges::sort(slot.resources, {}, [&](const RenderResource member) { return resources[member].firstPass; });
+		}
+	}
+
+	void RenderGraph::patchFirstBarriers()
+	{
+		// The first use of an image waits on the previous user of its memory: the image before it in the slot, or the
+		// last one of the previous frame. Pipeline barriers also order against earlier submissions on the queue.
+		for (const auto& slot : aliasSlots)
+		{
+			for (size_t i = 0; i < slot.resources.size(); ++i)
+			{
+				const Resource& resource = resources[slot.resources[i]];
+				const Resource& previous = resources[slot.resources[(i + slot.resources.size() - 1) % slot.resources.size()]];
+
+				ImageBarrier& barrier = passes[resource.firstBarrierPass].barriers[resource.firstBarrierIndex];
+				barrier.srcStages = previous.finalState.writeStages | previous.finalState.readStages;
+				barrier.srcAccess = previous.finalState.writeAccess;
+			}
+		}
+	}
+
+	void RenderGraph::releaseSizedResources(DeletionQueue& deletionQueue)
+	{
+		std::vector<VkFramebuffer> oldFramebuffers;
+		for (const auto& framebuffer : framebuffers | std::views::values)
+		{
+			oldFramebuffers.push_back(framebuffer);
+		}
+		framebuffers.clear();
+
+		std::vector<std::pair<VkImage, VkImageView>> oldImages;
+		for (auto& resource : resources)
+		{
+			if (!resource.imported && resource.image != VK_NULL_HANDLE)
+			{
+				oldImages.emplace_back(resource.image, resource.view);
+				resource.image = VK_NULL_HANDLE;
+				resource.view = VK_NULL_HANDLE;
+			}
+		}
+
+		std::vector<MemoryAllocation> oldAllocations;
+		for (const auto& slot : aliasSlots)
+		{
+			oldAllocations.push_back(slot.allocation);
+		}
+		aliasSlots.clear();
+
+		deletionQueue.push([device = device, allocator = memoryAllocator, oldFramebuffers = std::move(oldFramebuffers), oldImages = std::move(oldImages),
+			oldAllocations = std::move(oldAllocations)]
+			{
+				for (const auto& framebuffer : oldFramebuffers)
+				{
+					vkDestroyFramebuffer(device, framebuffer, nullptr);
+				}
+				for (const auto& [image, view] : oldImages)
+				{
+					vkDestroyImageView(device, view, nullptr);
+					vkDestroyImage(device, image, nullptr);
+				}
+				for (const auto& allocation : oldAllocations)
+				{
+					allocator->free(allocation);
+				}
+			});
+	}
+
+	void RenderGraph::destroy()
+	{
+		for (const auto& framebuffer : framebuffers | std::views::values)
+		{
+			vkDestroyFramebuffer(device, framebuffer, nullptr);
+		}
+		framebuffers.clear();
+
+		for (auto& resource : resources)
+		{
+			if (!resource.imported && resource.image != VK_NULL_HANDLE)
+			{
+				vkDestroyImageView(device, resource.view, nullptr);
+				vkDestroyImage(device, resource.image, nullptr);
+			}
+		}
+
+		for (const auto& slot : aliasSlots)
+		{
+			memoryAllocator->free(slot.allocation);
+		}
+		aliasSlots.clear();
+
+		for (auto& pass : passes)
+		{
+			vkDestroyRenderPass(device, pass.renderPass, nullptr);
+			pass.renderPass = VK_NULL_HANDLE;
+		}
+
+		resources.clear();
+		passes.clear();
+		finalBarriers.clear();
+		compiled = false;
+	}
+
+	void RenderGraph::setImportedImage(const RenderResource resource, const VkImage image, const VkImageView view)
+	{
+		resources[resource].image = image;
+		resources[resource].view = view;
+	}
+
+	void RenderGraph::execute(const VkCommandBuffer commandBuffer, const int frame, GpuProfiler* gpuProfiler)
+	{
+		for (uint32_t i = 0; i < passes.size(); ++i)
+		{
+			Pass& pass = passes[i];
+			if (pass.culled)
+			{
+				continue;
+			}
+
+			recordBarriers(commandBuffer, pass.barriers);
+
+			// Imported views change every frame and transient ones with the extent, so they are set right before use.
+			const bool rendersDynamically = dynamicRendering && !pass.attachments.empty();
+			if (rendersDynamically)
+			{
+				for (size_t k = 0; k < pass.colorResources.size(); ++k)
+				{
+					pass.rendering.colorAttachments[k].imageView = resources[pass.colorResources[k]].view;
+					pass.rendering.colorAttachments[k].resolveImageView = pass.resolveResources[k] != UINT32_MAX ? resources[pass.resolveResources[k]].view : VK_NULL_HANDLE;
+				}
+				if (pass.rendering.hasDepth)
+				{
+					pass.rendering.depthAttachment.imageView = resources[pass.depthResource].view;
+				}
+			}
+
+			DebugManager::beginLabel(commandBuffer, pass.name.c_str());
+			if (gpuProfiler != nullptr)
+			{
+				gpuProfiler->beginScope(commandBuffer, pass.name.c_str());
+			}
+
+			RenderPassContext context;
+			context.commandBuffer = commandBuffer;
+			context.renderPass = pass.renderPass;
+			context.framebuffer = pass.renderPass != VK_NULL_HANDLE ? getFramebuffer(i, pass) : VK_NULL_HANDLE;
+			context.dynamicRendering = rendersDynamically ? &pass.rendering : nullptr;
+			context.extent = extent;
+			context.frame = frame;
+			context.clearValues = &pass.clearValues;
+			pass.record(context);
+
+			if (gpuProfiler != nullptr)
+			{
+				gpuProfiler->endScope(commandBuffer);
+			}
+			DebugManager::endLabel(commandBuffer);
+		}
+
+		recordBarriers(commandBuffer, finalBarriers);
+	}
+
+	VkFramebuffer RenderGraph::getFramebuffer(const uint32_t passIndex, const Pass& pass)
+	{
+		FramebufferKey key;
+		key.pass = passIndex;
+		for (size_t i = 0; i < pass.attachments.size(); ++i)
+		{
+			key.views[i] = resources[pass.attachments[i]].view;
+		}
+
+		if (const auto it = framebuffers.find(key); it != framebuffers.end())
+		{
+			return it->second;
+		}
+
+		VkFramebufferCreateInfo framebufferInfo{};
+		framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+		framebufferInfo.renderPass = pass.renderPass;
+		framebufferInfo.attachmentCount = static_cast<uint32_t>(pass.attachments.size());
+		framebufferInfo.pAttachments = key.views.data();
+		framebufferInfo.width = extent.width;
+		framebufferInfo.height = extent.height;
+		framebufferInfo.layers = 1;
+
+		VkFramebuffer framebuffer;
+		if (vkCreateFramebuffer(device, &framebufferInfo, nullptr, &framebuffer) != VK_SUCCESS)
+		{
+			throw std::runtime_error("RenderGraph: failed to create framebuffer for " + pass.name + ".");
+		}
+
+		framebuffers.emplace(key, framebuffer);
+		return framebuffer;
+	}
+
+	void RenderGraph::recordBarriers(const VkCommandBuffer commandBuffer, const std::vector<ImageBarrier>& barriers)
+	{
+		if (barriers.empty())
+		{
+			return;
+		}
+
+		barrierScratch.clear();
+		VkPipelineStageFlags srcStages = 0;
+		VkPipelineStageFlags dstStages = 0;
+
+		for (const auto& barrier : barriers)
+		{
+			const Resource& resource = resources[barrier.resource];
+
+			VkImageMemoryBarrier imageBarrier{};
+			imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			imageBarrier.srcAccessMask = barrier.srcAccess;
+			imageBarrier.dstAccessMask = barrier.dstAccess;
+			imageBarrier.oldLayout = barrier.oldLayout;
+			imageBarrier.newLayout = barrier.newLayout;
+			imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			imageBarrier.image = resource.image;
+			imageBarrier.subresourceRange = { getAspectMask(resource.format), 0, 1, 0, 1 };
+			barrierScratch.push_back(imageBarrier);
+
+			srcStages |= barrier.srcStages;
+			dstStages |= barrier.dstStages;
+		}
+
+		vkCmdPipelineBarrier(commandBuffer, srcStages != 0 ? srcStages : VkPipelineStageFlags{VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT}, dstStages, 0,
+			0, nullptr, 0, nullptr, static_cast<uint32_t>(barrierScratch.size()), barrierScratch.data());
+	}
+
+	const RenderGraph::Pass& RenderGraph::findPass(const std::string& passName) const
+	{
+		const auto pass = std::ranges::find(passes, passName, &Pass::name);
+		if (pass == passes.end() || pass->culled || pass->attachments.empty())
+		{
+			throw std::runtime_error("RenderGraph: no render pass named " + passName + ", or it was culled.");
+		}
+
+		return *pass;
+	}
+
+	VkRenderPass RenderGraph::getRenderPass(const std::string& passName) const
+	{
+		return findPass(passName).renderPass;
+	}
+
+	const DynamicRenderingAttachments& RenderGraph::getDynamicRenderingAttachments(const std::string& passName) const
+	{
+		return findPass(passName).rendering;
+	}
+
+	VkDeviceSize RenderGraph::getTransientMemorySize() const
+	{
+		return std::accumulate(aliasSlots.begin(), aliasSlots.end(), VkDeviceSize{0}, [](const VkDeviceSize total, const AliasSlot& slot)
+			{
+				return slot.lazy ? total : total + slot.requirements.size;
+			});
+	}
+
+}
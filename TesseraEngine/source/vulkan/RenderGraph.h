@@ -0,0 +1,261 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+#include "MemoryAllocator.h"
+
+namespace tessera::vulkan
+{
+
+	class DeletionQueue;
+	class GpuProfiler;
+
+	using RenderResource = uint32_t;
+
+	// How a pass accesses an image; decides the layout, stages and access masks of the barriers around the pass.
+	enum class RenderResourceUsage : uint8_t
+	{
+		COLOR_ATTACHMENT,
+		// Written at the end of the pass by resolving one of its multisampled color attachments.
+		COLOR_RESOLVE,
+		DEPTH_STENCIL_ATTACHMENT,
+		DEPTH_STENCIL_READ_ONLY,
+		SAMPLED,
+		TRANSFER_SOURCE
+	};
+
+	// Transient images always match the extent of the graph.
+	struct TransientImageDescription
+	{
+		VkFormat format = VK_FORMAT_UNDEFINED;
+		VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+	};
+
+	// Attachments of a pass recorded with dynamic rendering. The image views are set anew every frame.
+	struct DynamicRenderingAttachments
+	{
+		std::vector<VkRenderingAttachmentInfo> colorAttachments;
+		VkRenderingAttachmentInfo depthAttachment{};
+		bool hasDepth = false;
+
+		// What pipelines and secondary command buffers drawing into the pass are created with.
+		std::vector<VkFormat> colorFormats;
+		VkFormat depthFormat = VK_FORMAT_UNDEFINED;
+		VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+	};
+
+	struct RenderPassContext
+	{
+		VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+		// VK_NULL_HANDLE for passes without attachments, and for every pass with dynamic rendering.
+		VkRenderPass renderPass = VK_NULL_HANDLE;
+		VkFramebuffer framebuffer = VK_NULL_HANDLE;
+		// Set instead of renderPass and framebuffer with dynamic rendering.
+		const DynamicRenderingAttachments* dynamicRendering = nullptr;
+		VkExtent2D extent{};
+		int frame = 0;
+		const std::vector<VkClearValue>* clearValues = nullptr;
+
+		// Left to the pass, since only it knows whether it records inline or through secondary command buffers.
+		void beginRenderPass(VkSubpassContents contents) const;
+		void endRenderPass() const;
+
+		// Describe the pass to secondary command buffers recorded for it. renderingInheritance is chained with dynamic rendering.
+		void fillInheritanceInfo(VkCommandBufferInheritanceInfo& inheritanceInfo, VkCommandBufferInheritanceRenderingInfo& renderingInheritance) const;
+	};
+
+	using RenderPassCallback = std::function<void(const RenderPassContext&)>;
+
+	class RenderGraph;
+
+	class RenderPassBuilder final
+	{
+	public:
+		RenderPassBuilder& writeColor(RenderResource resource, VkAttachmentLoadOp loadOp, VkClearColorValue clearColor = {});
+		// Resolve the multisampled color attachment source, written by this pass, into target within the subpass.
+		RenderPassBuilder& resolveColor(RenderResource source, RenderResource target);
+		RenderPassBuilder& writeDepth(RenderResource resource, VkAttachmentLoadOp loadOp, VkClearDepthStencilValue clearValue = { 1.0f, 0 });
+		RenderPassBuilder& readDepth(RenderResource resource);
+		RenderPassBuilder& read(RenderResource resource, RenderResourceUsage usage);
+		// Keeps the pass even when nothing reads what it writes, e.g. for readbacks.
+		RenderPassBuilder& setSideEffects();
+	private:
+		friend class RenderGraph;
+		RenderPassBuilder(RenderGraph& ownerGraph, const uint32_t passIndex) : graph(ownerGraph), pass(passIndex) {}
+
+		RenderGraph& graph;
+		uint32_t pass;
+	};
+
+	/**
+	 * @brief Frame described as passes declaring the images they read and write.
+	 *
+	 * compile() culls passes whose results are never used, derives the image barriers between passes (skipping
+	 * them between reads in the same layout) and creates one VkRenderPass per pass. Transient images whose
+	 * lifetimes do not overlap share memory. Imported images, such as the swap chain image, are provided every
+	 * frame; their previous contents are discarded and they end the frame in the layout given at import.
+	 *
+	 * Transient images used by a single pass only, such as multisampled attachments resolved within it, are
+	 * neither loaded nor stored. They are created as transient attachments in lazily allocated memory where
+	 * the device has it, so tile-based GPUs keep them in tile memory and never back them at all.
+	 *
+	 * Compiled with dynamic rendering, passes render straight into the image views of their attachments:
+	 * no VkRenderPass is created and no VkFramebuffer has to be recreated when the extent or an imported
+	 * image changes.
+	 */
+	class RenderGraph final
+	{
+	public:
+		RenderResource importImage(const std::string& name, VkFormat format, VkImageLayout finalLayout, VkPipelineStageFlags availableStages);
+		RenderResource createImage(const std::string& name, const TransientImageDescription& description);
+		RenderPassBuilder addPass(const std::string& name, RenderPassCallback record);
+
+		// Declarations cannot change afterwards. useDynamicRendering requires the dynamicRendering feature.
+		void compile(VkDevice device, bool useDynamicRendering = false);
+		void allocateTransients(MemoryAllocator& memoryAllocator, VkExtent2D extent);
+		// Defer destruction of everything sized by the extent, before allocateTransients() is called with a new one.
+		void releaseSizedResources(DeletionQueue& deletionQueue);
+		void destroy();
+
+		void setImportedImage(RenderResource resource, VkImage image, VkImageView view);
+		void execute(VkCommandBuffer commandBuffer, int frame, GpuProfiler* gpuProfiler);
+
+		// VK_NULL_HANDLE with dynamic rendering, where pipelines are created for the formats of getDynamicRenderingAttachments() instead.
+		[[nodiscard]] VkRenderPass getRenderPass(const std::string& passName) const;
+		[[nodiscard]] const DynamicRenderingAttachments& getDynamicRenderingAttachments(const std::string& passName) const;
+		[[nodiscard]] bool usesDynamicRendering() const { return dynamicRendering; }
+		[[nodiscard]] VkExtent2D getExtent() const { return extent; }
+		// Memory of all transient images after aliasing, without the lazily allocated ones.
+		[[nodiscard]] VkDeviceSize getTransientMemorySize() const;
+	private:
+		friend class RenderPassBuilder;
+
+		static constexpr size_t MAX_ATTACHMENTS = 8;
+		static constexpr VkImageUsageFlags ATTACHMENT_USAGE = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT
+			| VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+
+		struct ResourceState
+		{
+			VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+			VkPipelineStageFlags writeStages = 0;
+			VkAccessFlags writeAccess = 0;
+			VkPipelineStageFlags readStages = 0;
+			// Stages the last write was made visible to; reads elsewhere need another barrier.
+			VkPipelineStageFlags visibleStages = 0;
+		};
+
+		struct Resource
+		{
+			std::string name;
+			bool imported = false;
+			VkFormat format = VK_FORMAT_UNDEFINED;
+			VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+			VkImageLayout finalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			VkPipelineStageFlags availableStages = 0;
+
+			VkImageUsageFlags usage = 0;
+			uint32_t firstPass = UINT32_MAX;
+			uint32_t lastPass = 0;
+			ResourceState finalState;
+			// Barrier of the first use, patched once aliasing tells which image used the memory before.
+			uint32_t firstBarrierPass = UINT32_MAX;
+			uint32_t firstBarrierIndex = 0;
+			// Only used within one pass and placed in lazily allocated memory.
+			bool lazy = false;
+
+			VkImage image = VK_NULL_HANDLE;
+			VkImageView view = VK_NULL_HANDLE;
+		};
+
+		struct ResourceUse
+		{
+			RenderResource resource = 0;
+			RenderResourceUsage usage = RenderResourceUsage::SAMPLED;
+			VkAttachmentLoadOp loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+			VkClearValue clearValue{};
+			// Color attachment resolved into the resource, for COLOR_RESOLVE.
+			RenderResource resolveSource = 0;
+		};
+
+		struct ImageBarrier
+		{
+			RenderResource resource = 0;
+			VkImageLayout oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			VkImageLayout newLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			VkPipelineStageFlags srcStages = 0;
+			VkAccessFlags srcAccess = 0;
+			VkPipelineStageFlags dstStages = 0;
+			VkAccessFlags dstAccess = 0;
+		};
+
+		struct Pass
+		{
+			std::string name;
+			RenderPassCallback record;
+			std::vector<ResourceUse> uses;
+			bool sideEffects = false;
+
+			bool culled = false;
+			std::vector<ImageBarrier> barriers;
+			VkRenderPass renderPass = VK_NULL_HANDLE;
+			std::vector<RenderResource> attachments;
+			std::vector<VkClearValue> clearValues;
+
+			// Only with dynamic rendering; the resources tell execute() which views to set.
+			DynamicRenderingAttachments rendering;
+			std::vector<RenderResource> colorResources;
+			// Parallel to colorResources, UINT32_MAX for colors that are not resolved.
+			std::vector<RenderResource> resolveResources;
+			RenderResource depthResource = 0;
+		};
+
+		// Transient images sharing one allocation, ordered by first use.
+		struct AliasSlot
+		{
+			std::vector<RenderResource> resources;
+			VkMemoryRequirements requirements{};
+			MemoryAllocation allocation;
+			// Lazily allocated images are never aliased; there is hardly any memory behind them to share.
+			bool lazy = false;
+		};
+
+		struct FramebufferKey
+		{
+			uint32_t pass = 0;
+			std::array<VkImageView, MAX_ATTACHMENTS> views{};
+
+			auto operator<=>(const FramebufferKey&) const = default;
+		};
+
+		void cullPasses();
+		void deriveBarriers();
+		void createRenderPass(uint32_t passIndex);
+		void createRenderingAttachments(uint32_t passIndex);
+		[[nodiscard]] const Pass& findPass(const std::string& passName) const;
+		void assignAliasSlots(const std::vector<VkMemoryRequirements>& requirements);
+		void patchFirstBarriers();
+		[[nodiscard]] VkFramebuffer getFramebuffer(uint32_t passIndex, const Pass& pass);
+		void recordBarriers(VkCommandBuffer commandBuffer, const std::vector<ImageBarrier>& barriers);
+
+		VkDevice device = VK_NULL_HANDLE;
+		MemoryAllocator* memoryAllocator = nullptr;
+		VkExtent2D extent{};
+		bool compiled = false;
+		bool dynamicRendering = false;
+
+		std::vector<Resource> resources;
+		std::vector<Pass> passes;
+		std::vector<ImageBarrier> finalBarriers;
+		std::vector<AliasSlot> aliasSlots;
+		std::map<FramebufferKey, VkFramebuffer> framebuffers;
+
+		// Reused by recordBarriers() so executing the graph does not allocate.
+		std::vector<VkImageMemoryBarrier> barrierScratch;
+	};
+
+}
@@ -0,0 +1,182 @@
+#include "RenderGraphManager.h"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+#include "CommandBufferManager.h"
+#include "ComputeManager.h"
+#include "DeletionQueue.h"
+#include "DeviceManager.h"
+#include "GpuProfiler.h"
+#include "ImageViewManager.h"
+#include "IndirectDrawManager.h"
+#include "MemoryAllocator.h"
+#include "PipelineRegistry.h"
+#include "SwapChainManager.h"
+#include "utils/EngineConfig.h"
+#include "utils/interfaces/ServiceLocator.h"
+
+namespace tessera::vulkan
+{
+
+	void RenderGraphManager::init()
+	{
+		const auto& deviceManager = ServiceLocator::getService<DeviceManager>();
+		const auto& swapChain = ServiceLocator::getService<SwapChainManager>();
+		const auto& swapChainImageDetails = swapChain->getSwapChainImageDetails();
+
+		// Available once the acquire semaphore, waited on at the color attachment output stage, signals.
+		backBuffer = graph.importImage("Back buffer", swapChainImageDetails.swapChainImageFormat, swapChain->getFinalImageLayout(),
+			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+
+		const auto& config = ServiceLocator::getService<EngineConfig>();
+		depthPrepass = config->getBool("render.depthPrepass", false);
+		samples = findSampleCount(deviceManager->getPhysicalDevice(), config->getInt("render.msaaSamples", 1));
+
+		depthFormat = findDepthFormat(deviceManager->getPhysicalDevice());
+		depthBuffer = graph.createImage("Depth buffer", { depthFormat, samples });
+
+		// Its draws live in buffers the graph does not track, so nothing would keep the pass otherwise.
+		// With an async compute queue the IndirectDrawManager submits culling there instead.
+		if (IndirectDrawManager::isRequested() && IndirectDrawManager::isSupported() && !ServiceLocator::getService<ComputeManager>()->isAsync())
+		{
+			graph.addPass(CULL_PASS, [this](const RenderPassContext& context)
+				{
+					if (indirectDrawManager->isEnabled())
+					{
+						indirectDrawManager->recordCulling(context.commandBuffer, context.frame);
+					}
+				})
+				.setSideEffects();
+		}
+
+		if (depthPrepass)
+		{
+			graph.addPass(DEPTH_PREPASS, [this](const RenderPassContext& context) { commandBufferManager->recordDepthPrepass(context); })
+				.writeDepth(depthBuffer, VK_ATTACHMENT_LOAD_OP_CLEAR);
+		}
+
+		constexpr VkClearColorValue clearColor = { {0.0f, 0.0f, 0.0f, 1.0f} };
+		RenderPassBuilder mainPass = graph.addPass(MAIN_PASS, [this](const RenderPassContext& context) { commandBufferManager->recordMainPass(context); });
+
+		// The samples never leave the main pass: they are resolved into the back buffer at its end.
+		if (samples != VK_SAMPLE_COUNT_1_BIT)
+		{
+			const RenderResource multisampledColor = graph.createImage("Multisampled color", { swapChainImageDetails.swapChainImageFormat, samples });
+			mainPass.writeColor(multisampledColor, VK_ATTACHMENT_LOAD_OP_CLEAR, clearColor).resolveColor(multisampledColor, backBuffer);
+		}
+		else
+		{
+			mainPass.writeColor(backBuffer, VK_ATTACHMENT_LOAD_OP_CLEAR, clearColor);
+		}
+
+		// Only tested against after a prepass, whose depth is final.
+		if (depthPrepass)
+		{
+			mainPass.readDepth(depthBuffer);
+		}
+		else
+		{
+			mainPass.writeDepth(depthBuffer, VK_ATTACHMENT_LOAD_OP_CLEAR);
+		}
+
+		// Without render pass and framebuffer objects, resizing only recreates the transient images.
+		const bool dynamicRendering = config->getBool("render.dynamicRendering", false) && deviceManager->getCapabilities().dynamicRendering;
+		graph.compile(deviceManager->getLogicalDevice(), dynamicRendering);
+		graph.allocateTransients(*ServiceLocator::getService<MemoryAllocator>(), swapChainImageDetails.swapChainExtent);
+	}
+
+	VkFormat RenderGraphManager::findDepthFormat(const VkPhysicalDevice physicalDevice)
+	{
+		// Without stencil first, since nothing uses it; D32_SFLOAT or D24_UNORM_S8_UINT is supported everywhere.
+		for (const VkFormat format : { VK_FORMAT_D32_SFLOAT, VK_FORMAT_X8_D24_UNORM_PACK32, VK_FORMAT_D24_UNORM_S8_UINT, VK_FORMAT_D32_SFLOAT_S8_UINT })
+		{
+			VkFormatProperties properties;
+			vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &properties);
+			if ((properties.optimalTilingFeatures & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT) != 0)
+			{
+				return format;
+			}
+		}
+
+		throw std::runtime_error("RenderGraphManager: no supported depth format.");
+	}
+
+	VkSampleCountFlagBits RenderGraphManager::findSampleCount(const VkPhysicalDevice physicalDevice, const int requested)
+	{
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+		const VkSampleCountFlags supported = properties.limits.framebufferColorSampleCounts & properties.limits.framebufferDepthSampleCounts;
+
+		// The highest supported count up to the requested one; a single sample is always supported.
+		for (auto count = std::bit_floor(static_cast<uint32_t>(std::clamp(requested, 1, 64))); count > 1; count >>= 1)
+		{
+			if ((supported & count) != 0)
+			{
+				return static_cast<VkSampleCountFlagBits>(count);
+			}
+		}
+
+		return VK_SAMPLE_COUNT_1_BIT;
+	}
+
+	void RenderGraphManager::setPassTarget(const std::string& passName, PipelineDescription& description) const
+	{
+		description.renderPass = graph.getRenderPass(passName);
+		if (graph.usesDynamicRendering())
+		{
+			const auto& attachments = graph.getDynamicRenderingAttachments(passName);
+			description.colorFormats = attachments.colorFormats;
+			description.depthFormat = attachments.depthFormat;
+		}
+	}
+
+	void RenderGraphManager::setMainPassState(PipelineDescription& description) const
+	{
+		setPassTarget(MAIN_PASS, description);
+		description.samples = samples;
+		description.depthTestEnable = true;
+		// The prepass wrote the nearest depth already; only the fragments matching it are shaded.
+		description.depthWriteEnable = !depthPrepass;
+		description.depthCompareOp = depthPrepass ? VK_COMPARE_OP_EQUAL : VK_COMPARE_OP_LESS;
+	}
+
+	void RenderGraphManager::setDepthPrepassState(PipelineDescription& description) const
+	{
+		setPassTarget(DEPTH_PREPASS, description);
+		description.samples = samples;
+		description.fragmentShader = VK_NULL_HANDLE;
+		description.depthTestEnable = true;
+		description.depthWriteEnable = true;
+		description.depthCompareOp = VK_COMPARE_OP_LESS;
+	}
+
+	void RenderGraphManager::resolveServices()
+	{
+		commandBufferManager = ServiceLocator::getServicePointer<CommandBufferManager>();
+		gpuProfiler = ServiceLocator::getServicePointer<GpuProfiler>();
+		swapChainManager = ServiceLocator::getServicePointer<SwapChainManager>();
+		imageViewManager = ServiceLocator::getServicePointer<ImageViewManager>();
+		indirectDrawManager = ServiceLocator::getServicePointer<IndirectDrawManager>();
+	}
+
+	void RenderGraphManager::recreate()
+	{
+		graph.releaseSizedResources(*ServiceLocator::getService<DeletionQueue>());
+		graph.allocateTransients(*ServiceLocator::getService<MemoryAllocator>(), swapChainManager->getSwapChainImageDetails().swapChainExtent);
+	}
+
+	void RenderGraphManager::execute(const VkCommandBuffer commandBuffer, const uint32_t imageIndex, const int frame)
+	{
+		graph.setImportedImage(backBuffer, swapChainManager->getSwapChainImageDetails().swapChainImages[imageIndex],
+			imageViewManager->getSwapChainImageViews()[imageIndex]);
+		graph.execute(commandBuffer, frame, gpuProfiler);
+	}
+
+	void RenderGraphManager::clean()
+	{
+		graph.destroy();
+	}
+
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <string>
+#include <vulkan/vulkan_core.h>
+
+#include "RenderGraph.h"
+#include "utils/interfaces/Initializable.h"
+
+namespace tessera::vulkan
+{
+
+	class CommandBufferManager;
+	class GpuProfiler;
+	class ImageViewManager;
+	class IndirectDrawManager;
+	class SwapChainManager;
+	struct PipelineDescription;
+
+	/**
+	 * @brief Owns the RenderGraph of the frame.
+	 *
+	 * The passes are declared and compiled once in init(). Only the images sized by the swap chain are
+	 * recreated with it; the swap chain image itself is imported anew every frame.
+	 *
+	 * The main pass tests against a transient depth buffer. With render.depthPrepass, a depth-only pass fills
+	 * it first and the main pass tests for equal depth without writing, so every pixel is shaded once
+	 * however much the draws overlap. With render.msaaSamples, the main pass renders into multisampled
+	 * attachments that only live within it and resolves them into the back buffer. With render.dynamicRendering
+	 * on a Vulkan 1.3 device, passes render straight into image views.
+	 */
+	class RenderGraphManager final : public Initializable
+	{
+	public:
+		void init() override;
+		void resolveServices() override;
+		void clean() override;
+
+		// Hand the sized resources to the DeletionQueue and create new ones for the current swap chain.
+		void recreate();
+
+		void execute(VkCommandBuffer commandBuffer, uint32_t imageIndex, int frame);
+
+		[[nodiscard]] bool isDepthPrepassEnabled() const { return depthPrepass; }
+		[[nodiscard]] VkFormat getDepthFormat() const { return depthFormat; }
+
+		[[nodiscard]] VkSampleCountFlagBits getSampleCount() const { return samples; }
+
+		// Render pass or dynamic rendering formats, samples and depth state of opaque pipelines drawn in the main pass.
+		void setMainPassState(PipelineDescription& description) const;
+		// Same for the depth-only pipelines drawn in the prepass. Only valid with the prepass enabled.
+		void setDepthPrepassState(PipelineDescription& description) const;
+
+	private:
+		static constexpr auto CULL_PASS = "Cull";
+		static constexpr auto DEPTH_PREPASS = "Depth prepass";
+		static constexpr auto MAIN_PASS = "Main pass";
+
+		[[nodiscard]] static VkFormat findDepthFormat(VkPhysicalDevice physicalDevice);
+		[[nodiscard]] static VkSampleCountFlagBits findSampleCount(VkPhysicalDevice physicalDevice, int requested);
+		void setPassTarget(const std::string& passName, PipelineDescription& description) const;
+
+		RenderGraph graph;
+		RenderResource backBuffer = 0;
+		RenderResource depthBuffer = 0;
+		VkFormat depthFormat = VK_FORMAT_UNDEFINED;
+		bool depthPrepass = false;
+		// Of the color and depth attachments of the main pass; with more than one, the color is resolved into the back buffer.
+		VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+
+		// Resolved once in resolveServices() so recording does not go through the ServiceLocator.
+		CommandBufferManager* commandBufferManager = nullptr;
+		GpuProfiler* gpuProfiler = nullptr;
+		SwapChainManager* swapChainManager = nullptr;
+		ImageViewManager* imageViewManager = nullptr;
+		IndirectDrawManager* indirectDrawManager = nullptr;
+	};
+
+}
@@ -0,0 +1,142 @@
+#include "SceneManager.h"
+
+#include <algorithm>
+#include <bit>
+
+#include "CommandBufferManager.h"
+#include "DeletionQueue.h"
+#include "GraphicsPipelineManager.h"
+#include "UniformManager.h"
+#include "entities/Vertex.h"
+#include "utils/CpuProfiler.h"
+#include "utils/EngineConfig.h"
+#include "utils/Frustum.h"
+#include "utils/ThreadPool.h"
+#include "utils/interfaces/ServiceLocator.h"
+
+namespace tessera::vulkan
+{
+
+	void SceneManager::init()
+	{
+		bufferManager = ServiceLocator::getServicePointer<BufferManager>();
+		graphicsPipelineManager = ServiceLocator::getServicePointer<GraphicsPipelineManager>();
+		memoryAllocator = ServiceLocator::getServicePointer<MemoryAllocator>();
+		deletionQueue = ServiceLocator::getServicePointer<DeletionQueue>();
+		threadPool = ServiceLocator::getServicePointer<ThreadPool>();
+		uniformManager = ServiceLocator::getServicePointer<UniformManager>();
+		cpuCulling = ServiceLocator::getService<EngineConfig>()->getBool("render.cpuCulling", true);
+
+		frames.resize(CommandBufferManager::queryFramesInFlight());
+	}
+
+	void SceneManager::setMesh(const Entity entity, const MeshHandle mesh, const uint16_t material)
+	{
+		scene.setRenderable(entity, mesh, material, bufferManager->getMesh(mesh).boundingSphere);
+	}
+
+	void SceneManager::appendDraws(DrawList& drawList, const int frame)
+	{
+		scene.update(threadPool);
+
+		TESSERA_PROFILE_ZONE("Scene draws");
+		const Scene::Components& c = scene.getComponents();
+
+		if (cpuCulling)
+		{
+			bvh.update(scene);
+			bvh.query(Frustum::fromMatrix(uniformManager->getFrameConstants().viewProjection), visible);
+			// Back in dense order, so entities created together still form one run.
+			std::ranges::sort(visible);
+		}
+		else
+		{
+			visible.clear();
+			for (uint32_t i = 0; i < scene.getEntityCount(); ++i)
+			{
+				if (c.meshes[i] != 0)
+				{
+					visible.push_back(i);
+				}
+			}
+		}
+
+		visibleCount = static_cast<uint32_t>(visible.size());
+		if (visibleCount == 0)
+		{
+			return;
+		}
+
+		FrameInstances& instances = frames[frame];
+		reserveInstances(instances, visibleCount);
+		auto* instanceData = static_cast<InstanceData*>(instances.memory.mappedData);
+
+		const VkPipeline pipeline = graphicsPipelineManager->getInstancedPipeline();
+		const VkPipeline depthPipeline = graphicsPipelineManager->getInstancedDepthPipeline();
+
+		uint32_t instance = 0;
+		// Draw of the entities sharing the mesh and material of the previous renderable one.
+		size_t run = SIZE_MAX;
+		MeshHandle runMesh = 0;
+		for (const uint32_t i : visible)
+		{
+			// Written in order, which write-combined host memory favors.
+			instanceData[instance] = InstanceData{ glm::vec4(c.worldX[i], c.worldY[i], c.worldZ[i], c.worldScale[i]), glm::vec4(1.0f) };
+
+			if (run != SIZE_MAX && c.meshes[i] == runMesh && c.materials[i] == drawList[run].material)
+			{
+				++drawList[run].instanceCount;
+			}
+			else
+			{
+				DrawCommand draw = bufferManager->makeDraw(c.meshes[i]);
+				draw.pipeline = pipeline;
+				draw.depthPipeline = depthPipeline;
+				draw.instanceBuffer = instances.buffer;
+				draw.firstInstance = instance;
+				draw.material = c.materials[i];
+
+				run = drawList.size();
+				runMesh = c.meshes[i];
+				drawList.push_back(draw);
+			}
+			++instance;
+		}
+	}
+
+	void SceneManager::reserveInstances(FrameInstances& instances, const uint32_t count) const
+	{
+		if (count <= instances.capacity)
+		{
+			return;
+		}
+
+		// Frames still in flight may draw from the current buffer.
+		if (instances.buffer != VK_NULL_HANDLE)
+		{
+			deletionQueue->push([allocator = memoryAllocator, buffer = instances.buffer, memory = instances.memory]
+				{
+					allocator->destroyBuffer(buffer, memory);
+				});
+		}
+
+		instances.capacity = std::bit_ceil(std::max(count, MIN_INSTANCE_CAPACITY));
+		memoryAllocator->createBuffer(sizeof(InstanceData) * instances.capacity, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, instances.buffer, instances.memory);
+	}
+
+	void SceneManager::clean()
+	{
+		for (const FrameInstances& instances : frames)
+		{
+			if (instances.buffer != VK_NULL_HANDLE)
+			{
+				memoryAllocator->destroyBuffer(instances.buffer, instances.memory);
+			}
+		}
+		frames.clear();
+		scene = Scene();
+		bvh = BoundingVolumeHierarchy();
+	}
+
+}
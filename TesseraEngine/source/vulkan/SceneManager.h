@@ -0,0 +1,82 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+#include "BufferManager.h"
+#include "DrawList.h"
+#include "MemoryAllocator.h"
+#include "entities/BoundingVolumeHierarchy.h"
+#include "entities/Scene.h"
+#include "utils/interfaces/Initializable.h"
+
+namespace tessera
+{
+	class ThreadPool;
+}
+
+namespace tessera::vulkan
+{
+
+	class DeletionQueue;
+	class GraphicsPipelineManager;
+	class UniformManager;
+
+	/**
+	 * @brief Scene of the engine and the draws of its renderable entities.
+	 *
+	 * Every frame the scene is updated and its drawn entities are walked in dense order: their world
+	 * transforms are written into a persistently mapped instance buffer owned by the frame in flight, and
+	 * each run of consecutive entities sharing a mesh and material becomes one instanced draw. Entities
+	 * created together therefore draw together. The scene is meant to be changed from the render thread.
+	 *
+	 * With render.cpuCulling, only the entities a BoundingVolumeHierarchy finds in the view frustum of the
+	 * UniformManager camera are written and drawn, and recording the draws costs in proportion to what is
+	 * visible. Updating the scene and checking the tree for moved entities still take a linear pass each.
+	 */
+	class SceneManager final : public Initializable
+	{
+	public:
+		void init() override;
+		void clean() override;
+
+		[[nodiscard]] Scene& getScene() { return scene; }
+		// Entities drawn by the last recorded frame.
+		[[nodiscard]] uint32_t getVisibleCount() const { return visibleCount; }
+		// Draw mesh on entity, bounded by the bounding sphere of the mesh.
+		void setMesh(Entity entity, MeshHandle mesh, uint16_t material = 0);
+
+		// Update the scene and append its draws. Called while recording frame, after its in-flight fence has signaled.
+		void appendDraws(DrawList& drawList, int frame);
+	private:
+		// Instances drawn by one frame in flight. Host visible, so writing them needs no upload.
+		struct FrameInstances
+		{
+			VkBuffer buffer = VK_NULL_HANDLE;
+			MemoryAllocation memory;
+			uint32_t capacity = 0;
+		};
+
+		void reserveInstances(FrameInstances& instances, uint32_t count) const;
+
+		Scene scene;
+		std::vector<FrameInstances> frames;
+
+		bool cpuCulling = true;
+		BoundingVolumeHierarchy bvh;
+		// Dense indices of the entities drawn this frame, ascending; rebuilt every frame, keeping its capacity.
+		std::vector<uint32_t> visible;
+		uint32_t visibleCount = 0;
+
+		// appendDraws() creates and fills the instance buffers through these every frame.
+		BufferManager* bufferManager = nullptr;
+		GraphicsPipelineManager* graphicsPipelineManager = nullptr;
+		MemoryAllocator* memoryAllocator = nullptr;
+		DeletionQueue* deletionQueue = nullptr;
+		ThreadPool* threadPool = nullptr;
+		UniformManager* uniformManager = nullptr;
+
+		static constexpr uint32_t MIN_INSTANCE_CAPACITY = 256;
+	};
+
+}
@@ -0,0 +1,208 @@
+#include "ShaderLibrary.h"
+
+#include <future>
+#include <stdexcept>
+
+#include "DeletionQueue.h"
+#include "DeviceManager.h"
+#include "PipelineRegistry.h"
+#include "utils/EngineConfig.h"
+#include "utils/ShaderCompiler.h"
+#include "utils/ShaderLoader.h"
+#include "utils/TesseraLog.h"
+#include "utils/ThreadPool.h"
+#include "utils/interfaces/ServiceLocator.h"
+
+namespace tessera::vulkan
+{
+
+	void ShaderLibrary::init()
+	{
+		Initializable::init();
+		device = ServiceLocator::getService<DeviceManager>()->getLogicalDevice();
+		threadPool = ServiceLocator::getServicePointer<ThreadPool>();
+		deletionQueue = ServiceLocator::getServicePointer<DeletionQueue>();
+		pipelineRegistry = ServiceLocator::getServicePointer<PipelineRegistry>();
+
+		const auto& config = ServiceLocator::getService<EngineConfig>();
+		directory = config->getString("shaders.directory", "shaders");
+		cacheDirectory = config->getString("shaders.cacheDirectory", "shaders/cache");
+		compiler = config->getString("shaders.compiler", "");
+		hotReload = config->getBool("shaders.hotReload", false);
+
+		if (compiler.empty())
+		{
+			compiler = ShaderCompiler::findCompiler();
+		}
+	}
+
+	VkShaderModule ShaderLibrary::load(const std::string& name)
+	{
+		return load(std::vector{ name }).front();
+	}
+
+	std::vector<VkShaderModule> ShaderLibrary::load(const std::vector<std::string>& names)
+	{
+		std::vector<std::future<std::vector<char>>> compilations(names.size());
+		{
+			std::lock_guard lock(shadersMutex);
+			for (size_t i = 0; i < names.size(); ++i)
+			{
+				if (!shaders.contains(names[i]))
+				{
+					compilations[i] = threadPool->submit([this, name = names[i]] { return compile(name); });
+				}
+			}
+		}
+
+		std::vector<VkShaderModule> modules(names.size());
+		for (size_t i = 0; i < names.size(); ++i)
+		{
+			if (compilations[i].valid())
+			{
+				threadPool->waitFor(compilations[i]);
+				const VkShaderModule module = createShaderModule(compilations[i].get());
+
+				// Installs shipping only precompiled binaries have no source to time.
+				std::error_code error;
+				const auto writeTime = std::filesystem::last_write_time(getSourcePath(names[i]), error);
+
+				// Another service may have loaded the same source meanwhile; the first module wins.
+				std::lock_guard lock(shadersMutex);
+				const auto [it, inserted] = shaders.try_emplace(names[i], Shader{ module, writeTime });
+				if (!inserted)
+				{
+					vkDestroyShaderModule(device, module, nullptr);
+				}
+			}
+
+			std::lock_guard lock(shadersMutex);
+			modules[i] = shaders.at(names[i]).module;
+		}
+
+		return modules;
+	}
+
+	std::vector<char> ShaderLibrary::compile(const std::string& name) const
+	{
+		const std::filesystem::path sourcePath = getSourcePath(name);
+
+		try
+		{
+			return ShaderCompiler::compile(sourcePath.string(), cacheDirectory, compiler);
+		}
+		catch (const std::runtime_error& error)
+		{
+			const std::filesystem::path precompiledPath = sourcePath.string() + ".spv";
+			if (!std::filesystem::exists(precompiledPath))
+			{
+				throw;
+			}
+
+			TesseraLog::send(LogType::WARNING, "ShaderLibrary", std::string(error.what()) + " Using " + precompiledPath.string() + " instead.");
+			return ShaderLoader::readFile(precompiledPath.string());
+		}
+	}
+
+	VkShaderModule ShaderLibrary::createShaderModule(const std::vector<char>& code) const
+	{
+		VkShaderModuleCreateInfo createInfo{};
+		createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+		createInfo.codeSize = code.size();
+		createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+
+		VkShaderModule shaderModule;
+		if (vkCreateShaderModule(device, &createInfo, nullptr, &shaderModule) != VK_SUCCESS)
+		{
+			throw std::runtime_error("ShaderLibrary: failed to create shader module.");
+		}
+
+		return shaderModule;
+	}
+
+	void ShaderLibrary::addReloadListener(ReloadListener listener)
+	{
+		std::lock_guard lock(shadersMutex);
+		reloadListeners.push_back(std::move(listener));
+	}
+
+	void ShaderLibrary::update(const uint64_t frameNumber)
+	{
+		if (!hotReload || frameNumber % POLL_INTERVAL_FRAMES != 0)
+		{
+			return;
+		}
+
+		std::lock_guard lock(shadersMutex);
+		for (auto& [name, shader] : shaders)
+		{
+			std::error_code error;
+			const auto writeTime = std::filesystem::last_write_time(getSourcePath(name), error);
+
+			// Editors briefly remove files while saving; the next poll sees them again.
+			if (shader.compiling || error || writeTime == shader.writeTime)
+			{
+				continue;
+			}
+
+			shader.writeTime = writeTime;
+			shader.compiling = true;
+			TesseraLog::send(LogType::INFO, "ShaderLibrary", "Reloading " + name + ".");
+
+			// Precompiled binaries are as old as the previous source, so only a successful compilation counts.
+			threadPool->submit([this, sourcePath = getSourcePath(name).string()] { return ShaderCompiler::compile(sourcePath, cacheDirectory, compiler); },
+				[this, name](std::future<std::vector<char>> code)
+				{
+					try
+					{
+						reload(name, code.get());
+					}
+					catch (const std::runtime_error& compileError)
+					{
+						TesseraLog::send(LogType::ERROR, "ShaderLibrary", std::string(compileError.what()) + " Keeping the previous version of " + name + ".");
+					}
+
+					std::lock_guard compilingLock(shadersMutex);
+					shaders.at(name).compiling = false;
+				});
+		}
+	}
+
+	void ShaderLibrary::reload(const std::string& name, std::vector<char> code)
+	{
+		const VkShaderModule newModule = createShaderModule(code);
+
+		VkShaderModule oldModule;
+		std::vector<ReloadListener> listeners;
+		{
+			std::lock_guard lock(shadersMutex);
+			oldModule = shaders.at(name).module;
+			shaders.at(name).module = newModule;
+			listeners = reloadListeners;
+		}
+
+		pipelineRegistry->replaceShader(oldModule, newModule);
+		for (const auto& listener : listeners)
+		{
+			listener(oldModule, newModule);
+		}
+
+		deletionQueue->push([device = device, oldModule] { vkDestroyShaderModule(device, oldModule, nullptr); });
+	}
+
+	std::filesystem::path ShaderLibrary::getSourcePath(const std::string& name) const
+	{
+		return std::filesystem::path(directory) / name;
+	}
+
+	void ShaderLibrary::clean()
+	{
+		for (const auto& [name, shader] : shaders)
+		{
+			vkDestroyShaderModule(device, shader.module, nullptr);
+		}
+		shaders.clear();
+		reloadListeners.clear();
+	}
+
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+#include "utils/interfaces/Initializable.h"
+
+namespace tessera
+{
+	class ThreadPool;
+}
+
+namespace tessera::vulkan
+{
+
+	class DeletionQueue;
+	class PipelineRegistry;
+
+	/**
+	 * @brief Shader modules compiled from the GLSL sources at runtime, reloaded when a source changes.
+	 *
+	 * Sources are compiled through ShaderCompiler and its SPIR-V cache; when no compiler is available the
+	 * precompiled <source>.spv written by shaders/compile.bat is used instead. Each source has a single
+	 * module shared by everyone loading it.
+	 *
+	 * With shaders.hotReload, update() polls the sources and recompiles changed ones on the ThreadPool.
+	 * The new module then replaces the old one in the PipelineRegistry, which rebuilds only the pipelines
+	 * using it in the background, and in the reload listeners of pipelines kept elsewhere. A source that
+	 * fails to compile keeps its previous module.
+	 */
+	class ShaderLibrary final : public Initializable
+	{
+	public:
+		using ReloadListener = std::function<void(VkShaderModule oldModule, VkShaderModule newModule)>;
+
+		void init() override;
+		void clean() override;
+
+		// name is relative to shaders.directory, e.g. "shader.vert".
+		[[nodiscard]] VkShaderModule load(const std::string& name);
+		// Compiles the sources missing from the library concurrently; modules come back in the order of names.
+		[[nodiscard]] std::vector<VkShaderModule> load(const std::vector<std::string>& names);
+
+		// Called on the render thread after a module has been replaced. The old module is destroyed once the frames in flight retired.
+		void addReloadListener(ReloadListener listener);
+
+		// Look for changed sources every POLL_INTERVAL_FRAMES frames. Called once per frame before recording.
+		void update(uint64_t frameNumber);
+	private:
+		struct Shader
+		{
+			VkShaderModule module = VK_NULL_HANDLE;
+			std::filesystem::file_time_type writeTime;
+			bool compiling = false;
+		};
+
+		[[nodiscard]] std::vector<char> compile(const std::string& name) const;
+		[[nodiscard]] VkShaderModule createShaderModule(const std::vector<char>& code) const;
+		void reload(const std::string& name, std::vector<char> code);
+		[[nodiscard]] std::filesystem::path getSourcePath(const std::string& name) const;
+
+		VkDevice device = VK_NULL_HANDLE;
+		ThreadPool* threadPool = nullptr;
+		DeletionQueue* deletionQueue = nullptr;
+		PipelineRegistry* pipelineRegistry = nullptr;
+
+		std::string directory;
+		std::string cacheDirectory;
+		std::string compiler;
+		bool hotReload = false;
+
+		// Loads may come from services initializing concurrently.
+		std::mutex shadersMutex;
+		std::unordered_map<std::string, Shader> shaders;
+		std::vector<ReloadListener> reloadListeners;
+
+		static constexpr uint64_t POLL_INTERVAL_FRAMES = 30;
+	};
+
+}
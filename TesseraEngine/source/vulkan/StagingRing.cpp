@@ -0,0 +1,59 @@
+#include "StagingRing.h"
+
+namespace tessera::vulkan
+{
+
+	void StagingRing::create(MemoryAllocator& memoryAllocator, const VkDeviceSize requestedRegionSize, const uint32_t regionCount)
+	{
+		regionSize = requestedRegionSize;
+		regions.assign(regionCount, {});
+		currentRegion = 0;
+		currentFrameNumber = 0;
+
+		memoryAllocator.createBuffer(regionSize * regionCount, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			buffer, allocation);
+	}
+
+	void StagingRing::destroy(MemoryAllocator& memoryAllocator)
+	{
+		memoryAllocator.destroyBuffer(buffer, allocation);
+		buffer = VK_NULL_HANDLE;
+		allocation = {};
+		regions.clear();
+	}
+
+	std::optional<StagingRange> StagingRing::allocate(const VkDeviceSize size, const VkDeviceSize alignment, const uint64_t batchId)
+	{
+		Region& region = regions[currentRegion];
+		const VkDeviceSize offset = (region.head + alignment - 1) / alignment * alignment;
+
+		if (offset + size > regionSize)
+		{
+			return std::nullopt;
+		}
+
+		region.head = offset + size;
+		region.lastBatchId = batchId;
+
+		const VkDeviceSize bufferOffset = static_cast<VkDeviceSize>(currentRegion) * regionSize + offset;
+		return StagingRange{ buffer, bufferOffset, static_cast<char*>(allocation.mappedData) + bufferOffset };
+	}
+
+	uint64_t StagingRing::beginFrame(const uint64_t frameNumber)
+	{
+		// Uploads recorded before the first frame belong to frame zero.
+		if (frameNumber == currentFrameNumber)
+		{
+			return 0;
+		}
+
+		currentFrameNumber = frameNumber;
+		currentRegion = static_cast<uint32_t>(frameNumber % regions.size());
+
+		Region& region = regions[currentRegion];
+		const uint64_t lastBatchId = region.lastBatchId;
+		region = {};
+		return lastBatchId;
+	}
+
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <optional>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+#include "MemoryAllocator.h"
+
+namespace tessera::vulkan
+{
+
+	struct StagingRange
+	{
+		VkBuffer buffer = VK_NULL_HANDLE;
+		VkDeviceSize offset = 0;
+		void* data = nullptr;
+	};
+
+	/**
+	 * @brief Persistently mapped staging buffer split into one region per frame in flight.
+	 *
+	 * Sub-ranges are handed out linearly from the region of the frame being recorded and the whole
+	 * region is recycled at once when that frame slot comes around again, so uploads never allocate,
+	 * map or unmap memory.
+	 */
+	class StagingRing final
+	{
+	public:
+		void create(MemoryAllocator& memoryAllocator, VkDeviceSize requestedRegionSize, uint32_t regionCount);
+		void destroy(MemoryAllocator& memoryAllocator);
+
+		// Returns nothing when the current region cannot fit the request.
+		[[nodiscard]] std::optional<StagingRange> allocate(VkDeviceSize size, VkDeviceSize alignment, uint64_t batchId);
+
+		/**
+		 * @brief Switch to the region owned by frameNumber and reset it.
+		 *
+		 * @return Id of the last upload batch that read from the region, which must complete before it is overwritten.
+		 */
+		uint64_t beginFrame(uint64_t frameNumber);
+
+		[[nodiscard]] VkDeviceSize getRegionSize() const { return regionSize; }
+	private:
+		struct Region
+		{
+			VkDeviceSize head = 0;
+			uint64_t lastBatchId = 0;
+		};
+
+		VkBuffer buffer = VK_NULL_HANDLE;
+		MemoryAllocation allocation;
+		VkDeviceSize regionSize = 0;
+		std::vector<Region> regions;
+		uint32_t currentRegion = 0;
+		uint64_t currentFrameNumber = 0;
+	};
+
+}
@@ -11,8 +11,14 @@ namespace tessera::vulkan
 
 	void SurfaceManager::init()
 	{
+		const auto& glfwInitializer = ServiceLocator::getService<glfw::GlfwInitializer>();
+		if (glfwInitializer->isHeadless())
+		{
+			return;
+		}
+
 		const auto& instance = ServiceLocator::getService<InstanceManager>()->getInstance();
-		const std::shared_ptr<GLFWwindow>& window = ServiceLocator::getService<glfw::GlfwInitializer>()->getWindow();
+		const std::shared_ptr<GLFWwindow>& window = glfwInitializer->getWindow();
 
 		if (glfwCreateWindowSurface(instance, window.get(), nullptr, &surface) != VK_SUCCESS)
 		{
@@ -22,6 +28,11 @@ namespace tessera::vulkan
 
 	void SurfaceManager::clean()
 	{
+		if (surface == VK_NULL_HANDLE)
+		{
+			return;
+		}
+
 		const auto& instance = ServiceLocator::getService<InstanceManager>()->getInstance();
 
 		vkDestroySurfaceKHR(instance, surface, nullptr);
@@ -14,6 +14,7 @@ namespace tessera::vulkan
 		void init() override;
 		void clean() override;
 	
+		// VK_NULL_HANDLE when running headless.
 		[[nodiscard]] VkSurfaceKHR getSurface() const { return surface; }
 	private:
 		VkSurfaceKHR surface = VK_NULL_HANDLE;
@@ -3,41 +3,106 @@
 #include <algorithm>
 #include <cassert>
 #include <stdexcept>
+#include <string_view>
+#include <utility>
 #include <GLFW/glfw3.h>
 
+#include "CommandBufferManager.h"
+#include "DeletionQueue.h"
 #include "DeviceManager.h"
-#include "FramebufferManager.h"
 #include "ImageViewManager.h"
 #include "QueueManager.h"
+#include "RenderGraphManager.h"
 #include "SurfaceManager.h"
 #include "SyncObjectsManager.h"
 #include "glfw/GlfwInitializer.h"
+#include "utils/EngineConfig.h"
+#include "utils/TesseraLog.h"
 #include "utils/interfaces/ServiceLocator.h"
 
 namespace tessera::vulkan
 {
+
+	namespace
+	{
+		// Values accepted by render.presentMode.
+		constexpr std::pair<std::string_view, VkPresentModeKHR> PRESENT_MODE_NAMES[] = {
+			{ "fifo", VK_PRESENT_MODE_FIFO_KHR },
+			{ "fifo_relaxed", VK_PRESENT_MODE_FIFO_RELAXED_KHR },
+			{ "mailbox", VK_PRESENT_MODE_MAILBOX_KHR },
+			{ "immediate", VK_PRESENT_MODE_IMMEDIATE_KHR },
+		};
+	}
+
 	void SwapChainManager::init()
+	{
+		headless = ServiceLocator::getService<glfw::GlfwInitializer>()->isHeadless();
+		if (headless)
+		{
+			createOffscreenImages();
+			return;
+		}
+
+		createSwapChain(VK_NULL_HANDLE);
+	}
+
+	void SwapChainManager::createOffscreenImages()
+	{
+		const auto& config = ServiceLocator::getService<EngineConfig>();
+		const auto& memoryAllocator = ServiceLocator::getService<MemoryAllocator>();
+		logicalDevice = ServiceLocator::getService<DeviceManager>()->getLogicalDevice();
+
+		const VkExtent2D extent = {
+			static_cast<uint32_t>(std::max(config->getInt("render.headlessWidth", DEFAULT_OFFSCREEN_WIDTH), 1)),
+			static_cast<uint32_t>(std::max(config->getInt("render.headlessHeight", DEFAULT_OFFSCREEN_HEIGHT), 1))
+		};
+		const int imageCount = CommandBufferManager::queryFramesInFlight();
+
+		VkImageCreateInfo imageInfo{};
+		imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		imageInfo.imageType = VK_IMAGE_TYPE_2D;
+		imageInfo.format = OFFSCREEN_FORMAT;
+		imageInfo.extent = { extent.width, extent.height, 1 };
+		imageInfo.mipLevels = 1;
+		imageInfo.arrayLayers = 1;
+		imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+		imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		// Transfer source so results can be read back or compared against reference images.
+		imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+		imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+		std::vector<VkImage> images(imageCount);
+		offscreenAllocations.resize(imageCount);
+		for (int i = 0; i < imageCount; ++i)
+		{
+			memoryAllocator->createImage(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, images[i], offscreenAllocations[i]);
+		}
+
+		swapChainDetails = { OFFSCREEN_FORMAT, extent, images };
+
+		TesseraLog::send(LogType::INFO, "SwapChainManager", "Rendering into " + std::to_string(imageCount) + " offscreen images of "
+			+ std::to_string(extent.width) + "x" + std::to_string(extent.height) + ".");
+	}
+
+	void SwapChainManager::createSwapChain(const VkSwapchainKHR oldSwapChain)
 	{
 		const auto& deviceManager = ServiceLocator::getService<DeviceManager>();
 		const auto& window = ServiceLocator::getService<glfw::GlfwInitializer>()->getWindow();
 		const auto& surface = ServiceLocator::getService<SurfaceManager>()->getSurface();
+		const auto& config = ServiceLocator::getService<EngineConfig>();
 
 		const auto physicalDevice = deviceManager->getPhysicalDevice();
 		assert(physicalDevice);
-		const auto logicalDevice = deviceManager->getLogicalDevice();
+		logicalDevice = deviceManager->getLogicalDevice();
 		assert(logicalDevice);
 
 		const auto [capabilities, formats, presentModes] = querySwapChainSupport(physicalDevice, surface);
 
 		const auto [format, colorSpace] = chooseSwapSurfaceFormat(formats);
-		const VkPresentModeKHR presentMode = chooseSwapPresentMode(presentModes);
+		const VkPresentModeKHR presentMode = chooseSwapPresentMode(presentModes, config->getString("render.presentMode", "mailbox"));
 		const VkExtent2D extent = chooseSwapExtent(capabilities, window);
-
-		uint32_t imageCount = capabilities.minImageCount + 1;
-		if (capabilities.maxImageCount > 0 && imageCount > capabilities.maxImageCount) 
-		{
-			imageCount = capabilities.maxImageCount;
-		}
+		uint32_t imageCount = chooseSwapImageCount(capabilities, config->getInt("render.swapChainImages", 0));
 
 		VkSwapchainCreateInfoKHR createInfo{};
 		createInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
@@ -49,7 +114,7 @@ namespace tessera::vulkan
 		createInfo.imageArrayLayers = 1;
 		createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
 
-		const auto [graphicsFamily, presentFamily] = findQueueFamilies(physicalDevice, surface);
+		const auto [graphicsFamily, presentFamily, transferFamily, computeFamily, computeQueueIndex] = findQueueFamilies(physicalDevice, surface);
 		const uint32_t queueFamilyIndices[] = { graphicsFamily.value(), presentFamily.value() };
 
 		if (graphicsFamily != presentFamily) {
@@ -67,7 +132,8 @@ namespace tessera::vulkan
 		createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
 		createInfo.presentMode = presentMode;
 		createInfo.clipped = VK_TRUE;
-		createInfo.oldSwapchain = VK_NULL_HANDLE;
+		// Lets the driver hand over resources of the retired swap chain and keep presenting its queued images.
+		createInfo.oldSwapchain = oldSwapChain;
 
 		if (vkCreateSwapchainKHR(logicalDevice, &createInfo, nullptr, &swapChain) != VK_SUCCESS)
 		{
@@ -82,23 +148,27 @@ namespace tessera::vulkan
 		swapChainDetails = { format, extent, swapChainImages };
 	}
 
-	std::optional<uint32_t> SwapChainManager::acquireNextImage(const int currentFrame) const
+	void SwapChainManager::resolveServices()
 	{
-		const auto& device = ServiceLocator::getService<DeviceManager>()->getLogicalDevice();
-		const auto& imageAvailableSemaphore = ServiceLocator::getService<SyncObjectsManager>()->getImageAvailableSemaphores();
-		const auto& swapChainManager = ServiceLocator::getService<SwapChainManager>();
+		syncObjectsManager = ServiceLocator::getServicePointer<SyncObjectsManager>();
+	}
 
-		if (static_cast<size_t>(currentFrame) >= imageAvailableSemaphore.size() || currentFrame < 0)
+	std::optional<uint32_t> SwapChainManager::acquireNextImage(const int currentFrame)
+	{
+		// Offscreen images are tied to frame slots, whose previous frame has already been waited on.
+		if (headless)
 		{
-			throw std::out_of_range("SyncObjectsManager: current frame number is larger than number of fences.");
+			return static_cast<uint32_t>(currentFrame);
 		}
 
+		const VkSemaphore imageAvailableSemaphore = syncObjectsManager->getFrameSyncSlot(currentFrame).imageAvailableSemaphore;
+
 		uint32_t imageIndex;
-		const VkResult result = vkAcquireNextImageKHR(device, swapChain, UINT64_MAX, imageAvailableSemaphore[currentFrame], VK_NULL_HANDLE, &imageIndex);
+		const VkResult result = vkAcquireNextImageKHR(logicalDevice, swapChain, UINT64_MAX, imageAvailableSemaphore, VK_NULL_HANDLE, &imageIndex);
 
 		if (result == VK_ERROR_OUT_OF_DATE_KHR) 
 		{
-			swapChainManager->recreate();
+			recreate();
 			return std::nullopt;
 		}
 
@@ -112,39 +182,41 @@ namespace tessera::vulkan
 
 	void SwapChainManager::recreate()
 	{
-		const auto& deviceManager = ServiceLocator::getService<DeviceManager>();
 		const auto& imageViewManager = ServiceLocator::getService<ImageViewManager>();
-		const auto& framebufferManager = ServiceLocator::getService<FramebufferManager>();
+		const auto& renderGraphManager = ServiceLocator::getService<RenderGraphManager>();
 		const auto& glfwInitializer = ServiceLocator::getService<glfw::GlfwInitializer>();
-		const auto& device = ServiceLocator::getService<DeviceManager>()->getLogicalDevice();
+		const auto& deletionQueue = ServiceLocator::getService<DeletionQueue>();
 
 		glfwInitializer->handleMinimization();
-		deviceManager->deviceWaitIdle();
-
-		const auto& swapChainFramebuffers = ServiceLocator::getService<FramebufferManager>()->getSwapChainFramebuffers();
-		const auto& swapChainImageViews = ServiceLocator::getService<ImageViewManager>()->getSwapChainImageViews();
 
-		for (const auto& framebuffer : swapChainFramebuffers)
-		{
-			vkDestroyFramebuffer(device, framebuffer, nullptr);
-		}
-
-		for (const auto& imageView : swapChainImageViews)
-		{
-			vkDestroyImageView(device, imageView, nullptr);
-		}
+		// Frames in flight keep rendering to the old swap chain; it is destroyed once they retire instead of idling the device.
+		const VkSwapchainKHR oldSwapChain = swapChain;
+		createSwapChain(oldSwapChain);
 
-		vkDestroySwapchainKHR(device, swapChain, nullptr);
+		imageViewManager->recreate();
+		renderGraphManager->recreate();
 
-		this->init();
-		imageViewManager->init();
-		framebufferManager->init();
+		// Pushed last so it outlives the image views created from its images.
+		deletionQueue->push([device = logicalDevice, oldSwapChain]
+			{
+				vkDestroySwapchainKHR(device, oldSwapChain, nullptr);
+			});
 	}
 
 	void SwapChainManager::clean()
 	{
 		const auto& device = ServiceLocator::getService<DeviceManager>()->getLogicalDevice();
 
+		if (headless)
+		{
+			const auto& memoryAllocator = ServiceLocator::getService<MemoryAllocator>();
+			for (size_t i = 0; i < offscreenAllocations.size(); ++i)
+			{
+				memoryAllocator->destroyImage(swapChainDetails.swapChainImages[i], offscreenAllocations[i]);
+			}
+			return;
+		}
+
 		vkDestroySwapchainKHR(device, swapChain, nullptr);
 	}
 
@@ -190,21 +262,40 @@ namespace tessera::vulkan
 		return availableFormats[0];
 	}
 
-	VkPresentModeKHR SwapChainManager::chooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes)
+	VkPresentModeKHR SwapChainManager::chooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes, const std::string& requestedMode)
 	{
-		// TODO: Replace with std::find.
-		for (const auto& availablePresentMode : availablePresentModes) 
+		const auto namedMode = std::ranges::find(PRESENT_MODE_NAMES, requestedMode, &std::pair<std::string_view, VkPresentModeKHR>::first);
+		if (namedMode == std::ranges::end(PRESENT_MODE_NAMES))
 		{
-			if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR) 
-			{
-				return availablePresentMode;
-			}
+			TesseraLog::send(LogType::WARNING, "SwapChainManager", "Unknown present mode " + requestedMode + ", using mailbox.");
+		}
+
+		const VkPresentModeKHR presentMode = namedMode != std::ranges::end(PRESENT_MODE_NAMES) ? namedMode->second : VK_PRESENT_MODE_MAILBOX_KHR;
+
+		if (std::ranges::find(availablePresentModes, presentMode) != availablePresentModes.end())
+		{
+			return presentMode;
 		}
 
 		// Only the VK_PRESENT_MODE_FIFO_KHR mode is guaranteed to be available.
+		TesseraLog::send(LogType::INFO, "SwapChainManager", "Present mode " + requestedMode + " is not supported by the surface, using fifo.");
 		return VK_PRESENT_MODE_FIFO_KHR;
 	}
 
+	uint32_t SwapChainManager::chooseSwapImageCount(const VkSurfaceCapabilitiesKHR& capabilities, const int requestedCount)
+	{
+		// One image more than the minimum so the CPU does not wait on the driver to release one.
+		uint32_t imageCount = requestedCount > 0 ? static_cast<uint32_t>(requestedCount) : capabilities.minImageCount + 1;
+		imageCount = std::max(imageCount, capabilities.minImageCount);
+
+		if (capabilities.maxImageCount > 0 && imageCount > capabilities.maxImageCount)
+		{
+			imageCount = capabilities.maxImageCount;
+		}
+
+		return imageCount;
+	}
+
 	VkExtent2D SwapChainManager::chooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities, const std::shared_ptr<GLFWwindow>& window)
 	{
 		if (capabilities.currentExtent.width != std::numeric_limits<uint32_t>::max()) 
@@ -1,9 +1,11 @@
 #pragma once
+#include <string>
 #include <vector>
 #include <GLFW/glfw3.h>
 #include <vulkan/vulkan_core.h>
 
 #include "DeviceManager.h"
+#include "MemoryAllocator.h"
 
 namespace tessera::vulkan
 {
@@ -23,25 +25,48 @@ namespace tessera::vulkan
 		std::vector<VkImage> swapChainImages;
 	};
 
+	class SyncObjectsManager;
+
 	class SwapChainManager final : public Initializable
 	{
 	public:
 		void init() override;
+		void resolveServices() override;
 
-		[[nodiscard]] std::optional<uint32_t> acquireNextImage(const int currentFrame) const;
+		[[nodiscard]] std::optional<uint32_t> acquireNextImage(const int currentFrame);
 		void recreate();
 		void clean() override;
 
 		static SwapChainSupportDetails querySwapChainSupport(const VkPhysicalDevice& device, const VkSurfaceKHR& surface);
+		// VK_NULL_HANDLE when headless; the images are then offscreen render targets owned by this manager.
 		[[nodiscard]] VkSwapchainKHR getSwapChain() const { return swapChain; }
-		[[nodiscard]] SwapChainImageDetails getSwapChainImageDetails() const { return swapChainDetails; }
+		[[nodiscard]] bool isHeadless() const { return headless; }
+		// Layout the render pass leaves the images in for whatever consumes them next.
+		[[nodiscard]] VkImageLayout getFinalImageLayout() const { return headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR; }
+		[[nodiscard]] const SwapChainImageDetails& getSwapChainImageDetails() const { return swapChainDetails; }
 	private:
+		void createSwapChain(VkSwapchainKHR oldSwapChain);
+		// One image per frame in flight, so an image is only reused once the frame that rendered it retired.
+		void createOffscreenImages();
+
 		static VkSurfaceFormatKHR chooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats);
-		static VkPresentModeKHR chooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes);
+		static VkPresentModeKHR chooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes, const std::string& requestedMode);
+		static uint32_t chooseSwapImageCount(const VkSurfaceCapabilitiesKHR& capabilities, int requestedCount);
 		static VkExtent2D chooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities, const std::shared_ptr<GLFWwindow>& window);
 
 		VkSwapchainKHR swapChain = VK_NULL_HANDLE;
 		SwapChainImageDetails swapChainDetails {};
+
+		bool headless = false;
+		std::vector<MemoryAllocation> offscreenAllocations;
+
+		VkDevice logicalDevice = VK_NULL_HANDLE;
+		// Created after the swap chain, so only resolvable once every service is initialized.
+		SyncObjectsManager* syncObjectsManager = nullptr;
+
+		static constexpr VkFormat OFFSCREEN_FORMAT = VK_FORMAT_B8G8R8A8_SRGB;
+		static constexpr int DEFAULT_OFFSCREEN_WIDTH = 1920;
+		static constexpr int DEFAULT_OFFSCREEN_HEIGHT = 1080;
 	};
 	
 }
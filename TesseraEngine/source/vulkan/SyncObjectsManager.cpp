@@ -1,6 +1,7 @@
 #include "SyncObjectsManager.h"
 
 #include "CommandBufferManager.h"
+#include "TimelineSemaphore.h"
 #include "utils/interfaces/ServiceLocator.h"
 #include "vulkan/DeviceManager.h"
 
@@ -11,14 +12,13 @@ namespace tessera::vulkan
 	{
 		Initializable::init();
 
-		const auto& device = ServiceLocator::getService<DeviceManager>()->getLogicalDevice();
+		const auto& deviceManager = ServiceLocator::getService<DeviceManager>();
+		device = deviceManager->getLogicalDevice();
 		const auto& commandBufferManager = ServiceLocator::getService<CommandBufferManager>();
 
 		const auto numberOfBuffers = commandBufferManager->getNumberOfBuffers();
 
-		imageAvailableSemaphores.resize(numberOfBuffers);
-		renderFinishedSemaphores.resize(numberOfBuffers);
-		inFlightFences.resize(numberOfBuffers);
+		frameSyncSlots.resize(numberOfBuffers);
 
 		VkSemaphoreCreateInfo semaphoreInfo{};
 		semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
@@ -27,52 +27,97 @@ namespace tessera::vulkan
 		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
 		fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
 
-		for (int i = 0; i < numberOfBuffers; ++i)
+		const bool useTimeline = deviceManager->getCapabilities().timelineSemaphore;
+
+		for (auto& [imageAvailableSemaphore, renderFinishedSemaphore, inFlightFence] : frameSyncSlots)
 		{
-			if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &imageAvailableSemaphores[i]) != VK_SUCCESS ||
-				vkCreateSemaphore(device, &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]) != VK_SUCCESS ||
-				vkCreateFence(device, &fenceInfo, nullptr, &inFlightFences[i]) != VK_SUCCESS)
+			// Swap chain acquire and present only accept binary semaphores, so those stay per frame.
+			if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &imageAvailableSemaphore) != VK_SUCCESS ||
+				vkCreateSemaphore(device, &semaphoreInfo, nullptr, &renderFinishedSemaphore) != VK_SUCCESS ||
+				(!useTimeline && vkCreateFence(device, &fenceInfo, nullptr, &inFlightFence) != VK_SUCCESS))
 			{
 				throw std::runtime_error("SyncObjectsManager: failed to create semaphores.");
 			}
 		}
+
+		if (useTimeline)
+		{
+			frameTimeline = createTimelineSemaphore(device);
+		}
 	}
 
 	void SyncObjectsManager::clean()
 	{
-		const auto& device = ServiceLocator::getService<DeviceManager>()->getLogicalDevice();
+		for (const auto& [imageAvailableSemaphore, renderFinishedSemaphore, inFlightFence] : frameSyncSlots)
+		{
+			vkDestroySemaphore(device, imageAvailableSemaphore, nullptr);
+			vkDestroySemaphore(device, renderFinishedSemaphore, nullptr);
+			vkDestroyFence(device, inFlightFence, nullptr);
+		}
+		frameSyncSlots.clear();
 
-		for (size_t i = 0; i < imageAvailableSemaphores.size(); ++i)
+		vkDestroySemaphore(device, frameTimeline, nullptr);
+		frameTimeline = VK_NULL_HANDLE;
+	}
+
+	uint64_t SyncObjectsManager::waitForFrame(const int currentFrame, const uint64_t frameNumber) const
+	{
+		const VkFence inFlightFence = getFrameSyncSlot(currentFrame).inFlightFence;
+		const auto numberOfFrames = static_cast<uint64_t>(frameSyncSlots.size());
+
+		// The slot was last used numberOfFrames frames ago.
+		const uint64_t retiredFrames = frameNumber >= numberOfFrames ? frameNumber - numberOfFrames + 1 : 0;
+
+		if (usesTimelineSemaphore())
 		{
-			vkDestroySemaphore(device, imageAvailableSemaphores[i], nullptr);
-			vkDestroySemaphore(device, renderFinishedSemaphores[i], nullptr);
-			vkDestroyFence(device, inFlightFences[i], nullptr);
+			waitTimelineSemaphore(device, frameTimeline, retiredFrames);
+
+			// Later frames may have finished too, which lets uploads be recycled sooner.
+			return getTimelineSemaphoreValue(device, frameTimeline);
 		}
-		
+
+		vkWaitForFences(device, 1, &inFlightFence, VK_TRUE, UINT64_MAX);
+
+		return retiredFrames;
 	}
 
-	void SyncObjectsManager::waitForFences(const int currentFrame) const
+	void SyncObjectsManager::waitForPreviousFrame(const int currentFrame, const uint64_t frameNumber) const
 	{
-		if (static_cast<size_t>(currentFrame) >= inFlightFences.size() || currentFrame < 0)
+		if (frameNumber == 0)
 		{
-			throw std::out_of_range("SyncObjectsManager: current frame number is larger than number of fences.");
+			return;
+		}
+
+		if (usesTimelineSemaphore())
+		{
+			waitTimelineSemaphore(device, frameTimeline, frameNumber);
+			return;
 		}
 
-		const auto& device = ServiceLocator::getService<DeviceManager>()->getLogicalDevice();
+		const auto numberOfFrames = static_cast<int>(frameSyncSlots.size());
+		const VkFence previousFence = getFrameSyncSlot((currentFrame + numberOfFrames - 1) % numberOfFrames).inFlightFence;
 
-		vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
-		vkResetFences(device, 1, &inFlightFences[currentFrame]);
+		vkWaitForFences(device, 1, &previousFence, VK_TRUE, UINT64_MAX);
 	}
 
 	void SyncObjectsManager::resetFences(const int currentFrame) const
 	{
-		if (static_cast<size_t>(currentFrame) >= inFlightFences.size() || currentFrame < 0)
+		const VkFence inFlightFence = getFrameSyncSlot(currentFrame).inFlightFence;
+		if (inFlightFence == VK_NULL_HANDLE)
 		{
-			throw std::out_of_range("SyncObjectsManager: current frame number is larger than number of fences.");
+			return;
 		}
 
-		const auto& device = ServiceLocator::getService<DeviceManager>()->getLogicalDevice();
+		vkResetFences(device, 1, &inFlightFence);
+	}
+
+	const FrameSyncSlot& SyncObjectsManager::getFrameSyncSlot(const int currentFrame) const
+	{
+		if (static_cast<size_t>(currentFrame) >= frameSyncSlots.size() || currentFrame < 0)
+		{
+			throw std::out_of_range("SyncObjectsManager: current frame number is larger than number of fences.");
+		}
 
-		vkResetFences(device, 1, &inFlightFences[currentFrame]);
+		return frameSyncSlots[currentFrame];
 	}
 }
@@ -1,4 +1,6 @@
 #pragma once
+#include <cstdint>
+#include <vector>
 #include <vulkan/vulkan_core.h>
 
 #include "utils/interfaces/Initializable.h"
@@ -6,22 +8,48 @@
 namespace tessera::vulkan
 {
 
+	// Synchronization objects owned by one frame in flight.
+	struct FrameSyncSlot
+	{
+		VkSemaphore imageAvailableSemaphore = VK_NULL_HANDLE;
+		VkSemaphore renderFinishedSemaphore = VK_NULL_HANDLE;
+		// VK_NULL_HANDLE in timeline mode, where frame completion is tracked by the frame timeline instead.
+		VkFence inFlightFence = VK_NULL_HANDLE;
+	};
+
+	/**
+	 * @brief Per-frame semaphores and the CPU side of frame pacing.
+	 *
+	 * With timeline semaphores enabled every graphics submission signals the frame timeline with its
+	 * frame number + 1, so the value of the timeline is the number of frames that finished on the GPU.
+	 * Otherwise each frame slot owns a fence.
+	 */
 	class SyncObjectsManager final : public Initializable
 	{
 	public:
 		void init() override;
 		void clean() override;
 
-		void waitForFences(const int currentFrame) const;
+		/**
+		 * @brief Block until the previous frame recorded into currentFrame's slot has finished.
+		 *
+		 * @param frameNumber Number of the frame about to be recorded.
+		 * @return Number of frames known to have finished executing on the GPU.
+		 */
+		uint64_t waitForFrame(const int currentFrame, uint64_t frameNumber) const;
+
+		// Block until the most recently submitted frame has finished, leaving no frame queued on the GPU.
+		void waitForPreviousFrame(const int currentFrame, uint64_t frameNumber) const;
 		void resetFences(const int currentFrame) const;
-		[[nodiscard]] std::vector<VkSemaphore> getImageAvailableSemaphores() const { return imageAvailableSemaphores; }
-		[[nodiscard]] std::vector<VkSemaphore> getRenderFinishedSemaphores() const { return renderFinishedSemaphores; }
-		[[nodiscard]] std::vector<VkFence> getInFlightFences() const { return inFlightFences; }
+		[[nodiscard]] const FrameSyncSlot& getFrameSyncSlot(const int currentFrame) const;
+
+		[[nodiscard]] bool usesTimelineSemaphore() const { return frameTimeline != VK_NULL_HANDLE; }
+		[[nodiscard]] VkSemaphore getFrameTimeline() const { return frameTimeline; }
 	private:
-		std::vector<VkSemaphore> imageAvailableSemaphores;
-		std::vector<VkSemaphore> renderFinishedSemaphores;
-		std::vector<VkFence> inFlightFences;
+		std::vector<FrameSyncSlot> frameSyncSlots;
+		VkSemaphore frameTimeline = VK_NULL_HANDLE;
+
+		VkDevice device = VK_NULL_HANDLE;
 	};
 
 }
-
@@ -0,0 +1,365 @@
+#include "TextureManager.h"
+
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <stdexcept>
+#include <vector>
+
+#include "DeletionQueue.h"
+#include "DeviceManager.h"
+#include "UploadManager.h"
+#include "utils/EngineConfig.h"
+#include "utils/ThreadPool.h"
+#include "utils/TesseraLog.h"
+#include "utils/interfaces/ServiceLocator.h"
+
+namespace tessera::vulkan
+{
+
+	void TextureManager::init()
+	{
+		Initializable::init();
+		const auto& deviceManager = ServiceLocator::getService<DeviceManager>();
+		device = deviceManager->getLogicalDevice();
+		physicalDevice = deviceManager->getPhysicalDevice();
+		memoryAllocator = ServiceLocator::getServicePointer<MemoryAllocator>();
+		uploadManager = ServiceLocator::getServicePointer<UploadManager>();
+		descriptorManager = ServiceLocator::getServicePointer<DescriptorManager>();
+		deletionQueue = ServiceLocator::getServicePointer<DeletionQueue>();
+
+		const int budgetMegabytes = ServiceLocator::getService<EngineConfig>()->getInt("textures.budgetMB", DEFAULT_BUDGET_MB);
+		budget = static_cast<VkDeviceSize>(std::max(budgetMegabytes, 1)) * 1024 * 1024;
+
+		// Shared by every texture; levels missing from an image are simply not there to sample.
+		VkSamplerCreateInfo samplerInfo{};
+		samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+		samplerInfo.magFilter = VK_FILTER_LINEAR;
+		samplerInfo.minFilter = VK_FILTER_LINEAR;
+		samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+		samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+		samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+		samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+		samplerInfo.minLod = 0.0f;
+		samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+
+		if (vkCreateSampler(device, &samplerInfo, nullptr, &sampler) != VK_SUCCESS)
+		{
+			throw std::runtime_error("TextureManager: failed to create sampler.");
+		}
+	}
+
+	TextureHandle TextureManager::loadTexture(const std::string& filename)
+	{
+		return addTexture(readTexture(filename), filename);
+	}
+
+	void TextureManager::loadTextureAsync(const std::string& filename, std::function<void(TextureHandle)> onLoaded)
+	{
+		// Mapping and parsing happen on a worker; images and uploads are created back on the render thread.
+		ServiceLocator::getService<ThreadPool>()->submit([filename] { return readTexture(filename); },
+			[this, filename, onLoaded = std::move(onLoaded)](std::future<Texture> texture)
+			{
+				try
+				{
+					onLoaded(addTexture(texture.get(), filename));
+				}
+				catch (const std::exception& error)
+				{
+					TesseraLog::send(LogType::ERROR, "TextureManager", error.what());
+				}
+			});
+	}
+
+	TextureManager::Texture TextureManager::readTexture(const std::string& filename)
+	{
+		Texture texture;
+		texture.file = std::make_unique<MappedFile>(filename);
+		texture.data = KtxReader::read(*texture.file, filename);
+		return texture;
+	}
+
+	TextureHandle TextureManager::addTexture(Texture texture, const std::string& filename)
+	{
+		VkFormatProperties formatProperties;
+		vkGetPhysicalDeviceFormatProperties(physicalDevice, texture.data.format, &formatProperties);
+		if (!(formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT))
+		{
+			throw std::runtime_error("TextureManager: the device cannot sample the format of " + filename + ".");
+		}
+
+		const auto levelCount = static_cast<uint32_t>(texture.data.levels.size());
+		texture.tailLevel = levelCount - 1;
+		while (texture.tailLevel > 0 && std::max(texture.data.levels[texture.tailLevel - 1].width, texture.data.levels[texture.tailLevel - 1].height) <= TAIL_SIZE)
+		{
+			--texture.tailLevel;
+		}
+
+		// Uploaded with the next frame's uploads, which that frame waits on.
+		texture.resident = createImage(texture, texture.tailLevel);
+		uploadLevels(texture, texture.resident);
+		texture.lastUsedFrame = currentFrame;
+		if (descriptorManager->isBindlessEnabled())
+		{
+			texture.resident.bindlessIndex = descriptorManager->addTexture(texture.resident.view, sampler);
+		}
+
+		TESSERA_LOG(LogType::DEBUG, "TextureManager", "Loaded " + filename + " with " + std::to_string(levelCount) + " levels, "
+			+ std::to_string(levelCount - texture.tailLevel) + " of them resident.");
+
+		const TextureHandle handle = nextHandle++;
+		textures.emplace(handle, std::move(texture));
+		return handle;
+	}
+
+	void TextureManager::destroyTexture(const TextureHandle handle)
+	{
+		const auto it = textures.find(handle);
+		if (it == textures.end())
+		{
+			return;
+		}
+
+		releaseImage(it->second.resident);
+		if (it->second.streaming)
+		{
+			pendingReleaseBytes -= it->second.resident.memory.size;
+			releaseImage(*it->second.streaming);
+		}
+		textures.erase(it);
+	}
+
+	void TextureManager::requestResolution(const TextureHandle handle, const float screenPixels)
+	{
+		Texture& texture = textures.at(handle);
+		texture.lastUsedFrame = currentFrame;
+
+		if (screenPixels <= 0.0f)
+		{
+			return;
+		}
+
+		// One level per halving of the texels covering a pixel.
+		const TextureLevelView& base = texture.data.levels.front();
+		const float texelsPerPixel = static_cast<float>(std::max(base.width, base.height)) / screenPixels;
+		const float level = texelsPerPixel > 1.0f ? std::floor(std::log2(texelsPerPixel)) : 0.0f;
+
+		texture.requestedLevel = std::min(texture.requestedLevel, std::min(static_cast<uint32_t>(level), texture.tailLevel));
+	}
+
+	void TextureManager::update(const uint64_t frameNumber)
+	{
+		currentFrame = frameNumber;
+		finishStreams();
+
+		// Finest requests first, they are the most visible.
+		std::vector<std::pair<uint32_t, TextureHandle>> requests;
+		for (auto& [handle, texture] : textures)
+		{
+			if (texture.requestedLevel < texture.resident.firstLevel && !texture.streaming)
+			{
+				requests.emplace_back(texture.requestedLevel, handle);
+			}
+			texture.requestedLevel = UINT32_MAX;
+		}
+		std::ranges::sort(requests);
+
+		uint32_t started = 0;
+		for (auto [level, handle] : requests)
+		{
+			if (started == MAX_STREAMS_PER_FRAME)
+			{
+				break;
+			}
+
+			Texture& texture = textures.at(handle);
+
+			// Settle for coarser levels when the budget cannot fit the requested ones.
+			while (level < texture.resident.firstLevel && !makeRoom(getImageSize(texture, level), handle))
+			{
+				++level;
+			}
+
+			if (level < texture.resident.firstLevel)
+			{
+				stream(texture, level);
+				++started;
+			}
+		}
+	}
+
+	void TextureManager::stream(Texture& texture, const uint32_t firstLevel)
+	{
+		// Uploads recorded by others so far are submitted first, since frames must keep waiting on those.
+		uploadManager->flush();
+
+		texture.streaming = createImage(texture, firstLevel);
+		pendingReleaseBytes += texture.resident.memory.size;
+		uploadLevels(texture, *texture.streaming);
+
+		// Frames do not wait on the stream; the image replaces the resident one once the batch completed.
+		texture.streamingBatch = uploadManager->flush(false);
+	}
+
+	bool TextureManager::makeRoom(const VkDeviceSize bytes, const TextureHandle requester)
+	{
+		if (residentBytes + bytes <= budget)
+		{
+			return true;
+		}
+
+		// Least recently used first; textures used this frame are never evicted.
+		std::vector<std::pair<uint64_t, TextureHandle>> candidates;
+		for (const auto& [handle, texture] : textures)
+		{
+			if (handle != requester && texture.lastUsedFrame < currentFrame && texture.resident.firstLevel < texture.tailLevel && !texture.streaming)
+			{
+				candidates.emplace_back(texture.lastUsedFrame, handle);
+			}
+		}
+		std::ranges::sort(candidates);
+
+		for (const auto& [lastUsedFrame, handle] : candidates)
+		{
+			// Images replaced by streams in flight are freed soon, so evicting more would not be needed.
+			if (residentBytes - pendingReleaseBytes + bytes <= budget)
+			{
+				break;
+			}
+
+			// The tail is reuploaded from the mapped file; the previous image is freed once the new one replaced it.
+			Texture& texture = textures.at(handle);
+			stream(texture, texture.tailLevel);
+		}
+
+		// Evicted images are only freed once their replacements landed, so the room appears over the next frames.
+		return residentBytes + bytes <= budget;
+	}
+
+	void TextureManager::finishStreams()
+	{
+		for (auto& [handle, texture] : textures)
+		{
+			if (!texture.streaming || !uploadManager->isBatchComplete(texture.streamingBatch))
+			{
+				continue;
+			}
+
+			pendingReleaseBytes -= texture.resident.memory.size;
+			releaseImage(texture.resident);
+			texture.resident = *texture.streaming;
+			texture.streaming.reset();
+
+			if (descriptorManager->isBindlessEnabled())
+			{
+				texture.resident.bindlessIndex = descriptorManager->addTexture(texture.resident.view, sampler);
+			}
+		}
+	}
+
+	TextureManager::TextureImage TextureManager::createImage(const Texture& texture, const uint32_t firstLevel)
+	{
+		const TextureLevelView& top = texture.data.levels[firstLevel];
+		const auto levelCount = static_cast<uint32_t>(texture.data.levels.size()) - firstLevel;
+
+		// Written on the transfer queue and sampled on the graphics queue.
+		const std::vector<uint32_t> queueFamilies = uploadManager->getSharedQueueFamilies();
+
+		VkImageCreateInfo imageInfo{};
+		imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		imageInfo.imageType = VK_IMAGE_TYPE_2D;
+		imageInfo.format = texture.data.format;
+		imageInfo.extent = { top.width, top.height, 1 };
+		imageInfo.mipLevels = levelCount;
+		imageInfo.arrayLayers = 1;
+		imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+		imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+		imageInfo.sharingMode = queueFamilies.size() > 1 ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE;
+		imageInfo.queueFamilyIndexCount = queueFamilies.size() > 1 ? static_cast<uint32_t>(queueFamilies.size()) : 0;
+		imageInfo.pQueueFamilyIndices = queueFamilies.size() > 1 ? queueFamilies.data() : nullptr;
+		imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+		TextureImage image;
+		image.firstLevel = firstLevel;
+		memoryAllocator->createImage(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image.image, image.memory);
+
+		VkImageViewCreateInfo viewInfo{};
+		viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		viewInfo.image = image.image;
+		viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		viewInfo.format = texture.data.format;
+		viewInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, levelCount, 0, 1 };
+
+		if (vkCreateImageView(device, &viewInfo, nullptr, &image.view) != VK_SUCCESS)
+		{
+			throw std::runtime_error("TextureManager: failed to create image view.");
+		}
+
+		// Counted from creation, so images still streaming weigh on the budget as well.
+		residentBytes += image.memory.size;
+		return image;
+	}
+
+	void TextureManager::uploadLevels(const Texture& texture, const TextureImage& image) const
+	{
+		std::vector<ImageLevelUpload> levels;
+		for (uint32_t level = image.firstLevel; level < texture.data.levels.size(); ++level)
+		{
+			const TextureLevelView& levelView = texture.data.levels[level];
+			levels.push_back({ levelView.data, levelView.size, level - image.firstLevel, { levelView.width, levelView.height, 1 } });
+		}
+
+		uploadManager->uploadToImage(image.image, VK_IMAGE_ASPECT_COLOR_BIT, levels);
+	}
+
+	void TextureManager::releaseImage(const TextureImage& image)
+	{
+		residentBytes -= image.memory.size;
+
+		if (image.bindlessIndex != INVALID_BINDLESS_INDEX)
+		{
+			descriptorManager->removeTexture(image.bindlessIndex);
+		}
+
+		uploadManager->enqueueRelease([allocator = memoryAllocator, deleter = deletionQueue, device = device, image]
+			{
+				deleter->push([allocator, device, image]
+					{
+						vkDestroyImageView(device, image.view, nullptr);
+						allocator->destroyImage(image.image, image.memory);
+					});
+			});
+	}
+
+	VkDeviceSize TextureManager::getImageSize(const Texture& texture, const uint32_t firstLevel) const
+	{
+		VkDeviceSize size = 0;
+		for (uint32_t level = firstLevel; level < texture.data.levels.size(); ++level)
+		{
+			size += texture.data.levels[level].size;
+		}
+		return size;
+	}
+
+	void TextureManager::clean()
+	{
+		// Every frame has retired by now, so the images can go right away.
+		for (auto& [handle, texture] : textures)
+		{
+			vkDestroyImageView(device, texture.resident.view, nullptr);
+			memoryAllocator->destroyImage(texture.resident.image, texture.resident.memory);
+			if (texture.streaming)
+			{
+				vkDestroyImageView(device, texture.streaming->view, nullptr);
+				memoryAllocator->destroyImage(texture.streaming->image, texture.streaming->memory);
+			}
+		}
+		textures.clear();
+		residentBytes = 0;
+		pendingReleaseBytes = 0;
+
+		vkDestroySampler(device, sampler, nullptr);
+	}
+
+}
@@ -0,0 +1,125 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vulkan/vulkan_core.h>
+
+#include "DescriptorManager.h"
+#include "MemoryAllocator.h"
+#include "utils/KtxReader.h"
+#include "utils/MappedFile.h"
+#include "utils/interfaces/Initializable.h"
+
+namespace tessera::vulkan
+{
+
+	class DeletionQueue;
+	class UploadManager;
+
+	using TextureHandle = uint32_t;
+
+	/**
+	 * @brief Block-compressed KTX2 textures whose mip levels are streamed by screen-space need.
+	 *
+	 * Loading a texture only uploads its tail of small levels. Every frame, requestResolution() reports how
+	 * large a texture appears on screen, and update() streams in the finer levels this calls for. The new
+	 * image goes through its own transfer batch and replaces the resident one once the batch has completed,
+	 * so frames never wait on streaming. Residency is held under textures.budgetMB by dropping the least
+	 * recently used textures back to their tail.
+	 *
+	 * Residency changes recreate the image, so views and bindless indices are looked up every frame.
+	 * Textures are meant to be used from the thread recording frames.
+	 */
+	class TextureManager final : public Initializable
+	{
+	public:
+		void init() override;
+		void clean() override;
+
+		TextureHandle loadTexture(const std::string& filename);
+		// Read and parse the file on the ThreadPool; onLoaded runs on the render thread at the start of a later frame.
+		void loadTextureAsync(const std::string& filename, std::function<void(TextureHandle)> onLoaded);
+		void destroyTexture(TextureHandle handle);
+
+		// The texture covers about screenPixels pixels along its larger axis; the largest report of a frame wins.
+		void requestResolution(TextureHandle handle, float screenPixels);
+		// Swap in finished streams and start new ones. Called once per frame before recording.
+		void update(uint64_t frameNumber);
+
+		[[nodiscard]] VkImageView getImageView(TextureHandle handle) const { return textures.at(handle).resident.view; }
+		// INVALID_BINDLESS_INDEX without bindless tables.
+		[[nodiscard]] BindlessIndex getBindlessIndex(TextureHandle handle) const { return textures.at(handle).resident.bindlessIndex; }
+		// Most detailed mip level resident, 0 being the full resolution.
+		[[nodiscard]] uint32_t getResidentLevel(TextureHandle handle) const { return textures.at(handle).resident.firstLevel; }
+		[[nodiscard]] VkSampler getSampler() const { return sampler; }
+		// Memory of every resident and streaming image.
+		[[nodiscard]] VkDeviceSize getResidentBytes() const { return residentBytes; }
+		[[nodiscard]] VkDeviceSize getBudget() const { return budget; }
+
+		static constexpr BindlessIndex INVALID_BINDLESS_INDEX = UINT32_MAX;
+	private:
+		// Image holding the levels from firstLevel down to the smallest one.
+		struct TextureImage
+		{
+			VkImage image = VK_NULL_HANDLE;
+			MemoryAllocation memory;
+			VkImageView view = VK_NULL_HANDLE;
+			uint32_t firstLevel = 0;
+			BindlessIndex bindlessIndex = INVALID_BINDLESS_INDEX;
+		};
+
+		struct Texture
+		{
+			std::unique_ptr<MappedFile> file;
+			TextureView data;
+			// Coarsest level that is always resident.
+			uint32_t tailLevel = 0;
+
+			TextureImage resident;
+			std::optional<TextureImage> streaming;
+			uint64_t streamingBatch = 0;
+
+			// Finest level asked for by the reports of the current frame.
+			uint32_t requestedLevel = UINT32_MAX;
+			uint64_t lastUsedFrame = 0;
+		};
+
+		[[nodiscard]] static Texture readTexture(const std::string& filename);
+		TextureHandle addTexture(Texture texture, const std::string& filename);
+		[[nodiscard]] TextureImage createImage(const Texture& texture, uint32_t firstLevel);
+		void uploadLevels(const Texture& texture, const TextureImage& image) const;
+		// Releases once the current upload batch completed and the frames in flight retired.
+		void releaseImage(const TextureImage& image);
+		void stream(Texture& texture, uint32_t firstLevel);
+		// Drop least recently used textures to their tail until bytes more fit into the budget.
+		bool makeRoom(VkDeviceSize bytes, TextureHandle requester);
+		void finishStreams();
+		[[nodiscard]] VkDeviceSize getImageSize(const Texture& texture, uint32_t firstLevel) const;
+
+		VkDevice device = VK_NULL_HANDLE;
+		VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+		VkSampler sampler = VK_NULL_HANDLE;
+		MemoryAllocator* memoryAllocator = nullptr;
+		UploadManager* uploadManager = nullptr;
+		DescriptorManager* descriptorManager = nullptr;
+		DeletionQueue* deletionQueue = nullptr;
+
+		std::map<TextureHandle, Texture> textures;
+		TextureHandle nextHandle = 1;
+		VkDeviceSize residentBytes = 0;
+		// Part of residentBytes held by images that streams in flight replace.
+		VkDeviceSize pendingReleaseBytes = 0;
+		VkDeviceSize budget = 0;
+		uint64_t currentFrame = 0;
+
+		static constexpr int DEFAULT_BUDGET_MB = 256;
+		// Levels at most this large are loaded with the texture and never evicted.
+		static constexpr uint32_t TAIL_SIZE = 128;
+		// Bounds the transfer work started by one frame.
+		static constexpr uint32_t MAX_STREAMS_PER_FRAME = 4;
+	};
+
+}
@@ -0,0 +1,53 @@
+#include "TimelineSemaphore.h"
+
+#include <stdexcept>
+
+namespace tessera::vulkan
+{
+
+	VkSemaphore createTimelineSemaphore(const VkDevice& device, const uint64_t initialValue)
+	{
+		VkSemaphoreTypeCreateInfo typeInfo{};
+		typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+		typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+		typeInfo.initialValue = initialValue;
+
+		VkSemaphoreCreateInfo semaphoreInfo{};
+		semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+		semaphoreInfo.pNext = &typeInfo;
+
+		VkSemaphore semaphore;
+		if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &semaphore) != VK_SUCCESS)
+		{
+			throw std::runtime_error("TimelineSemaphore: failed to create timeline semaphore.");
+		}
+
+		return semaphore;
+	}
+
+	void waitTimelineSemaphore(const VkDevice& device, const VkSemaphore& semaphore, const uint64_t value)
+	{
+		VkSemaphoreWaitInfo waitInfo{};
+		waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+		waitInfo.semaphoreCount = 1;
+		waitInfo.pSemaphores = &semaphore;
+		waitInfo.pValues = &value;
+
+		if (vkWaitSemaphores(device, &waitInfo, UINT64_MAX) != VK_SUCCESS)
+		{
+			throw std::runtime_error("TimelineSemaphore: failed to wait for timeline semaphore.");
+		}
+	}
+
+	uint64_t getTimelineSemaphoreValue(const VkDevice& device, const VkSemaphore& semaphore)
+	{
+		uint64_t value = 0;
+		if (vkGetSemaphoreCounterValue(device, semaphore, &value) != VK_SUCCESS)
+		{
+			throw std::runtime_error("TimelineSemaphore: failed to query timeline semaphore value.");
+		}
+
+		return value;
+	}
+
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include <cstdint>
+#include <vulkan/vulkan_core.h>
+
+namespace tessera::vulkan
+{
+
+	// Helpers for Vulkan 1.2 timeline semaphores. Only valid when DeviceManager::getCapabilities().timelineSemaphore is set.
+
+	VkSemaphore createTimelineSemaphore(const VkDevice& device, uint64_t initialValue = 0);
+
+	// Block until semaphore has reached value.
+	void waitTimelineSemaphore(const VkDevice& device, const VkSemaphore& semaphore, uint64_t value);
+
+	[[nodiscard]] uint64_t getTimelineSemaphoreValue(const VkDevice& device, const VkSemaphore& semaphore);
+
+}
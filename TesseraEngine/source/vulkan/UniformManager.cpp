@@ -0,0 +1,115 @@
+#include "UniformManager.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#include "CommandBufferManager.h"
+#include "DeviceManager.h"
+#include "MemoryAllocator.h"
+#include "utils/interfaces/ServiceLocator.h"
+
+namespace tessera::vulkan
+{
+
+	void UniformManager::init()
+	{
+		Initializable::init();
+		const auto& deviceManager = ServiceLocator::getService<DeviceManager>();
+		device = deviceManager->getLogicalDevice();
+		memoryAllocator = ServiceLocator::getServicePointer<MemoryAllocator>();
+
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(deviceManager->getPhysicalDevice(), &properties);
+
+		uniformRing.create(*memoryAllocator, REGION_SIZE, static_cast<uint32_t>(CommandBufferManager::queryFramesInFlight()),
+			properties.limits.minUniformBufferOffsetAlignment);
+		createFrameSet();
+
+		startTime = std::chrono::steady_clock::now();
+		previousFrameTime = startTime;
+	}
+
+	void UniformManager::createFrameSet()
+	{
+		VkDescriptorSetLayoutBinding binding{};
+		binding.binding = 0;
+		binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+		binding.descriptorCount = 1;
+		binding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+
+		VkDescriptorSetLayoutCreateInfo layoutInfo{};
+		layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		layoutInfo.bindingCount = 1;
+		layoutInfo.pBindings = &binding;
+
+		if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &frameLayout) != VK_SUCCESS)
+		{
+			throw std::runtime_error("UniformManager: failed to create frame descriptor set layout.");
+		}
+
+		descriptorAllocator.create(device, 1, { { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1.0f } });
+		frameSet = descriptorAllocator.allocate(frameLayout);
+
+		// Points at the start of the ring; the dynamic offset selects the constants of a frame.
+		VkDescriptorBufferInfo bufferInfo{};
+		bufferInfo.buffer = uniformRing.getBuffer();
+		bufferInfo.offset = 0;
+		bufferInfo.range = sizeof(FrameConstants);
+
+		VkWriteDescriptorSet write{};
+		write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		write.dstSet = frameSet;
+		write.dstBinding = 0;
+		write.descriptorCount = 1;
+		write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+		write.pBufferInfo = &bufferInfo;
+
+		vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+	}
+
+	void UniformManager::setCamera(const glm::mat4& view, const glm::mat4& projection)
+	{
+		frameConstants.view = view;
+		frameConstants.projection = projection;
+		frameConstants.viewProjection = projection * view;
+		frameConstants.cameraPosition = glm::inverse(view)[3];
+	}
+
+	void UniformManager::beginFrame(const int frame, const uint64_t frameNumber)
+	{
+		const auto now = std::chrono::steady_clock::now();
+		frameConstants.time = std::chrono::duration<float>(now - startTime).count();
+		frameConstants.deltaTime = std::chrono::duration<float>(now - previousFrameTime).count();
+		frameConstants.frameNumber = static_cast<uint32_t>(frameNumber);
+		previousFrameTime = now;
+
+		std::lock_guard lock(ringMutex);
+		uniformRing.beginFrame(frame);
+
+		// The region always fits the constants, since it starts empty.
+		const std::optional<UniformAllocation> allocation = uniformRing.allocate(sizeof(FrameConstants));
+		std::memcpy(allocation->data, &frameConstants, sizeof(FrameConstants));
+		frameOffset = allocation->offset;
+	}
+
+	UniformAllocation UniformManager::allocate(const VkDeviceSize size)
+	{
+		std::lock_guard lock(ringMutex);
+
+		const std::optional<UniformAllocation> allocation = uniformRing.allocate(size);
+		if (!allocation)
+		{
+			throw std::runtime_error("UniformManager: uniform data of the frame exceeds its ring region.");
+		}
+
+		return *allocation;
+	}
+
+	void UniformManager::clean()
+	{
+		descriptorAllocator.destroy();
+		vkDestroyDescriptorSetLayout(device, frameLayout, nullptr);
+		uniformRing.destroy(*memoryAllocator);
+	}
+
+}
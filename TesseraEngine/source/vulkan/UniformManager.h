@@ -0,0 +1,84 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <glm/glm.hpp>
+#include <vulkan/vulkan_core.h>
+
+#include "DescriptorAllocator.h"
+#include "UniformRing.h"
+#include "utils/interfaces/Initializable.h"
+
+namespace tessera::vulkan
+{
+
+	class MemoryAllocator;
+
+	// Constants of one frame. Laid out as Frame in shaders/shader.vert and shaders/instanced.vert (std140).
+	struct FrameConstants
+	{
+		glm::mat4 viewProjection{ 1.0f };
+		glm::mat4 view{ 1.0f };
+		glm::mat4 projection{ 1.0f };
+		glm::vec4 cameraPosition{ 0.0f, 0.0f, 0.0f, 1.0f };
+		// Seconds since the engine started and since the previous frame.
+		float time = 0.0f;
+		float deltaTime = 0.0f;
+		uint32_t frameNumber = 0;
+		uint32_t padding = 0;
+	};
+
+	static_assert(sizeof(FrameConstants) == 224);
+
+	/**
+	 * @brief Per-frame uniform data written into a persistently mapped UniformRing.
+	 *
+	 * beginFrame() writes the FrameConstants of the frame into its region, which draws read through one
+	 * dynamic uniform buffer descriptor at set FRAME_SET; only the dynamic offset changes between frames.
+	 * Other per-frame data is allocated from the same region and addressed by dynamic offset as well.
+	 * The camera defaults to identity matrices, drawing positions as clip space coordinates.
+	 */
+	class UniformManager final : public Initializable
+	{
+	public:
+		void init() override;
+		void clean() override;
+
+		// Used from the next frame on; until then frames keep their own copy.
+		void setCamera(const glm::mat4& view, const glm::mat4& projection);
+
+		// Recycle the region of frame and write its constants. Only valid once the frame's in-flight fence has signaled.
+		void beginFrame(int frame, uint64_t frameNumber);
+		// Valid until the frame slot is reset again. Safe to call from recording threads.
+		[[nodiscard]] UniformAllocation allocate(VkDeviceSize size);
+
+		[[nodiscard]] const FrameConstants& getFrameConstants() const { return frameConstants; }
+		[[nodiscard]] VkDescriptorSetLayout getFrameLayout() const { return frameLayout; }
+		[[nodiscard]] VkDescriptorSet getFrameSet() const { return frameSet; }
+		// Dynamic offset of the constants of the frame being recorded.
+		[[nodiscard]] uint32_t getFrameOffset() const { return frameOffset; }
+		[[nodiscard]] VkBuffer getBuffer() const { return uniformRing.getBuffer(); }
+
+		static constexpr uint32_t FRAME_SET = 0;
+	private:
+		void createFrameSet();
+
+		VkDevice device = VK_NULL_HANDLE;
+		MemoryAllocator* memoryAllocator = nullptr;
+		UniformRing uniformRing;
+		std::mutex ringMutex;
+
+		// Holds the single frame set for the lifetime of the engine.
+		DescriptorAllocator descriptorAllocator;
+		VkDescriptorSetLayout frameLayout = VK_NULL_HANDLE;
+		VkDescriptorSet frameSet = VK_NULL_HANDLE;
+		uint32_t frameOffset = 0;
+
+		FrameConstants frameConstants;
+		std::chrono::steady_clock::time_point startTime;
+		std::chrono::steady_clock::time_point previousFrameTime;
+
+		static constexpr VkDeviceSize REGION_SIZE = 256ull * 1024;
+	};
+
+}
@@ -0,0 +1,48 @@
+#include "UniformRing.h"
+
+namespace tessera::vulkan
+{
+
+	void UniformRing::create(MemoryAllocator& memoryAllocator, const VkDeviceSize requestedRegionSize, const uint32_t regionCount, const VkDeviceSize minOffsetAlignment)
+	{
+		alignment = minOffsetAlignment > 0 ? minOffsetAlignment : 1;
+		// Every region starts on an aligned offset as well.
+		regionSize = (requestedRegionSize + alignment - 1) / alignment * alignment;
+		heads.assign(regionCount, 0);
+		currentRegion = 0;
+
+		memoryAllocator.createBuffer(regionSize * regionCount, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, buffer, allocation);
+	}
+
+	void UniformRing::destroy(MemoryAllocator& memoryAllocator)
+	{
+		memoryAllocator.destroyBuffer(buffer, allocation);
+		buffer = VK_NULL_HANDLE;
+		allocation = {};
+		heads.clear();
+	}
+
+	std::optional<UniformAllocation> UniformRing::allocate(const VkDeviceSize size)
+	{
+		VkDeviceSize& head = heads[currentRegion];
+		const VkDeviceSize offset = (head + alignment - 1) / alignment * alignment;
+
+		if (offset + size > regionSize)
+		{
+			return std::nullopt;
+		}
+
+		head = offset + size;
+
+		const VkDeviceSize bufferOffset = static_cast<VkDeviceSize>(currentRegion) * regionSize + offset;
+		return UniformAllocation{ buffer, static_cast<uint32_t>(bufferOffset), static_cast<char*>(allocation.mappedData) + bufferOffset };
+	}
+
+	void UniformRing::beginFrame(const int frame)
+	{
+		currentRegion = static_cast<uint32_t>(frame) % static_cast<uint32_t>(heads.size());
+		heads[currentRegion] = 0;
+	}
+
+}
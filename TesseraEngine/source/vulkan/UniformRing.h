@@ -0,0 +1,48 @@
+#pragma once
+#include <optional>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+#include "MemoryAllocator.h"
+
+namespace tessera::vulkan
+{
+
+	struct UniformAllocation
+	{
+		VkBuffer buffer = VK_NULL_HANDLE;
+		// Offset into buffer, usable as the dynamic offset of a uniform buffer descriptor pointing at the start of buffer.
+		uint32_t offset = 0;
+		void* data = nullptr;
+	};
+
+	/**
+	 * @brief Persistently mapped uniform buffer split into one region per frame in flight.
+	 *
+	 * Like the StagingRing, sub-ranges are handed out linearly from the region of the frame being recorded
+	 * and the region is recycled as a whole once that frame slot comes around again. Writes go straight
+	 * to host-coherent memory read by the GPU, so per-frame data never maps memory or recreates buffers.
+	 */
+	class UniformRing final
+	{
+	public:
+		void create(MemoryAllocator& memoryAllocator, VkDeviceSize requestedRegionSize, uint32_t regionCount, VkDeviceSize minOffsetAlignment);
+		void destroy(MemoryAllocator& memoryAllocator);
+
+		// Returns nothing when the current region cannot fit the request.
+		[[nodiscard]] std::optional<UniformAllocation> allocate(VkDeviceSize size);
+		// Only valid once the frame's in-flight fence has signaled.
+		void beginFrame(int frame);
+
+		[[nodiscard]] VkBuffer getBuffer() const { return buffer; }
+		[[nodiscard]] VkDeviceSize getRegionSize() const { return regionSize; }
+	private:
+		VkBuffer buffer = VK_NULL_HANDLE;
+		MemoryAllocation allocation;
+		VkDeviceSize regionSize = 0;
+		VkDeviceSize alignment = 1;
+		std::vector<VkDeviceSize> heads;
+		uint32_t currentRegion = 0;
+	};
+
+}
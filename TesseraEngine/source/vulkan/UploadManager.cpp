@@ -0,0 +1,537 @@
+#include "UploadManager.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "CommandBufferManager.h"
+#include "DeviceManager.h"
+#include "GpuProfiler.h"
+#include "QueueManager.h"
+#include "TimelineSemaphore.h"
+#include "utils/interfaces/ServiceLocator.h"
+
+namespace tessera::vulkan
+{
+
+	void UploadManager::init()
+	{
+		Initializable::init();
+		const auto& deviceManager = ServiceLocator::getService<DeviceManager>();
+		device = deviceManager->getLogicalDevice();
+		const auto& queueManager = ServiceLocator::getService<QueueManager>();
+		const auto [graphicsFamily, presentFamily, transferFamily, computeFamily, computeQueueIndex] = queueManager->getQueueFamilyIndices();
+		transferQueue = queueManager->getTransferQueue();
+
+		// Compute work on its own queue reads uploaded buffers as well.
+		sharedQueueFamilies = { graphicsFamily.value() };
+		for (const uint32_t family : { transferFamily.value(), computeFamily.value() })
+		{
+			if (std::ranges::find(sharedQueueFamilies, family) == sharedQueueFamilies.end())
+			{
+				sharedQueueFamilies.push_back(family);
+			}
+		}
+
+		VkCommandPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+		poolInfo.queueFamilyIndex = transferFamily.value();
+
+		if (vkCreateCommandPool(device, &poolInfo, nullptr, &commandPool) != VK_SUCCESS)
+		{
+			throw std::runtime_error("UploadManager: failed to create command pool.");
+		}
+
+		if (deviceManager->getCapabilities().timelineSemaphore)
+		{
+			uploadTimeline = createTimelineSemaphore(device);
+		}
+
+		memoryAllocator = ServiceLocator::getService<MemoryAllocator>();
+		gpuProfiler = ServiceLocator::getServicePointer<GpuProfiler>();
+		stagingRing.create(*memoryAllocator, STAGING_REGION_SIZE, static_cast<uint32_t>(CommandBufferManager::queryFramesInFlight()));
+	}
+
+	void UploadManager::enqueueBufferCopy(const VkBuffer srcBuffer, const VkBuffer dstBuffer, const VkBufferCopy& region)
+	{
+		std::lock_guard lock(uploadMutex);
+
+		if (!recording)
+		{
+			beginBatch();
+		}
+
+		vkCmdCopyBuffer(currentBatch.commandBuffer, srcBuffer, dstBuffer, 1, &region);
+	}
+
+	void UploadManager::enqueueTransferBarrier()
+	{
+		std::lock_guard lock(uploadMutex);
+
+		// Barriers also order against the copies of batches submitted earlier to the same queue.
+		if (!recording)
+		{
+			beginBatch();
+		}
+
+		VkMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+
+		vkCmdPipelineBarrier(currentBatch.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+	}
+
+	void UploadManager::uploadToBuffer(const void* data, const VkDeviceSize size, const VkBuffer dstBuffer, const VkDeviceSize dstOffset)
+	{
+		std::lock_guard lock(uploadMutex);
+
+		if (!recording)
+		{
+			beginBatch();
+		}
+
+		VkBufferCopy region{};
+		region.dstOffset = dstOffset;
+		region.size = size;
+
+		const StagingRange range = stage(data, size);
+		region.srcOffset = range.offset;
+		vkCmdCopyBuffer(currentBatch.commandBuffer, range.buffer, dstBuffer, 1, &region);
+	}
+
+	void UploadManager::uploadToImage(const VkImage dstImage, const VkImageAspectFlags aspect, const std::vector<ImageLevelUpload>& levels)
+	{
+		if (levels.empty())
+		{
+			return;
+		}
+
+		std::lock_guard lock(uploadMutex);
+
+		if (!recording)
+		{
+			beginBatch();
+		}
+
+		uint32_t firstLevel = levels.front().mipLevel;
+		uint32_t lastLevel = firstLevel;
+		for (const ImageLevelUpload& level : levels)
+		{
+			firstLevel = std::min(firstLevel, level.mipLevel);
+			lastLevel = std::max(lastLevel, level.mipLevel);
+		}
+
+		VkImageMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.srcAccessMask = 0;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		// The image is shared concurrently, so no queue family ownership transfer is needed.
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = dstImage;
+		barrier.subresourceRange = { aspect, firstLevel, lastLevel - firstLevel + 1, 0, 1 };
+
+		vkCmdPipelineBarrier(currentBatch.commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+		for (const ImageLevelUpload& level : levels)
+		{
+			const StagingRange range = stage(level.data, level.size);
+
+			// Zero row length and height mean tightly packed, in texel blocks for compressed formats.
+			VkBufferImageCopy region{};
+			region.bufferOffset = range.offset;
+			region.bufferRowLength = 0;
+			region.bufferImageHeight = 0;
+			region.imageSubresource = { aspect, level.mipLevel, 0, 1 };
+			region.imageOffset = { 0, 0, 0 };
+			region.imageExtent = level.extent;
+
+			vkCmdCopyBufferToImage(currentBatch.commandBuffer, range.buffer, dstImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+		}
+
+		// Graphics submissions wait on the batch at all stages, which makes the copies visible to them.
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = 0;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+		vkCmdPipelineBarrier(currentBatch.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+	}
+
+	StagingRange UploadManager::stage(const void* data, const VkDeviceSize size)
+	{
+		// The recording batch receives its id on flush.
+		const uint64_t batchId = lastSubmittedBatchId + 1;
+
+		if (const std::optional<StagingRange> range = stagingRing.allocate(size, STAGING_ALIGNMENT, batchId))
+		{
+			memcpy(range->data, data, size);
+			return *range;
+		}
+
+		VkBuffer stagingBuffer;
+		MemoryAllocation stagingBufferMemory;
+		memoryAllocator->createBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+		memcpy(stagingBufferMemory.mappedData, data, size);
+
+		currentBatch.releases.emplace_back([allocator = memoryAllocator, stagingBuffer, stagingBufferMemory]
+			{
+				allocator->destroyBuffer(stagingBuffer, stagingBufferMemory);
+			});
+		return { stagingBuffer, 0, stagingBufferMemory.mappedData };
+	}
+
+	void UploadManager::beginFrame(const uint64_t frameNumber)
+	{
+		std::lock_guard lock(uploadMutex);
+
+		const uint64_t lastBatchId = stagingRing.beginFrame(frameNumber);
+		if (lastBatchId != 0)
+		{
+			waitForBatch(lastBatchId);
+		}
+	}
+
+	void UploadManager::enqueueRelease(std::function<void()> release)
+	{
+		std::lock_guard lock(uploadMutex);
+
+		if (!recording)
+		{
+			beginBatch();
+		}
+
+		currentBatch.releases.emplace_back(std::move(release));
+	}
+
+	uint64_t UploadManager::flush(const bool graphicsWait)
+	{
+		std::lock_guard lock(uploadMutex);
+
+		if (!recording)
+		{
+			return lastSubmittedBatchId;
+		}
+
+		if (currentBatch.timestampPool != VK_NULL_HANDLE)
+		{
+			vkCmdWriteTimestamp(currentBatch.commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, currentBatch.timestampPool, 1);
+		}
+
+		if (vkEndCommandBuffer(currentBatch.commandBuffer) != VK_SUCCESS)
+		{
+			throw std::runtime_error("UploadManager: failed to record upload command buffer.");
+		}
+
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &currentBatch.commandBuffer;
+
+		const uint64_t batchId = lastSubmittedBatchId + 1;
+
+		VkTimelineSemaphoreSubmitInfo timelineInfo{};
+		timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+		timelineInfo.signalSemaphoreValueCount = 1;
+		timelineInfo.pSignalSemaphoreValues = &batchId;
+
+		if (uploadTimeline != VK_NULL_HANDLE)
+		{
+			// The timeline is signaled regardless of graphicsWait; it also replaces the fence.
+			submitInfo.pNext = &timelineInfo;
+			submitInfo.signalSemaphoreCount = 1;
+			submitInfo.pSignalSemaphores = &uploadTimeline;
+		}
+		else if (graphicsWait)
+		{
+			submitInfo.signalSemaphoreCount = 1;
+			submitInfo.pSignalSemaphores = &currentBatch.semaphore;
+		}
+
+		if (vkQueueSubmit(transferQueue, 1, &submitInfo, currentBatch.fence) != VK_SUCCESS)
+		{
+			throw std::runtime_error("UploadManager: failed to submit upload command buffer.");
+		}
+
+		currentBatch.id = batchId;
+		lastSubmittedBatchId = batchId;
+		currentBatch.graphicsWait = graphicsWait;
+		currentBatch.waitConsumed = false;
+		submittedBatches.emplace_back(std::move(currentBatch));
+		currentBatch = {};
+		recording = false;
+
+		return lastSubmittedBatchId;
+	}
+
+	bool UploadManager::isBatchComplete(const uint64_t batchId)
+	{
+		std::lock_guard lock(uploadMutex);
+
+		for (const auto& batch : submittedBatches)
+		{
+			if (batch.id == batchId)
+			{
+				return hasCompleted(batch);
+			}
+		}
+
+		// Batches leave the submitted list only after completion.
+		return batchId <= lastSubmittedBatchId;
+	}
+
+	void UploadManager::collectCompletedBatches(const uint64_t completedFrames)
+	{
+		std::vector<std::function<void()>> releases;
+
+		{
+			std::lock_guard lock(uploadMutex);
+
+			// Batches complete in submission order on the transfer queue, so stop at the first one still pending.
+			while (!submittedBatches.empty() && isRecyclable(submittedBatches.front(), completedFrames))
+			{
+				UploadBatch batch = std::move(submittedBatches.front());
+				submittedBatches.pop_front();
+				reportBatchTime(batch);
+
+				for (auto& release : batch.releases)
+				{
+					releases.emplace_back(std::move(release));
+				}
+				batch.releases.clear();
+
+				if (batch.fence != VK_NULL_HANDLE)
+				{
+					vkResetFences(device, 1, &batch.fence);
+				}
+				freeBatches.emplace_back(std::move(batch));
+			}
+		}
+
+		// Release callbacks may free memory through other services, so they run outside the lock.
+		for (const auto& release : releases)
+		{
+			release();
+		}
+	}
+
+	void UploadManager::consumeGraphicsWaits(const uint64_t frameNumber, std::vector<VkSemaphore>& waitSemaphores, std::vector<VkPipelineStageFlags>& waitStages, std::vector<uint64_t>& waitValues)
+	{
+		std::lock_guard lock(uploadMutex);
+
+		uint64_t timelineWaitValue = 0;
+
+		for (auto& batch : submittedBatches)
+		{
+			if (batch.graphicsWait && !batch.waitConsumed)
+			{
+				if (uploadTimeline != VK_NULL_HANDLE)
+				{
+					// Batches complete in order, so a single wait on the newest one covers all of them.
+					timelineWaitValue = batch.id;
+				}
+				else
+				{
+					waitSemaphores.push_back(batch.semaphore);
+					waitStages.push_back(VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+					waitValues.push_back(0);
+				}
+				batch.waitConsumed = true;
+				batch.consumingFrame = frameNumber;
+			}
+		}
+
+		if (timelineWaitValue != 0)
+		{
+			waitSemaphores.push_back(uploadTimeline);
+			waitStages.push_back(VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+			waitValues.push_back(timelineWaitValue);
+		}
+	}
+
+	void UploadManager::beginBatch()
+	{
+		if (!freeBatches.empty())
+		{
+			currentBatch = std::move(freeBatches.back());
+			freeBatches.pop_back();
+		}
+		else
+		{
+			VkCommandBufferAllocateInfo allocInfo{};
+			allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			allocInfo.commandPool = commandPool;
+			allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			allocInfo.commandBufferCount = 1;
+
+			if (vkAllocateCommandBuffers(device, &allocInfo, &currentBatch.commandBuffer) != VK_SUCCESS)
+			{
+				throw std::runtime_error("UploadManager: failed to allocate upload command buffer.");
+			}
+
+			// Timeline batches are tracked by their id alone.
+			if (uploadTimeline == VK_NULL_HANDLE)
+			{
+				VkFenceCreateInfo fenceInfo{};
+				fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+				VkSemaphoreCreateInfo semaphoreInfo{};
+				semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+				if (vkCreateFence(device, &fenceInfo, nullptr, &currentBatch.fence) != VK_SUCCESS ||
+					vkCreateSemaphore(device, &semaphoreInfo, nullptr, &currentBatch.semaphore) != VK_SUCCESS)
+				{
+					throw std::runtime_error("UploadManager: failed to create upload synchronization objects.");
+				}
+			}
+
+			if (gpuProfiler->canTimeTransfers())
+			{
+				VkQueryPoolCreateInfo poolInfo{};
+				poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+				poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+				poolInfo.queryCount = 2;
+
+				if (vkCreateQueryPool(device, &poolInfo, nullptr, &currentBatch.timestampPool) != VK_SUCCESS)
+				{
+					throw std::runtime_error("UploadManager: failed to create upload timestamp query pool.");
+				}
+			}
+		}
+
+		// Beginning a command buffer from a pool with the reset flag implicitly resets it.
+		VkCommandBufferBeginInfo beginInfo{};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+		if (vkBeginCommandBuffer(currentBatch.commandBuffer, &beginInfo) != VK_SUCCESS)
+		{
+			throw std::runtime_error("UploadManager: failed to begin recording upload command buffer.");
+		}
+
+		if (currentBatch.timestampPool != VK_NULL_HANDLE)
+		{
+			// Transfer queues may not support vkCmdResetQueryPool; the batch's previous results were read on recycling.
+			vkResetQueryPool(device, currentBatch.timestampPool, 0, 2);
+			vkCmdWriteTimestamp(currentBatch.commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, currentBatch.timestampPool, 0);
+		}
+
+		recording = true;
+	}
+
+	void UploadManager::waitForBatch(const uint64_t batchId)
+	{
+		// Batches the frame waited on have completed already, so this only blocks for uploads submitted without a graphics wait.
+		for (const auto& batch : submittedBatches)
+		{
+			if (batch.id == batchId)
+			{
+				if (uploadTimeline != VK_NULL_HANDLE)
+				{
+					waitTimelineSemaphore(device, uploadTimeline, batchId);
+				}
+				else
+				{
+					vkWaitForFences(device, 1, &batch.fence, VK_TRUE, UINT64_MAX);
+				}
+				return;
+			}
+		}
+	}
+
+	bool UploadManager::hasCompleted(const UploadBatch& batch) const
+	{
+		if (uploadTimeline != VK_NULL_HANDLE)
+		{
+			return getTimelineSemaphoreValue(device, uploadTimeline) >= batch.id;
+		}
+
+		return vkGetFenceStatus(device, batch.fence) == VK_SUCCESS;
+	}
+
+	bool UploadManager::isRecyclable(const UploadBatch& batch, const uint64_t completedFrames) const
+	{
+		if (!hasCompleted(batch))
+		{
+			return false;
+		}
+
+		// Timeline values are never reused, so the consuming frame does not have to retire first.
+		if (uploadTimeline != VK_NULL_HANDLE)
+		{
+			return true;
+		}
+
+		// A signaled binary semaphore cannot be signaled again until some submission has waited on it and retired.
+		return !batch.graphicsWait || (batch.waitConsumed && batch.consumingFrame < completedFrames);
+	}
+
+	void UploadManager::reportBatchTime(const UploadBatch& batch) const
+	{
+		if (batch.timestampPool == VK_NULL_HANDLE)
+		{
+			return;
+		}
+
+		uint64_t timestamps[2] = {};
+		if (vkGetQueryPoolResults(device, batch.timestampPool, 0, 2, sizeof(timestamps), timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS)
+		{
+			gpuProfiler->addTransferSample("Uploads", timestamps[0], timestamps[1]);
+		}
+	}
+
+	void UploadManager::destroyBatch(const UploadBatch& batch) const
+	{
+		vkDestroyQueryPool(device, batch.timestampPool, nullptr);
+		vkDestroySemaphore(device, batch.semaphore, nullptr);
+		vkDestroyFence(device, batch.fence, nullptr);
+	}
+
+	void UploadManager::clean()
+	{
+		if (recording)
+		{
+			flush(false);
+		}
+
+		if (uploadTimeline != VK_NULL_HANDLE)
+		{
+			waitTimelineSemaphore(device, uploadTimeline, lastSubmittedBatchId);
+		}
+
+		for (auto& batch : submittedBatches)
+		{
+			if (batch.fence != VK_NULL_HANDLE)
+			{
+				vkWaitForFences(device, 1, &batch.fence, VK_TRUE, UINT64_MAX);
+			}
+
+			for (const auto& release : batch.releases)
+			{
+				release();
+			}
+
+			destroyBatch(batch);
+		}
+		submittedBatches.clear();
+
+		for (const auto& batch : freeBatches)
+		{
+			destroyBatch(batch);
+		}
+		freeBatches.clear();
+
+		stagingRing.destroy(*memoryAllocator);
+
+		vkDestroySemaphore(device, uploadTimeline, nullptr);
+		uploadTimeline = VK_NULL_HANDLE;
+
+		// Command buffers are freed together with the pool.
+		vkDestroyCommandPool(device, commandPool, nullptr);
+	}
+
+}
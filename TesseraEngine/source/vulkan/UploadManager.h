@@ -0,0 +1,144 @@
+#pragma once
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+#include "StagingRing.h"
+#include "utils/interfaces/Initializable.h"
+
+namespace tessera::vulkan
+{
+
+	class GpuProfiler;
+
+	// Tightly packed data of one mip level.
+	struct ImageLevelUpload
+	{
+		const void* data = nullptr;
+		VkDeviceSize size = 0;
+		uint32_t mipLevel = 0;
+		VkExtent3D extent{};
+	};
+
+	/**
+	 * @brief Batches buffer copies onto the transfer queue.
+	 *
+	 * Copies are recorded into the current batch until flush() submits it with a fence and, optionally,
+	 * a semaphore the next graphics submission waits on. Nothing blocks the CPU: finished batches are
+	 * recycled from the frame loop once their fence has signaled and the frame that waited on them retired.
+	 * Source data is staged through a per-frame StagingRing; uploads that do not fit fall back to a
+	 * temporary staging buffer released with their batch.
+	 * With timeline semaphores enabled each batch signals the upload timeline with its id instead of
+	 * owning a fence and a binary semaphore.
+	 */
+	class UploadManager final : public Initializable
+	{
+	public:
+		void init() override;
+		void clean() override;
+
+		void enqueueBufferCopy(VkBuffer srcBuffer, VkBuffer dstBuffer, const VkBufferCopy& region);
+		// Copies are not ordered with each other; the ones recorded after this see what earlier ones wrote.
+		void enqueueTransferBarrier();
+
+		// Stage size bytes of data and copy them into dstBuffer at dstOffset.
+		void uploadToBuffer(const void* data, VkDeviceSize size, VkBuffer dstBuffer, VkDeviceSize dstOffset = 0);
+
+		/**
+		 * @brief Stage every level and copy it into the mip levels of dstImage.
+		 *
+		 * The levels move from an undefined layout to SHADER_READ_ONLY_OPTIMAL, so earlier contents are discarded.
+		 * dstImage must be created with getSharedQueueFamilies().
+		 */
+		void uploadToImage(VkImage dstImage, VkImageAspectFlags aspect, const std::vector<ImageLevelUpload>& levels);
+
+		/**
+		 * @brief Recycle the staging region of the frame about to be recorded.
+		 *
+		 * Must be called once the frame's in-flight fence has signaled.
+		 */
+		void beginFrame(uint64_t frameNumber);
+
+		/**
+		 * @brief Run callback once the current batch has completed on the GPU.
+		 *
+		 * Used to release staging resources without waiting on the transfer queue.
+		 */
+		void enqueueRelease(std::function<void()> release);
+
+		/**
+		 * @brief Submit the current batch to the transfer queue.
+		 *
+		 * @param graphicsWait Make the next graphics submission wait until the copies have landed.
+		 * @return Id of the submitted batch, or of the last submitted one if nothing was recorded.
+		 */
+		uint64_t flush(bool graphicsWait = true);
+
+		[[nodiscard]] bool isBatchComplete(uint64_t batchId);
+
+		/**
+		 * @brief Recycle batches whose copies finished and whose consuming frame retired.
+		 *
+		 * @param completedFrames Number of frames known to have finished executing on the graphics queue.
+		 */
+		void collectCompletedBatches(uint64_t completedFrames);
+
+		/**
+		 * @brief Append the waits the next graphics submission needs for pending uploads.
+		 *
+		 * waitValues receives the timeline value of each wait, 0 for binary semaphores.
+		 */
+		void consumeGraphicsWaits(uint64_t frameNumber, std::vector<VkSemaphore>& waitSemaphores, std::vector<VkPipelineStageFlags>& waitStages, std::vector<uint64_t>& waitValues);
+
+		// Queue families a destination buffer written by this manager is shared between.
+		[[nodiscard]] std::vector<uint32_t> getSharedQueueFamilies() const { return sharedQueueFamilies; }
+	private:
+		struct UploadBatch
+		{
+			VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+			VkFence fence = VK_NULL_HANDLE;
+			VkSemaphore semaphore = VK_NULL_HANDLE;
+			uint64_t id = 0;
+			bool graphicsWait = false;
+			bool waitConsumed = false;
+			uint64_t consumingFrame = 0;
+			// Two timestamps around the batch's copies; VK_NULL_HANDLE unless transfers are profiled.
+			VkQueryPool timestampPool = VK_NULL_HANDLE;
+			std::vector<std::function<void()>> releases;
+		};
+
+		void beginBatch();
+		// Copy data into staging memory read by the current batch. Called with uploadMutex held.
+		[[nodiscard]] StagingRange stage(const void* data, VkDeviceSize size);
+		void waitForBatch(uint64_t batchId);
+		[[nodiscard]] bool isRecyclable(const UploadBatch& batch, uint64_t completedFrames) const;
+		void destroyBatch(const UploadBatch& batch) const;
+		[[nodiscard]] bool hasCompleted(const UploadBatch& batch) const;
+		void reportBatchTime(const UploadBatch& batch) const;
+
+		VkDevice device = VK_NULL_HANDLE;
+		VkQueue transferQueue = VK_NULL_HANDLE;
+		VkCommandPool commandPool = VK_NULL_HANDLE;
+		// Signaled with the batch id on completion; VK_NULL_HANDLE when batches use fences.
+		VkSemaphore uploadTimeline = VK_NULL_HANDLE;
+		std::vector<uint32_t> sharedQueueFamilies;
+		std::shared_ptr<MemoryAllocator> memoryAllocator;
+		GpuProfiler* gpuProfiler = nullptr;
+		StagingRing stagingRing;
+
+		std::mutex uploadMutex;
+		bool recording = false;
+		UploadBatch currentBatch;
+		std::deque<UploadBatch> submittedBatches;
+		std::vector<UploadBatch> freeBatches;
+		uint64_t lastSubmittedBatchId = 0;
+
+		static constexpr VkDeviceSize STAGING_REGION_SIZE = 8ull * 1024 * 1024;
+		// Satisfies the texel alignment of every format as well as optimalBufferCopyOffsetAlignment on common hardware.
+		static constexpr VkDeviceSize STAGING_ALIGNMENT = 16;
+	};
+
+}